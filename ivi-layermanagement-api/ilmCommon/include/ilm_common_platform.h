@@ -36,6 +36,13 @@ ILM_COMMON_PLATFORM_FUNC gIlmCommonPlatformFunc;
 
 void init_ilmCommonPlatformTable();
 
+#ifdef ILM_MOCK_PLATFORM
+void init_ilmCommonMockPlatformTable();
+
+/* ILM_TRUE if ILM_PLATFORM=mock selects the in-memory platforms */
+t_ilm_bool is_ilmMockPlatformSelected();
+#endif /* ILM_MOCK_PLATFORM */
+
 #ifdef __cplusplus
 } /**/
 #endif /* __cplusplus */
@@ -149,6 +149,42 @@ typedef enum e_ilmOrientation
     ILM_TWOHUNDREDSEVENTY = 3           /*!< Orientation value, to describe 270 degree of rotation regarding the z-axis*/
 } ilmOrientation;
 
+/**
+ * \brief Enumeration of the policies for reporting property changes
+ * \ingroup ilmControl
+ **/
+typedef enum e_ilmEventRate
+{
+    ILM_EVENT_RATE_IMMEDIATE = 0,       /*!< changes are reported after every commit */
+    ILM_EVENT_RATE_FRAME = 1,           /*!< changes are merged and reported at most once per output repaint */
+    ILM_EVENT_RATE_LIMITED = 2          /*!< changes are merged and reported at most maxRate times per second */
+} ilmEventRate;
+
+/**
+ * \brief Enumeration of the file formats of screenshots
+ * \ingroup ilmControl
+ **/
+typedef enum e_ilmScreenshotFormat
+{
+    ILM_SCREENSHOT_FORMAT_PNG = 0,      /*!< compressed PNG image, the default */
+    ILM_SCREENSHOT_FORMAT_RAW = 1,      /*!< 16 byte header and uncompressed BGRA pixels */
+    ILM_SCREENSHOT_FORMAT_PPM = 2,      /*!< binary portable pixmap without alpha */
+    ILM_SCREENSHOT_FORMAT_PAM = 3,      /*!< portable arbitrary map with alpha */
+    ILM_SCREENSHOT_FORMAT_QOI = 4       /*!< quite OK image format with alpha */
+} ilmScreenshotFormat;
+
+/**
+ * \brief Enumeration of the easing curves of property transitions
+ * \ingroup ilmControl
+ **/
+typedef enum e_ilmTransitionEasing
+{
+    ILM_EASING_LINEAR = 0,              /*!< constant speed */
+    ILM_EASING_EASE_IN = 1,             /*!< starts slowly */
+    ILM_EASING_EASE_OUT = 2,            /*!< ends slowly */
+    ILM_EASING_EASE_IN_OUT = 3          /*!< starts and ends slowly */
+} ilmTransitionEasing;
+
 /**
  * \brief Identifier of different input device types. Can be used as a bitmask.
  * \ingroup ilmClient
@@ -280,6 +316,64 @@ struct ilmScreenProperties
     t_ilm_uint screenHeight;        /*!< height value of screen in pixels */
 };
 
+/**
+ * \brief Typedef for representing the presentation of a frame aligned commit
+ * \ingroup ilmControl
+ **/
+struct ilmPresentationTiming
+{
+    t_ilm_uint seconds;     /*!< frame time of the repaint containing the changes, seconds part */
+    t_ilm_uint nanoseconds; /*!< frame time of the repaint containing the changes, nanoseconds part */
+    t_ilm_uint sequence;    /*!< number of frames repainted by the output */
+};
+
+/**
+ * \brief Typedef for representing a screenshot taken into shared memory
+ * \ingroup ilmControl
+ **/
+struct ilmScreenshotBuffer
+{
+    t_ilm_uint width;       /*!< width of the captured area in pixels */
+    t_ilm_uint height;      /*!< height of the captured area in pixels */
+    t_ilm_uint stride;      /*!< number of bytes between two rows of pixels */
+    t_ilm_uint format;      /*!< wl_shm format of the pixels, 0 is ARGB8888 */
+    t_ilm_uint size;        /*!< size of the memory at pixels in bytes */
+    void* pixels;           /*!< pixel data, the captured area starts at the top left corner */
+    struct ilmPresentationTiming timing; /*!< repaint the pixels were read from, 0 if unknown */
+};
+
+/**
+ * \brief Typedef for representing a frame of a continuous capture
+ * \ingroup ilmControl
+ **/
+struct ilmCaptureFrame
+{
+    struct ilmScreenshotBuffer buffer; /*!< pixels, size and timing of the frame */
+    t_ilm_uint damageCount;  /*!< number of rectangles changed since the previous frame */
+    t_ilm_int* damage;       /*!< x, y, width and height of each changed rectangle */
+};
+
+/**
+ * \brief Number of frame interval buckets in struct ilmSurfaceFrameStats
+ * \ingroup ilmControl
+ **/
+#define ILM_FRAME_INTERVAL_BUCKETS 8
+
+/**
+ * \brief Typedef for representing the frame statistics of a surface
+ * \ingroup ilmControl
+ **/
+struct ilmSurfaceFrameStats
+{
+    t_ilm_uint commitCount;     /*!< content updates of the surface */
+    t_ilm_uint presentCount;    /*!< content updates shown on a screen */
+    t_ilm_uint dropCount;       /*!< content updates replaced before they were shown */
+    t_ilm_uint latencyAverage;  /*!< average time from update to end of repaint in microseconds */
+    t_ilm_uint latencyMax;      /*!< maximum time from update to end of repaint in microseconds */
+    t_ilm_float fps;            /*!< shown content updates per second over the last second */
+    t_ilm_uint intervals[ILM_FRAME_INTERVAL_BUCKETS]; /*!< times between shown updates, buckets end at 17, 34, 50, 67, 100, 200 and 500 ms */
+};
+
 /**
  * enum representing all possible incoming events for ilmClient and
  * Communicator Plugin
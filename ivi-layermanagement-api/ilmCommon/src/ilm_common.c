@@ -37,6 +37,20 @@ ILM_EXPORT ilmErrorTypes ilmControl_init(t_ilm_nativedisplay);
 ILM_EXPORT void ilmClient_destroy();
 ILM_EXPORT void ilmControl_destroy();
 
+#ifdef ILM_MOCK_PLATFORM
+/* ILM_PLATFORM=mock runs ilmCommon and ilmControl without a compositor */
+ILM_EXPORT t_ilm_bool
+is_ilmMockPlatformSelected()
+{
+    const char *platform = getenv("ILM_PLATFORM");
+
+    if ((platform != NULL) && (strcmp(platform, "mock") == 0)) {
+        return ILM_TRUE;
+    }
+    return ILM_FALSE;
+}
+#endif /* ILM_MOCK_PLATFORM */
+
 ILM_EXPORT ilmErrorTypes
 ilm_init()
 {
@@ -49,6 +63,27 @@ ilm_initWithNativedisplay(t_ilm_nativedisplay nativedisplay)
     ilmErrorTypes err = ILM_SUCCESS;
     t_ilm_nativedisplay display = 0;
 
+#ifdef ILM_MOCK_PLATFORM
+    if (is_ilmMockPlatformSelected() == ILM_TRUE)
+    {
+        /* there is no compositor to serve ilmClient */
+        init_ilmCommonMockPlatformTable();
+
+        err = gIlmCommonPlatformFunc.init(nativedisplay);
+        if (ILM_SUCCESS != err)
+        {
+            return err;
+        }
+
+        err = ilmControl_init(gIlmCommonPlatformFunc.getNativedisplay());
+        if (ILM_SUCCESS != err)
+        {
+            gIlmCommonPlatformFunc.destroy();
+        }
+        return err;
+    }
+#endif /* ILM_MOCK_PLATFORM */
+
     init_ilmCommonPlatformTable();
 
     err = gIlmCommonPlatformFunc.init(nativedisplay);
@@ -87,6 +122,13 @@ ILM_EXPORT ilmErrorTypes
 ilm_destroy()
 {
     ilmErrorTypes retVal = gIlmCommonPlatformFunc.destroy();
+#ifdef ILM_MOCK_PLATFORM
+    if (is_ilmMockPlatformSelected() == ILM_TRUE)
+    {
+        ilmControl_destroy();
+        return retVal;
+    }
+#endif /* ILM_MOCK_PLATFORM */
     ilmClient_destroy();
     ilmControl_destroy(); // block until control thread is stopped
     return retVal;
@@ -0,0 +1,93 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ilm_common.h"
+#include "ilm_common_platform.h"
+#include "ilm_types.h"
+
+static ilmErrorTypes mock_init(t_ilm_nativedisplay nativedisplay);
+static t_ilm_nativedisplay mock_getNativedisplay();
+static t_ilm_bool mock_isInitialized();
+static ilmErrorTypes mock_destroy();
+
+void init_ilmCommonMockPlatformTable()
+{
+    gIlmCommonPlatformFunc.init = mock_init;
+    gIlmCommonPlatformFunc.getNativedisplay = mock_getNativedisplay;
+    gIlmCommonPlatformFunc.isInitialized = mock_isInitialized;
+    gIlmCommonPlatformFunc.destroy = mock_destroy;
+}
+
+/*
+ *=============================================================================
+ * global vars
+ *=============================================================================
+ */
+struct ilm_common_mock_context {
+    int32_t valid;
+    t_ilm_nativedisplay display;
+};
+
+static struct ilm_common_mock_context ilm_context = {0, 0};
+
+/*
+ * The mock platform has no display connection. A native display passed
+ * in by the application is kept and handed on untouched.
+ */
+static ilmErrorTypes
+mock_init(t_ilm_nativedisplay nativedisplay)
+{
+    struct ilm_common_mock_context *ctx = &ilm_context;
+
+    ctx->display = nativedisplay;
+    ctx->valid = 1;
+
+    return ILM_SUCCESS;
+}
+
+static t_ilm_nativedisplay
+mock_getNativedisplay()
+{
+    struct ilm_common_mock_context *ctx = &ilm_context;
+
+    return ctx->display;
+}
+
+static t_ilm_bool
+mock_isInitialized()
+{
+    struct ilm_common_mock_context *ctx = &ilm_context;
+
+    if (ctx->valid != 0) {
+        return ILM_TRUE;
+    } else {
+        return ILM_FALSE;
+    }
+}
+
+static ilmErrorTypes
+mock_destroy()
+{
+    struct ilm_common_mock_context *ctx = &ilm_context;
+
+    ctx->valid = 0;
+
+    return ILM_SUCCESS;
+}
@@ -496,6 +496,8 @@ ilmErrorTypes ilm_displaySetRenderOrder(t_ilm_display display, t_ilm_layer *pLay
 /**
  * \brief Take a screenshot from the current displayed layer scene.
  * The screenshot is saved as bmp file with the corresponding filename.
+ * The call returns when the file has been written if the compositor
+ * reports completion, otherwise as soon as the request was sent.
  * \ingroup ilmControl
  * \param[in] screen Id of screen where screenshot should be taken
  * \param[in] filename Location where the screenshot should be stored
@@ -506,7 +508,10 @@ ilmErrorTypes ilm_takeScreenshot(t_ilm_uint screen, t_ilm_const_string filename)
 
 /**
  * \brief Take a screenshot of a certain layer
- * The screenshot is saved as bmp file with the corresponding filename.
+ * The area covered by the layer is saved as png file with the corresponding
+ * filename.
+ * The call returns when the file has been written if the compositor
+ * reports completion, otherwise as soon as the request was sent.
  * \ingroup ilmControl
  * \param[in] filename Location where the screenshot should be stored
  * \param[in] layerid Identifier of the layer to take the screenshot of
@@ -518,6 +523,8 @@ ilmErrorTypes ilm_takeLayerScreenshot(t_ilm_const_string filename, t_ilm_layer l
 /**
  * \brief Take a screenshot of a certain surface
  * The screenshot is saved as bmp file with the corresponding filename.
+ * The call returns when the file has been written if the compositor
+ * reports completion, otherwise as soon as the request was sent.
  * \ingroup ilmControl
  * \param[in] filename Location where the screenshot should be stored
  * \param[in] surfaceid Identifier of the surface to take the screenshot of
@@ -526,6 +533,129 @@ ilmErrorTypes ilm_takeLayerScreenshot(t_ilm_const_string filename, t_ilm_layer l
  */
 ilmErrorTypes ilm_takeSurfaceScreenshot(t_ilm_const_string filename, t_ilm_surface surfaceid);
 
+/**
+ * \brief Take a screenshot from the current displayed layer scene into shared memory.
+ * The compositor copies the raw pixels into a shared memory buffer after its
+ * next repaint, no file is written. The buffer must be released with
+ * ilm_releaseScreenshotBuffer.
+ * \ingroup ilmControl
+ * \param[in] screen Id of screen where screenshot should be taken
+ * \param[out] pBuffer pixels, format and size of the screenshot
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the client can not call the method on the service.
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support
+ *         screenshots into shared memory
+ */
+ilmErrorTypes ilm_takeScreenshotToBuffer(t_ilm_uint screen, struct ilmScreenshotBuffer* pBuffer);
+
+/**
+ * \brief Take a screenshot of a certain layer into shared memory
+ * The area covered by the layer is read back from the screen showing it, so
+ * content stacked above the layer is included.
+ * The buffer must be released with ilm_releaseScreenshotBuffer.
+ * \ingroup ilmControl
+ * \param[in] layerid Identifier of the layer to take the screenshot of
+ * \param[out] pBuffer pixels, format and size of the screenshot
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the client can not call the method on the service.
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support
+ *         screenshots into shared memory
+ */
+ilmErrorTypes ilm_takeLayerScreenshotToBuffer(t_ilm_layer layerid, struct ilmScreenshotBuffer* pBuffer);
+
+/**
+ * \brief Take a screenshot of a certain surface into shared memory
+ * The area covered by the surface is read back from the screen showing it, so
+ * content stacked above the surface is included.
+ * The buffer must be released with ilm_releaseScreenshotBuffer.
+ * \ingroup ilmControl
+ * \param[in] surfaceid Identifier of the surface to take the screenshot of
+ * \param[out] pBuffer pixels, format and size of the screenshot
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the client can not call the method on the service.
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support
+ *         screenshots into shared memory
+ */
+ilmErrorTypes ilm_takeSurfaceScreenshotToBuffer(t_ilm_surface surfaceid, struct ilmScreenshotBuffer* pBuffer);
+
+/**
+ * \brief Release the memory of a screenshot taken into shared memory
+ * \ingroup ilmControl
+ * \param[in] pBuffer screenshot filled by one of the ilm_take*ScreenshotToBuffer calls
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the buffer was not filled by a screenshot
+ */
+ilmErrorTypes ilm_releaseScreenshotBuffer(struct ilmScreenshotBuffer* pBuffer);
+
+/**
+ * \brief Start a continuous capture of a screen
+ * After every interval-th repaint of the screen the compositor copies the
+ * screen into one of bufferCount shared memory buffers, which are handed
+ * out by ilm_getCaptureFrame. The capture is paused while all buffers are
+ * held by the caller.
+ * \ingroup ilmControl
+ * \param[in] screen Id of the screen to capture
+ * \param[in] interval number of repaints per captured frame, 0 is treated as 1
+ * \param[in] bufferCount number of frames which can be held at the same time
+ * \param[out] pCaptureId identifier of the new capture
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the client can not call the method on the service.
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support
+ *         continuous captures
+ */
+ilmErrorTypes ilm_startScreenCapture(t_ilm_uint screen, t_ilm_uint interval, t_ilm_uint bufferCount, t_ilm_uint* pCaptureId);
+
+/**
+ * \brief Start a continuous capture of the area covered by a surface
+ * The area covered by the surface is read back from the screen showing it,
+ * so content stacked above the surface is included. Nothing is captured
+ * while the surface is not shown. See ilm_startScreenCapture.
+ * \ingroup ilmControl
+ * \param[in] surfaceid Identifier of the surface to capture
+ * \param[in] interval number of repaints per captured frame, 0 is treated as 1
+ * \param[in] bufferCount number of frames which can be held at the same time
+ * \param[out] pCaptureId identifier of the new capture
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the client can not call the method on the service.
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support
+ *         continuous captures
+ */
+ilmErrorTypes ilm_startSurfaceCapture(t_ilm_surface surfaceid, t_ilm_uint interval, t_ilm_uint bufferCount, t_ilm_uint* pCaptureId);
+
+/**
+ * \brief Wait for the next frame of a continuous capture
+ * Frames are returned in the order they were captured. The damage lists
+ * the rectangles changed since the previous frame of the capture. The
+ * frame stays valid until it is passed to ilm_releaseCaptureFrame.
+ * \ingroup ilmControl
+ * \param[in] captureId identifier of the capture
+ * \param[out] pFrame pixels, timing and damage of the frame
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the capture was stopped or the client can not call
+ *         the method on the service.
+ */
+ilmErrorTypes ilm_getCaptureFrame(t_ilm_uint captureId, struct ilmCaptureFrame* pFrame);
+
+/**
+ * \brief Hand a frame back to a continuous capture to be filled again
+ * \ingroup ilmControl
+ * \param[in] captureId identifier of the capture
+ * \param[in] pFrame frame returned by ilm_getCaptureFrame
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the frame does not belong to the capture
+ */
+ilmErrorTypes ilm_releaseCaptureFrame(t_ilm_uint captureId, struct ilmCaptureFrame* pFrame);
+
+/**
+ * \brief Stop a continuous capture and free its buffers
+ * Frames which were not released become invalid.
+ * \ingroup ilmControl
+ * \param[in] captureId identifier of the capture
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the capture does not exist
+ */
+ilmErrorTypes ilm_stopCapture(t_ilm_uint captureId);
+
 /**
  * \brief Enable or disable a rendering optimization
  *
@@ -569,6 +699,241 @@ ilmErrorTypes ilm_layerAddNotification(t_ilm_layer layer, layerNotificationFunc
  */
 ilmErrorTypes ilm_layerRemoveNotification(t_ilm_layer layer);
 
+/**
+ * \brief Limit how often property changes are reported to this client.
+ *
+ * Passive controllers, which only need a coarse view of the scene, can
+ * let the compositor merge the changes per object and report only the
+ * latest values after an output repaint. This applies to the properties
+ * returned by the get functions and passed to layer notifications.
+ * \ingroup ilmControl
+ * \param[in] policy when changes are reported
+ * \param[in] maxRate maximum number of reports per second for
+ *            ILM_EVENT_RATE_LIMITED, ignored otherwise
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_ERROR_INVALID_ARGUMENTS if the policy is unknown
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support
+ *         event rate policies
+ */
+ilmErrorTypes ilm_setEventRate(ilmEventRate policy, t_ilm_uint maxRate);
+
+/**
+ * \brief Restrict the surfaces and layers reported to this client.
+ *
+ * Controllers which only manage a part of the scene can let the
+ * compositor leave out the other objects. Once a range was added, only
+ * surfaces and layers in a range have their properties updated and their
+ * notifications called. Objects created outside of the ranges are not
+ * known to this client. With withMembers, a layer range also covers the
+ * surfaces on these layers.
+ * \ingroup ilmControl
+ * \param[in] type ILM_SURFACE or ILM_LAYER
+ * \param[in] idMin first id of the range
+ * \param[in] idMax last id of the range
+ * \param[in] withMembers ILM_TRUE to include the surfaces on the layers of
+ *            a layer range, ignored for surface ranges
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_ERROR_INVALID_ARGUMENTS if the type is unknown or idMin is
+ *         larger than idMax
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support
+ *         interest ranges
+ */
+ilmErrorTypes ilm_addInterest(ilmObjectType type, t_ilm_uint idMin,
+                              t_ilm_uint idMax, t_ilm_bool withMembers);
+
+/**
+ * \brief Restrict the properties reported to this client.
+ *
+ * Only changes of the properties in mask are reported, the others keep
+ * the value they had when the mask was set. The pixel format of surfaces
+ * is only reported with ILM_NOTIFICATION_ALL.
+ * \ingroup ilmControl
+ * \param[in] mask properties to report
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support
+ *         interest ranges
+ */
+ilmErrorTypes ilm_setInterestMask(t_ilm_notification_mask mask);
+
+/**
+ * \brief Report all surfaces, layers and properties again.
+ *
+ * Objects created while they were left out are not announced afterwards.
+ * \ingroup ilmControl
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support
+ *         interest ranges
+ */
+ilmErrorTypes ilm_clearInterest(void);
+
+/**
+ * \brief Get the frame statistics of a surface.
+ *
+ * The compositor counts the content updates of the surface since it was
+ * created, how many of them were shown on a screen and how long that took.
+ * \ingroup ilmControl
+ * \param[in] surfaceId id of the surface
+ * \param[out] pStats the statistics of the surface
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the surface does not exist
+ * \return ILM_ERROR_INVALID_ARGUMENTS if pStats is NULL
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not provide
+ *         frame statistics
+ */
+ilmErrorTypes ilm_getSurfaceFrameStats(t_ilm_surface surfaceId,
+                                       struct ilmSurfaceFrameStats* pStats);
+
+/**
+ * \brief Set the file format of the screenshots taken by this client.
+ *
+ * PNG files are small but slow to encode. The other formats store the
+ * pixels with little or no compression, which is much faster for large
+ * screens. The format applies to ilm_takeScreenshot(),
+ * ilm_takeLayerScreenshot() and ilm_takeSurfaceScreenshot(). Other
+ * formats than PNG store the area of a surface on its screen, so the
+ * surface has to be shown.
+ * \ingroup ilmControl
+ * \param[in] format file format of the following screenshots
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_ERROR_INVALID_ARGUMENTS if the format is unknown
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor only supports PNG
+ */
+ilmErrorTypes ilm_setScreenshotFormat(ilmScreenshotFormat format);
+
+/**
+ * \brief Let the compositor change the opacity of a surface over time.
+ *
+ * The transition starts with the next ilm_commitChanges(). The compositor
+ * moves the opacity from its current value to the target on every repaint,
+ * so the controller sends one request instead of one per frame. Setting
+ * the opacity with ilm_surfaceSetOpacity() cancels the transition.
+ * \ingroup ilmControl
+ * \param[in] surfaceId id of the surface
+ * \param[in] opacity target opacity, 0.0 (transparent) to 1.0 (opaque)
+ * \param[in] durationMillis duration of the transition in milliseconds
+ * \param[in] easing progress of the transition over time
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the surface does not exist
+ * \return ILM_ERROR_INVALID_ARGUMENTS if the easing is unknown
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support
+ *         transitions
+ */
+ilmErrorTypes ilm_surfaceTransitionOpacity(t_ilm_surface surfaceId,
+                                           t_ilm_float opacity,
+                                           t_ilm_uint durationMillis,
+                                           ilmTransitionEasing easing);
+
+/**
+ * \brief Let the compositor move the destination rectangle of a surface
+ *        over time.
+ *
+ * Like ilm_surfaceTransitionOpacity(), for the destination rectangle. It
+ * is cancelled by ilm_surfaceSetDestinationRectangle().
+ * \ingroup ilmControl
+ * \param[in] surfaceId id of the surface
+ * \param[in] x target horizontal position within the layer
+ * \param[in] y target vertical position within the layer
+ * \param[in] width target width within the layer
+ * \param[in] height target height within the layer
+ * \param[in] durationMillis duration of the transition in milliseconds
+ * \param[in] easing progress of the transition over time
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the surface does not exist
+ * \return ILM_ERROR_INVALID_ARGUMENTS if the easing is unknown
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support
+ *         transitions
+ */
+ilmErrorTypes ilm_surfaceTransitionDestinationRectangle(
+                                           t_ilm_surface surfaceId,
+                                           t_ilm_int x, t_ilm_int y,
+                                           t_ilm_int width, t_ilm_int height,
+                                           t_ilm_uint durationMillis,
+                                           ilmTransitionEasing easing);
+
+/**
+ * \brief Let the compositor change the opacity of a layer over time.
+ *
+ * Like ilm_surfaceTransitionOpacity(), for a layer. It is cancelled by
+ * ilm_layerSetOpacity().
+ * \ingroup ilmControl
+ * \param[in] layerId id of the layer
+ * \param[in] opacity target opacity, 0.0 (transparent) to 1.0 (opaque)
+ * \param[in] durationMillis duration of the transition in milliseconds
+ * \param[in] easing progress of the transition over time
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the layer does not exist
+ * \return ILM_ERROR_INVALID_ARGUMENTS if the easing is unknown
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support
+ *         transitions
+ */
+ilmErrorTypes ilm_layerTransitionOpacity(t_ilm_layer layerId,
+                                         t_ilm_float opacity,
+                                         t_ilm_uint durationMillis,
+                                         ilmTransitionEasing easing);
+
+/**
+ * \brief Let the compositor move the destination rectangle of a layer
+ *        over time.
+ *
+ * Like ilm_surfaceTransitionOpacity(), for the destination rectangle of
+ * a layer. It is cancelled by ilm_layerSetDestinationRectangle().
+ * \ingroup ilmControl
+ * \param[in] layerId id of the layer
+ * \param[in] x target horizontal position on the screen
+ * \param[in] y target vertical position on the screen
+ * \param[in] width target width on the screen
+ * \param[in] height target height on the screen
+ * \param[in] durationMillis duration of the transition in milliseconds
+ * \param[in] easing progress of the transition over time
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the layer does not exist
+ * \return ILM_ERROR_INVALID_ARGUMENTS if the easing is unknown
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support
+ *         transitions
+ */
+ilmErrorTypes ilm_layerTransitionDestinationRectangle(t_ilm_layer layerId,
+                                         t_ilm_int x, t_ilm_int y,
+                                         t_ilm_int width, t_ilm_int height,
+                                         t_ilm_uint durationMillis,
+                                         ilmTransitionEasing easing);
+
+/**
+ * \brief Get whether a surface contributes to the content of a screen.
+ *
+ * Unlike the visibility set with ilm_surfaceSetVisibility(), the effective
+ * visibility is determined by the compositor after each commit. It is
+ * ILM_FALSE if the surface or its layers are hidden or fully transparent,
+ * if the surface is not on a layer of a screen, if it is outside of its
+ * layer or the screen, or if it is fully covered by opaque surfaces above
+ * it. Applications can use it to pause rendering.
+ * \ingroup ilmControl
+ * \param[in] surfaceId id of the surface
+ * \param[out] pVisibility effective visibility of the surface
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the surface does not exist or pVisibility is NULL
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not report the
+ *         effective visibility
+ */
+ilmErrorTypes ilm_surfaceGetEffectiveVisibility(t_ilm_surface surfaceId,
+                                                t_ilm_bool *pVisibility);
+
+/**
+ * \brief Commit all changes at the start of the next output repaint.
+ *
+ * All changes committed this way until the next repaint are applied
+ * together, so they become visible in the same frame. The call blocks
+ * until the frame containing the changes was repainted, which allows
+ * animations to be paced by the output refresh.
+ * \ingroup ilmControl
+ * \param[out] pTiming optional, frame time and sequence number of the
+ *             repaint which contained the changes
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the changes could not be presented
+ * \return ILM_ERROR_NOT_IMPLEMENTED if the compositor does not support
+ *         frame aligned commits
+ */
+ilmErrorTypes ilm_commitChangesOnFrame(struct ilmPresentationTiming* pTiming);
+
 #ifdef __cplusplus
 } /**/
 #endif /* __cplusplus */
@@ -139,12 +139,61 @@ typedef struct _ILM_CONTROL_PLATFORM_FUNC
                    t_ilm_int x, t_ilm_int y,
                    t_ilm_int width, t_ilm_int height);
     ilmErrorTypes (*commitChanges)();
+    ilmErrorTypes (*commitChangesOnFrame)(
+                   struct ilmPresentationTiming* pTiming);
+    ilmErrorTypes (*takeScreenshotToBuffer)(t_ilm_uint screen,
+                   struct ilmScreenshotBuffer* pBuffer);
+    ilmErrorTypes (*takeLayerScreenshotToBuffer)(t_ilm_layer layerid,
+                   struct ilmScreenshotBuffer* pBuffer);
+    ilmErrorTypes (*takeSurfaceScreenshotToBuffer)(t_ilm_surface surfaceid,
+                   struct ilmScreenshotBuffer* pBuffer);
+    ilmErrorTypes (*releaseScreenshotBuffer)(
+                   struct ilmScreenshotBuffer* pBuffer);
+    ilmErrorTypes (*startScreenCapture)(t_ilm_uint screen,
+                   t_ilm_uint interval, t_ilm_uint bufferCount,
+                   t_ilm_uint* pCaptureId);
+    ilmErrorTypes (*startSurfaceCapture)(t_ilm_surface surfaceid,
+                   t_ilm_uint interval, t_ilm_uint bufferCount,
+                   t_ilm_uint* pCaptureId);
+    ilmErrorTypes (*getCaptureFrame)(t_ilm_uint captureId,
+                   struct ilmCaptureFrame* pFrame);
+    ilmErrorTypes (*releaseCaptureFrame)(t_ilm_uint captureId,
+                   struct ilmCaptureFrame* pFrame);
+    ilmErrorTypes (*stopCapture)(t_ilm_uint captureId);
+    ilmErrorTypes (*setEventRate)(ilmEventRate policy, t_ilm_uint maxRate);
+    ilmErrorTypes (*getSurfaceFrameStats)(t_ilm_surface surfaceId,
+                   struct ilmSurfaceFrameStats* pStats);
+    ilmErrorTypes (*setScreenshotFormat)(ilmScreenshotFormat format);
+    ilmErrorTypes (*surfaceTransitionOpacity)(t_ilm_surface surfaceId,
+                   t_ilm_float opacity, t_ilm_uint durationMillis,
+                   ilmTransitionEasing easing);
+    ilmErrorTypes (*surfaceTransitionDestinationRectangle)(
+                   t_ilm_surface surfaceId, t_ilm_int x, t_ilm_int y,
+                   t_ilm_int width, t_ilm_int height,
+                   t_ilm_uint durationMillis, ilmTransitionEasing easing);
+    ilmErrorTypes (*layerTransitionOpacity)(t_ilm_layer layerId,
+                   t_ilm_float opacity, t_ilm_uint durationMillis,
+                   ilmTransitionEasing easing);
+    ilmErrorTypes (*layerTransitionDestinationRectangle)(
+                   t_ilm_layer layerId, t_ilm_int x, t_ilm_int y,
+                   t_ilm_int width, t_ilm_int height,
+                   t_ilm_uint durationMillis, ilmTransitionEasing easing);
+    ilmErrorTypes (*surfaceGetEffectiveVisibility)(t_ilm_surface surfaceId,
+                   t_ilm_bool *pVisibility);
+    ilmErrorTypes (*addInterest)(ilmObjectType type, t_ilm_uint idMin,
+                   t_ilm_uint idMax, t_ilm_bool withMembers);
+    ilmErrorTypes (*setInterestMask)(t_ilm_notification_mask mask);
+    ilmErrorTypes (*clearInterest)(void);
 } ILM_CONTROL_PLATFORM_FUNC;
 
 ILM_CONTROL_PLATFORM_FUNC gIlmControlPlatformFunc;
 
 void init_ilmControlPlatformTable();
 
+#ifdef ILM_MOCK_PLATFORM
+void init_ilmControlMockPlatformTable();
+#endif /* ILM_MOCK_PLATFORM */
+
 #ifdef __cplusplus
 } /**/
 #endif /* __cplusplus */
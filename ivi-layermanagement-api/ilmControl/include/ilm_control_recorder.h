@@ -0,0 +1,179 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ****************************************************************************/
+#ifndef _ILM_CONTROL_RECORDER_H_
+#define _ILM_CONTROL_RECORDER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include "ilm_common.h"
+
+/*
+ * Call log of the ilmControl platform table
+ *
+ * When ILM_CONTROL_RECORD names a file, ilmControl_init() wraps the
+ * active platform so that every call is appended to that file with its
+ * arguments, its result, a CLOCK_MONOTONIC timestamp and its duration.
+ * A log can be replayed against any platform, either with the recorded
+ * timing or as fast as possible.
+ * Continuous captures are passed through without being recorded, their
+ * frames depend on the compositor rather than on the calls. So are the
+ * event rate, the interest ranges and the screenshot format, which only
+ * change what the recording client observes, and the frame statistics
+ * and the effective visibility of surfaces, which are determined by the
+ * compositor.
+ *
+ * The file starts with the magic "ILMR" and a 32 bit version, followed
+ * by one record per call: a struct ilmRecordHeader and `size` bytes of
+ * arguments as 32 bit words. All values are in host byte order.
+ */
+#define ILM_RECORD_MAGIC   0x524d4c49  /* "ILMR" */
+#define ILM_RECORD_VERSION 1
+
+struct ilmRecordHeader
+{
+    unsigned short func;          /* index of the call, see ilmRecordFunc */
+    unsigned short client;        /* sending client in compositor journals */
+    int            result;        /* ilmErrorTypes returned by the call */
+    unsigned long long timestamp; /* start of the call in ns */
+    unsigned int   duration;      /* duration of the call in ns */
+    unsigned int   size;          /* size of the arguments in bytes */
+};
+
+/*
+ * Recorded calls. The values are stored in the log and must not change;
+ * new calls are added at the end.
+ */
+typedef enum e_ilmRecordFunc
+{
+    ILM_RECORD_GET_PROPERTIES_OF_LAYER = 0,
+    ILM_RECORD_GET_PROPERTIES_OF_SCREEN,
+    ILM_RECORD_GET_NUMBER_OF_HARDWARE_LAYERS,
+    ILM_RECORD_GET_SCREEN_IDS,
+    ILM_RECORD_GET_LAYER_IDS,
+    ILM_RECORD_GET_LAYER_IDS_ON_SCREEN,
+    ILM_RECORD_GET_SURFACE_IDS,
+    ILM_RECORD_GET_SURFACE_IDS_ON_LAYER,
+    ILM_RECORD_LAYER_CREATE_WITH_DIMENSION,
+    ILM_RECORD_LAYER_REMOVE,
+    ILM_RECORD_LAYER_GET_TYPE,
+    ILM_RECORD_LAYER_SET_VISIBILITY,
+    ILM_RECORD_LAYER_GET_VISIBILITY,
+    ILM_RECORD_LAYER_SET_OPACITY,
+    ILM_RECORD_LAYER_GET_OPACITY,
+    ILM_RECORD_LAYER_SET_SOURCE_RECTANGLE,
+    ILM_RECORD_LAYER_SET_DESTINATION_RECTANGLE,
+    ILM_RECORD_LAYER_GET_DIMENSION,
+    ILM_RECORD_LAYER_SET_DIMENSION,
+    ILM_RECORD_LAYER_GET_POSITION,
+    ILM_RECORD_LAYER_SET_POSITION,
+    ILM_RECORD_LAYER_SET_ORIENTATION,
+    ILM_RECORD_LAYER_GET_ORIENTATION,
+    ILM_RECORD_LAYER_SET_CHROMA_KEY,
+    ILM_RECORD_LAYER_SET_RENDER_ORDER,
+    ILM_RECORD_LAYER_GET_CAPABILITIES,
+    ILM_RECORD_LAYER_TYPE_GET_CAPABILITIES,
+    ILM_RECORD_SURFACE_SET_VISIBILITY,
+    ILM_RECORD_SURFACE_SET_OPACITY,
+    ILM_RECORD_SURFACE_GET_OPACITY,
+    ILM_RECORD_SET_KEYBOARD_FOCUS_ON,
+    ILM_RECORD_GET_KEYBOARD_FOCUS_SURFACE_ID,
+    ILM_RECORD_SURFACE_SET_DESTINATION_RECTANGLE,
+    ILM_RECORD_SURFACE_SET_DIMENSION,
+    ILM_RECORD_SURFACE_GET_POSITION,
+    ILM_RECORD_SURFACE_SET_POSITION,
+    ILM_RECORD_SURFACE_SET_ORIENTATION,
+    ILM_RECORD_SURFACE_GET_ORIENTATION,
+    ILM_RECORD_SURFACE_GET_PIXELFORMAT,
+    ILM_RECORD_SURFACE_SET_CHROMA_KEY,
+    ILM_RECORD_DISPLAY_SET_RENDER_ORDER,
+    ILM_RECORD_TAKE_SCREENSHOT,
+    ILM_RECORD_TAKE_LAYER_SCREENSHOT,
+    ILM_RECORD_TAKE_SURFACE_SCREENSHOT,
+    ILM_RECORD_SET_OPTIMIZATION_MODE,
+    ILM_RECORD_GET_OPTIMIZATION_MODE,
+    ILM_RECORD_LAYER_ADD_NOTIFICATION,
+    ILM_RECORD_LAYER_REMOVE_NOTIFICATION,
+    ILM_RECORD_DESTROY,
+    ILM_RECORD_GET_NATIVE_HANDLE,
+    ILM_RECORD_GET_PROPERTIES_OF_SURFACE,
+    ILM_RECORD_LAYER_ADD_SURFACE,
+    ILM_RECORD_LAYER_REMOVE_SURFACE,
+    ILM_RECORD_SURFACE_GET_DIMENSION,
+    ILM_RECORD_SURFACE_GET_VISIBILITY,
+    ILM_RECORD_SURFACE_SET_SOURCE_RECTANGLE,
+    ILM_RECORD_COMMIT_CHANGES,
+    ILM_RECORD_COMMIT_CHANGES_ON_FRAME,
+    ILM_RECORD_TAKE_SCREENSHOT_TO_BUFFER,
+    ILM_RECORD_TAKE_LAYER_SCREENSHOT_TO_BUFFER,
+    ILM_RECORD_TAKE_SURFACE_SCREENSHOT_TO_BUFFER,
+    ILM_RECORD_SURFACE_TRANSITION_OPACITY,
+    ILM_RECORD_SURFACE_TRANSITION_DESTINATION_RECTANGLE,
+    ILM_RECORD_LAYER_TRANSITION_OPACITY,
+    ILM_RECORD_LAYER_TRANSITION_DESTINATION_RECTANGLE,
+    ILM_RECORD_FUNC_COUNT
+} ilmRecordFunc;
+
+/*
+ * Outcome of a replay. Times are in microseconds.
+ */
+struct ilmReplayStatistics
+{
+    t_ilm_uint  callCount;      /* number of replayed calls */
+    t_ilm_uint  mismatchCount;  /* calls whose result differs from the log */
+    t_ilm_uint  skippedCount;   /* records which could not be replayed */
+    t_ilm_ulong recordedTime;   /* time span covered by the log */
+    t_ilm_ulong elapsedTime;    /* time taken by the replay */
+    t_ilm_ulong callTime;       /* time spent inside the platform calls */
+};
+
+/**
+ * \brief Start recording all calls of the active ilmControl platform.
+ * \ingroup ilmControl
+ * \param[in] filename log file, an existing file is overwritten
+ * \return ILM_SUCCESS if the method call was successful
+ * \return ILM_FAILED if the file could not be created or recording is active
+ */
+ilmErrorTypes ilmControl_startRecording(t_ilm_const_string filename);
+
+/**
+ * \brief Stop recording and close the log file.
+ * \ingroup ilmControl
+ */
+void ilmControl_stopRecording();
+
+/**
+ * \brief Replay a call log against the active ilmControl platform.
+ * \ingroup ilmControl
+ * \param[in] filename log file written by ilmControl_startRecording()
+ * \param[in] realtime ILM_TRUE to keep the recorded timing,
+ *            ILM_FALSE to replay as fast as possible
+ * \param[out] pStatistics optional, receives the replay statistics
+ * \return ILM_SUCCESS if the log was replayed completely
+ * \return ILM_FAILED if the file could not be read or is corrupt
+ */
+ilmErrorTypes ilmControl_replay(t_ilm_const_string filename,
+                                t_ilm_bool realtime,
+                                struct ilmReplayStatistics* pStatistics);
+
+#ifdef __cplusplus
+} /**/
+#endif /* __cplusplus */
+
+#endif /* _ILM_CONTROL_RECORDER_H_ */
@@ -23,7 +23,9 @@
 #include <pthread.h>
 #include <signal.h>
 #include "ilm_common.h"
+#include "ilm_common_platform.h"
 #include "ilm_control_platform.h"
+#include "ilm_control_recorder.h"
 
 /* GCC visibility */
 #if defined(__GNUC__) && __GNUC__ >= 4
@@ -35,9 +37,36 @@
 ILM_EXPORT ilmErrorTypes
 ilmControl_init(t_ilm_nativedisplay nativedisplay)
 {
-    init_ilmControlPlatformTable();
-
-    return gIlmControlPlatformFunc.init(nativedisplay);
+    ilmErrorTypes result = ILM_FAILED;
+    const char *record_file = NULL;
+
+#ifdef ILM_MOCK_PLATFORM
+    /* ILM_PLATFORM=mock replaces the wayland platform by an in-memory
+     * scene, see ilm_control_mock_platform.c */
+    if (is_ilmMockPlatformSelected() == ILM_TRUE)
+    {
+        init_ilmControlMockPlatformTable();
+    }
+    else
+#endif /* ILM_MOCK_PLATFORM */
+    {
+        init_ilmControlPlatformTable();
+    }
+
+    result = gIlmControlPlatformFunc.init(nativedisplay);
+    if (result != ILM_SUCCESS)
+    {
+        return result;
+    }
+
+    /* recording failures are reported but do not stop the controller */
+    record_file = getenv("ILM_CONTROL_RECORD");
+    if ((record_file != NULL) && (*record_file != '\0'))
+    {
+        ilmControl_startRecording(record_file);
+    }
+
+    return ILM_SUCCESS;
 }
 
 ILM_EXPORT void
@@ -343,6 +372,71 @@ ilm_takeSurfaceScreenshot(t_ilm_const_string filename, t_ilm_surface surfaceid)
     return gIlmControlPlatformFunc.takeSurfaceScreenshot(filename, surfaceid);
 }
 
+ILM_EXPORT ilmErrorTypes
+ilm_takeScreenshotToBuffer(t_ilm_uint screen,
+                           struct ilmScreenshotBuffer* pBuffer)
+{
+    return gIlmControlPlatformFunc.takeScreenshotToBuffer(screen, pBuffer);
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_takeLayerScreenshotToBuffer(t_ilm_layer layerid,
+                                struct ilmScreenshotBuffer* pBuffer)
+{
+    return gIlmControlPlatformFunc.takeLayerScreenshotToBuffer(layerid,
+                                                               pBuffer);
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_takeSurfaceScreenshotToBuffer(t_ilm_surface surfaceid,
+                                  struct ilmScreenshotBuffer* pBuffer)
+{
+    return gIlmControlPlatformFunc.takeSurfaceScreenshotToBuffer(surfaceid,
+                                                                 pBuffer);
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_releaseScreenshotBuffer(struct ilmScreenshotBuffer* pBuffer)
+{
+    return gIlmControlPlatformFunc.releaseScreenshotBuffer(pBuffer);
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_startScreenCapture(t_ilm_uint screen, t_ilm_uint interval,
+                       t_ilm_uint bufferCount, t_ilm_uint* pCaptureId)
+{
+    return gIlmControlPlatformFunc.startScreenCapture(screen, interval,
+                                                      bufferCount,
+                                                      pCaptureId);
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_startSurfaceCapture(t_ilm_surface surfaceid, t_ilm_uint interval,
+                        t_ilm_uint bufferCount, t_ilm_uint* pCaptureId)
+{
+    return gIlmControlPlatformFunc.startSurfaceCapture(surfaceid, interval,
+                                                       bufferCount,
+                                                       pCaptureId);
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_getCaptureFrame(t_ilm_uint captureId, struct ilmCaptureFrame* pFrame)
+{
+    return gIlmControlPlatformFunc.getCaptureFrame(captureId, pFrame);
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_releaseCaptureFrame(t_ilm_uint captureId, struct ilmCaptureFrame* pFrame)
+{
+    return gIlmControlPlatformFunc.releaseCaptureFrame(captureId, pFrame);
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_stopCapture(t_ilm_uint captureId)
+{
+    return gIlmControlPlatformFunc.stopCapture(captureId);
+}
+
 ILM_EXPORT ilmErrorTypes
 ilm_SetOptimizationMode(ilmOptimization id, ilmOptimizationMode mode)
 {
@@ -367,6 +461,93 @@ ilm_layerRemoveNotification(t_ilm_layer layer)
     return gIlmControlPlatformFunc.layerRemoveNotification(layer);
 }
 
+ILM_EXPORT ilmErrorTypes
+ilm_setEventRate(ilmEventRate policy, t_ilm_uint maxRate)
+{
+    return gIlmControlPlatformFunc.setEventRate(policy, maxRate);
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_addInterest(ilmObjectType type, t_ilm_uint idMin, t_ilm_uint idMax,
+                t_ilm_bool withMembers)
+{
+    return gIlmControlPlatformFunc.addInterest(type, idMin, idMax,
+                                               withMembers);
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_setInterestMask(t_ilm_notification_mask mask)
+{
+    return gIlmControlPlatformFunc.setInterestMask(mask);
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_clearInterest(void)
+{
+    return gIlmControlPlatformFunc.clearInterest();
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_getSurfaceFrameStats(t_ilm_surface surfaceId,
+                         struct ilmSurfaceFrameStats* pStats)
+{
+    return gIlmControlPlatformFunc.getSurfaceFrameStats(surfaceId, pStats);
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_setScreenshotFormat(ilmScreenshotFormat format)
+{
+    return gIlmControlPlatformFunc.setScreenshotFormat(format);
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_surfaceTransitionOpacity(t_ilm_surface surfaceId, t_ilm_float opacity,
+                             t_ilm_uint durationMillis,
+                             ilmTransitionEasing easing)
+{
+    return gIlmControlPlatformFunc.surfaceTransitionOpacity(
+               surfaceId, opacity, durationMillis, easing);
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_surfaceTransitionDestinationRectangle(t_ilm_surface surfaceId,
+                                          t_ilm_int x, t_ilm_int y,
+                                          t_ilm_int width, t_ilm_int height,
+                                          t_ilm_uint durationMillis,
+                                          ilmTransitionEasing easing)
+{
+    return gIlmControlPlatformFunc.surfaceTransitionDestinationRectangle(
+               surfaceId, x, y, width, height, durationMillis, easing);
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_layerTransitionOpacity(t_ilm_layer layerId, t_ilm_float opacity,
+                           t_ilm_uint durationMillis,
+                           ilmTransitionEasing easing)
+{
+    return gIlmControlPlatformFunc.layerTransitionOpacity(
+               layerId, opacity, durationMillis, easing);
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_layerTransitionDestinationRectangle(t_ilm_layer layerId,
+                                        t_ilm_int x, t_ilm_int y,
+                                        t_ilm_int width, t_ilm_int height,
+                                        t_ilm_uint durationMillis,
+                                        ilmTransitionEasing easing)
+{
+    return gIlmControlPlatformFunc.layerTransitionDestinationRectangle(
+               layerId, x, y, width, height, durationMillis, easing);
+}
+
+ILM_EXPORT ilmErrorTypes
+ilm_surfaceGetEffectiveVisibility(t_ilm_surface surfaceId,
+                                  t_ilm_bool *pVisibility)
+{
+    return gIlmControlPlatformFunc.surfaceGetEffectiveVisibility(
+               surfaceId, pVisibility);
+}
+
 ILM_EXPORT ilmErrorTypes
 ilm_getNativeHandle(t_ilm_uint pid, t_ilm_const_char *p_window_title,
                     t_ilm_int *p_handle, t_ilm_nativehandle **p_handles)
@@ -420,3 +601,9 @@ ilm_commitChanges()
 {
     return gIlmControlPlatformFunc.commitChanges();
 }
+
+ILM_EXPORT ilmErrorTypes
+ilm_commitChangesOnFrame(struct ilmPresentationTiming* pTiming)
+{
+    return gIlmControlPlatformFunc.commitChangesOnFrame(pTiming);
+}
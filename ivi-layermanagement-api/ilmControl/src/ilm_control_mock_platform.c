@@ -0,0 +1,2459 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ****************************************************************************/
+/*
+ * In-memory ilmControl platform.
+ *
+ * Keeps the whole scene inside the process, so that HMI logic and the
+ * ilm API itself can be exercised and benchmarked without a running
+ * compositor. It is selected at runtime with ILM_PLATFORM=mock when the
+ * library was built with BUILD_ILM_MOCK_PLATFORM.
+ *
+ * The semantics follow the wayland platform: setters are staged and only
+ * become visible to getters and notifications on ilm_commitChanges(),
+ * layers are created and removed immediately, and surfaces come into
+ * existence the first time a setter references them (like
+ * ivi_controller.surface_create does in the compositor).
+ *
+ * Environment:
+ *   ILM_MOCK_SCREENS            number of screens (default 1)
+ *   ILM_MOCK_SCREEN_SIZE        screen resolution, e.g. 1920x1080
+ *   ILM_MOCK_LATENCY_US         artificial delay added to every call,
+ *                               standing in for the protocol roundtrip
+ *   ILM_MOCK_COMMIT_LATENCY_US  additional delay added to commits
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <memory.h>
+#include <unistd.h>
+#include <time.h>
+#include "ilm_common.h"
+#include "ilm_control_platform.h"
+#include "wayland-util.h"
+
+static ilmErrorTypes mock_getPropertiesOfLayer(t_ilm_uint layerID,
+                     struct ilmLayerProperties* pLayerProperties);
+static ilmErrorTypes mock_getPropertiesOfScreen(t_ilm_display screenID,
+                     struct ilmScreenProperties* pScreenProperties);
+static ilmErrorTypes mock_getNumberOfHardwareLayers(t_ilm_uint screenID,
+                     t_ilm_uint* pNumberOfHardwareLayers);
+static ilmErrorTypes mock_getScreenIDs(t_ilm_uint* pNumberOfIDs,
+                     t_ilm_uint** ppIDs);
+static ilmErrorTypes mock_getLayerIDs(t_ilm_int* pLength,
+                     t_ilm_layer** ppArray);
+static ilmErrorTypes mock_getLayerIDsOnScreen(t_ilm_uint screenId,
+                     t_ilm_int* pLength, t_ilm_layer** ppArray);
+static ilmErrorTypes mock_getSurfaceIDs(t_ilm_int* pLength,
+                     t_ilm_surface** ppArray);
+static ilmErrorTypes mock_getSurfaceIDsOnLayer(t_ilm_layer layer,
+                     t_ilm_int* pLength, t_ilm_surface** ppArray);
+static ilmErrorTypes mock_layerCreateWithDimension(t_ilm_layer* pLayerId,
+                     t_ilm_uint width, t_ilm_uint height);
+static ilmErrorTypes mock_layerRemove(t_ilm_layer layerId);
+static ilmErrorTypes mock_layerGetType(t_ilm_layer layerId,
+                     ilmLayerType* pLayerType);
+static ilmErrorTypes mock_layerSetVisibility(t_ilm_layer layerId,
+                     t_ilm_bool newVisibility);
+static ilmErrorTypes mock_layerGetVisibility(t_ilm_layer layerId,
+                     t_ilm_bool *pVisibility);
+static ilmErrorTypes mock_layerSetOpacity(t_ilm_layer layerId,
+                     t_ilm_float opacity);
+static ilmErrorTypes mock_layerGetOpacity(t_ilm_layer layerId,
+                     t_ilm_float *pOpacity);
+static ilmErrorTypes mock_layerSetSourceRectangle(t_ilm_layer layerId,
+                     t_ilm_uint x, t_ilm_uint y,
+                     t_ilm_uint width, t_ilm_uint height);
+static ilmErrorTypes mock_layerSetDestinationRectangle(t_ilm_layer layerId,
+                     t_ilm_int x, t_ilm_int y,
+                     t_ilm_int width, t_ilm_int height);
+static ilmErrorTypes mock_layerGetDimension(t_ilm_layer layerId,
+                     t_ilm_uint *pDimension);
+static ilmErrorTypes mock_layerSetDimension(t_ilm_layer layerId,
+                     t_ilm_uint *pDimension);
+static ilmErrorTypes mock_layerGetPosition(t_ilm_layer layerId,
+                     t_ilm_uint *pPosition);
+static ilmErrorTypes mock_layerSetPosition(t_ilm_layer layerId,
+                     t_ilm_uint *pPosition);
+static ilmErrorTypes mock_layerSetOrientation(t_ilm_layer layerId,
+                     ilmOrientation orientation);
+static ilmErrorTypes mock_layerGetOrientation(t_ilm_layer layerId,
+                     ilmOrientation *pOrientation);
+static ilmErrorTypes mock_layerSetChromaKey(t_ilm_layer layerId,
+                     t_ilm_int* pColor);
+static ilmErrorTypes mock_layerSetRenderOrder(t_ilm_layer layerId,
+                     t_ilm_layer *pSurfaceId,
+                     t_ilm_int number);
+static ilmErrorTypes mock_layerGetCapabilities(t_ilm_layer layerId,
+                     t_ilm_layercapabilities *pCapabilities);
+static ilmErrorTypes mock_layerTypeGetCapabilities(ilmLayerType layerType,
+                     t_ilm_layercapabilities *pCapabilities);
+static ilmErrorTypes mock_surfaceSetVisibility(t_ilm_surface surfaceId,
+                     t_ilm_bool newVisibility);
+static ilmErrorTypes mock_surfaceSetOpacity(t_ilm_surface surfaceId,
+                     t_ilm_float opacity);
+static ilmErrorTypes mock_surfaceGetOpacity(t_ilm_surface surfaceId,
+                     t_ilm_float *pOpacity);
+static ilmErrorTypes mock_SetKeyboardFocusOn(t_ilm_surface surfaceId);
+static ilmErrorTypes mock_GetKeyboardFocusSurfaceId(
+                     t_ilm_surface* pSurfaceId);
+static ilmErrorTypes mock_surfaceSetDestinationRectangle(
+                     t_ilm_surface surfaceId,
+                     t_ilm_int x, t_ilm_int y,
+                     t_ilm_int width, t_ilm_int height);
+static ilmErrorTypes mock_surfaceSetDimension(t_ilm_surface surfaceId,
+                     t_ilm_uint *pDimension);
+static ilmErrorTypes mock_surfaceGetPosition(t_ilm_surface surfaceId,
+                     t_ilm_uint *pPosition);
+static ilmErrorTypes mock_surfaceSetPosition(t_ilm_surface surfaceId,
+                     t_ilm_uint *pPosition);
+static ilmErrorTypes mock_surfaceSetOrientation(t_ilm_surface surfaceId,
+                     ilmOrientation orientation);
+static ilmErrorTypes mock_surfaceGetOrientation(t_ilm_surface surfaceId,
+                     ilmOrientation *pOrientation);
+static ilmErrorTypes mock_surfaceGetPixelformat(t_ilm_layer surfaceId,
+                     ilmPixelFormat *pPixelformat);
+static ilmErrorTypes mock_surfaceSetChromaKey(t_ilm_surface surfaceId,
+                     t_ilm_int* pColor);
+static ilmErrorTypes mock_displaySetRenderOrder(t_ilm_display display,
+                     t_ilm_layer *pLayerId, const t_ilm_uint number);
+static ilmErrorTypes mock_takeScreenshot(t_ilm_uint screen,
+                     t_ilm_const_string filename);
+static ilmErrorTypes mock_takeLayerScreenshot(t_ilm_const_string filename,
+                     t_ilm_layer layerid);
+static ilmErrorTypes mock_takeSurfaceScreenshot(t_ilm_const_string filename,
+                     t_ilm_surface surfaceid);
+static ilmErrorTypes mock_SetOptimizationMode(ilmOptimization id,
+                     ilmOptimizationMode mode);
+static ilmErrorTypes mock_GetOptimizationMode(ilmOptimization id,
+                     ilmOptimizationMode* pMode);
+static ilmErrorTypes mock_layerAddNotification(t_ilm_layer layer,
+                     layerNotificationFunc callback);
+static ilmErrorTypes mock_layerRemoveNotification(t_ilm_layer layer);
+static ilmErrorTypes mock_init(t_ilm_nativedisplay nativedisplay);
+static void mock_destroy();
+static ilmErrorTypes mock_getNativeHandle(t_ilm_uint pid,
+                     t_ilm_int *n_handle,
+                     t_ilm_nativehandle **p_handles);
+static ilmErrorTypes mock_getPropertiesOfSurface(t_ilm_uint surfaceID,
+                     struct ilmSurfaceProperties* pSurfaceProperties);
+static ilmErrorTypes mock_layerAddSurface(t_ilm_layer layerId,
+                     t_ilm_surface surfaceId);
+static ilmErrorTypes mock_layerRemoveSurface(t_ilm_layer layerId,
+                     t_ilm_surface surfaceId);
+static ilmErrorTypes mock_surfaceGetDimension(t_ilm_surface surfaceId,
+                     t_ilm_uint *pDimension);
+static ilmErrorTypes mock_surfaceGetVisibility(t_ilm_surface surfaceId,
+                     t_ilm_bool *pVisibility);
+static ilmErrorTypes mock_surfaceSetSourceRectangle(t_ilm_surface surfaceId,
+                     t_ilm_int x, t_ilm_int y,
+                     t_ilm_int width, t_ilm_int height);
+static ilmErrorTypes mock_commitChanges();
+static ilmErrorTypes mock_commitChangesOnFrame(
+                     struct ilmPresentationTiming* pTiming);
+static ilmErrorTypes mock_takeScreenshotToBuffer(t_ilm_uint screen,
+                     struct ilmScreenshotBuffer* pBuffer);
+static ilmErrorTypes mock_takeLayerScreenshotToBuffer(t_ilm_layer layerid,
+                     struct ilmScreenshotBuffer* pBuffer);
+static ilmErrorTypes mock_takeSurfaceScreenshotToBuffer(
+                     t_ilm_surface surfaceid,
+                     struct ilmScreenshotBuffer* pBuffer);
+static ilmErrorTypes mock_releaseScreenshotBuffer(
+                     struct ilmScreenshotBuffer* pBuffer);
+static ilmErrorTypes mock_startScreenCapture(t_ilm_uint screen,
+                     t_ilm_uint interval, t_ilm_uint bufferCount,
+                     t_ilm_uint* pCaptureId);
+static ilmErrorTypes mock_startSurfaceCapture(t_ilm_surface surfaceid,
+                     t_ilm_uint interval, t_ilm_uint bufferCount,
+                     t_ilm_uint* pCaptureId);
+static ilmErrorTypes mock_getCaptureFrame(t_ilm_uint captureId,
+                     struct ilmCaptureFrame* pFrame);
+static ilmErrorTypes mock_releaseCaptureFrame(t_ilm_uint captureId,
+                     struct ilmCaptureFrame* pFrame);
+static ilmErrorTypes mock_stopCapture(t_ilm_uint captureId);
+static ilmErrorTypes mock_setEventRate(ilmEventRate policy,
+                     t_ilm_uint maxRate);
+static ilmErrorTypes mock_getSurfaceFrameStats(t_ilm_surface surfaceId,
+                     struct ilmSurfaceFrameStats* pStats);
+static ilmErrorTypes mock_setScreenshotFormat(ilmScreenshotFormat format);
+static ilmErrorTypes mock_surfaceTransitionOpacity(t_ilm_surface surfaceId,
+                     t_ilm_float opacity, t_ilm_uint durationMillis,
+                     ilmTransitionEasing easing);
+static ilmErrorTypes mock_surfaceTransitionDestinationRectangle(
+                     t_ilm_surface surfaceId, t_ilm_int x, t_ilm_int y,
+                     t_ilm_int width, t_ilm_int height,
+                     t_ilm_uint durationMillis, ilmTransitionEasing easing);
+static ilmErrorTypes mock_layerTransitionOpacity(t_ilm_layer layerId,
+                     t_ilm_float opacity, t_ilm_uint durationMillis,
+                     ilmTransitionEasing easing);
+static ilmErrorTypes mock_layerTransitionDestinationRectangle(
+                     t_ilm_layer layerId, t_ilm_int x, t_ilm_int y,
+                     t_ilm_int width, t_ilm_int height,
+                     t_ilm_uint durationMillis, ilmTransitionEasing easing);
+static ilmErrorTypes mock_surfaceGetEffectiveVisibility(
+                     t_ilm_surface surfaceId, t_ilm_bool *pVisibility);
+static ilmErrorTypes mock_addInterest(ilmObjectType type,
+                     t_ilm_uint idMin, t_ilm_uint idMax,
+                     t_ilm_bool withMembers);
+static ilmErrorTypes mock_setInterestMask(t_ilm_notification_mask mask);
+static ilmErrorTypes mock_clearInterest(void);
+
+void init_ilmControlMockPlatformTable()
+{
+    gIlmControlPlatformFunc.getPropertiesOfLayer =
+        mock_getPropertiesOfLayer;
+    gIlmControlPlatformFunc.getPropertiesOfScreen =
+        mock_getPropertiesOfScreen;
+    gIlmControlPlatformFunc.getNumberOfHardwareLayers =
+        mock_getNumberOfHardwareLayers;
+    gIlmControlPlatformFunc.getScreenIDs =
+        mock_getScreenIDs;
+    gIlmControlPlatformFunc.getLayerIDs =
+        mock_getLayerIDs;
+    gIlmControlPlatformFunc.getLayerIDsOnScreen =
+        mock_getLayerIDsOnScreen;
+    gIlmControlPlatformFunc.getSurfaceIDs =
+        mock_getSurfaceIDs;
+    gIlmControlPlatformFunc.getSurfaceIDsOnLayer =
+        mock_getSurfaceIDsOnLayer;
+    gIlmControlPlatformFunc.layerCreateWithDimension =
+        mock_layerCreateWithDimension;
+    gIlmControlPlatformFunc.layerRemove =
+        mock_layerRemove;
+    gIlmControlPlatformFunc.layerGetType =
+        mock_layerGetType;
+    gIlmControlPlatformFunc.layerSetVisibility =
+        mock_layerSetVisibility;
+    gIlmControlPlatformFunc.layerGetVisibility =
+        mock_layerGetVisibility;
+    gIlmControlPlatformFunc.layerSetOpacity =
+        mock_layerSetOpacity;
+    gIlmControlPlatformFunc.layerGetOpacity =
+        mock_layerGetOpacity;
+    gIlmControlPlatformFunc.layerSetSourceRectangle =
+        mock_layerSetSourceRectangle;
+    gIlmControlPlatformFunc.layerSetDestinationRectangle =
+        mock_layerSetDestinationRectangle;
+    gIlmControlPlatformFunc.layerGetDimension =
+        mock_layerGetDimension;
+    gIlmControlPlatformFunc.layerSetDimension =
+        mock_layerSetDimension;
+    gIlmControlPlatformFunc.layerGetPosition =
+        mock_layerGetPosition;
+    gIlmControlPlatformFunc.layerSetPosition =
+        mock_layerSetPosition;
+    gIlmControlPlatformFunc.layerSetOrientation =
+        mock_layerSetOrientation;
+    gIlmControlPlatformFunc.layerGetOrientation =
+        mock_layerGetOrientation;
+    gIlmControlPlatformFunc.layerSetChromaKey =
+        mock_layerSetChromaKey;
+    gIlmControlPlatformFunc.layerSetRenderOrder =
+        mock_layerSetRenderOrder;
+    gIlmControlPlatformFunc.layerGetCapabilities =
+        mock_layerGetCapabilities;
+    gIlmControlPlatformFunc.layerTypeGetCapabilities =
+        mock_layerTypeGetCapabilities;
+    gIlmControlPlatformFunc.surfaceSetVisibility =
+        mock_surfaceSetVisibility;
+    gIlmControlPlatformFunc.surfaceSetOpacity =
+        mock_surfaceSetOpacity;
+    gIlmControlPlatformFunc.surfaceGetOpacity =
+        mock_surfaceGetOpacity;
+    gIlmControlPlatformFunc.SetKeyboardFocusOn =
+        mock_SetKeyboardFocusOn;
+    gIlmControlPlatformFunc.GetKeyboardFocusSurfaceId =
+        mock_GetKeyboardFocusSurfaceId;
+    gIlmControlPlatformFunc.surfaceSetDestinationRectangle =
+        mock_surfaceSetDestinationRectangle;
+    gIlmControlPlatformFunc.surfaceSetDimension =
+        mock_surfaceSetDimension;
+    gIlmControlPlatformFunc.surfaceGetPosition =
+        mock_surfaceGetPosition;
+    gIlmControlPlatformFunc.surfaceSetPosition =
+        mock_surfaceSetPosition;
+    gIlmControlPlatformFunc.surfaceSetOrientation =
+        mock_surfaceSetOrientation;
+    gIlmControlPlatformFunc.surfaceGetOrientation =
+        mock_surfaceGetOrientation;
+    gIlmControlPlatformFunc.surfaceGetPixelformat =
+        mock_surfaceGetPixelformat;
+    gIlmControlPlatformFunc.surfaceSetChromaKey =
+        mock_surfaceSetChromaKey;
+    gIlmControlPlatformFunc.displaySetRenderOrder =
+        mock_displaySetRenderOrder;
+    gIlmControlPlatformFunc.takeScreenshot =
+        mock_takeScreenshot;
+    gIlmControlPlatformFunc.takeLayerScreenshot =
+        mock_takeLayerScreenshot;
+    gIlmControlPlatformFunc.takeSurfaceScreenshot =
+        mock_takeSurfaceScreenshot;
+    gIlmControlPlatformFunc.SetOptimizationMode =
+        mock_SetOptimizationMode;
+    gIlmControlPlatformFunc.GetOptimizationMode =
+        mock_GetOptimizationMode;
+    gIlmControlPlatformFunc.layerAddNotification =
+        mock_layerAddNotification;
+    gIlmControlPlatformFunc.layerRemoveNotification =
+        mock_layerRemoveNotification;
+    gIlmControlPlatformFunc.init =
+        mock_init;
+    gIlmControlPlatformFunc.destroy =
+        mock_destroy;
+    gIlmControlPlatformFunc.getNativeHandle =
+        mock_getNativeHandle;
+    gIlmControlPlatformFunc.getPropertiesOfSurface =
+        mock_getPropertiesOfSurface;
+    gIlmControlPlatformFunc.layerAddSurface =
+        mock_layerAddSurface;
+    gIlmControlPlatformFunc.layerRemoveSurface =
+        mock_layerRemoveSurface;
+    gIlmControlPlatformFunc.surfaceGetDimension =
+        mock_surfaceGetDimension;
+    gIlmControlPlatformFunc.surfaceGetVisibility =
+        mock_surfaceGetVisibility;
+    gIlmControlPlatformFunc.surfaceSetSourceRectangle =
+        mock_surfaceSetSourceRectangle;
+    gIlmControlPlatformFunc.commitChanges =
+        mock_commitChanges;
+    gIlmControlPlatformFunc.commitChangesOnFrame =
+        mock_commitChangesOnFrame;
+    gIlmControlPlatformFunc.takeScreenshotToBuffer =
+        mock_takeScreenshotToBuffer;
+    gIlmControlPlatformFunc.takeLayerScreenshotToBuffer =
+        mock_takeLayerScreenshotToBuffer;
+    gIlmControlPlatformFunc.takeSurfaceScreenshotToBuffer =
+        mock_takeSurfaceScreenshotToBuffer;
+    gIlmControlPlatformFunc.releaseScreenshotBuffer =
+        mock_releaseScreenshotBuffer;
+    gIlmControlPlatformFunc.startScreenCapture =
+        mock_startScreenCapture;
+    gIlmControlPlatformFunc.startSurfaceCapture =
+        mock_startSurfaceCapture;
+    gIlmControlPlatformFunc.getCaptureFrame =
+        mock_getCaptureFrame;
+    gIlmControlPlatformFunc.releaseCaptureFrame =
+        mock_releaseCaptureFrame;
+    gIlmControlPlatformFunc.stopCapture =
+        mock_stopCapture;
+    gIlmControlPlatformFunc.setEventRate =
+        mock_setEventRate;
+    gIlmControlPlatformFunc.getSurfaceFrameStats =
+        mock_getSurfaceFrameStats;
+    gIlmControlPlatformFunc.setScreenshotFormat =
+        mock_setScreenshotFormat;
+    gIlmControlPlatformFunc.surfaceTransitionOpacity =
+        mock_surfaceTransitionOpacity;
+    gIlmControlPlatformFunc.surfaceTransitionDestinationRectangle =
+        mock_surfaceTransitionDestinationRectangle;
+    gIlmControlPlatformFunc.layerTransitionOpacity =
+        mock_layerTransitionOpacity;
+    gIlmControlPlatformFunc.layerTransitionDestinationRectangle =
+        mock_layerTransitionDestinationRectangle;
+    gIlmControlPlatformFunc.surfaceGetEffectiveVisibility =
+        mock_surfaceGetEffectiveVisibility;
+    gIlmControlPlatformFunc.addInterest =
+        mock_addInterest;
+    gIlmControlPlatformFunc.setInterestMask =
+        mock_setInterestMask;
+    gIlmControlPlatformFunc.clearInterest =
+        mock_clearInterest;
+}
+
+/*
+ * Staged changes are tracked per object with the same bits that are
+ * reported to layer notifications.
+ */
+#define MOCK_PENDING_ORDER ILM_BIT(16)
+
+/*
+ * Render orders are kept as plain id arrays. An object id may be listed
+ * in several orders, exactly as in the compositor.
+ */
+struct mock_order {
+    t_ilm_uint *ids;
+    t_ilm_uint count;
+    t_ilm_uint capacity;
+};
+
+struct mock_surface {
+    struct wl_list link;
+    t_ilm_surface id_surface;
+
+    struct ilmSurfaceProperties prop;
+    struct ilmSurfaceProperties pending;
+    uint32_t pending_mask;
+};
+
+struct mock_layer {
+    struct wl_list link;
+    t_ilm_layer id_layer;
+
+    struct ilmLayerProperties prop;
+    struct ilmLayerProperties pending;
+    uint32_t pending_mask;
+    layerNotificationFunc notification;
+    /* changes not reported yet because of the event rate */
+    t_ilm_notification_mask held_mask;
+
+    struct mock_order order;
+    struct mock_order pending_order;
+};
+
+struct mock_screen {
+    struct wl_list link;
+    t_ilm_uint id_screen;
+    t_ilm_uint width;
+    t_ilm_uint height;
+
+    struct mock_order order;
+    struct mock_order pending_order;
+    uint32_t pending_mask;
+};
+
+struct mock_interest {
+    ilmObjectType type;
+    t_ilm_uint id_min;
+    t_ilm_uint id_max;
+};
+
+struct mock_capture {
+    struct wl_list link;
+    t_ilm_uint id_capture;
+    t_ilm_uint id_target;
+    int surface;
+    t_ilm_uint interval;
+    t_ilm_uint num_buffer;
+    t_ilm_uint num_held;
+    /* commit_count at the last frame, the first frame is damaged fully */
+    uint32_t commit_seen;
+    int started;
+};
+
+struct ilm_mock_context {
+    int32_t valid;
+
+    struct wl_list list_surface;
+    struct wl_list list_layer;
+    struct wl_list list_screen;
+    struct wl_list list_capture;
+
+    uint32_t internal_id_layer;
+    uint32_t internal_id_capture;
+    t_ilm_surface keyboard_focus;
+    uint32_t frame_count;
+    uint32_t commit_count;
+    ilmEventRate event_rate;
+    ilmScreenshotFormat screenshot_format;
+
+    /* ranges of ilm_addInterest, all objects are reported without any */
+    struct mock_interest *interests;
+    t_ilm_uint interest_count;
+    t_ilm_notification_mask interest_mask;
+
+    useconds_t latency_us;
+    useconds_t commit_latency_us;
+};
+
+static struct ilm_mock_context ilm_context = {0};
+
+static uint32_t
+env_to_uint(const char *name, uint32_t default_value)
+{
+    const char *value = getenv(name);
+    char *end = NULL;
+    unsigned long result = 0;
+
+    if ((value == NULL) || (*value == '\0')) {
+        return default_value;
+    }
+
+    result = strtoul(value, &end, 10);
+    if (*end != '\0') {
+        fprintf(stderr, "ignoring invalid value %s=%s\n", name, value);
+        return default_value;
+    }
+
+    return (uint32_t)result;
+}
+
+static void
+order_release(struct mock_order *order)
+{
+    free(order->ids);
+    memset(order, 0, sizeof *order);
+}
+
+static int32_t
+order_reserve(struct mock_order *order, t_ilm_uint count)
+{
+    t_ilm_uint capacity = order->capacity;
+    t_ilm_uint *ids = NULL;
+
+    if (count <= capacity) {
+        return 0;
+    }
+
+    if (capacity == 0) {
+        capacity = 8;
+    }
+    while (capacity < count) {
+        capacity *= 2;
+    }
+
+    ids = realloc(order->ids, capacity * sizeof *ids);
+    if (ids == NULL) {
+        fprintf(stderr, "failed to allocate render order in mock platform\n");
+        return -1;
+    }
+
+    order->ids = ids;
+    order->capacity = capacity;
+    return 0;
+}
+
+static int32_t
+order_copy(struct mock_order *dst, const struct mock_order *src)
+{
+    if (order_reserve(dst, src->count) != 0) {
+        return -1;
+    }
+
+    if (src->count > 0) {
+        memcpy(dst->ids, src->ids, src->count * sizeof *src->ids);
+    }
+    dst->count = src->count;
+    return 0;
+}
+
+static int32_t
+order_find(const struct mock_order *order, t_ilm_uint id)
+{
+    t_ilm_uint i = 0;
+
+    for (i = 0; i < order->count; i++) {
+        if (order->ids[i] == id) {
+            return (int32_t)i;
+        }
+    }
+
+    return -1;
+}
+
+static int32_t
+order_append(struct mock_order *order, t_ilm_uint id)
+{
+    if (order_find(order, id) >= 0) {
+        return 0;
+    }
+
+    if (order_reserve(order, order->count + 1) != 0) {
+        return -1;
+    }
+
+    order->ids[order->count++] = id;
+    return 0;
+}
+
+static void
+order_remove(struct mock_order *order, t_ilm_uint id)
+{
+    int32_t index = order_find(order, id);
+
+    if (index < 0) {
+        return;
+    }
+
+    memmove(&order->ids[index], &order->ids[index + 1],
+            (order->count - (t_ilm_uint)index - 1) * sizeof *order->ids);
+    order->count--;
+}
+
+static int32_t
+order_set(struct mock_order *order, const t_ilm_uint *ids, t_ilm_uint count)
+{
+    t_ilm_uint i = 0;
+
+    order->count = 0;
+    if (order_reserve(order, count) != 0) {
+        return -1;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (order_append(order, ids[i]) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static ilmErrorTypes
+order_to_array(const struct mock_order *order,
+               t_ilm_int *pLength, t_ilm_uint **ppArray)
+{
+    /* allocate at least one element, callers free() the result */
+    *ppArray = malloc((order->count + 1) * sizeof **ppArray);
+    if (*ppArray == NULL) {
+        *pLength = 0;
+        return ILM_FAILED;
+    }
+
+    if (order->count > 0) {
+        memcpy(*ppArray, order->ids, order->count * sizeof **ppArray);
+    }
+    *pLength = (t_ilm_int)order->count;
+
+    return ILM_SUCCESS;
+}
+
+static struct ilm_mock_context*
+get_instance()
+{
+    struct ilm_mock_context *ctx = &ilm_context;
+
+    if (ctx->latency_us > 0) {
+        usleep(ctx->latency_us);
+    }
+
+    return ctx;
+}
+
+static struct mock_surface*
+get_surface(struct ilm_mock_context *ctx, t_ilm_surface id_surface)
+{
+    struct mock_surface *surf = NULL;
+
+    wl_list_for_each(surf, &ctx->list_surface, link) {
+        if (surf->id_surface == id_surface) {
+            return surf;
+        }
+    }
+
+    return NULL;
+}
+
+static struct mock_surface*
+get_or_create_surface(struct ilm_mock_context *ctx, t_ilm_surface id_surface)
+{
+    struct mock_surface *surf = get_surface(ctx, id_surface);
+
+    if (surf != NULL) {
+        return surf;
+    }
+
+    if (id_surface == INVALID_ID) {
+        return NULL;
+    }
+
+    surf = calloc(1, sizeof *surf);
+    if (surf == NULL) {
+        fprintf(stderr, "failed to allocate surface in mock platform\n");
+        return NULL;
+    }
+
+    surf->id_surface = id_surface;
+    surf->prop.opacity = 1.0f;
+    surf->prop.pixelformat = ILM_PIXELFORMAT_RGBA_8888;
+    surf->prop.inputDevicesAcceptance = ILM_INPUT_DEVICE_ALL;
+    surf->prop.creatorPid = (t_ilm_int)getpid();
+    surf->pending = surf->prop;
+
+    wl_list_init(&surf->link);
+    wl_list_insert(ctx->list_surface.prev, &surf->link);
+
+    return surf;
+}
+
+static struct mock_layer*
+get_layer(struct ilm_mock_context *ctx, t_ilm_layer id_layer)
+{
+    struct mock_layer *layer = NULL;
+
+    wl_list_for_each(layer, &ctx->list_layer, link) {
+        if (layer->id_layer == id_layer) {
+            return layer;
+        }
+    }
+
+    return NULL;
+}
+
+static struct mock_screen*
+get_screen(struct ilm_mock_context *ctx, t_ilm_uint id_screen)
+{
+    struct mock_screen *scrn = NULL;
+
+    wl_list_for_each(scrn, &ctx->list_screen, link) {
+        if (scrn->id_screen == id_screen) {
+            return scrn;
+        }
+    }
+
+    return NULL;
+}
+
+static uint32_t
+gen_layer_id(struct ilm_mock_context *ctx)
+{
+    do {
+        ctx->internal_id_layer++;
+    } while ((ctx->internal_id_layer == INVALID_ID) ||
+             (get_layer(ctx, ctx->internal_id_layer) != NULL));
+
+    return ctx->internal_id_layer;
+}
+
+static void
+create_screens(struct ilm_mock_context *ctx)
+{
+    struct mock_screen *scrn = NULL;
+    uint32_t num_screen = env_to_uint("ILM_MOCK_SCREENS", 1);
+    const char *size = getenv("ILM_MOCK_SCREEN_SIZE");
+    unsigned int width = 1920;
+    unsigned int height = 1080;
+    uint32_t i = 0;
+
+    if ((size != NULL) && (sscanf(size, "%ux%u", &width, &height) != 2)) {
+        fprintf(stderr, "ignoring invalid value ILM_MOCK_SCREEN_SIZE=%s\n",
+                size);
+        width = 1920;
+        height = 1080;
+    }
+
+    for (i = 0; i < num_screen; i++) {
+        scrn = calloc(1, sizeof *scrn);
+        if (scrn == NULL) {
+            fprintf(stderr, "failed to allocate screen in mock platform\n");
+            return;
+        }
+
+        scrn->id_screen = i;
+        scrn->width = width;
+        scrn->height = height;
+
+        wl_list_init(&scrn->link);
+        wl_list_insert(ctx->list_screen.prev, &scrn->link);
+    }
+}
+
+static ilmErrorTypes
+mock_init(t_ilm_nativedisplay nativedisplay)
+{
+    struct ilm_mock_context *ctx = &ilm_context;
+    (void)nativedisplay;
+
+    memset(ctx, 0, sizeof *ctx);
+
+    wl_list_init(&ctx->list_surface);
+    wl_list_init(&ctx->list_layer);
+    wl_list_init(&ctx->list_screen);
+    wl_list_init(&ctx->list_capture);
+
+    ctx->keyboard_focus = INVALID_ID;
+    ctx->interest_mask = ILM_NOTIFICATION_ALL;
+    ctx->latency_us = env_to_uint("ILM_MOCK_LATENCY_US", 0);
+    ctx->commit_latency_us = env_to_uint("ILM_MOCK_COMMIT_LATENCY_US", 0);
+
+    create_screens(ctx);
+
+    ctx->valid = 1;
+
+    return ILM_SUCCESS;
+}
+
+static void
+mock_destroy()
+{
+    struct ilm_mock_context *ctx = &ilm_context;
+    struct mock_surface *surf = NULL;
+    struct mock_surface *surf_next = NULL;
+    struct mock_layer *layer = NULL;
+    struct mock_layer *layer_next = NULL;
+    struct mock_screen *scrn = NULL;
+    struct mock_screen *scrn_next = NULL;
+    struct mock_capture *capture = NULL;
+    struct mock_capture *capture_next = NULL;
+
+    if (ctx->valid == 0) {
+        return;
+    }
+
+    wl_list_for_each_safe(capture, capture_next, &ctx->list_capture, link) {
+        wl_list_remove(&capture->link);
+        free(capture);
+    }
+
+    wl_list_for_each_safe(surf, surf_next, &ctx->list_surface, link) {
+        wl_list_remove(&surf->link);
+        free(surf);
+    }
+
+    wl_list_for_each_safe(layer, layer_next, &ctx->list_layer, link) {
+        wl_list_remove(&layer->link);
+        order_release(&layer->order);
+        order_release(&layer->pending_order);
+        free(layer);
+    }
+
+    wl_list_for_each_safe(scrn, scrn_next, &ctx->list_screen, link) {
+        wl_list_remove(&scrn->link);
+        order_release(&scrn->order);
+        order_release(&scrn->pending_order);
+        free(scrn);
+    }
+
+    free(ctx->interests);
+    ctx->interests = NULL;
+    ctx->interest_count = 0;
+
+    ctx->valid = 0;
+}
+
+static ilmErrorTypes
+mock_getPropertiesOfLayer(t_ilm_uint layerID,
+                          struct ilmLayerProperties* pLayerProperties)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_layer *layer = get_layer(ctx, layerID);
+
+    if ((pLayerProperties == NULL) || (layer == NULL)) {
+        return ILM_FAILED;
+    }
+
+    *pLayerProperties = layer->prop;
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_getPropertiesOfScreen(t_ilm_display screenID,
+                           struct ilmScreenProperties* pScreenProperties)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_screen *scrn = get_screen(ctx, screenID);
+    t_ilm_int length = 0;
+
+    if ((pScreenProperties == NULL) || (scrn == NULL)) {
+        return ILM_FAILED;
+    }
+
+    memset(pScreenProperties, 0, sizeof *pScreenProperties);
+    pScreenProperties->screenWidth = scrn->width;
+    pScreenProperties->screenHeight = scrn->height;
+
+    if (order_to_array(&scrn->order, &length,
+                       &pScreenProperties->layerIds) != ILM_SUCCESS) {
+        return ILM_FAILED;
+    }
+    pScreenProperties->layerCount = (t_ilm_uint)length;
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_getNumberOfHardwareLayers(t_ilm_uint screenID,
+                               t_ilm_uint* pNumberOfHardwareLayers)
+{
+    (void)screenID;
+    /* Not supported */
+    if (pNumberOfHardwareLayers != NULL) {
+        *pNumberOfHardwareLayers = 0;
+        return ILM_SUCCESS;
+    } else {
+        return ILM_FAILED;
+    }
+}
+
+static ilmErrorTypes
+mock_getScreenIDs(t_ilm_uint* pNumberOfIDs, t_ilm_uint** ppIDs)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_screen *scrn = NULL;
+    t_ilm_uint *ids = NULL;
+
+    if ((pNumberOfIDs == NULL) || (ppIDs == NULL)) {
+        return ILM_FAILED;
+    }
+
+    *pNumberOfIDs = 0;
+    *ppIDs = malloc((wl_list_length(&ctx->list_screen) + 1) * sizeof **ppIDs);
+    if (*ppIDs == NULL) {
+        return ILM_FAILED;
+    }
+
+    ids = *ppIDs;
+    wl_list_for_each(scrn, &ctx->list_screen, link) {
+        *ids = scrn->id_screen;
+        ids++;
+    }
+    *pNumberOfIDs = wl_list_length(&ctx->list_screen);
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_getLayerIDs(t_ilm_int* pLength, t_ilm_layer** ppArray)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_layer *layer = NULL;
+    t_ilm_layer *ids = NULL;
+
+    if ((pLength == NULL) || (ppArray == NULL)) {
+        return ILM_FAILED;
+    }
+
+    *pLength = 0;
+    *ppArray = malloc((wl_list_length(&ctx->list_layer) + 1) *
+                      sizeof **ppArray);
+    if (*ppArray == NULL) {
+        return ILM_FAILED;
+    }
+
+    ids = *ppArray;
+    wl_list_for_each(layer, &ctx->list_layer, link) {
+        *ids = layer->id_layer;
+        ids++;
+    }
+    *pLength = wl_list_length(&ctx->list_layer);
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_getLayerIDsOnScreen(t_ilm_uint screenId,
+                         t_ilm_int* pLength,
+                         t_ilm_layer** ppArray)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_screen *scrn = get_screen(ctx, screenId);
+
+    if ((pLength == NULL) || (ppArray == NULL) || (scrn == NULL)) {
+        return ILM_FAILED;
+    }
+
+    return order_to_array(&scrn->order, pLength, ppArray);
+}
+
+static ilmErrorTypes
+mock_getSurfaceIDs(t_ilm_int* pLength, t_ilm_surface** ppArray)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_surface *surf = NULL;
+    t_ilm_surface *ids = NULL;
+
+    if ((pLength == NULL) || (ppArray == NULL)) {
+        return ILM_FAILED;
+    }
+
+    *pLength = 0;
+    *ppArray = malloc((wl_list_length(&ctx->list_surface) + 1) *
+                      sizeof **ppArray);
+    if (*ppArray == NULL) {
+        return ILM_FAILED;
+    }
+
+    ids = *ppArray;
+    wl_list_for_each(surf, &ctx->list_surface, link) {
+        *ids = surf->id_surface;
+        ids++;
+    }
+    *pLength = wl_list_length(&ctx->list_surface);
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_getSurfaceIDsOnLayer(t_ilm_layer layer,
+                          t_ilm_int* pLength,
+                          t_ilm_surface** ppArray)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_layer *mock_layer = get_layer(ctx, layer);
+
+    if ((pLength == NULL) || (ppArray == NULL) || (mock_layer == NULL)) {
+        return ILM_FAILED;
+    }
+
+    return order_to_array(&mock_layer->order, pLength, ppArray);
+}
+
+static ilmErrorTypes
+mock_layerCreateWithDimension(t_ilm_layer* pLayerId,
+                              t_ilm_uint width,
+                              t_ilm_uint height)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_layer *layer = NULL;
+    uint32_t layerid = 0;
+
+    if (pLayerId == NULL) {
+        return ILM_FAILED;
+    }
+
+    if (*pLayerId != INVALID_ID) {
+        if (get_layer(ctx, *pLayerId) != NULL) {
+            fprintf(stderr, "layerid=%d is already used.\n", *pLayerId);
+            return ILM_FAILED;
+        }
+        layerid = *pLayerId;
+    } else {
+        layerid = gen_layer_id(ctx);
+    }
+
+    layer = calloc(1, sizeof *layer);
+    if (layer == NULL) {
+        fprintf(stderr, "failed to allocate layer in mock platform\n");
+        return ILM_FAILED;
+    }
+
+    layer->id_layer = layerid;
+    layer->prop.opacity = 1.0f;
+    layer->prop.sourceWidth = width;
+    layer->prop.sourceHeight = height;
+    layer->prop.origSourceWidth = width;
+    layer->prop.origSourceHeight = height;
+    layer->prop.destWidth = width;
+    layer->prop.destHeight = height;
+    layer->prop.type = ILM_LAYERTYPE_SOFTWARE2D;
+    layer->prop.creatorPid = (t_ilm_int)getpid();
+    layer->pending = layer->prop;
+
+    wl_list_init(&layer->link);
+    wl_list_insert(ctx->list_layer.prev, &layer->link);
+
+    *pLayerId = layerid;
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_layerRemove(t_ilm_layer layerId)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_layer *layer = get_layer(ctx, layerId);
+    struct mock_screen *scrn = NULL;
+
+    if (layer == NULL) {
+        return ILM_SUCCESS;
+    }
+
+    wl_list_for_each(scrn, &ctx->list_screen, link) {
+        order_remove(&scrn->order, layerId);
+        order_remove(&scrn->pending_order, layerId);
+    }
+
+    wl_list_remove(&layer->link);
+    order_release(&layer->order);
+    order_release(&layer->pending_order);
+    free(layer);
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_layerGetType(t_ilm_layer layerId, ilmLayerType* pLayerType)
+{
+    (void)layerId;
+    /* Not supported */
+    if (pLayerType != NULL) {
+        *pLayerType = ILM_LAYERTYPE_SOFTWARE2D;
+    }
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_layerSetVisibility(t_ilm_layer layerId, t_ilm_bool newVisibility)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_layer *layer = get_layer(ctx, layerId);
+
+    if (layer == NULL) {
+        return ILM_FAILED;
+    }
+
+    layer->pending.visibility = (newVisibility == ILM_TRUE) ? 1 : 0;
+    layer->pending_mask |= ILM_NOTIFICATION_VISIBILITY;
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_layerGetVisibility(t_ilm_layer layerId, t_ilm_bool *pVisibility)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_layer *layer = get_layer(ctx, layerId);
+
+    if ((pVisibility == NULL) || (layer == NULL)) {
+        return ILM_FAILED;
+    }
+
+    *pVisibility = layer->prop.visibility;
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_layerSetOpacity(t_ilm_layer layerId, t_ilm_float opacity)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_layer *layer = get_layer(ctx, layerId);
+
+    if (layer == NULL) {
+        return ILM_FAILED;
+    }
+
+    layer->pending.opacity = opacity;
+    layer->pending_mask |= ILM_NOTIFICATION_OPACITY;
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_layerGetOpacity(t_ilm_layer layerId, t_ilm_float *pOpacity)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_layer *layer = get_layer(ctx, layerId);
+
+    if ((pOpacity == NULL) || (layer == NULL)) {
+        return ILM_FAILED;
+    }
+
+    *pOpacity = layer->prop.opacity;
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_layerSetSourceRectangle(t_ilm_layer layerId,
+                             t_ilm_uint x, t_ilm_uint y,
+                             t_ilm_uint width, t_ilm_uint height)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_layer *layer = get_layer(ctx, layerId);
+
+    if (layer == NULL) {
+        return ILM_FAILED;
+    }
+
+    layer->pending.sourceX = x;
+    layer->pending.sourceY = y;
+    layer->pending.sourceWidth = width;
+    layer->pending.sourceHeight = height;
+    layer->pending_mask |= ILM_NOTIFICATION_SOURCE_RECT;
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_layerSetDestinationRectangle(t_ilm_layer layerId,
+                                  t_ilm_int x, t_ilm_int y,
+                                  t_ilm_int width, t_ilm_int height)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_layer *layer = get_layer(ctx, layerId);
+
+    if (layer == NULL) {
+        return ILM_FAILED;
+    }
+
+    layer->pending.destX = (t_ilm_uint)x;
+    layer->pending.destY = (t_ilm_uint)y;
+    layer->pending.destWidth = (t_ilm_uint)width;
+    layer->pending.destHeight = (t_ilm_uint)height;
+    layer->pending_mask |= ILM_NOTIFICATION_DEST_RECT;
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_layerGetDimension(t_ilm_layer layerId, t_ilm_uint *pDimension)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_layer *layer = get_layer(ctx, layerId);
+
+    if ((pDimension == NULL) || (layer == NULL)) {
+        return ILM_FAILED;
+    }
+
+    *pDimension = layer->prop.destWidth;
+    *(pDimension + 1) = layer->prop.destHeight;
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_layerSetDimension(t_ilm_layer layerId, t_ilm_uint *pDimension)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_layer *layer = get_layer(ctx, layerId);
+
+    if ((pDimension == NULL) || (layer == NULL)) {
+        return ILM_FAILED;
+    }
+
+    layer->pending.destWidth = *pDimension;
+    layer->pending.destHeight = *(pDimension + 1);
+    layer->pending_mask |= ILM_NOTIFICATION_DEST_RECT;
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_layerGetPosition(t_ilm_layer layerId, t_ilm_uint *pPosition)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_layer *layer = get_layer(ctx, layerId);
+
+    if ((pPosition == NULL) || (layer == NULL)) {
+        return ILM_FAILED;
+    }
+
+    *pPosition = layer->prop.destX;
+    *(pPosition + 1) = layer->prop.destY;
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_layerSetPosition(t_ilm_layer layerId, t_ilm_uint *pPosition)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_layer *layer = get_layer(ctx, layerId);
+
+    if ((pPosition == NULL) || (layer == NULL)) {
+        return ILM_FAILED;
+    }
+
+    layer->pending.destX = *pPosition;
+    layer->pending.destY = *(pPosition + 1);
+    layer->pending_mask |= ILM_NOTIFICATION_DEST_RECT;
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_layerSetOrientation(t_ilm_layer layerId, ilmOrientation orientation)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_layer *layer = get_layer(ctx, layerId);
+
+    if ((orientation < ILM_ZERO) || (orientation > ILM_TWOHUNDREDSEVENTY)) {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    if (layer == NULL) {
+        return ILM_FAILED;
+    }
+
+    layer->pending.orientation = orientation;
+    layer->pending_mask |= ILM_NOTIFICATION_ORIENTATION;
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_layerGetOrientation(t_ilm_layer layerId, ilmOrientation *pOrientation)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_layer *layer = get_layer(ctx, layerId);
+
+    if ((pOrientation == NULL) || (layer == NULL)) {
+        return ILM_FAILED;
+    }
+
+    *pOrientation = layer->prop.orientation;
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_layerSetChromaKey(t_ilm_layer layerId, t_ilm_int* pColor)
+{
+    (void)layerId;
+    (void)pColor;
+    /* Not supported */
+    return ILM_FAILED;
+}
+
+static ilmErrorTypes
+mock_layerSetRenderOrder(t_ilm_layer layerId,
+                         t_ilm_surface *pSurfaceId,
+                         t_ilm_int number)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_layer *layer = get_layer(ctx, layerId);
+    t_ilm_int cnt = 0;
+
+    if ((layer == NULL) || (number < 0) ||
+        ((number > 0) && (pSurfaceId == NULL))) {
+        return ILM_FAILED;
+    }
+
+    for (cnt = 0; cnt < number; cnt++) {
+        if (get_or_create_surface(ctx, pSurfaceId[cnt]) == NULL) {
+            return ILM_FAILED;
+        }
+    }
+
+    if (order_set(&layer->pending_order, pSurfaceId,
+                  (t_ilm_uint)number) != 0) {
+        return ILM_FAILED;
+    }
+    layer->pending_mask |= MOCK_PENDING_ORDER;
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_layerGetCapabilities(t_ilm_layer layerId,
+                          t_ilm_layercapabilities *pCapabilities)
+{
+    (void)layerId;
+    (void)pCapabilities;
+    /* Not supported */
+    return ILM_FAILED;
+}
+
+static ilmErrorTypes
+mock_layerTypeGetCapabilities(ilmLayerType layerType,
+                              t_ilm_layercapabilities *pCapabilities)
+{
+    (void)layerType;
+    (void)pCapabilities;
+    /* Not supported */
+    return ILM_FAILED;
+}
+
+static ilmErrorTypes
+mock_surfaceSetVisibility(t_ilm_surface surfaceId, t_ilm_bool newVisibility)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_surface *surf = get_or_create_surface(ctx, surfaceId);
+
+    if (surf == NULL) {
+        return ILM_FAILED;
+    }
+
+    surf->pending.visibility = (newVisibility == ILM_TRUE) ? 1 : 0;
+    surf->pending_mask |= ILM_NOTIFICATION_VISIBILITY;
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_surfaceSetOpacity(t_ilm_surface surfaceId, t_ilm_float opacity)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_surface *surf = get_or_create_surface(ctx, surfaceId);
+
+    if (surf == NULL) {
+        return ILM_FAILED;
+    }
+
+    surf->pending.opacity = opacity;
+    surf->pending_mask |= ILM_NOTIFICATION_OPACITY;
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_surfaceGetOpacity(t_ilm_surface surfaceId, t_ilm_float *pOpacity)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_surface *surf = get_surface(ctx, surfaceId);
+
+    if ((pOpacity == NULL) || (surf == NULL)) {
+        return ILM_FAILED;
+    }
+
+    *pOpacity = surf->prop.opacity;
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_SetKeyboardFocusOn(t_ilm_surface surfaceId)
+{
+    struct ilm_mock_context *ctx = get_instance();
+
+    ctx->keyboard_focus = surfaceId;
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_GetKeyboardFocusSurfaceId(t_ilm_surface* pSurfaceId)
+{
+    struct ilm_mock_context *ctx = get_instance();
+
+    if (pSurfaceId == NULL) {
+        return ILM_FAILED;
+    }
+
+    *pSurfaceId = ctx->keyboard_focus;
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_surfaceSetDestinationRectangle(t_ilm_surface surfaceId,
+                                    t_ilm_int x, t_ilm_int y,
+                                    t_ilm_int width, t_ilm_int height)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_surface *surf = get_or_create_surface(ctx, surfaceId);
+
+    if (surf == NULL) {
+        return ILM_FAILED;
+    }
+
+    surf->pending.destX = (t_ilm_uint)x;
+    surf->pending.destY = (t_ilm_uint)y;
+    surf->pending.destWidth = (t_ilm_uint)width;
+    surf->pending.destHeight = (t_ilm_uint)height;
+    surf->pending_mask |= ILM_NOTIFICATION_DEST_RECT;
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_surfaceSetDimension(t_ilm_surface surfaceId, t_ilm_uint *pDimension)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_surface *surf = NULL;
+
+    if (pDimension == NULL) {
+        return ILM_FAILED;
+    }
+
+    surf = get_or_create_surface(ctx, surfaceId);
+    if (surf == NULL) {
+        return ILM_FAILED;
+    }
+
+    surf->pending.destWidth = *pDimension;
+    surf->pending.destHeight = *(pDimension + 1);
+    surf->pending_mask |= ILM_NOTIFICATION_DEST_RECT;
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_surfaceGetPosition(t_ilm_surface surfaceId, t_ilm_uint *pPosition)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_surface *surf = get_surface(ctx, surfaceId);
+
+    if ((pPosition == NULL) || (surf == NULL)) {
+        return ILM_FAILED;
+    }
+
+    *pPosition = surf->prop.destX;
+    *(pPosition + 1) = surf->prop.destY;
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_surfaceSetPosition(t_ilm_surface surfaceId, t_ilm_uint *pPosition)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_surface *surf = NULL;
+
+    if (pPosition == NULL) {
+        return ILM_FAILED;
+    }
+
+    surf = get_or_create_surface(ctx, surfaceId);
+    if (surf == NULL) {
+        return ILM_FAILED;
+    }
+
+    surf->pending.destX = *pPosition;
+    surf->pending.destY = *(pPosition + 1);
+    surf->pending_mask |= ILM_NOTIFICATION_DEST_RECT;
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_surfaceSetOrientation(t_ilm_surface surfaceId,
+                           ilmOrientation orientation)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_surface *surf = NULL;
+
+    if ((orientation < ILM_ZERO) || (orientation > ILM_TWOHUNDREDSEVENTY)) {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    surf = get_or_create_surface(ctx, surfaceId);
+    if (surf == NULL) {
+        return ILM_FAILED;
+    }
+
+    surf->pending.orientation = orientation;
+    surf->pending_mask |= ILM_NOTIFICATION_ORIENTATION;
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_surfaceGetOrientation(t_ilm_surface surfaceId,
+                           ilmOrientation *pOrientation)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_surface *surf = get_surface(ctx, surfaceId);
+
+    if ((pOrientation == NULL) || (surf == NULL)) {
+        return ILM_FAILED;
+    }
+
+    *pOrientation = surf->prop.orientation;
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_surfaceGetPixelformat(t_ilm_layer surfaceId,
+                           ilmPixelFormat *pPixelformat)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_surface *surf = get_surface(ctx, surfaceId);
+
+    if ((pPixelformat == NULL) || (surf == NULL)) {
+        return ILM_FAILED;
+    }
+
+    *pPixelformat = surf->prop.pixelformat;
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_surfaceSetChromaKey(t_ilm_surface surfaceId, t_ilm_int* pColor)
+{
+    (void)surfaceId;
+    (void)pColor;
+    /* Not supported */
+    return ILM_FAILED;
+}
+
+static ilmErrorTypes
+mock_displaySetRenderOrder(t_ilm_display display,
+                           t_ilm_layer *pLayerId, const t_ilm_uint number)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_screen *scrn = get_screen(ctx, display);
+    struct mock_order order = {0};
+    t_ilm_uint cnt = 0;
+
+    if ((scrn == NULL) || ((number > 0) && (pLayerId == NULL))) {
+        return ILM_FAILED;
+    }
+
+    /* unknown layers are skipped, as the wayland platform does */
+    for (cnt = 0; cnt < number; cnt++) {
+        if (get_layer(ctx, pLayerId[cnt]) == NULL) {
+            continue;
+        }
+        if (order_append(&order, pLayerId[cnt]) != 0) {
+            order_release(&order);
+            return ILM_FAILED;
+        }
+    }
+
+    if (order_copy(&scrn->pending_order, &order) != 0) {
+        order_release(&order);
+        return ILM_FAILED;
+    }
+    order_release(&order);
+    scrn->pending_mask |= MOCK_PENDING_ORDER;
+
+    return ILM_SUCCESS;
+}
+
+/*
+ * Nothing is rendered, so screenshots only validate their target and do
+ * not write a file.
+ */
+static ilmErrorTypes
+mock_takeScreenshot(t_ilm_uint screen, t_ilm_const_string filename)
+{
+    struct ilm_mock_context *ctx = get_instance();
+
+    if ((filename == NULL) || (get_screen(ctx, screen) == NULL)) {
+        return ILM_FAILED;
+    }
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_takeLayerScreenshot(t_ilm_const_string filename, t_ilm_layer layerid)
+{
+    struct ilm_mock_context *ctx = get_instance();
+
+    if ((filename == NULL) || (get_layer(ctx, layerid) == NULL)) {
+        return ILM_FAILED;
+    }
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_takeSurfaceScreenshot(t_ilm_const_string filename,
+                           t_ilm_surface surfaceid)
+{
+    struct ilm_mock_context *ctx = get_instance();
+
+    if ((filename == NULL) || (get_surface(ctx, surfaceid) == NULL)) {
+        return ILM_FAILED;
+    }
+
+    return ILM_SUCCESS;
+}
+
+/*
+ * Screenshots into a buffer have the committed size of their target and
+ * are transparent black.
+ */
+static ilmErrorTypes
+fill_screenshot_buffer(t_ilm_uint width, t_ilm_uint height,
+                       struct ilmScreenshotBuffer* pBuffer)
+{
+    if ((width == 0) || (height == 0)) {
+        return ILM_FAILED;
+    }
+
+    pBuffer->pixels = calloc(height, width * 4);
+    if (pBuffer->pixels == NULL) {
+        return ILM_FAILED;
+    }
+
+    pBuffer->width = width;
+    pBuffer->height = height;
+    pBuffer->stride = width * 4;
+    pBuffer->format = 0; /* WL_SHM_FORMAT_ARGB8888 */
+    pBuffer->size = width * height * 4;
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_takeScreenshotToBuffer(t_ilm_uint screen,
+                            struct ilmScreenshotBuffer* pBuffer)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_screen *scrn = NULL;
+
+    if (pBuffer == NULL) {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+    memset(pBuffer, 0, sizeof *pBuffer);
+
+    scrn = get_screen(ctx, screen);
+    if (scrn == NULL) {
+        return ILM_FAILED;
+    }
+
+    return fill_screenshot_buffer(scrn->width, scrn->height, pBuffer);
+}
+
+static ilmErrorTypes
+mock_takeLayerScreenshotToBuffer(t_ilm_layer layerid,
+                                 struct ilmScreenshotBuffer* pBuffer)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_layer *layer = NULL;
+
+    if (pBuffer == NULL) {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+    memset(pBuffer, 0, sizeof *pBuffer);
+
+    layer = get_layer(ctx, layerid);
+    if (layer == NULL) {
+        return ILM_FAILED;
+    }
+
+    return fill_screenshot_buffer(layer->prop.destWidth,
+                                  layer->prop.destHeight, pBuffer);
+}
+
+static ilmErrorTypes
+mock_takeSurfaceScreenshotToBuffer(t_ilm_surface surfaceid,
+                                   struct ilmScreenshotBuffer* pBuffer)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_surface *surf = NULL;
+
+    if (pBuffer == NULL) {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+    memset(pBuffer, 0, sizeof *pBuffer);
+
+    surf = get_surface(ctx, surfaceid);
+    if (surf == NULL) {
+        return ILM_FAILED;
+    }
+
+    return fill_screenshot_buffer(surf->prop.destWidth,
+                                  surf->prop.destHeight, pBuffer);
+}
+
+static ilmErrorTypes
+mock_releaseScreenshotBuffer(struct ilmScreenshotBuffer* pBuffer)
+{
+    if ((pBuffer == NULL) || (pBuffer->pixels == NULL)) {
+        return ILM_FAILED;
+    }
+
+    free(pBuffer->pixels);
+    memset(pBuffer, 0, sizeof *pBuffer);
+
+    return ILM_SUCCESS;
+}
+
+static struct mock_capture*
+get_capture(struct ilm_mock_context *ctx, t_ilm_uint id_capture)
+{
+    struct mock_capture *capture = NULL;
+
+    wl_list_for_each(capture, &ctx->list_capture, link) {
+        if (capture->id_capture == id_capture) {
+            return capture;
+        }
+    }
+
+    return NULL;
+}
+
+static ilmErrorTypes
+start_capture(struct ilm_mock_context *ctx, t_ilm_uint id_target,
+              int surface, t_ilm_uint interval, t_ilm_uint bufferCount,
+              t_ilm_uint* pCaptureId)
+{
+    struct mock_capture *capture = calloc(1, sizeof *capture);
+
+    if (capture == NULL) {
+        return ILM_FAILED;
+    }
+
+    capture->id_capture = ++ctx->internal_id_capture;
+    capture->id_target = id_target;
+    capture->surface = surface;
+    capture->interval = (interval > 0) ? interval : 1;
+    capture->num_buffer = bufferCount;
+    wl_list_insert(ctx->list_capture.prev, &capture->link);
+
+    *pCaptureId = capture->id_capture;
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_startScreenCapture(t_ilm_uint screen, t_ilm_uint interval,
+                        t_ilm_uint bufferCount, t_ilm_uint* pCaptureId)
+{
+    struct ilm_mock_context *ctx = get_instance();
+
+    if ((pCaptureId == NULL) || (bufferCount == 0)) {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    if (get_screen(ctx, screen) == NULL) {
+        return ILM_FAILED;
+    }
+
+    return start_capture(ctx, screen, 0, interval, bufferCount, pCaptureId);
+}
+
+static ilmErrorTypes
+mock_startSurfaceCapture(t_ilm_surface surfaceid, t_ilm_uint interval,
+                         t_ilm_uint bufferCount, t_ilm_uint* pCaptureId)
+{
+    struct ilm_mock_context *ctx = get_instance();
+
+    if ((pCaptureId == NULL) || (bufferCount == 0)) {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    if (get_surface(ctx, surfaceid) == NULL) {
+        return ILM_FAILED;
+    }
+
+    return start_capture(ctx, surfaceid, 1, interval, bufferCount,
+                         pCaptureId);
+}
+
+/*
+ * Every frame is a repaint of its own, interval frames after the previous
+ * one. It is damaged fully if it is the first frame or a commit happened
+ * since the previous frame, otherwise it is not damaged at all.
+ */
+static ilmErrorTypes
+mock_getCaptureFrame(t_ilm_uint captureId, struct ilmCaptureFrame* pFrame)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_capture *capture = NULL;
+    struct mock_screen *scrn = NULL;
+    struct mock_surface *surf = NULL;
+    struct timespec now;
+    ilmErrorTypes result = ILM_FAILED;
+
+    if (pFrame == NULL) {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+    memset(pFrame, 0, sizeof *pFrame);
+
+    capture = get_capture(ctx, captureId);
+    if ((capture == NULL) || (capture->num_held == capture->num_buffer)) {
+        return ILM_FAILED;
+    }
+
+    if (capture->surface) {
+        surf = get_surface(ctx, capture->id_target);
+        if (surf != NULL) {
+            result = fill_screenshot_buffer(surf->prop.destWidth,
+                                            surf->prop.destHeight,
+                                            &pFrame->buffer);
+        }
+    } else {
+        scrn = get_screen(ctx, capture->id_target);
+        if (scrn != NULL) {
+            result = fill_screenshot_buffer(scrn->width, scrn->height,
+                                            &pFrame->buffer);
+        }
+    }
+    if (result != ILM_SUCCESS) {
+        return result;
+    }
+
+    if (!capture->started || (capture->commit_seen != ctx->commit_count)) {
+        pFrame->damage = calloc(4, sizeof *pFrame->damage);
+        if (pFrame->damage == NULL) {
+            mock_releaseScreenshotBuffer(&pFrame->buffer);
+            return ILM_FAILED;
+        }
+        pFrame->damage[2] = (t_ilm_int)pFrame->buffer.width;
+        pFrame->damage[3] = (t_ilm_int)pFrame->buffer.height;
+        pFrame->damageCount = 1;
+    }
+    capture->started = 1;
+    capture->commit_seen = ctx->commit_count;
+    capture->num_held++;
+
+    ctx->frame_count += capture->interval;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    pFrame->buffer.timing.seconds = (t_ilm_uint)now.tv_sec;
+    pFrame->buffer.timing.nanoseconds = (t_ilm_uint)now.tv_nsec;
+    pFrame->buffer.timing.sequence = ctx->frame_count;
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_releaseCaptureFrame(t_ilm_uint captureId, struct ilmCaptureFrame* pFrame)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_capture *capture = NULL;
+
+    if (pFrame == NULL) {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    capture = get_capture(ctx, captureId);
+    if ((capture == NULL) || (capture->num_held == 0) ||
+        (pFrame->buffer.pixels == NULL)) {
+        return ILM_FAILED;
+    }
+
+    capture->num_held--;
+    free(pFrame->damage);
+    free(pFrame->buffer.pixels);
+    memset(pFrame, 0, sizeof *pFrame);
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_stopCapture(t_ilm_uint captureId)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_capture *capture = get_capture(ctx, captureId);
+
+    if (capture == NULL) {
+        return ILM_FAILED;
+    }
+
+    wl_list_remove(&capture->link);
+    free(capture);
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_SetOptimizationMode(ilmOptimization id, ilmOptimizationMode mode)
+{
+    (void)id;
+    (void)mode;
+    /* Not supported */
+    return ILM_FAILED;
+}
+
+static ilmErrorTypes
+mock_GetOptimizationMode(ilmOptimization id, ilmOptimizationMode* pMode)
+{
+    (void)id;
+    (void)pMode;
+    /* Not supported */
+    return ILM_FAILED;
+}
+
+static ilmErrorTypes
+mock_layerAddNotification(t_ilm_layer layer,
+                          layerNotificationFunc callback)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_layer *mock_layer = get_layer(ctx, layer);
+
+    if (mock_layer == NULL) {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    mock_layer->notification = callback;
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_layerRemoveNotification(t_ilm_layer layer)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_layer *mock_layer = get_layer(ctx, layer);
+
+    if (mock_layer == NULL) {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    mock_layer->notification = NULL;
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_getNativeHandle(t_ilm_uint pid, t_ilm_int *n_handle,
+                     t_ilm_nativehandle **p_handles)
+{
+    (void)pid;
+    /* There are no client processes behind the mock scene */
+    *n_handle = 0;
+    *p_handles = NULL;
+
+    return ILM_FAILED;
+}
+
+static ilmErrorTypes
+mock_getPropertiesOfSurface(t_ilm_uint surfaceID,
+                            struct ilmSurfaceProperties* pSurfaceProperties)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_surface *surf = get_surface(ctx, surfaceID);
+
+    if ((pSurfaceProperties == NULL) || (surf == NULL)) {
+        return ILM_FAILED;
+    }
+
+    *pSurfaceProperties = surf->prop;
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_layerAddSurface(t_ilm_layer layerId,
+                     t_ilm_surface surfaceId)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_layer *layer = get_layer(ctx, layerId);
+
+    if ((layer == NULL) || (get_or_create_surface(ctx, surfaceId) == NULL)) {
+        return ILM_FAILED;
+    }
+
+    if ((layer->pending_mask & MOCK_PENDING_ORDER) == 0) {
+        if (order_copy(&layer->pending_order, &layer->order) != 0) {
+            return ILM_FAILED;
+        }
+    }
+
+    if (order_append(&layer->pending_order, surfaceId) != 0) {
+        return ILM_FAILED;
+    }
+    layer->pending_mask |= MOCK_PENDING_ORDER;
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_layerRemoveSurface(t_ilm_layer layerId,
+                        t_ilm_surface surfaceId)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_layer *layer = get_layer(ctx, layerId);
+
+    if ((layer == NULL) || (get_surface(ctx, surfaceId) == NULL)) {
+        return ILM_FAILED;
+    }
+
+    if ((layer->pending_mask & MOCK_PENDING_ORDER) == 0) {
+        if (order_copy(&layer->pending_order, &layer->order) != 0) {
+            return ILM_FAILED;
+        }
+    }
+
+    order_remove(&layer->pending_order, surfaceId);
+    layer->pending_mask |= MOCK_PENDING_ORDER;
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_surfaceGetDimension(t_ilm_surface surfaceId,
+                         t_ilm_uint *pDimension)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_surface *surf = get_surface(ctx, surfaceId);
+
+    if ((pDimension == NULL) || (surf == NULL)) {
+        return ILM_FAILED;
+    }
+
+    *pDimension = surf->prop.destWidth;
+    *(pDimension + 1) = surf->prop.destHeight;
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_surfaceGetVisibility(t_ilm_surface surfaceId,
+                          t_ilm_bool *pVisibility)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_surface *surf = get_surface(ctx, surfaceId);
+
+    if ((pVisibility == NULL) || (surf == NULL)) {
+        return ILM_FAILED;
+    }
+
+    *pVisibility = surf->prop.visibility;
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_surfaceSetSourceRectangle(t_ilm_surface surfaceId,
+                               t_ilm_int x, t_ilm_int y,
+                               t_ilm_int width, t_ilm_int height)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_surface *surf = get_or_create_surface(ctx, surfaceId);
+
+    if (surf == NULL) {
+        return ILM_FAILED;
+    }
+
+    surf->pending.sourceX = (t_ilm_uint)x;
+    surf->pending.sourceY = (t_ilm_uint)y;
+    surf->pending.sourceWidth = (t_ilm_uint)width;
+    surf->pending.sourceHeight = (t_ilm_uint)height;
+    surf->pending_mask |= ILM_NOTIFICATION_SOURCE_RECT;
+
+    return ILM_SUCCESS;
+}
+
+/*
+ * Part of the changes in mask which is reported for the layer, following
+ * the interest ranges and mask.
+ */
+static t_ilm_notification_mask
+layer_interest_mask(struct ilm_mock_context *ctx, struct mock_layer *layer,
+                    t_ilm_notification_mask mask)
+{
+    t_ilm_uint i = 0;
+
+    if (ctx->interest_count == 0) {
+        return (t_ilm_notification_mask)(mask & ctx->interest_mask);
+    }
+
+    for (i = 0; i < ctx->interest_count; i++) {
+        if ((ctx->interests[i].type == ILM_LAYER) &&
+            (layer->id_layer >= ctx->interests[i].id_min) &&
+            (layer->id_layer <= ctx->interests[i].id_max)) {
+            return (t_ilm_notification_mask)(mask & ctx->interest_mask);
+        }
+    }
+
+    return (t_ilm_notification_mask)0;
+}
+
+static ilmErrorTypes
+mock_commitChanges()
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_surface *surf = NULL;
+    struct mock_layer *layer = NULL;
+    struct mock_layer *next = NULL;
+    struct mock_screen *scrn = NULL;
+    t_ilm_notification_mask mask;
+
+    if (ctx->commit_latency_us > 0) {
+        usleep(ctx->commit_latency_us);
+    }
+
+    wl_list_for_each(surf, &ctx->list_surface, link) {
+        if (surf->pending_mask == 0) {
+            continue;
+        }
+        surf->prop = surf->pending;
+        surf->pending_mask = 0;
+    }
+
+    wl_list_for_each(scrn, &ctx->list_screen, link) {
+        if (scrn->pending_mask == 0) {
+            continue;
+        }
+        if (order_copy(&scrn->order, &scrn->pending_order) != 0) {
+            return ILM_FAILED;
+        }
+        scrn->pending_mask = 0;
+    }
+
+    /* a notification callback may remove its own layer */
+    wl_list_for_each_safe(layer, next, &ctx->list_layer, link) {
+        if (layer->pending_mask == 0) {
+            continue;
+        }
+
+        if (layer->pending_mask & MOCK_PENDING_ORDER) {
+            if (order_copy(&layer->order, &layer->pending_order) != 0) {
+                return ILM_FAILED;
+            }
+        }
+
+        mask = (t_ilm_notification_mask)
+               (layer->pending_mask & ~MOCK_PENDING_ORDER);
+        layer->prop = layer->pending;
+        layer->pending_mask = 0;
+
+        if (ctx->event_rate != ILM_EVENT_RATE_IMMEDIATE) {
+            layer->held_mask = (t_ilm_notification_mask)
+                               (layer->held_mask | mask);
+            continue;
+        }
+
+        mask = layer_interest_mask(ctx, layer, mask);
+        if ((mask != 0) && (layer->notification != NULL)) {
+            layer->notification(layer->id_layer, &layer->prop, mask);
+        }
+    }
+
+    ctx->commit_count++;
+
+    return ILM_SUCCESS;
+}
+
+/*
+ * Report the changes held back by the event rate with their latest
+ * values.
+ */
+static void
+send_held_notifications(struct ilm_mock_context *ctx)
+{
+    struct mock_layer *layer = NULL;
+    struct mock_layer *next = NULL;
+    t_ilm_notification_mask mask;
+
+    wl_list_for_each_safe(layer, next, &ctx->list_layer, link) {
+        mask = layer_interest_mask(ctx, layer, layer->held_mask);
+        layer->held_mask = (t_ilm_notification_mask)0;
+
+        if ((mask != 0) && (layer->notification != NULL)) {
+            layer->notification(layer->id_layer, &layer->prop, mask);
+        }
+    }
+}
+
+/*
+ * There is no repaint, every frame aligned commit is presented at once
+ * in a frame of its own.
+ */
+static ilmErrorTypes
+mock_commitChangesOnFrame(struct ilmPresentationTiming* pTiming)
+{
+    struct ilm_mock_context *ctx = &ilm_context;
+    struct timespec now;
+    ilmErrorTypes result = mock_commitChanges();
+
+    if (result != ILM_SUCCESS) {
+        return result;
+    }
+
+    ctx->frame_count++;
+    send_held_notifications(ctx);
+
+    if (pTiming != NULL) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        pTiming->seconds = (t_ilm_uint)now.tv_sec;
+        pTiming->nanoseconds = (t_ilm_uint)now.tv_nsec;
+        pTiming->sequence = ctx->frame_count;
+    }
+
+    return ILM_SUCCESS;
+}
+
+/*
+ * Held back changes are reported at the frames of frame aligned commits.
+ * The mock has no output refresh, so the limited rate is not enforced.
+ */
+static ilmErrorTypes
+mock_setEventRate(ilmEventRate policy, t_ilm_uint maxRate)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    (void)maxRate;
+
+    switch (policy) {
+    case ILM_EVENT_RATE_IMMEDIATE:
+    case ILM_EVENT_RATE_FRAME:
+    case ILM_EVENT_RATE_LIMITED:
+        break;
+    default:
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    ctx->event_rate = policy;
+
+    if (policy == ILM_EVENT_RATE_IMMEDIATE) {
+        send_held_notifications(ctx);
+    }
+
+    return ILM_SUCCESS;
+}
+
+/*
+ * Mock surfaces have no application updating their content, so all of
+ * their frame statistics are 0.
+ */
+static ilmErrorTypes
+mock_getSurfaceFrameStats(t_ilm_surface surfaceId,
+                          struct ilmSurfaceFrameStats* pStats)
+{
+    struct ilm_mock_context *ctx = get_instance();
+
+    if (pStats == NULL) {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    if (get_surface(ctx, surfaceId) == NULL) {
+        return ILM_FAILED;
+    }
+
+    memset(pStats, 0, sizeof *pStats);
+    return ILM_SUCCESS;
+}
+
+/*
+ * Mock screenshots write no files, so the format is only validated.
+ */
+static ilmErrorTypes
+mock_setScreenshotFormat(ilmScreenshotFormat format)
+{
+    struct ilm_mock_context *ctx = get_instance();
+
+    switch (format) {
+    case ILM_SCREENSHOT_FORMAT_PNG:
+    case ILM_SCREENSHOT_FORMAT_RAW:
+    case ILM_SCREENSHOT_FORMAT_PPM:
+    case ILM_SCREENSHOT_FORMAT_PAM:
+    case ILM_SCREENSHOT_FORMAT_QOI:
+        break;
+    default:
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    ctx->screenshot_format = format;
+
+    return ILM_SUCCESS;
+}
+
+/*
+ * The mock has no output refresh to step transitions on, so a transition
+ * sets its target, which is applied by the next commit.
+ */
+static int
+is_valid_easing(ilmTransitionEasing easing)
+{
+    switch (easing) {
+    case ILM_EASING_LINEAR:
+    case ILM_EASING_EASE_IN:
+    case ILM_EASING_EASE_OUT:
+    case ILM_EASING_EASE_IN_OUT:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static ilmErrorTypes
+mock_surfaceTransitionOpacity(t_ilm_surface surfaceId, t_ilm_float opacity,
+                              t_ilm_uint durationMillis,
+                              ilmTransitionEasing easing)
+{
+    (void)durationMillis;
+
+    if (!is_valid_easing(easing)) {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    return mock_surfaceSetOpacity(surfaceId, opacity);
+}
+
+static ilmErrorTypes
+mock_surfaceTransitionDestinationRectangle(t_ilm_surface surfaceId,
+                                           t_ilm_int x, t_ilm_int y,
+                                           t_ilm_int width, t_ilm_int height,
+                                           t_ilm_uint durationMillis,
+                                           ilmTransitionEasing easing)
+{
+    (void)durationMillis;
+
+    if (!is_valid_easing(easing)) {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    return mock_surfaceSetDestinationRectangle(surfaceId,
+                                               x, y, width, height);
+}
+
+static ilmErrorTypes
+mock_layerTransitionOpacity(t_ilm_layer layerId, t_ilm_float opacity,
+                            t_ilm_uint durationMillis,
+                            ilmTransitionEasing easing)
+{
+    (void)durationMillis;
+
+    if (!is_valid_easing(easing)) {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    return mock_layerSetOpacity(layerId, opacity);
+}
+
+static ilmErrorTypes
+mock_layerTransitionDestinationRectangle(t_ilm_layer layerId,
+                                         t_ilm_int x, t_ilm_int y,
+                                         t_ilm_int width, t_ilm_int height,
+                                         t_ilm_uint durationMillis,
+                                         ilmTransitionEasing easing)
+{
+    (void)durationMillis;
+
+    if (!is_valid_easing(easing)) {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    return mock_layerSetDestinationRectangle(layerId, x, y, width, height);
+}
+
+/*
+ * The mock does not know the content of surfaces, so no surface is
+ * considered to be covered by the surfaces above it.
+ */
+static ilmErrorTypes
+mock_surfaceGetEffectiveVisibility(t_ilm_surface surfaceId,
+                                   t_ilm_bool *pVisibility)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_surface *surf = get_surface(ctx, surfaceId);
+    struct mock_screen *scrn = NULL;
+    struct mock_layer *layer = NULL;
+    t_ilm_uint i = 0;
+
+    if ((pVisibility == NULL) || (surf == NULL)) {
+        return ILM_FAILED;
+    }
+
+    *pVisibility = ILM_FALSE;
+
+    if (!surf->prop.visibility || (surf->prop.opacity <= 0.0f)) {
+        return ILM_SUCCESS;
+    }
+
+    wl_list_for_each(scrn, &ctx->list_screen, link) {
+        for (i = 0; i < scrn->order.count; i++) {
+            layer = get_layer(ctx, scrn->order.ids[i]);
+            if ((layer == NULL) || !layer->prop.visibility ||
+                (layer->prop.opacity <= 0.0f)) {
+                continue;
+            }
+
+            if (order_find(&layer->order, surfaceId) >= 0) {
+                *pVisibility = ILM_TRUE;
+                return ILM_SUCCESS;
+            }
+        }
+    }
+
+    return ILM_SUCCESS;
+}
+
+/*
+ * Mock surfaces have no notifications, so surface ranges and their
+ * members only keep the layers out of the notifications.
+ */
+static ilmErrorTypes
+mock_addInterest(ilmObjectType type, t_ilm_uint idMin, t_ilm_uint idMax,
+                 t_ilm_bool withMembers)
+{
+    struct ilm_mock_context *ctx = get_instance();
+    struct mock_interest *interests = NULL;
+    (void)withMembers;
+
+    if (((type != ILM_SURFACE) && (type != ILM_LAYER)) || (idMin > idMax)) {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    interests = realloc(ctx->interests,
+                        (ctx->interest_count + 1) * sizeof *interests);
+    if (interests == NULL) {
+        return ILM_FAILED;
+    }
+
+    interests[ctx->interest_count].type = type;
+    interests[ctx->interest_count].id_min = idMin;
+    interests[ctx->interest_count].id_max = idMax;
+    ctx->interests = interests;
+    ctx->interest_count++;
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_setInterestMask(t_ilm_notification_mask mask)
+{
+    struct ilm_mock_context *ctx = get_instance();
+
+    ctx->interest_mask = mask;
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+mock_clearInterest(void)
+{
+    struct ilm_mock_context *ctx = get_instance();
+
+    free(ctx->interests);
+    ctx->interests = NULL;
+    ctx->interest_count = 0;
+    ctx->interest_mask = ILM_NOTIFICATION_ALL;
+
+    return ILM_SUCCESS;
+}
@@ -0,0 +1,2014 @@
+/**************************************************************************
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include "ilm_common.h"
+#include "ilm_control_platform.h"
+#include "ilm_control_recorder.h"
+
+/* GCC visibility */
+#if defined(__GNUC__) && __GNUC__ >= 4
+#define ILM_EXPORT __attribute__ ((visibility("default")))
+#else
+#define ILM_EXPORT
+#endif
+
+/*
+ *=============================================================================
+ * argument encoding
+ *=============================================================================
+ */
+struct record_args {
+    uint32_t *words;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t inline_words[16];
+};
+
+static void
+args_init(struct record_args *args)
+{
+    args->words = args->inline_words;
+    args->count = 0;
+    args->capacity = sizeof(args->inline_words) / sizeof(uint32_t);
+}
+
+static void
+args_release(struct record_args *args)
+{
+    if (args->words != args->inline_words) {
+        free(args->words);
+    }
+    args_init(args);
+}
+
+static void
+args_put(struct record_args *args, uint32_t value)
+{
+    uint32_t capacity = 0;
+    uint32_t *words = NULL;
+
+    if (args->count == args->capacity) {
+        capacity = args->capacity * 2;
+        if (args->words == args->inline_words) {
+            words = malloc(capacity * sizeof(uint32_t));
+            if (words != NULL) {
+                memcpy(words, args->words, args->count * sizeof(uint32_t));
+            }
+        } else {
+            words = realloc(args->words, capacity * sizeof(uint32_t));
+        }
+
+        if (words == NULL) {
+            /* the record is truncated, which replay reports as skipped */
+            return;
+        }
+        args->words = words;
+        args->capacity = capacity;
+    }
+
+    args->words[args->count++] = value;
+}
+
+static void
+args_put_float(struct record_args *args, t_ilm_float value)
+{
+    uint32_t words[2];
+
+    memcpy(words, &value, sizeof(words));
+    args_put(args, words[0]);
+    args_put(args, words[1]);
+}
+
+static void
+args_put_array(struct record_args *args,
+               const t_ilm_uint *array, t_ilm_uint length)
+{
+    t_ilm_uint i = 0;
+
+    if (array == NULL) {
+        length = 0;
+    }
+
+    args_put(args, length);
+    for (i = 0; i < length; i++) {
+        args_put(args, array[i]);
+    }
+}
+
+static void
+args_put_string(struct record_args *args, t_ilm_const_string string)
+{
+    uint32_t length = 0;
+    uint32_t word = 0;
+    uint32_t i = 0;
+
+    if (string != NULL) {
+        length = (uint32_t)strlen(string);
+    }
+
+    args_put(args, length);
+    for (i = 0; i < length; i += sizeof(word)) {
+        word = 0;
+        memcpy(&word, string + i,
+               (length - i < sizeof(word)) ? length - i : sizeof(word));
+        args_put(args, word);
+    }
+}
+
+/*
+ *=============================================================================
+ * recorder
+ *=============================================================================
+ */
+struct ilm_recorder_context {
+    FILE *file;
+    ILM_CONTROL_PLATFORM_FUNC platform;
+};
+
+static struct ilm_recorder_context ilm_recorder = {0};
+static pthread_mutex_t ilm_recorder_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static uint64_t
+get_time_ns()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void
+record(ilmRecordFunc func, ilmErrorTypes result, uint64_t start,
+       struct record_args *args)
+{
+    struct ilm_recorder_context *ctx = &ilm_recorder;
+    struct ilmRecordHeader header;
+    uint64_t duration = get_time_ns() - start;
+
+    memset(&header, 0, sizeof header);
+    header.func = (unsigned short)func;
+    header.result = (int)result;
+    header.timestamp = start;
+    header.duration = (duration > UINT32_MAX) ? UINT32_MAX
+                                              : (unsigned int)duration;
+    header.size = args->count * sizeof(uint32_t);
+
+    pthread_mutex_lock(&ilm_recorder_mutex);
+    if (ctx->file != NULL) {
+        if ((fwrite(&header, sizeof header, 1, ctx->file) != 1) ||
+            (fwrite(args->words, sizeof(uint32_t), args->count,
+                    ctx->file) != args->count)) {
+            fprintf(stderr, "failed to write ilmControl call log: %s\n",
+                    strerror(errno));
+        }
+
+        /* keep the log usable when the controller crashes */
+        if ((func == ILM_RECORD_COMMIT_CHANGES) ||
+            (func == ILM_RECORD_COMMIT_CHANGES_ON_FRAME)) {
+            fflush(ctx->file);
+        }
+    }
+    pthread_mutex_unlock(&ilm_recorder_mutex);
+
+    args_release(args);
+}
+
+static ilmErrorTypes
+rec_getPropertiesOfLayer(t_ilm_uint layerID,
+                         struct ilmLayerProperties* pLayerProperties)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.getPropertiesOfLayer(
+                               layerID, pLayerProperties);
+
+    args_init(&args);
+    args_put(&args, layerID);
+    record(ILM_RECORD_GET_PROPERTIES_OF_LAYER, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_getPropertiesOfScreen(t_ilm_display screenID,
+                          struct ilmScreenProperties* pScreenProperties)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.getPropertiesOfScreen(
+                               screenID, pScreenProperties);
+
+    args_init(&args);
+    args_put(&args, screenID);
+    record(ILM_RECORD_GET_PROPERTIES_OF_SCREEN, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_getNumberOfHardwareLayers(t_ilm_uint screenID,
+                              t_ilm_uint* pNumberOfHardwareLayers)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.getNumberOfHardwareLayers(
+                               screenID, pNumberOfHardwareLayers);
+
+    args_init(&args);
+    args_put(&args, screenID);
+    record(ILM_RECORD_GET_NUMBER_OF_HARDWARE_LAYERS, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_getScreenIDs(t_ilm_uint* pNumberOfIDs, t_ilm_uint** ppIDs)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.getScreenIDs(
+                               pNumberOfIDs, ppIDs);
+
+    args_init(&args);
+    record(ILM_RECORD_GET_SCREEN_IDS, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_getLayerIDs(t_ilm_int* pLength, t_ilm_layer** ppArray)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.getLayerIDs(
+                               pLength, ppArray);
+
+    args_init(&args);
+    record(ILM_RECORD_GET_LAYER_IDS, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_getLayerIDsOnScreen(t_ilm_uint screenId,
+                        t_ilm_int* pLength, t_ilm_layer** ppArray)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.getLayerIDsOnScreen(
+                               screenId, pLength, ppArray);
+
+    args_init(&args);
+    args_put(&args, screenId);
+    record(ILM_RECORD_GET_LAYER_IDS_ON_SCREEN, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_getSurfaceIDs(t_ilm_int* pLength, t_ilm_surface** ppArray)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.getSurfaceIDs(
+                               pLength, ppArray);
+
+    args_init(&args);
+    record(ILM_RECORD_GET_SURFACE_IDS, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_getSurfaceIDsOnLayer(t_ilm_layer layer,
+                         t_ilm_int* pLength, t_ilm_surface** ppArray)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.getSurfaceIDsOnLayer(
+                               layer, pLength, ppArray);
+
+    args_init(&args);
+    args_put(&args, layer);
+    record(ILM_RECORD_GET_SURFACE_IDS_ON_LAYER, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_layerCreateWithDimension(t_ilm_layer* pLayerId,
+                             t_ilm_uint width, t_ilm_uint height)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    t_ilm_layer requested = (pLayerId != NULL) ? *pLayerId : INVALID_ID;
+    ilmErrorTypes result = ilm_recorder.platform.layerCreateWithDimension(
+                               pLayerId, width, height);
+
+    /* the created id is kept to map generated ids during replay */
+    args_init(&args);
+    args_put(&args, requested);
+    args_put(&args, width);
+    args_put(&args, height);
+    args_put(&args, (pLayerId != NULL) ? *pLayerId : INVALID_ID);
+    record(ILM_RECORD_LAYER_CREATE_WITH_DIMENSION, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_layerRemove(t_ilm_layer layerId)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.layerRemove(layerId);
+
+    args_init(&args);
+    args_put(&args, layerId);
+    record(ILM_RECORD_LAYER_REMOVE, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_layerGetType(t_ilm_layer layerId, ilmLayerType* pLayerType)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.layerGetType(
+                               layerId, pLayerType);
+
+    args_init(&args);
+    args_put(&args, layerId);
+    record(ILM_RECORD_LAYER_GET_TYPE, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_layerSetVisibility(t_ilm_layer layerId, t_ilm_bool newVisibility)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.layerSetVisibility(
+                               layerId, newVisibility);
+
+    args_init(&args);
+    args_put(&args, layerId);
+    args_put(&args, newVisibility);
+    record(ILM_RECORD_LAYER_SET_VISIBILITY, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_layerGetVisibility(t_ilm_layer layerId, t_ilm_bool *pVisibility)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.layerGetVisibility(
+                               layerId, pVisibility);
+
+    args_init(&args);
+    args_put(&args, layerId);
+    record(ILM_RECORD_LAYER_GET_VISIBILITY, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_layerSetOpacity(t_ilm_layer layerId, t_ilm_float opacity)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.layerSetOpacity(
+                               layerId, opacity);
+
+    args_init(&args);
+    args_put(&args, layerId);
+    args_put_float(&args, opacity);
+    record(ILM_RECORD_LAYER_SET_OPACITY, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_layerGetOpacity(t_ilm_layer layerId, t_ilm_float *pOpacity)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.layerGetOpacity(
+                               layerId, pOpacity);
+
+    args_init(&args);
+    args_put(&args, layerId);
+    record(ILM_RECORD_LAYER_GET_OPACITY, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_layerSetSourceRectangle(t_ilm_layer layerId,
+                            t_ilm_uint x, t_ilm_uint y,
+                            t_ilm_uint width, t_ilm_uint height)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.layerSetSourceRectangle(
+                               layerId, x, y, width, height);
+
+    args_init(&args);
+    args_put(&args, layerId);
+    args_put(&args, x);
+    args_put(&args, y);
+    args_put(&args, width);
+    args_put(&args, height);
+    record(ILM_RECORD_LAYER_SET_SOURCE_RECTANGLE, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_layerSetDestinationRectangle(t_ilm_layer layerId,
+                                 t_ilm_int x, t_ilm_int y,
+                                 t_ilm_int width, t_ilm_int height)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.layerSetDestinationRectangle(
+                               layerId, x, y, width, height);
+
+    args_init(&args);
+    args_put(&args, layerId);
+    args_put(&args, (uint32_t)x);
+    args_put(&args, (uint32_t)y);
+    args_put(&args, (uint32_t)width);
+    args_put(&args, (uint32_t)height);
+    record(ILM_RECORD_LAYER_SET_DESTINATION_RECTANGLE, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_layerGetDimension(t_ilm_layer layerId, t_ilm_uint *pDimension)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.layerGetDimension(
+                               layerId, pDimension);
+
+    args_init(&args);
+    args_put(&args, layerId);
+    record(ILM_RECORD_LAYER_GET_DIMENSION, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_layerSetDimension(t_ilm_layer layerId, t_ilm_uint *pDimension)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.layerSetDimension(
+                               layerId, pDimension);
+
+    args_init(&args);
+    args_put(&args, layerId);
+    args_put_array(&args, pDimension, 2);
+    record(ILM_RECORD_LAYER_SET_DIMENSION, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_layerGetPosition(t_ilm_layer layerId, t_ilm_uint *pPosition)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.layerGetPosition(
+                               layerId, pPosition);
+
+    args_init(&args);
+    args_put(&args, layerId);
+    record(ILM_RECORD_LAYER_GET_POSITION, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_layerSetPosition(t_ilm_layer layerId, t_ilm_uint *pPosition)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.layerSetPosition(
+                               layerId, pPosition);
+
+    args_init(&args);
+    args_put(&args, layerId);
+    args_put_array(&args, pPosition, 2);
+    record(ILM_RECORD_LAYER_SET_POSITION, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_layerSetOrientation(t_ilm_layer layerId, ilmOrientation orientation)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.layerSetOrientation(
+                               layerId, orientation);
+
+    args_init(&args);
+    args_put(&args, layerId);
+    args_put(&args, (uint32_t)orientation);
+    record(ILM_RECORD_LAYER_SET_ORIENTATION, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_layerGetOrientation(t_ilm_layer layerId, ilmOrientation *pOrientation)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.layerGetOrientation(
+                               layerId, pOrientation);
+
+    args_init(&args);
+    args_put(&args, layerId);
+    record(ILM_RECORD_LAYER_GET_ORIENTATION, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_layerSetChromaKey(t_ilm_layer layerId, t_ilm_int* pColor)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.layerSetChromaKey(
+                               layerId, pColor);
+
+    args_init(&args);
+    args_put(&args, layerId);
+    args_put_array(&args, (const t_ilm_uint*)pColor, 3);
+    record(ILM_RECORD_LAYER_SET_CHROMA_KEY, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_layerSetRenderOrder(t_ilm_layer layerId,
+                        t_ilm_layer *pSurfaceId, t_ilm_int number)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.layerSetRenderOrder(
+                               layerId, pSurfaceId, number);
+
+    args_init(&args);
+    args_put(&args, layerId);
+    args_put_array(&args, pSurfaceId, (number > 0) ? (t_ilm_uint)number : 0);
+    record(ILM_RECORD_LAYER_SET_RENDER_ORDER, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_layerGetCapabilities(t_ilm_layer layerId,
+                         t_ilm_layercapabilities *pCapabilities)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.layerGetCapabilities(
+                               layerId, pCapabilities);
+
+    args_init(&args);
+    args_put(&args, layerId);
+    record(ILM_RECORD_LAYER_GET_CAPABILITIES, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_layerTypeGetCapabilities(ilmLayerType layerType,
+                             t_ilm_layercapabilities *pCapabilities)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.layerTypeGetCapabilities(
+                               layerType, pCapabilities);
+
+    args_init(&args);
+    args_put(&args, (uint32_t)layerType);
+    record(ILM_RECORD_LAYER_TYPE_GET_CAPABILITIES, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_surfaceSetVisibility(t_ilm_surface surfaceId, t_ilm_bool newVisibility)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.surfaceSetVisibility(
+                               surfaceId, newVisibility);
+
+    args_init(&args);
+    args_put(&args, surfaceId);
+    args_put(&args, newVisibility);
+    record(ILM_RECORD_SURFACE_SET_VISIBILITY, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_surfaceSetOpacity(t_ilm_surface surfaceId, t_ilm_float opacity)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.surfaceSetOpacity(
+                               surfaceId, opacity);
+
+    args_init(&args);
+    args_put(&args, surfaceId);
+    args_put_float(&args, opacity);
+    record(ILM_RECORD_SURFACE_SET_OPACITY, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_surfaceGetOpacity(t_ilm_surface surfaceId, t_ilm_float *pOpacity)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.surfaceGetOpacity(
+                               surfaceId, pOpacity);
+
+    args_init(&args);
+    args_put(&args, surfaceId);
+    record(ILM_RECORD_SURFACE_GET_OPACITY, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_SetKeyboardFocusOn(t_ilm_surface surfaceId)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.SetKeyboardFocusOn(
+                               surfaceId);
+
+    args_init(&args);
+    args_put(&args, surfaceId);
+    record(ILM_RECORD_SET_KEYBOARD_FOCUS_ON, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_GetKeyboardFocusSurfaceId(t_ilm_surface* pSurfaceId)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.GetKeyboardFocusSurfaceId(
+                               pSurfaceId);
+
+    args_init(&args);
+    record(ILM_RECORD_GET_KEYBOARD_FOCUS_SURFACE_ID, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_surfaceSetDestinationRectangle(t_ilm_surface surfaceId,
+                                   t_ilm_int x, t_ilm_int y,
+                                   t_ilm_int width, t_ilm_int height)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result =
+        ilm_recorder.platform.surfaceSetDestinationRectangle(
+            surfaceId, x, y, width, height);
+
+    args_init(&args);
+    args_put(&args, surfaceId);
+    args_put(&args, (uint32_t)x);
+    args_put(&args, (uint32_t)y);
+    args_put(&args, (uint32_t)width);
+    args_put(&args, (uint32_t)height);
+    record(ILM_RECORD_SURFACE_SET_DESTINATION_RECTANGLE, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_surfaceSetDimension(t_ilm_surface surfaceId, t_ilm_uint *pDimension)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.surfaceSetDimension(
+                               surfaceId, pDimension);
+
+    args_init(&args);
+    args_put(&args, surfaceId);
+    args_put_array(&args, pDimension, 2);
+    record(ILM_RECORD_SURFACE_SET_DIMENSION, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_surfaceGetPosition(t_ilm_surface surfaceId, t_ilm_uint *pPosition)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.surfaceGetPosition(
+                               surfaceId, pPosition);
+
+    args_init(&args);
+    args_put(&args, surfaceId);
+    record(ILM_RECORD_SURFACE_GET_POSITION, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_surfaceSetPosition(t_ilm_surface surfaceId, t_ilm_uint *pPosition)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.surfaceSetPosition(
+                               surfaceId, pPosition);
+
+    args_init(&args);
+    args_put(&args, surfaceId);
+    args_put_array(&args, pPosition, 2);
+    record(ILM_RECORD_SURFACE_SET_POSITION, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_surfaceSetOrientation(t_ilm_surface surfaceId,
+                          ilmOrientation orientation)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.surfaceSetOrientation(
+                               surfaceId, orientation);
+
+    args_init(&args);
+    args_put(&args, surfaceId);
+    args_put(&args, (uint32_t)orientation);
+    record(ILM_RECORD_SURFACE_SET_ORIENTATION, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_surfaceGetOrientation(t_ilm_surface surfaceId,
+                          ilmOrientation *pOrientation)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.surfaceGetOrientation(
+                               surfaceId, pOrientation);
+
+    args_init(&args);
+    args_put(&args, surfaceId);
+    record(ILM_RECORD_SURFACE_GET_ORIENTATION, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_surfaceGetPixelformat(t_ilm_layer surfaceId,
+                          ilmPixelFormat *pPixelformat)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.surfaceGetPixelformat(
+                               surfaceId, pPixelformat);
+
+    args_init(&args);
+    args_put(&args, surfaceId);
+    record(ILM_RECORD_SURFACE_GET_PIXELFORMAT, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_surfaceSetChromaKey(t_ilm_surface surfaceId, t_ilm_int* pColor)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.surfaceSetChromaKey(
+                               surfaceId, pColor);
+
+    args_init(&args);
+    args_put(&args, surfaceId);
+    args_put_array(&args, (const t_ilm_uint*)pColor, 3);
+    record(ILM_RECORD_SURFACE_SET_CHROMA_KEY, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_displaySetRenderOrder(t_ilm_display display,
+                          t_ilm_layer *pLayerId, const t_ilm_uint number)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.displaySetRenderOrder(
+                               display, pLayerId, number);
+
+    args_init(&args);
+    args_put(&args, display);
+    args_put_array(&args, pLayerId, number);
+    record(ILM_RECORD_DISPLAY_SET_RENDER_ORDER, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_takeScreenshot(t_ilm_uint screen, t_ilm_const_string filename)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.takeScreenshot(
+                               screen, filename);
+
+    args_init(&args);
+    args_put(&args, screen);
+    args_put_string(&args, filename);
+    record(ILM_RECORD_TAKE_SCREENSHOT, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_takeLayerScreenshot(t_ilm_const_string filename, t_ilm_layer layerid)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.takeLayerScreenshot(
+                               filename, layerid);
+
+    args_init(&args);
+    args_put(&args, layerid);
+    args_put_string(&args, filename);
+    record(ILM_RECORD_TAKE_LAYER_SCREENSHOT, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_takeSurfaceScreenshot(t_ilm_const_string filename,
+                          t_ilm_surface surfaceid)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.takeSurfaceScreenshot(
+                               filename, surfaceid);
+
+    args_init(&args);
+    args_put(&args, surfaceid);
+    args_put_string(&args, filename);
+    record(ILM_RECORD_TAKE_SURFACE_SCREENSHOT, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_SetOptimizationMode(ilmOptimization id, ilmOptimizationMode mode)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.SetOptimizationMode(
+                               id, mode);
+
+    args_init(&args);
+    args_put(&args, (uint32_t)id);
+    args_put(&args, (uint32_t)mode);
+    record(ILM_RECORD_SET_OPTIMIZATION_MODE, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_GetOptimizationMode(ilmOptimization id, ilmOptimizationMode* pMode)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.GetOptimizationMode(
+                               id, pMode);
+
+    args_init(&args);
+    args_put(&args, (uint32_t)id);
+    record(ILM_RECORD_GET_OPTIMIZATION_MODE, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_layerAddNotification(t_ilm_layer layer, layerNotificationFunc callback)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.layerAddNotification(
+                               layer, callback);
+
+    args_init(&args);
+    args_put(&args, layer);
+    record(ILM_RECORD_LAYER_ADD_NOTIFICATION, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_layerRemoveNotification(t_ilm_layer layer)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.layerRemoveNotification(
+                               layer);
+
+    args_init(&args);
+    args_put(&args, layer);
+    record(ILM_RECORD_LAYER_REMOVE_NOTIFICATION, result, start, &args);
+    return result;
+}
+
+static void
+rec_destroy()
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+
+    ilm_recorder.platform.destroy();
+
+    args_init(&args);
+    record(ILM_RECORD_DESTROY, ILM_SUCCESS, start, &args);
+
+    ilmControl_stopRecording();
+}
+
+static ilmErrorTypes
+rec_getNativeHandle(t_ilm_uint pid, t_ilm_int *n_handle,
+                    t_ilm_nativehandle **p_handles)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.getNativeHandle(
+                               pid, n_handle, p_handles);
+
+    args_init(&args);
+    args_put(&args, pid);
+    record(ILM_RECORD_GET_NATIVE_HANDLE, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_getPropertiesOfSurface(t_ilm_uint surfaceID,
+                           struct ilmSurfaceProperties* pSurfaceProperties)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.getPropertiesOfSurface(
+                               surfaceID, pSurfaceProperties);
+
+    args_init(&args);
+    args_put(&args, surfaceID);
+    record(ILM_RECORD_GET_PROPERTIES_OF_SURFACE, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_layerAddSurface(t_ilm_layer layerId, t_ilm_surface surfaceId)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.layerAddSurface(
+                               layerId, surfaceId);
+
+    args_init(&args);
+    args_put(&args, layerId);
+    args_put(&args, surfaceId);
+    record(ILM_RECORD_LAYER_ADD_SURFACE, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_layerRemoveSurface(t_ilm_layer layerId, t_ilm_surface surfaceId)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.layerRemoveSurface(
+                               layerId, surfaceId);
+
+    args_init(&args);
+    args_put(&args, layerId);
+    args_put(&args, surfaceId);
+    record(ILM_RECORD_LAYER_REMOVE_SURFACE, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_surfaceGetDimension(t_ilm_surface surfaceId, t_ilm_uint *pDimension)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.surfaceGetDimension(
+                               surfaceId, pDimension);
+
+    args_init(&args);
+    args_put(&args, surfaceId);
+    record(ILM_RECORD_SURFACE_GET_DIMENSION, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_surfaceGetVisibility(t_ilm_surface surfaceId, t_ilm_bool *pVisibility)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.surfaceGetVisibility(
+                               surfaceId, pVisibility);
+
+    args_init(&args);
+    args_put(&args, surfaceId);
+    record(ILM_RECORD_SURFACE_GET_VISIBILITY, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_surfaceSetSourceRectangle(t_ilm_surface surfaceId,
+                              t_ilm_int x, t_ilm_int y,
+                              t_ilm_int width, t_ilm_int height)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.surfaceSetSourceRectangle(
+                               surfaceId, x, y, width, height);
+
+    args_init(&args);
+    args_put(&args, surfaceId);
+    args_put(&args, (uint32_t)x);
+    args_put(&args, (uint32_t)y);
+    args_put(&args, (uint32_t)width);
+    args_put(&args, (uint32_t)height);
+    record(ILM_RECORD_SURFACE_SET_SOURCE_RECTANGLE, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_commitChanges()
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.commitChanges();
+
+    args_init(&args);
+    record(ILM_RECORD_COMMIT_CHANGES, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_commitChangesOnFrame(struct ilmPresentationTiming* pTiming)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.commitChangesOnFrame(
+                               pTiming);
+
+    args_init(&args);
+    record(ILM_RECORD_COMMIT_CHANGES_ON_FRAME, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_takeScreenshotToBuffer(t_ilm_uint screen,
+                           struct ilmScreenshotBuffer* pBuffer)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.takeScreenshotToBuffer(
+                               screen, pBuffer);
+
+    args_init(&args);
+    args_put(&args, screen);
+    record(ILM_RECORD_TAKE_SCREENSHOT_TO_BUFFER, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_takeLayerScreenshotToBuffer(t_ilm_layer layerid,
+                                struct ilmScreenshotBuffer* pBuffer)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.takeLayerScreenshotToBuffer(
+                               layerid, pBuffer);
+
+    args_init(&args);
+    args_put(&args, layerid);
+    record(ILM_RECORD_TAKE_LAYER_SCREENSHOT_TO_BUFFER, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_takeSurfaceScreenshotToBuffer(t_ilm_surface surfaceid,
+                                  struct ilmScreenshotBuffer* pBuffer)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result =
+        ilm_recorder.platform.takeSurfaceScreenshotToBuffer(surfaceid,
+                                                            pBuffer);
+
+    args_init(&args);
+    args_put(&args, surfaceid);
+    record(ILM_RECORD_TAKE_SURFACE_SCREENSHOT_TO_BUFFER, result, start,
+           &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_surfaceTransitionOpacity(t_ilm_surface surfaceId, t_ilm_float opacity,
+                             t_ilm_uint durationMillis,
+                             ilmTransitionEasing easing)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.surfaceTransitionOpacity(
+                               surfaceId, opacity, durationMillis, easing);
+
+    args_init(&args);
+    args_put(&args, surfaceId);
+    args_put_float(&args, opacity);
+    args_put(&args, durationMillis);
+    args_put(&args, (uint32_t)easing);
+    record(ILM_RECORD_SURFACE_TRANSITION_OPACITY, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_surfaceTransitionDestinationRectangle(t_ilm_surface surfaceId,
+                                          t_ilm_int x, t_ilm_int y,
+                                          t_ilm_int width, t_ilm_int height,
+                                          t_ilm_uint durationMillis,
+                                          ilmTransitionEasing easing)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result =
+        ilm_recorder.platform.surfaceTransitionDestinationRectangle(
+            surfaceId, x, y, width, height, durationMillis, easing);
+
+    args_init(&args);
+    args_put(&args, surfaceId);
+    args_put(&args, (uint32_t)x);
+    args_put(&args, (uint32_t)y);
+    args_put(&args, (uint32_t)width);
+    args_put(&args, (uint32_t)height);
+    args_put(&args, durationMillis);
+    args_put(&args, (uint32_t)easing);
+    record(ILM_RECORD_SURFACE_TRANSITION_DESTINATION_RECTANGLE, result, start,
+           &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_layerTransitionOpacity(t_ilm_layer layerId, t_ilm_float opacity,
+                           t_ilm_uint durationMillis,
+                           ilmTransitionEasing easing)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result = ilm_recorder.platform.layerTransitionOpacity(
+                               layerId, opacity, durationMillis, easing);
+
+    args_init(&args);
+    args_put(&args, layerId);
+    args_put_float(&args, opacity);
+    args_put(&args, durationMillis);
+    args_put(&args, (uint32_t)easing);
+    record(ILM_RECORD_LAYER_TRANSITION_OPACITY, result, start, &args);
+    return result;
+}
+
+static ilmErrorTypes
+rec_layerTransitionDestinationRectangle(t_ilm_layer layerId,
+                                        t_ilm_int x, t_ilm_int y,
+                                        t_ilm_int width, t_ilm_int height,
+                                        t_ilm_uint durationMillis,
+                                        ilmTransitionEasing easing)
+{
+    struct record_args args;
+    uint64_t start = get_time_ns();
+    ilmErrorTypes result =
+        ilm_recorder.platform.layerTransitionDestinationRectangle(
+            layerId, x, y, width, height, durationMillis, easing);
+
+    args_init(&args);
+    args_put(&args, layerId);
+    args_put(&args, (uint32_t)x);
+    args_put(&args, (uint32_t)y);
+    args_put(&args, (uint32_t)width);
+    args_put(&args, (uint32_t)height);
+    args_put(&args, durationMillis);
+    args_put(&args, (uint32_t)easing);
+    record(ILM_RECORD_LAYER_TRANSITION_DESTINATION_RECTANGLE, result, start,
+           &args);
+    return result;
+}
+
+ILM_EXPORT ilmErrorTypes
+ilmControl_startRecording(t_ilm_const_string filename)
+{
+    struct ilm_recorder_context *ctx = &ilm_recorder;
+    ILM_CONTROL_PLATFORM_FUNC *func = &gIlmControlPlatformFunc;
+    uint32_t file_header[2] = {ILM_RECORD_MAGIC, ILM_RECORD_VERSION};
+
+    if ((filename == NULL) || (ctx->file != NULL)) {
+        return ILM_FAILED;
+    }
+
+    ctx->file = fopen(filename, "wb");
+    if (ctx->file == NULL) {
+        fprintf(stderr, "failed to open ilmControl call log %s: %s\n",
+                filename, strerror(errno));
+        return ILM_FAILED;
+    }
+
+    if (fwrite(file_header, sizeof file_header, 1, ctx->file) != 1) {
+        fclose(ctx->file);
+        ctx->file = NULL;
+        return ILM_FAILED;
+    }
+
+    /* keep the active platform and route every call through the recorder */
+    ctx->platform = *func;
+
+    func->getPropertiesOfLayer = rec_getPropertiesOfLayer;
+    func->getPropertiesOfScreen = rec_getPropertiesOfScreen;
+    func->getNumberOfHardwareLayers = rec_getNumberOfHardwareLayers;
+    func->getScreenIDs = rec_getScreenIDs;
+    func->getLayerIDs = rec_getLayerIDs;
+    func->getLayerIDsOnScreen = rec_getLayerIDsOnScreen;
+    func->getSurfaceIDs = rec_getSurfaceIDs;
+    func->getSurfaceIDsOnLayer = rec_getSurfaceIDsOnLayer;
+    func->layerCreateWithDimension = rec_layerCreateWithDimension;
+    func->layerRemove = rec_layerRemove;
+    func->layerGetType = rec_layerGetType;
+    func->layerSetVisibility = rec_layerSetVisibility;
+    func->layerGetVisibility = rec_layerGetVisibility;
+    func->layerSetOpacity = rec_layerSetOpacity;
+    func->layerGetOpacity = rec_layerGetOpacity;
+    func->layerSetSourceRectangle = rec_layerSetSourceRectangle;
+    func->layerSetDestinationRectangle = rec_layerSetDestinationRectangle;
+    func->layerGetDimension = rec_layerGetDimension;
+    func->layerSetDimension = rec_layerSetDimension;
+    func->layerGetPosition = rec_layerGetPosition;
+    func->layerSetPosition = rec_layerSetPosition;
+    func->layerSetOrientation = rec_layerSetOrientation;
+    func->layerGetOrientation = rec_layerGetOrientation;
+    func->layerSetChromaKey = rec_layerSetChromaKey;
+    func->layerSetRenderOrder = rec_layerSetRenderOrder;
+    func->layerGetCapabilities = rec_layerGetCapabilities;
+    func->layerTypeGetCapabilities = rec_layerTypeGetCapabilities;
+    func->surfaceSetVisibility = rec_surfaceSetVisibility;
+    func->surfaceSetOpacity = rec_surfaceSetOpacity;
+    func->surfaceGetOpacity = rec_surfaceGetOpacity;
+    func->SetKeyboardFocusOn = rec_SetKeyboardFocusOn;
+    func->GetKeyboardFocusSurfaceId = rec_GetKeyboardFocusSurfaceId;
+    func->surfaceSetDestinationRectangle = rec_surfaceSetDestinationRectangle;
+    func->surfaceSetDimension = rec_surfaceSetDimension;
+    func->surfaceGetPosition = rec_surfaceGetPosition;
+    func->surfaceSetPosition = rec_surfaceSetPosition;
+    func->surfaceSetOrientation = rec_surfaceSetOrientation;
+    func->surfaceGetOrientation = rec_surfaceGetOrientation;
+    func->surfaceGetPixelformat = rec_surfaceGetPixelformat;
+    func->surfaceSetChromaKey = rec_surfaceSetChromaKey;
+    func->displaySetRenderOrder = rec_displaySetRenderOrder;
+    func->takeScreenshot = rec_takeScreenshot;
+    func->takeLayerScreenshot = rec_takeLayerScreenshot;
+    func->takeSurfaceScreenshot = rec_takeSurfaceScreenshot;
+    func->SetOptimizationMode = rec_SetOptimizationMode;
+    func->GetOptimizationMode = rec_GetOptimizationMode;
+    func->layerAddNotification = rec_layerAddNotification;
+    func->layerRemoveNotification = rec_layerRemoveNotification;
+    func->destroy = rec_destroy;
+    func->getNativeHandle = rec_getNativeHandle;
+    func->getPropertiesOfSurface = rec_getPropertiesOfSurface;
+    func->layerAddSurface = rec_layerAddSurface;
+    func->layerRemoveSurface = rec_layerRemoveSurface;
+    func->surfaceGetDimension = rec_surfaceGetDimension;
+    func->surfaceGetVisibility = rec_surfaceGetVisibility;
+    func->surfaceSetSourceRectangle = rec_surfaceSetSourceRectangle;
+    func->commitChanges = rec_commitChanges;
+    func->commitChangesOnFrame = rec_commitChangesOnFrame;
+    func->takeScreenshotToBuffer = rec_takeScreenshotToBuffer;
+    func->takeLayerScreenshotToBuffer = rec_takeLayerScreenshotToBuffer;
+    func->takeSurfaceScreenshotToBuffer = rec_takeSurfaceScreenshotToBuffer;
+    func->surfaceTransitionOpacity = rec_surfaceTransitionOpacity;
+    func->surfaceTransitionDestinationRectangle =
+        rec_surfaceTransitionDestinationRectangle;
+    func->layerTransitionOpacity = rec_layerTransitionOpacity;
+    func->layerTransitionDestinationRectangle =
+        rec_layerTransitionDestinationRectangle;
+
+    return ILM_SUCCESS;
+}
+
+ILM_EXPORT void
+ilmControl_stopRecording()
+{
+    struct ilm_recorder_context *ctx = &ilm_recorder;
+
+    pthread_mutex_lock(&ilm_recorder_mutex);
+    if (ctx->file == NULL) {
+        pthread_mutex_unlock(&ilm_recorder_mutex);
+        return;
+    }
+
+    fclose(ctx->file);
+    ctx->file = NULL;
+    gIlmControlPlatformFunc = ctx->platform;
+    pthread_mutex_unlock(&ilm_recorder_mutex);
+}
+
+/*
+ *=============================================================================
+ * replay
+ *=============================================================================
+ */
+struct replay_args {
+    const uint32_t *words;
+    uint32_t count;
+    uint32_t pos;
+    int32_t error;
+};
+
+/* layer ids generated by the platform differ between runs */
+struct replay_layer_map {
+    t_ilm_layer *ids;
+    uint32_t count;
+    uint32_t capacity;
+};
+
+static uint32_t
+replay_get(struct replay_args *args)
+{
+    if (args->pos >= args->count) {
+        args->error = 1;
+        return 0;
+    }
+
+    return args->words[args->pos++];
+}
+
+static t_ilm_float
+replay_get_float(struct replay_args *args)
+{
+    uint32_t words[2];
+    t_ilm_float value = 0;
+
+    words[0] = replay_get(args);
+    words[1] = replay_get(args);
+    memcpy(&value, words, sizeof(value));
+
+    return value;
+}
+
+/* returns a pointer into the record, valid until the next record is read */
+static const t_ilm_uint*
+replay_get_array(struct replay_args *args, t_ilm_uint *pLength)
+{
+    const t_ilm_uint *array = NULL;
+
+    *pLength = replay_get(args);
+    if ((args->error != 0) || (*pLength > args->count - args->pos)) {
+        args->error = 1;
+        *pLength = 0;
+        return NULL;
+    }
+
+    array = &args->words[args->pos];
+    args->pos += *pLength;
+
+    return array;
+}
+
+static char*
+replay_get_string(struct replay_args *args)
+{
+    uint32_t length = replay_get(args);
+    uint32_t words = (length + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+    char *string = NULL;
+
+    if ((args->error != 0) || (words > args->count - args->pos)) {
+        args->error = 1;
+        return NULL;
+    }
+
+    string = malloc(length + 1);
+    if (string == NULL) {
+        args->error = 1;
+        return NULL;
+    }
+
+    memcpy(string, &args->words[args->pos], length);
+    string[length] = '\0';
+    args->pos += words;
+
+    return string;
+}
+
+static t_ilm_layer
+replay_map_layer(struct replay_layer_map *map, t_ilm_layer layer)
+{
+    uint32_t i = 0;
+
+    for (i = 0; i < map->count; i += 2) {
+        if (map->ids[i] == layer) {
+            return map->ids[i + 1];
+        }
+    }
+
+    return layer;
+}
+
+static void
+replay_add_layer(struct replay_layer_map *map,
+                 t_ilm_layer recorded, t_ilm_layer replayed)
+{
+    t_ilm_layer *ids = NULL;
+
+    if ((recorded == replayed) || (recorded == INVALID_ID)) {
+        return;
+    }
+
+    if (map->count + 2 > map->capacity) {
+        ids = realloc(map->ids, (map->capacity + 32) * sizeof *ids);
+        if (ids == NULL) {
+            return;
+        }
+        map->ids = ids;
+        map->capacity += 32;
+    }
+
+    map->ids[map->count++] = recorded;
+    map->ids[map->count++] = replayed;
+}
+
+static void
+replay_layer_notification(t_ilm_layer layer,
+                          struct ilmLayerProperties* properties,
+                          t_ilm_notification_mask mask)
+{
+    (void)layer;
+    (void)properties;
+    (void)mask;
+}
+
+/*
+ * Issue a single recorded call against the active platform.
+ * Returns -1 when the record can not be replayed.
+ */
+static int32_t
+replay_call(const struct ilmRecordHeader *header, struct replay_args *args,
+            struct replay_layer_map *map, ilmErrorTypes *pResult)
+{
+    ILM_CONTROL_PLATFORM_FUNC *func = &gIlmControlPlatformFunc;
+    struct ilmLayerProperties layer_prop;
+    struct ilmSurfaceProperties surface_prop;
+    struct ilmScreenProperties screen_prop;
+    struct ilmScreenshotBuffer screenshot;
+    t_ilm_uint values[4] = {0};
+    t_ilm_uint *id_array = NULL;
+    t_ilm_nativehandle *handles = NULL;
+    const t_ilm_uint *array = NULL;
+    t_ilm_uint length = 0;
+    t_ilm_int count = 0;
+    t_ilm_uint a0 = 0;
+    t_ilm_uint a1 = 0;
+    t_ilm_uint a2 = 0;
+    t_ilm_uint a3 = 0;
+    t_ilm_uint a4 = 0;
+    t_ilm_uint a5 = 0;
+    t_ilm_uint a6 = 0;
+    t_ilm_float f = 0;
+    t_ilm_layer layer = 0;
+    char *string = NULL;
+    ilmErrorTypes result = ILM_FAILED;
+
+    switch (header->func) {
+    case ILM_RECORD_GET_PROPERTIES_OF_LAYER:
+        a0 = replay_map_layer(map, replay_get(args));
+        result = func->getPropertiesOfLayer(a0, &layer_prop);
+        break;
+    case ILM_RECORD_GET_PROPERTIES_OF_SCREEN:
+        a0 = replay_get(args);
+        memset(&screen_prop, 0, sizeof screen_prop);
+        result = func->getPropertiesOfScreen(a0, &screen_prop);
+        if (result == ILM_SUCCESS) {
+            free(screen_prop.layerIds);
+        }
+        break;
+    case ILM_RECORD_GET_NUMBER_OF_HARDWARE_LAYERS:
+        a0 = replay_get(args);
+        result = func->getNumberOfHardwareLayers(a0, &values[0]);
+        break;
+    case ILM_RECORD_GET_SCREEN_IDS:
+        result = func->getScreenIDs(&length, &id_array);
+        break;
+    case ILM_RECORD_GET_LAYER_IDS:
+        result = func->getLayerIDs(&count, &id_array);
+        break;
+    case ILM_RECORD_GET_LAYER_IDS_ON_SCREEN:
+        a0 = replay_get(args);
+        result = func->getLayerIDsOnScreen(a0, &count, &id_array);
+        break;
+    case ILM_RECORD_GET_SURFACE_IDS:
+        result = func->getSurfaceIDs(&count, &id_array);
+        break;
+    case ILM_RECORD_GET_SURFACE_IDS_ON_LAYER:
+        a0 = replay_map_layer(map, replay_get(args));
+        result = func->getSurfaceIDsOnLayer(a0, &count, &id_array);
+        break;
+    case ILM_RECORD_LAYER_CREATE_WITH_DIMENSION:
+        layer = replay_get(args);
+        a1 = replay_get(args);
+        a2 = replay_get(args);
+        a3 = replay_get(args);
+        if (args->error != 0) {
+            break;
+        }
+        result = func->layerCreateWithDimension(&layer, a1, a2);
+        if (result == ILM_SUCCESS) {
+            replay_add_layer(map, a3, layer);
+        }
+        break;
+    case ILM_RECORD_LAYER_REMOVE:
+        a0 = replay_map_layer(map, replay_get(args));
+        result = func->layerRemove(a0);
+        break;
+    case ILM_RECORD_LAYER_GET_TYPE:
+        a0 = replay_map_layer(map, replay_get(args));
+        result = func->layerGetType(a0, (ilmLayerType*)&values[0]);
+        break;
+    case ILM_RECORD_LAYER_SET_VISIBILITY:
+        a0 = replay_map_layer(map, replay_get(args));
+        a1 = replay_get(args);
+        result = func->layerSetVisibility(a0, a1);
+        break;
+    case ILM_RECORD_LAYER_GET_VISIBILITY:
+        a0 = replay_map_layer(map, replay_get(args));
+        result = func->layerGetVisibility(a0, &values[0]);
+        break;
+    case ILM_RECORD_LAYER_SET_OPACITY:
+        a0 = replay_map_layer(map, replay_get(args));
+        f = replay_get_float(args);
+        result = func->layerSetOpacity(a0, f);
+        break;
+    case ILM_RECORD_LAYER_GET_OPACITY:
+        a0 = replay_map_layer(map, replay_get(args));
+        result = func->layerGetOpacity(a0, &f);
+        break;
+    case ILM_RECORD_LAYER_SET_SOURCE_RECTANGLE:
+        a0 = replay_map_layer(map, replay_get(args));
+        a1 = replay_get(args);
+        a2 = replay_get(args);
+        a3 = replay_get(args);
+        a4 = replay_get(args);
+        result = func->layerSetSourceRectangle(a0, a1, a2, a3, a4);
+        break;
+    case ILM_RECORD_LAYER_SET_DESTINATION_RECTANGLE:
+        a0 = replay_map_layer(map, replay_get(args));
+        a1 = replay_get(args);
+        a2 = replay_get(args);
+        a3 = replay_get(args);
+        a4 = replay_get(args);
+        result = func->layerSetDestinationRectangle(a0,
+                     (t_ilm_int)a1, (t_ilm_int)a2,
+                     (t_ilm_int)a3, (t_ilm_int)a4);
+        break;
+    case ILM_RECORD_LAYER_GET_DIMENSION:
+        a0 = replay_map_layer(map, replay_get(args));
+        result = func->layerGetDimension(a0, values);
+        break;
+    case ILM_RECORD_LAYER_SET_DIMENSION:
+        a0 = replay_map_layer(map, replay_get(args));
+        array = replay_get_array(args, &length);
+        if ((args->error != 0) || (length != 2)) {
+            args->error = 1;
+            break;
+        }
+        memcpy(values, array, 2 * sizeof *values);
+        result = func->layerSetDimension(a0, values);
+        break;
+    case ILM_RECORD_LAYER_GET_POSITION:
+        a0 = replay_map_layer(map, replay_get(args));
+        result = func->layerGetPosition(a0, values);
+        break;
+    case ILM_RECORD_LAYER_SET_POSITION:
+        a0 = replay_map_layer(map, replay_get(args));
+        array = replay_get_array(args, &length);
+        if ((args->error != 0) || (length != 2)) {
+            args->error = 1;
+            break;
+        }
+        memcpy(values, array, 2 * sizeof *values);
+        result = func->layerSetPosition(a0, values);
+        break;
+    case ILM_RECORD_LAYER_SET_ORIENTATION:
+        a0 = replay_map_layer(map, replay_get(args));
+        a1 = replay_get(args);
+        result = func->layerSetOrientation(a0, (ilmOrientation)a1);
+        break;
+    case ILM_RECORD_LAYER_GET_ORIENTATION:
+        a0 = replay_map_layer(map, replay_get(args));
+        result = func->layerGetOrientation(a0, (ilmOrientation*)&values[0]);
+        break;
+    case ILM_RECORD_LAYER_SET_CHROMA_KEY:
+        a0 = replay_map_layer(map, replay_get(args));
+        array = replay_get_array(args, &length);
+        if (args->error != 0) {
+            break;
+        }
+        memcpy(values, array, ((length < 3) ? length : 3) * sizeof *values);
+        result = func->layerSetChromaKey(a0,
+                     (length > 0) ? (t_ilm_int*)values : NULL);
+        break;
+    case ILM_RECORD_LAYER_SET_RENDER_ORDER:
+        a0 = replay_map_layer(map, replay_get(args));
+        array = replay_get_array(args, &length);
+        if (args->error != 0) {
+            break;
+        }
+        result = func->layerSetRenderOrder(a0, (t_ilm_surface*)array,
+                                           (t_ilm_int)length);
+        break;
+    case ILM_RECORD_LAYER_GET_CAPABILITIES:
+        a0 = replay_map_layer(map, replay_get(args));
+        result = func->layerGetCapabilities(a0, &values[0]);
+        break;
+    case ILM_RECORD_LAYER_TYPE_GET_CAPABILITIES:
+        a0 = replay_get(args);
+        result = func->layerTypeGetCapabilities((ilmLayerType)a0,
+                                                &values[0]);
+        break;
+    case ILM_RECORD_SURFACE_SET_VISIBILITY:
+        a0 = replay_get(args);
+        a1 = replay_get(args);
+        result = func->surfaceSetVisibility(a0, a1);
+        break;
+    case ILM_RECORD_SURFACE_SET_OPACITY:
+        a0 = replay_get(args);
+        f = replay_get_float(args);
+        result = func->surfaceSetOpacity(a0, f);
+        break;
+    case ILM_RECORD_SURFACE_GET_OPACITY:
+        a0 = replay_get(args);
+        result = func->surfaceGetOpacity(a0, &f);
+        break;
+    case ILM_RECORD_SET_KEYBOARD_FOCUS_ON:
+        a0 = replay_get(args);
+        result = func->SetKeyboardFocusOn(a0);
+        break;
+    case ILM_RECORD_GET_KEYBOARD_FOCUS_SURFACE_ID:
+        result = func->GetKeyboardFocusSurfaceId(&values[0]);
+        break;
+    case ILM_RECORD_SURFACE_SET_DESTINATION_RECTANGLE:
+        a0 = replay_get(args);
+        a1 = replay_get(args);
+        a2 = replay_get(args);
+        a3 = replay_get(args);
+        a4 = replay_get(args);
+        result = func->surfaceSetDestinationRectangle(a0,
+                     (t_ilm_int)a1, (t_ilm_int)a2,
+                     (t_ilm_int)a3, (t_ilm_int)a4);
+        break;
+    case ILM_RECORD_SURFACE_SET_DIMENSION:
+        a0 = replay_get(args);
+        array = replay_get_array(args, &length);
+        if ((args->error != 0) || (length != 2)) {
+            args->error = 1;
+            break;
+        }
+        memcpy(values, array, 2 * sizeof *values);
+        result = func->surfaceSetDimension(a0, values);
+        break;
+    case ILM_RECORD_SURFACE_GET_POSITION:
+        a0 = replay_get(args);
+        result = func->surfaceGetPosition(a0, values);
+        break;
+    case ILM_RECORD_SURFACE_SET_POSITION:
+        a0 = replay_get(args);
+        array = replay_get_array(args, &length);
+        if ((args->error != 0) || (length != 2)) {
+            args->error = 1;
+            break;
+        }
+        memcpy(values, array, 2 * sizeof *values);
+        result = func->surfaceSetPosition(a0, values);
+        break;
+    case ILM_RECORD_SURFACE_SET_ORIENTATION:
+        a0 = replay_get(args);
+        a1 = replay_get(args);
+        result = func->surfaceSetOrientation(a0, (ilmOrientation)a1);
+        break;
+    case ILM_RECORD_SURFACE_GET_ORIENTATION:
+        a0 = replay_get(args);
+        result = func->surfaceGetOrientation(a0,
+                                             (ilmOrientation*)&values[0]);
+        break;
+    case ILM_RECORD_SURFACE_GET_PIXELFORMAT:
+        a0 = replay_get(args);
+        result = func->surfaceGetPixelformat(a0,
+                                             (ilmPixelFormat*)&values[0]);
+        break;
+    case ILM_RECORD_SURFACE_SET_CHROMA_KEY:
+        a0 = replay_get(args);
+        array = replay_get_array(args, &length);
+        if (args->error != 0) {
+            break;
+        }
+        memcpy(values, array, ((length < 3) ? length : 3) * sizeof *values);
+        result = func->surfaceSetChromaKey(a0,
+                     (length > 0) ? (t_ilm_int*)values : NULL);
+        break;
+    case ILM_RECORD_DISPLAY_SET_RENDER_ORDER:
+        a0 = replay_get(args);
+        array = replay_get_array(args, &length);
+        if (args->error != 0) {
+            break;
+        }
+        id_array = malloc((length + 1) * sizeof *id_array);
+        if (id_array == NULL) {
+            break;
+        }
+        for (a1 = 0; a1 < length; a1++) {
+            id_array[a1] = replay_map_layer(map, array[a1]);
+        }
+        result = func->displaySetRenderOrder(a0, id_array, length);
+        break;
+    case ILM_RECORD_TAKE_SCREENSHOT:
+        a0 = replay_get(args);
+        string = replay_get_string(args);
+        if (string == NULL) {
+            break;
+        }
+        result = func->takeScreenshot(a0, string);
+        break;
+    case ILM_RECORD_TAKE_LAYER_SCREENSHOT:
+        a0 = replay_map_layer(map, replay_get(args));
+        string = replay_get_string(args);
+        if (string == NULL) {
+            break;
+        }
+        result = func->takeLayerScreenshot(string, a0);
+        break;
+    case ILM_RECORD_TAKE_SURFACE_SCREENSHOT:
+        a0 = replay_get(args);
+        string = replay_get_string(args);
+        if (string == NULL) {
+            break;
+        }
+        result = func->takeSurfaceScreenshot(string, a0);
+        break;
+    case ILM_RECORD_SET_OPTIMIZATION_MODE:
+        a0 = replay_get(args);
+        a1 = replay_get(args);
+        result = func->SetOptimizationMode((ilmOptimization)a0,
+                                           (ilmOptimizationMode)a1);
+        break;
+    case ILM_RECORD_GET_OPTIMIZATION_MODE:
+        a0 = replay_get(args);
+        result = func->GetOptimizationMode((ilmOptimization)a0,
+                                           (ilmOptimizationMode*)&values[0]);
+        break;
+    case ILM_RECORD_LAYER_ADD_NOTIFICATION:
+        /* the recorded callback is not available, a no-op one stands in */
+        a0 = replay_map_layer(map, replay_get(args));
+        result = func->layerAddNotification(a0, replay_layer_notification);
+        break;
+    case ILM_RECORD_LAYER_REMOVE_NOTIFICATION:
+        a0 = replay_map_layer(map, replay_get(args));
+        result = func->layerRemoveNotification(a0);
+        break;
+    case ILM_RECORD_GET_NATIVE_HANDLE:
+        a0 = replay_get(args);
+        result = func->getNativeHandle(a0, &count, &handles);
+        if (result == ILM_SUCCESS) {
+            free(handles);
+        }
+        break;
+    case ILM_RECORD_GET_PROPERTIES_OF_SURFACE:
+        a0 = replay_get(args);
+        result = func->getPropertiesOfSurface(a0, &surface_prop);
+        break;
+    case ILM_RECORD_LAYER_ADD_SURFACE:
+        a0 = replay_map_layer(map, replay_get(args));
+        a1 = replay_get(args);
+        result = func->layerAddSurface(a0, a1);
+        break;
+    case ILM_RECORD_LAYER_REMOVE_SURFACE:
+        a0 = replay_map_layer(map, replay_get(args));
+        a1 = replay_get(args);
+        result = func->layerRemoveSurface(a0, a1);
+        break;
+    case ILM_RECORD_SURFACE_GET_DIMENSION:
+        a0 = replay_get(args);
+        result = func->surfaceGetDimension(a0, values);
+        break;
+    case ILM_RECORD_SURFACE_GET_VISIBILITY:
+        a0 = replay_get(args);
+        result = func->surfaceGetVisibility(a0, &values[0]);
+        break;
+    case ILM_RECORD_SURFACE_SET_SOURCE_RECTANGLE:
+        a0 = replay_get(args);
+        a1 = replay_get(args);
+        a2 = replay_get(args);
+        a3 = replay_get(args);
+        a4 = replay_get(args);
+        result = func->surfaceSetSourceRectangle(a0,
+                     (t_ilm_int)a1, (t_ilm_int)a2,
+                     (t_ilm_int)a3, (t_ilm_int)a4);
+        break;
+    case ILM_RECORD_COMMIT_CHANGES:
+        result = func->commitChanges();
+        break;
+    case ILM_RECORD_COMMIT_CHANGES_ON_FRAME:
+        result = func->commitChangesOnFrame(NULL);
+        break;
+    case ILM_RECORD_TAKE_SCREENSHOT_TO_BUFFER:
+        a0 = replay_get(args);
+        result = func->takeScreenshotToBuffer(a0, &screenshot);
+        func->releaseScreenshotBuffer(&screenshot);
+        break;
+    case ILM_RECORD_TAKE_LAYER_SCREENSHOT_TO_BUFFER:
+        a0 = replay_map_layer(map, replay_get(args));
+        result = func->takeLayerScreenshotToBuffer(a0, &screenshot);
+        func->releaseScreenshotBuffer(&screenshot);
+        break;
+    case ILM_RECORD_TAKE_SURFACE_SCREENSHOT_TO_BUFFER:
+        a0 = replay_get(args);
+        result = func->takeSurfaceScreenshotToBuffer(a0, &screenshot);
+        func->releaseScreenshotBuffer(&screenshot);
+        break;
+    case ILM_RECORD_SURFACE_TRANSITION_OPACITY:
+        a0 = replay_get(args);
+        f = replay_get_float(args);
+        a1 = replay_get(args);
+        a2 = replay_get(args);
+        result = func->surfaceTransitionOpacity(a0, f, a1,
+                                                (ilmTransitionEasing)a2);
+        break;
+    case ILM_RECORD_SURFACE_TRANSITION_DESTINATION_RECTANGLE:
+        a0 = replay_get(args);
+        a1 = replay_get(args);
+        a2 = replay_get(args);
+        a3 = replay_get(args);
+        a4 = replay_get(args);
+        a5 = replay_get(args);
+        a6 = replay_get(args);
+        result = func->surfaceTransitionDestinationRectangle(a0,
+                     (t_ilm_int)a1, (t_ilm_int)a2,
+                     (t_ilm_int)a3, (t_ilm_int)a4,
+                     a5, (ilmTransitionEasing)a6);
+        break;
+    case ILM_RECORD_LAYER_TRANSITION_OPACITY:
+        a0 = replay_map_layer(map, replay_get(args));
+        f = replay_get_float(args);
+        a1 = replay_get(args);
+        a2 = replay_get(args);
+        result = func->layerTransitionOpacity(a0, f, a1,
+                                              (ilmTransitionEasing)a2);
+        break;
+    case ILM_RECORD_LAYER_TRANSITION_DESTINATION_RECTANGLE:
+        a0 = replay_map_layer(map, replay_get(args));
+        a1 = replay_get(args);
+        a2 = replay_get(args);
+        a3 = replay_get(args);
+        a4 = replay_get(args);
+        a5 = replay_get(args);
+        a6 = replay_get(args);
+        result = func->layerTransitionDestinationRectangle(a0,
+                     (t_ilm_int)a1, (t_ilm_int)a2,
+                     (t_ilm_int)a3, (t_ilm_int)a4,
+                     a5, (ilmTransitionEasing)a6);
+        break;
+    case ILM_RECORD_DESTROY:
+    default:
+        /* the replay runs inside an initialized ilm, keep it alive */
+        return -1;
+    }
+
+    free(id_array);
+    free(string);
+
+    if (args->error != 0) {
+        return -1;
+    }
+
+    *pResult = result;
+    return 0;
+}
+
+static void
+sleep_until_ns(uint64_t deadline)
+{
+    struct timespec ts;
+
+    ts.tv_sec = (time_t)(deadline / 1000000000ULL);
+    ts.tv_nsec = (long)(deadline % 1000000000ULL);
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+}
+
+ILM_EXPORT ilmErrorTypes
+ilmControl_replay(t_ilm_const_string filename, t_ilm_bool realtime,
+                  struct ilmReplayStatistics* pStatistics)
+{
+    struct ilmReplayStatistics stats;
+    struct ilmRecordHeader header;
+    struct replay_args args;
+    struct replay_layer_map map = {NULL, 0, 0};
+    uint32_t file_header[2] = {0, 0};
+    uint32_t *words = NULL;
+    uint32_t capacity = 0;
+    uint64_t first = 0;
+    uint64_t replay_start = 0;
+    uint64_t call_start = 0;
+    uint64_t call_time = 0;
+    ilmErrorTypes result = ILM_FAILED;
+    ilmErrorTypes returnValue = ILM_FAILED;
+    FILE *file = NULL;
+
+    memset(&stats, 0, sizeof stats);
+    replay_start = get_time_ns();
+
+    file = fopen(filename, "rb");
+    if (file == NULL) {
+        fprintf(stderr, "failed to open ilmControl call log %s: %s\n",
+                filename, strerror(errno));
+        return ILM_FAILED;
+    }
+
+    do {
+        if ((fread(file_header, sizeof file_header, 1, file) != 1) ||
+            (file_header[0] != ILM_RECORD_MAGIC) ||
+            (file_header[1] != ILM_RECORD_VERSION)) {
+            fprintf(stderr, "%s is not an ilmControl call log\n", filename);
+            break;
+        }
+
+        while (fread(&header, sizeof header, 1, file) == 1) {
+            if ((header.size % sizeof(uint32_t)) != 0) {
+                break;
+            }
+
+            args.count = header.size / sizeof(uint32_t);
+            if (args.count > capacity) {
+                uint32_t *grown = realloc(words, header.size);
+                if (grown == NULL) {
+                    break;
+                }
+                words = grown;
+                capacity = args.count;
+            }
+
+            if ((args.count > 0) &&
+                (fread(words, sizeof(uint32_t), args.count, file) !=
+                 args.count)) {
+                break;
+            }
+
+            args.words = words;
+            args.pos = 0;
+            args.error = 0;
+
+            if (stats.callCount + stats.skippedCount == 0) {
+                first = header.timestamp;
+            }
+            stats.recordedTime = (t_ilm_ulong)
+                ((header.timestamp + header.duration - first) / 1000);
+
+            if (realtime == ILM_TRUE) {
+                sleep_until_ns(replay_start + (header.timestamp - first));
+            }
+
+            call_start = get_time_ns();
+            if (replay_call(&header, &args, &map, &result) != 0) {
+                stats.skippedCount++;
+                continue;
+            }
+            call_time += get_time_ns() - call_start;
+
+            stats.callCount++;
+            if (result != (ilmErrorTypes)header.result) {
+                stats.mismatchCount++;
+            }
+        }
+
+        if (feof(file) == 0) {
+            fprintf(stderr, "ilmControl call log %s is corrupt\n", filename);
+            break;
+        }
+
+        returnValue = ILM_SUCCESS;
+    } while (0);
+
+    stats.elapsedTime = (t_ilm_ulong)((get_time_ns() - replay_start) / 1000);
+    stats.callTime = (t_ilm_ulong)(call_time / 1000);
+
+    if (pStatistics != NULL) {
+        *pStatistics = stats;
+    }
+
+    free(map.ids);
+    free(words);
+    fclose(file);
+
+    return returnValue;
+}
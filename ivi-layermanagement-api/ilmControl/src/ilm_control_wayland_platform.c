@@ -23,6 +23,8 @@
 #include <pthread.h>
 #include <signal.h>
 #include <poll.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include "ilm_common.h"
 #include "ilm_control_platform.h"
 #include "wayland-util.h"
@@ -145,6 +147,56 @@ static ilmErrorTypes wayland_surfaceSetSourceRectangle(t_ilm_surface surfaceId,
                          t_ilm_int x, t_ilm_int y,
                          t_ilm_int width, t_ilm_int height);
 static ilmErrorTypes wayland_commitChanges();
+static ilmErrorTypes wayland_commitChangesOnFrame(
+                         struct ilmPresentationTiming* pTiming);
+static ilmErrorTypes wayland_takeScreenshotToBuffer(t_ilm_uint screen,
+                         struct ilmScreenshotBuffer* pBuffer);
+static ilmErrorTypes wayland_takeLayerScreenshotToBuffer(t_ilm_layer layerid,
+                         struct ilmScreenshotBuffer* pBuffer);
+static ilmErrorTypes wayland_takeSurfaceScreenshotToBuffer(
+                         t_ilm_surface surfaceid,
+                         struct ilmScreenshotBuffer* pBuffer);
+static ilmErrorTypes wayland_releaseScreenshotBuffer(
+                         struct ilmScreenshotBuffer* pBuffer);
+static ilmErrorTypes wayland_startScreenCapture(t_ilm_uint screen,
+                         t_ilm_uint interval, t_ilm_uint bufferCount,
+                         t_ilm_uint* pCaptureId);
+static ilmErrorTypes wayland_startSurfaceCapture(t_ilm_surface surfaceid,
+                         t_ilm_uint interval, t_ilm_uint bufferCount,
+                         t_ilm_uint* pCaptureId);
+static ilmErrorTypes wayland_getCaptureFrame(t_ilm_uint captureId,
+                         struct ilmCaptureFrame* pFrame);
+static ilmErrorTypes wayland_releaseCaptureFrame(t_ilm_uint captureId,
+                         struct ilmCaptureFrame* pFrame);
+static ilmErrorTypes wayland_stopCapture(t_ilm_uint captureId);
+static ilmErrorTypes wayland_setEventRate(ilmEventRate policy,
+                         t_ilm_uint maxRate);
+static ilmErrorTypes wayland_getSurfaceFrameStats(t_ilm_surface surfaceId,
+                         struct ilmSurfaceFrameStats* pStats);
+static ilmErrorTypes wayland_setScreenshotFormat(ilmScreenshotFormat format);
+static ilmErrorTypes wayland_surfaceTransitionOpacity(t_ilm_surface surfaceId,
+                         t_ilm_float opacity, t_ilm_uint durationMillis,
+                         ilmTransitionEasing easing);
+static ilmErrorTypes wayland_surfaceTransitionDestinationRectangle(
+                         t_ilm_surface surfaceId, t_ilm_int x, t_ilm_int y,
+                         t_ilm_int width, t_ilm_int height,
+                         t_ilm_uint durationMillis,
+                         ilmTransitionEasing easing);
+static ilmErrorTypes wayland_layerTransitionOpacity(t_ilm_layer layerId,
+                         t_ilm_float opacity, t_ilm_uint durationMillis,
+                         ilmTransitionEasing easing);
+static ilmErrorTypes wayland_layerTransitionDestinationRectangle(
+                         t_ilm_layer layerId, t_ilm_int x, t_ilm_int y,
+                         t_ilm_int width, t_ilm_int height,
+                         t_ilm_uint durationMillis,
+                         ilmTransitionEasing easing);
+static ilmErrorTypes wayland_surfaceGetEffectiveVisibility(
+                         t_ilm_surface surfaceId, t_ilm_bool *pVisibility);
+static ilmErrorTypes wayland_addInterest(ilmObjectType type,
+                         t_ilm_uint idMin, t_ilm_uint idMax,
+                         t_ilm_bool withMembers);
+static ilmErrorTypes wayland_setInterestMask(t_ilm_notification_mask mask);
+static ilmErrorTypes wayland_clearInterest(void);
 
 void init_ilmControlPlatformTable()
 {
@@ -264,6 +316,48 @@ void init_ilmControlPlatformTable()
         wayland_surfaceSetSourceRectangle;
     gIlmControlPlatformFunc.commitChanges =
         wayland_commitChanges;
+    gIlmControlPlatformFunc.commitChangesOnFrame =
+        wayland_commitChangesOnFrame;
+    gIlmControlPlatformFunc.takeScreenshotToBuffer =
+        wayland_takeScreenshotToBuffer;
+    gIlmControlPlatformFunc.takeLayerScreenshotToBuffer =
+        wayland_takeLayerScreenshotToBuffer;
+    gIlmControlPlatformFunc.takeSurfaceScreenshotToBuffer =
+        wayland_takeSurfaceScreenshotToBuffer;
+    gIlmControlPlatformFunc.releaseScreenshotBuffer =
+        wayland_releaseScreenshotBuffer;
+    gIlmControlPlatformFunc.startScreenCapture =
+        wayland_startScreenCapture;
+    gIlmControlPlatformFunc.startSurfaceCapture =
+        wayland_startSurfaceCapture;
+    gIlmControlPlatformFunc.getCaptureFrame =
+        wayland_getCaptureFrame;
+    gIlmControlPlatformFunc.releaseCaptureFrame =
+        wayland_releaseCaptureFrame;
+    gIlmControlPlatformFunc.stopCapture =
+        wayland_stopCapture;
+    gIlmControlPlatformFunc.setEventRate =
+        wayland_setEventRate;
+    gIlmControlPlatformFunc.getSurfaceFrameStats =
+        wayland_getSurfaceFrameStats;
+    gIlmControlPlatformFunc.setScreenshotFormat =
+        wayland_setScreenshotFormat;
+    gIlmControlPlatformFunc.surfaceTransitionOpacity =
+        wayland_surfaceTransitionOpacity;
+    gIlmControlPlatformFunc.surfaceTransitionDestinationRectangle =
+        wayland_surfaceTransitionDestinationRectangle;
+    gIlmControlPlatformFunc.layerTransitionOpacity =
+        wayland_layerTransitionOpacity;
+    gIlmControlPlatformFunc.layerTransitionDestinationRectangle =
+        wayland_layerTransitionDestinationRectangle;
+    gIlmControlPlatformFunc.surfaceGetEffectiveVisibility =
+        wayland_surfaceGetEffectiveVisibility;
+    gIlmControlPlatformFunc.addInterest =
+        wayland_addInterest;
+    gIlmControlPlatformFunc.setInterestMask =
+        wayland_setInterestMask;
+    gIlmControlPlatformFunc.clearInterest =
+        wayland_clearInterest;
 }
 
 struct surface_context {
@@ -274,6 +368,8 @@ struct surface_context {
 
     t_ilm_uint id_surface;
     struct ilmSurfaceProperties prop;
+    /* determined by the compositor, see ilm_surfaceGetEffectiveVisibility */
+    t_ilm_bool effective_visibility;
     surfaceNotificationFunc notification;
 
     struct {
@@ -310,6 +406,11 @@ struct screen_context {
 
     struct ilmScreenProperties prop;
 
+    struct {
+        int32_t width;
+        int32_t height;
+    } mode;
+
     struct {
         struct wl_list list_layer;
         struct wl_list link;
@@ -318,6 +419,27 @@ struct screen_context {
     struct ilm_control_context *ctx;
 };
 
+struct capture_buffer_context {
+    struct wl_buffer *buffer;
+    struct ilmScreenshotBuffer frame;
+    struct wl_array damage;
+    int queued;
+    struct wl_list link;
+};
+
+struct capture_context {
+    t_ilm_uint id_capture;
+    struct ivi_controller_capture *controller;
+    struct capture_buffer_context *buffers;
+    t_ilm_uint num_buffer;
+    /* damage received since the last frame */
+    struct wl_array damage;
+    /* frames received but not handed out yet */
+    struct wl_list list_ready;
+    int stopped;
+    struct wl_list link;
+};
+
 struct nativehandle_context {
     uint32_t pid;
     uint32_t nativehandle;
@@ -329,10 +451,13 @@ struct wayland_context {
     struct wl_registry *registry;
     struct wl_compositor *compositor;
     struct ivi_controller *controller;
+    uint32_t controller_version;
+    struct wl_shm *shm;
 
     struct wl_list list_surface;
     struct wl_list list_layer;
     struct wl_list list_screen;
+    struct wl_list list_capture;
 };
 
 struct ilm_control_context {
@@ -349,6 +474,9 @@ struct ilm_control_context {
     pthread_t thread;
     pthread_mutex_t mutex;
     uint32_t internal_id_surface;
+    uint32_t internal_id_capture;
+    /* IVI_CONTROLLER_SCREENSHOT_FORMAT_* of screenshots into files */
+    uint32_t screenshot_format;
 };
 
 static int32_t
@@ -435,12 +563,14 @@ output_listener_mode(void *data,
                      int32_t height,
                      int32_t refresh)
 {
-    (void)data;
+    struct screen_context *ctx_scrn = data;
     (void)output;
-    (void)flags;
-    (void)width;
-    (void)height;
     (void)refresh;
+
+    if (flags & WL_OUTPUT_MODE_CURRENT) {
+        ctx_scrn->mode.width = width;
+        ctx_scrn->mode.height = height;
+    }
 }
 
 static void
@@ -1136,6 +1266,23 @@ controller_surface_listener_input_focus(void *data,
     (void)enabled;
 }
 
+static void
+controller_surface_listener_effective_visibility(void *data,
+                   struct ivi_controller_surface *controller,
+                   int32_t visibility)
+{
+    struct wayland_context *ctx = data;
+    struct surface_context *ctx_surf = NULL;
+
+    ctx_surf = get_surface_context_by_controller(ctx, controller);
+    if (ctx_surf == NULL) {
+        fprintf(stderr, "Invalid controller_surface in %s\n", __FUNCTION__);
+        return;
+    }
+
+    ctx_surf->effective_visibility = (t_ilm_bool)visibility;
+}
+
 static struct ivi_controller_surface_listener controller_surface_listener =
 {
     controller_surface_listener_visibility,
@@ -1149,9 +1296,165 @@ static struct ivi_controller_surface_listener controller_surface_listener =
     controller_surface_listener_stats,
     controller_surface_listener_destroyed,
     controller_surface_listener_content,
-    controller_surface_listener_input_focus
+    controller_surface_listener_input_focus,
+    controller_surface_listener_effective_visibility
+};
+
+/* record of the ivi_controller.scene_changes event */
+struct scene_change {
+    uint32_t object_type;
+    uint32_t id;
+    uint32_t mask;
+    wl_fixed_t opacity;
+    int32_t source_x;
+    int32_t source_y;
+    int32_t source_width;
+    int32_t source_height;
+    int32_t dest_x;
+    int32_t dest_y;
+    int32_t dest_width;
+    int32_t dest_height;
+    uint32_t orientation;
+    uint32_t visibility;
+    uint32_t pixelformat;
 };
 
+static ilmOrientation
+get_ilm_orientation(uint32_t orientation)
+{
+    switch (orientation) {
+    case IVI_CONTROLLER_SURFACE_ORIENTATION_90_DEGREES:
+        return ILM_NINETY;
+    case IVI_CONTROLLER_SURFACE_ORIENTATION_180_DEGREES:
+        return ILM_ONEHUNDREDEIGHTY;
+    case IVI_CONTROLLER_SURFACE_ORIENTATION_270_DEGREES:
+        return ILM_TWOHUNDREDSEVENTY;
+    default:
+        return ILM_ZERO;
+    }
+}
+
+static void
+apply_surface_change(struct wayland_context *ctx,
+                     const struct scene_change *change)
+{
+    struct surface_context *ctx_surf = NULL;
+
+    wl_list_for_each(ctx_surf, &ctx->list_surface, link) {
+        if (ctx_surf->id_surface == change->id) {
+            break;
+        }
+    }
+    if (&ctx_surf->link == &ctx->list_surface) {
+        return;
+    }
+
+    if (change->mask & IVI_CONTROLLER_SCENE_FIELD_OPACITY) {
+        ctx_surf->prop.opacity =
+            (t_ilm_float)wl_fixed_to_double(change->opacity);
+    }
+    if (change->mask & IVI_CONTROLLER_SCENE_FIELD_SOURCE_RECTANGLE) {
+        ctx_surf->prop.sourceX = (t_ilm_uint)change->source_x;
+        ctx_surf->prop.sourceY = (t_ilm_uint)change->source_y;
+        ctx_surf->prop.sourceWidth = (t_ilm_uint)change->source_width;
+        ctx_surf->prop.sourceHeight = (t_ilm_uint)change->source_height;
+        if (ctx_surf->prop.origSourceWidth == 0) {
+            ctx_surf->prop.origSourceWidth = (t_ilm_uint)change->source_width;
+        }
+        if (ctx_surf->prop.origSourceHeight == 0) {
+            ctx_surf->prop.origSourceHeight =
+                (t_ilm_uint)change->source_height;
+        }
+    }
+    if (change->mask & IVI_CONTROLLER_SCENE_FIELD_DESTINATION_RECTANGLE) {
+        ctx_surf->prop.destX = (t_ilm_uint)change->dest_x;
+        ctx_surf->prop.destY = (t_ilm_uint)change->dest_y;
+        ctx_surf->prop.destWidth = (t_ilm_uint)change->dest_width;
+        ctx_surf->prop.destHeight = (t_ilm_uint)change->dest_height;
+    }
+    if (change->mask & IVI_CONTROLLER_SCENE_FIELD_ORIENTATION) {
+        ctx_surf->prop.orientation = get_ilm_orientation(change->orientation);
+    }
+    if (change->mask & IVI_CONTROLLER_SCENE_FIELD_VISIBILITY) {
+        ctx_surf->prop.visibility = (t_ilm_bool)change->visibility;
+    }
+    if (change->mask & IVI_CONTROLLER_SCENE_FIELD_PIXELFORMAT) {
+        ctx_surf->prop.pixelformat = (t_ilm_uint)change->pixelformat;
+    }
+}
+
+static void
+apply_layer_change(struct wayland_context *ctx,
+                   const struct scene_change *change)
+{
+    struct layer_context *ctx_layer = NULL;
+    t_ilm_notification_mask mask = 0;
+
+    wl_list_for_each(ctx_layer, &ctx->list_layer, link) {
+        if (ctx_layer->id_layer == change->id) {
+            break;
+        }
+    }
+    if (&ctx_layer->link == &ctx->list_layer) {
+        return;
+    }
+
+    if (change->mask & IVI_CONTROLLER_SCENE_FIELD_OPACITY) {
+        ctx_layer->prop.opacity =
+            (t_ilm_float)wl_fixed_to_double(change->opacity);
+        mask |= ILM_NOTIFICATION_OPACITY;
+    }
+    if (change->mask & IVI_CONTROLLER_SCENE_FIELD_SOURCE_RECTANGLE) {
+        ctx_layer->prop.sourceX = (t_ilm_uint)change->source_x;
+        ctx_layer->prop.sourceY = (t_ilm_uint)change->source_y;
+        ctx_layer->prop.sourceWidth = (t_ilm_uint)change->source_width;
+        ctx_layer->prop.sourceHeight = (t_ilm_uint)change->source_height;
+        mask |= ILM_NOTIFICATION_SOURCE_RECT;
+    }
+    if (change->mask & IVI_CONTROLLER_SCENE_FIELD_DESTINATION_RECTANGLE) {
+        ctx_layer->prop.destX = (t_ilm_uint)change->dest_x;
+        ctx_layer->prop.destY = (t_ilm_uint)change->dest_y;
+        ctx_layer->prop.destWidth = (t_ilm_uint)change->dest_width;
+        ctx_layer->prop.destHeight = (t_ilm_uint)change->dest_height;
+        mask |= ILM_NOTIFICATION_DEST_RECT;
+    }
+    if (change->mask & IVI_CONTROLLER_SCENE_FIELD_ORIENTATION) {
+        ctx_layer->prop.orientation = get_ilm_orientation(change->orientation);
+        mask |= ILM_NOTIFICATION_ORIENTATION;
+    }
+    if (change->mask & IVI_CONTROLLER_SCENE_FIELD_VISIBILITY) {
+        ctx_layer->prop.visibility = (t_ilm_bool)change->visibility;
+        mask |= ILM_NOTIFICATION_VISIBILITY;
+    }
+
+    if ((ctx_layer->notification != NULL) && (mask != 0)) {
+        ctx_layer->notification(ctx_layer->id_layer,
+                                &ctx_layer->prop,
+                                mask);
+    }
+}
+
+static void
+apply_scene_changes(struct wayland_context *ctx, struct wl_array *changes)
+{
+    const struct scene_change *change = changes->data;
+    size_t count = changes->size / sizeof *change;
+    size_t i = 0;
+
+    for (i = 0; i < count; i++) {
+        switch (change[i].object_type) {
+        case IVI_CONTROLLER_OBJECT_TYPE_SURFACE:
+            apply_surface_change(ctx, &change[i]);
+            break;
+        case IVI_CONTROLLER_OBJECT_TYPE_LAYER:
+            apply_layer_change(ctx, &change[i]);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
 static void
 controller_listener_screen_for_child(void *data,
                            struct ivi_controller *ivi_controller,
@@ -1174,12 +1477,14 @@ controller_listener_layer_for_child(void *data,
     (void)id_layer;
 }
 
-static void
-controller_listener_surface_for_child(void *data,
-                            struct ivi_controller *controller,
-                            uint32_t id_surface)
+/*
+ * Create the context of a surface announced by the compositor, the
+ * controller surface reports to listener if it is not NULL.
+ */
+static struct surface_context*
+create_surface_context(struct wayland_context *ctx, uint32_t id_surface,
+                       const struct ivi_controller_surface_listener *listener)
 {
-    struct wayland_context *ctx = data;
     struct surface_context *ctx_surf = NULL;
     int32_t is_inside = 0;
 
@@ -1188,28 +1493,90 @@ controller_listener_surface_for_child(void *data,
 
     if (is_inside != 0) {
         fprintf(stderr, "invalid id_surface in controller_listener_surface\n");
-        return;
+        return NULL;
     }
 
     ctx_surf = calloc(1, sizeof *ctx_surf);
     if (ctx_surf == NULL) {
         fprintf(stderr, "Failed to allocate memory for surface_context\n");
-        return;
+        return NULL;
     }
 
     ctx_surf->controller = ivi_controller_surface_create(
-                               controller, id_surface);
+                               ctx->controller, id_surface);
     if (ctx_surf->controller == NULL) {
         fprintf(stderr, "Failed to create controller surface\n");
-        return;
+        free(ctx_surf);
+        return NULL;
     }
     ctx_surf->id_surface = id_surface;
 
     wl_list_init(&ctx_surf->link);
     wl_list_insert(&ctx->list_surface, &ctx_surf->link);
-    ivi_controller_surface_add_listener(ctx_surf->controller,
-                                        &controller_surface_listener, ctx);
-    wl_display_roundtrip(ctx->display);
+    if (listener != NULL) {
+        ivi_controller_surface_add_listener(ctx_surf->controller,
+                                            listener, ctx);
+    }
+
+    return ctx_surf;
+}
+
+/*
+ * Create the contexts of the surfaces in a scene file and fill in their
+ * properties. The render order following the records is not used.
+ */
+static void
+apply_scene(struct wayland_context *ctx, int32_t fd, uint32_t objects_size,
+            const struct ivi_controller_surface_listener *listener)
+{
+    const struct scene_change *change = NULL;
+    struct wl_array objects;
+    void *data = NULL;
+    size_t count = 0;
+    size_t i = 0;
+
+    if (objects_size == 0) {
+        close(fd);
+        return;
+    }
+
+    data = mmap(NULL, objects_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        fprintf(stderr, "Failed to map scene of ivi_controller\n");
+        return;
+    }
+
+    change = data;
+    count = objects_size / sizeof *change;
+    for (i = 0; i < count; i++) {
+        if ((change[i].object_type == IVI_CONTROLLER_OBJECT_TYPE_SURFACE) &&
+            !wayland_controller_is_inside_surface_list(&ctx->list_surface,
+                                                       change[i].id)) {
+            create_surface_context(ctx, change[i].id, listener);
+        }
+    }
+
+    objects.data = data;
+    objects.size = objects_size;
+    objects.alloc = 0;
+    apply_scene_changes(ctx, &objects);
+
+    munmap(data, objects_size);
+}
+
+static void
+controller_listener_surface_for_child(void *data,
+                            struct ivi_controller *controller,
+                            uint32_t id_surface)
+{
+    struct wayland_context *ctx = data;
+    (void)controller;
+
+    if (create_surface_context(ctx, id_surface,
+                               &controller_surface_listener) != NULL) {
+        wl_display_roundtrip(ctx->display);
+    }
 }
 
 static void
@@ -1228,11 +1595,39 @@ controller_listener_error_for_child(void *data,
     (void)error_text;
 }
 
+static void
+controller_listener_scene_changes_for_child(void *data,
+                                   struct ivi_controller *controller,
+                                   struct wl_array *changes)
+{
+    struct wayland_context *ctx = data;
+    (void)controller;
+
+    apply_scene_changes(ctx, changes);
+}
+
+static void
+controller_listener_scene_for_child(void *data,
+                           struct ivi_controller *controller,
+                           int32_t fd,
+                           uint32_t objects_size,
+                           uint32_t order_size)
+{
+    struct wayland_context *ctx = data;
+    (void)controller;
+    (void)order_size;
+
+    apply_scene(ctx, fd, objects_size, &controller_surface_listener);
+}
+
 static struct ivi_controller_listener controller_listener_for_child = {
     controller_listener_screen_for_child,
     controller_listener_layer_for_child,
     controller_listener_surface_for_child,
-    controller_listener_error_for_child
+    controller_listener_error_for_child,
+    NULL, /* native handles are not requested */
+    controller_listener_scene_changes_for_child,
+    controller_listener_scene_for_child
 };
 
 static void
@@ -1269,33 +1664,9 @@ controller_listener_surface_for_main(void *data,
                             uint32_t id_surface)
 {
     struct ilm_control_context *ctx = data;
-    struct surface_context *ctx_surf = NULL;
-    int32_t is_inside = 0;
-
-    is_inside = wayland_controller_is_inside_surface_list(
-                    &ctx->main_ctx.list_surface, id_surface);
-
-    if (is_inside != 0) {
-        fprintf(stderr, "invalid id_surface in controller_listener_surface\n");
-        return;
-    }
-
-    ctx_surf = calloc(1, sizeof *ctx_surf);
-    if (ctx_surf == NULL) {
-        fprintf(stderr, "Failed to allocate memory for surface_context\n");
-        return;
-    }
-
-    ctx_surf->controller = ivi_controller_surface_create(
-                               controller, id_surface);
-    if (ctx_surf->controller == NULL) {
-        fprintf(stderr, "Failed to create controller surface\n");
-        return;
-    }
-    ctx_surf->id_surface = id_surface;
+    (void)controller;
 
-    wl_list_init(&ctx_surf->link);
-    wl_list_insert(&ctx->main_ctx.list_surface, &ctx_surf->link);
+    create_surface_context(&ctx->main_ctx, id_surface, NULL);
 }
 
 static void
@@ -1314,11 +1685,39 @@ controller_listener_error_for_main(void *data,
     (void)error_text;
 }
 
+static void
+controller_listener_scene_changes_for_main(void *data,
+                                  struct ivi_controller *controller,
+                                  struct wl_array *changes)
+{
+    struct ilm_control_context *ctx = data;
+    (void)controller;
+
+    apply_scene_changes(&ctx->main_ctx, changes);
+}
+
+static void
+controller_listener_scene_for_main(void *data,
+                          struct ivi_controller *controller,
+                          int32_t fd,
+                          uint32_t objects_size,
+                          uint32_t order_size)
+{
+    struct ilm_control_context *ctx = data;
+    (void)controller;
+    (void)order_size;
+
+    apply_scene(&ctx->main_ctx, fd, objects_size, NULL);
+}
+
 static struct ivi_controller_listener controller_listener_for_main = {
     controller_listener_screen_for_main,
     controller_listener_layer_for_main,
     controller_listener_surface_for_main,
-    controller_listener_error_for_main
+    controller_listener_error_for_main,
+    NULL, /* native handles are not requested */
+    controller_listener_scene_changes_for_main,
+    controller_listener_scene_for_main
 };
 
 static void
@@ -1328,11 +1727,20 @@ registry_handle_control_for_child(void *data,
                        uint32_t version)
 {
     struct wayland_context *ctx = data;
-    (void)version;
 
     if (strcmp(interface, "ivi_controller") == 0) {
+        /* version 5 packs the property changes into scene_changes,
+         * version 6 sends the whole scene at once,
+         * version 7 limits the rate of scene changes,
+         * version 12 reports the effective visibility of surfaces,
+         * version 13 filters the objects and properties,
+         * the features of version 2 to 4 and 8 to 11 are used by main_ctx
+         * only */
+        ctx->controller_version = (version < 5) ? 1 :
+                                  ((version < 13) ? version : 13);
         ctx->controller = wl_registry_bind(registry, name,
-                                           &ivi_controller_interface, 1);
+                                           &ivi_controller_interface,
+                                           ctx->controller_version);
         if (ctx->controller == NULL) {
             fprintf(stderr, "Failed to registry bind ivi_controller\n");
             return;
@@ -1359,11 +1767,24 @@ registry_handle_control_for_main(void *data,
                        uint32_t version)
 {
     struct ilm_control_context *ctx = data;
-    (void)version;
 
     if (strcmp(interface, "ivi_controller") == 0) {
+        /* version 2 adds frame aligned commits,
+         * version 3 screenshots into shared memory,
+         * version 4 screenshot completion and continuous captures,
+         * version 5 packed property changes,
+         * version 6 the scene in one event,
+         * version 7 event rate policies,
+         * version 8 frame statistics,
+         * version 9 screenshot file formats,
+         * version 10 property transitions,
+         * version 11 native handle watches,
+         * version 12 effective visibility of surfaces,
+         * version 13 interest filters */
+        ctx->main_ctx.controller_version = (version < 13) ? version : 13;
         ctx->main_ctx.controller = wl_registry_bind(registry, name,
-                                           &ivi_controller_interface, 1);
+                                           &ivi_controller_interface,
+                                           ctx->main_ctx.controller_version);
         if (ctx->main_ctx.controller == NULL) {
             fprintf(stderr, "Failed to registry bind ivi_controller\n");
             return;
@@ -1374,6 +1795,13 @@ registry_handle_control_for_main(void *data,
             fprintf(stderr, "Failed to add ivi_controller listener\n");
             return;
         }
+    } else if (strcmp(interface, "wl_shm") == 0) {
+        ctx->main_ctx.shm = wl_registry_bind(registry, name,
+                                             &wl_shm_interface, 1);
+        if (ctx->main_ctx.shm == NULL) {
+            fprintf(stderr, "Failed to registry bind wl_shm\n");
+            return;
+        }
     } else if (strcmp(interface, "wl_output") == 0) {
 
         struct screen_context *ctx_scrn = calloc(1, sizeof *ctx_scrn);
@@ -1472,6 +1900,7 @@ wayland_context_init(struct wayland_context *ctx)
     wl_list_init(&ctx->list_screen);
     wl_list_init(&ctx->list_layer);
     wl_list_init(&ctx->list_surface);
+    wl_list_init(&ctx->list_capture);
 }
 
 static ilmErrorTypes
@@ -2645,6 +3074,198 @@ wayland_displaySetRenderOrder(t_ilm_display display,
     return returnValue;
 }
 
+struct screenshot_context {
+    int done;
+    ilmErrorTypes result;
+    struct ilmScreenshotBuffer *buffer;
+};
+
+static void
+screenshot_listener_done(void *data,
+                         struct ivi_controller_screenshot *screenshot,
+                         uint32_t format,
+                         int32_t width,
+                         int32_t height,
+                         int32_t stride)
+{
+    struct screenshot_context *ctx_shot = data;
+    (void)screenshot;
+
+    ctx_shot->buffer->format = format;
+    ctx_shot->buffer->width = (t_ilm_uint)width;
+    ctx_shot->buffer->height = (t_ilm_uint)height;
+    ctx_shot->buffer->stride = (t_ilm_uint)stride;
+    ctx_shot->result = ILM_SUCCESS;
+    ctx_shot->done = 1;
+}
+
+static void
+screenshot_listener_failed(void *data,
+                           struct ivi_controller_screenshot *screenshot)
+{
+    struct screenshot_context *ctx_shot = data;
+    (void)screenshot;
+
+    ctx_shot->result = ILM_FAILED;
+    ctx_shot->done = 1;
+}
+
+static void
+screenshot_listener_frame(void *data,
+                          struct ivi_controller_screenshot *screenshot,
+                          uint32_t tv_sec,
+                          uint32_t tv_nsec,
+                          uint32_t seq)
+{
+    struct screenshot_context *ctx_shot = data;
+    (void)screenshot;
+
+    ctx_shot->buffer->timing.seconds = tv_sec;
+    ctx_shot->buffer->timing.nanoseconds = tv_nsec;
+    ctx_shot->buffer->timing.sequence = seq;
+}
+
+static struct ivi_controller_screenshot_listener screenshot_listener = {
+    screenshot_listener_done,
+    screenshot_listener_failed,
+    screenshot_listener_frame
+};
+
+static int
+create_anonymous_file(off_t size)
+{
+    static const char template[] = "/ilm-screenshot-XXXXXX";
+    const char *path = getenv("XDG_RUNTIME_DIR");
+    char *name = NULL;
+    int fd = -1;
+
+    if (path == NULL) {
+        fprintf(stderr, "XDG_RUNTIME_DIR is not set\n");
+        return -1;
+    }
+
+    name = malloc(strlen(path) + sizeof template);
+    if (name == NULL) {
+        return -1;
+    }
+    strcpy(name, path);
+    strcat(name, template);
+
+    fd = mkstemp(name);
+    if (fd >= 0) {
+        unlink(name);
+        fcntl(fd, F_SETFD, fcntl(fd, F_GETFD) | FD_CLOEXEC);
+        if (ftruncate(fd, size) < 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    free(name);
+    return fd;
+}
+
+/*
+ * Create a wl_shm buffer large enough for the largest screen, every
+ * screenshot is cropped to the screen it is taken from. Pages which are
+ * not written by the compositor are never backed by memory.
+ */
+static struct wl_buffer*
+create_screenshot_buffer(struct wayland_context *ctx,
+                         struct ilmScreenshotBuffer *pBuffer)
+{
+    struct screen_context *ctx_scrn = NULL;
+    struct wl_shm_pool *pool = NULL;
+    struct wl_buffer *buffer = NULL;
+    int32_t width = 0;
+    int32_t height = 0;
+    int32_t stride = 0;
+    int fd = -1;
+
+    wl_list_for_each(ctx_scrn, &ctx->list_screen, link) {
+        if (ctx_scrn->mode.width > width) {
+            width = ctx_scrn->mode.width;
+        }
+        if (ctx_scrn->mode.height > height) {
+            height = ctx_scrn->mode.height;
+        }
+    }
+
+    if ((ctx->shm == NULL) || (width <= 0) || (height <= 0)) {
+        return NULL;
+    }
+
+    stride = width * 4;
+    fd = create_anonymous_file((off_t)stride * height);
+    if (fd < 0) {
+        fprintf(stderr, "Failed to create screenshot buffer\n");
+        return NULL;
+    }
+
+    pBuffer->pixels = mmap(NULL, stride * height, PROT_READ | PROT_WRITE,
+                           MAP_SHARED, fd, 0);
+    if (pBuffer->pixels == MAP_FAILED) {
+        fprintf(stderr, "Failed to map screenshot buffer\n");
+        pBuffer->pixels = NULL;
+        close(fd);
+        return NULL;
+    }
+    pBuffer->size = stride * height;
+
+    pool = wl_shm_create_pool(ctx->shm, fd, stride * height);
+    buffer = wl_shm_pool_create_buffer(pool, 0, width, height, stride,
+                                       WL_SHM_FORMAT_ARGB8888);
+    wl_shm_pool_destroy(pool);
+    close(fd);
+
+    return buffer;
+}
+
+static ilmErrorTypes
+wait_for_screenshot(struct wayland_context *ctx,
+                    struct ivi_controller_screenshot *screenshot,
+                    struct ilmScreenshotBuffer *pBuffer)
+{
+    struct screenshot_context ctx_shot;
+
+    memset(&ctx_shot, 0, sizeof ctx_shot);
+    ctx_shot.result = ILM_FAILED;
+    ctx_shot.buffer = pBuffer;
+
+    if (screenshot == NULL) {
+        return ILM_FAILED;
+    }
+
+    ivi_controller_screenshot_add_listener(screenshot,
+                                           &screenshot_listener,
+                                           &ctx_shot);
+
+    while (ctx_shot.done == 0) {
+        if (wl_display_dispatch(ctx->display) < 0) {
+            break;
+        }
+    }
+
+    /* the compositor destroys the object after its event */
+    ivi_controller_screenshot_destroy(screenshot);
+
+    return ctx_shot.result;
+}
+
+/*
+ * Screenshots into a file report their completion with version 4 of the
+ * protocol, the size reported for them is 0.
+ */
+static ilmErrorTypes
+wait_for_screenshot_file(struct wayland_context *ctx,
+                         struct ivi_controller_screenshot *screenshot)
+{
+    struct ilmScreenshotBuffer unused;
+
+    memset(&unused, 0, sizeof unused);
+    return wait_for_screenshot(ctx, screenshot, &unused);
+}
+
 static ilmErrorTypes
 wayland_takeScreenshot(t_ilm_uint screen, t_ilm_const_string filename)
 {
@@ -2653,7 +3274,20 @@ wayland_takeScreenshot(t_ilm_uint screen, t_ilm_const_string filename)
     struct screen_context *ctx_scrn = NULL;
 
     ctx_scrn = get_screen_context_by_id(&ctx->main_ctx, (uint32_t)screen);
-    if (ctx_scrn != NULL) {
+    if (ctx_scrn == NULL) {
+        return ILM_FAILED;
+    }
+
+    if (ctx->screenshot_format != IVI_CONTROLLER_SCREENSHOT_FORMAT_PNG) {
+        returnValue = wait_for_screenshot_file(&ctx->main_ctx,
+                          ivi_controller_screen_screenshot_file_format(
+                              ctx_scrn->controller, filename,
+                              ctx->screenshot_format));
+    } else if (ctx->main_ctx.controller_version >= 4) {
+        returnValue = wait_for_screenshot_file(&ctx->main_ctx,
+                          ivi_controller_screen_screenshot_file(
+                              ctx_scrn->controller, filename));
+    } else {
         ivi_controller_screen_screenshot(ctx_scrn->controller,
                                         filename);
         wl_display_flush(ctx->main_ctx.display);
@@ -2672,7 +3306,20 @@ wayland_takeLayerScreenshot(t_ilm_const_string filename, t_ilm_layer layerid)
 
     ctx_layer = (struct layer_context*)wayland_controller_get_layer_context(
                     &ctx->main_ctx, (uint32_t)layerid);
-    if (ctx_layer != NULL) {
+    if (ctx_layer == NULL) {
+        return ILM_FAILED;
+    }
+
+    if (ctx->screenshot_format != IVI_CONTROLLER_SCREENSHOT_FORMAT_PNG) {
+        returnValue = wait_for_screenshot_file(&ctx->main_ctx,
+                          ivi_controller_layer_screenshot_file_format(
+                              ctx_layer->controller, filename,
+                              ctx->screenshot_format));
+    } else if (ctx->main_ctx.controller_version >= 4) {
+        returnValue = wait_for_screenshot_file(&ctx->main_ctx,
+                          ivi_controller_layer_screenshot_file(
+                              ctx_layer->controller, filename));
+    } else {
         ivi_controller_layer_screenshot(ctx_layer->controller,
                                         filename);
         returnValue = ILM_SUCCESS;
@@ -2690,7 +3337,20 @@ wayland_takeSurfaceScreenshot(t_ilm_const_string filename,
     struct surface_context *ctx_surf = NULL;
 
     ctx_surf = get_surface_context(&ctx->main_ctx, (uint32_t)surfaceid);
-    if (ctx_surf) {
+    if (ctx_surf == NULL) {
+        return ILM_FAILED;
+    }
+
+    if (ctx->screenshot_format != IVI_CONTROLLER_SCREENSHOT_FORMAT_PNG) {
+        returnValue = wait_for_screenshot_file(&ctx->main_ctx,
+                          ivi_controller_surface_screenshot_file_format(
+                              ctx_surf->controller, filename,
+                              ctx->screenshot_format));
+    } else if (ctx->main_ctx.controller_version >= 4) {
+        returnValue = wait_for_screenshot_file(&ctx->main_ctx,
+                          ivi_controller_surface_screenshot_file(
+                              ctx_surf->controller, filename));
+    } else {
         ivi_controller_surface_screenshot(ctx_surf->controller,
                                           filename);
         wl_display_flush(ctx->main_ctx.display);
@@ -2926,3 +3586,1031 @@ wayland_commitChanges()
 
     return returnValue;
 }
+
+struct commit_feedback_context {
+    int32_t done;
+    ilmErrorTypes result;
+    struct ilmPresentationTiming timing;
+};
+
+static void
+commit_feedback_listener_presented(void *data,
+                                   struct ivi_controller_commit_feedback *feedback,
+                                   uint32_t tv_sec,
+                                   uint32_t tv_nsec,
+                                   uint32_t seq)
+{
+    struct commit_feedback_context *ctx_feedback = data;
+    (void)feedback;
+
+    ctx_feedback->timing.seconds = tv_sec;
+    ctx_feedback->timing.nanoseconds = tv_nsec;
+    ctx_feedback->timing.sequence = seq;
+    ctx_feedback->result = ILM_SUCCESS;
+    ctx_feedback->done = 1;
+}
+
+static void
+commit_feedback_listener_discarded(void *data,
+                                   struct ivi_controller_commit_feedback *feedback)
+{
+    struct commit_feedback_context *ctx_feedback = data;
+    (void)feedback;
+
+    ctx_feedback->result = ILM_FAILED;
+    ctx_feedback->done = 1;
+}
+
+static struct ivi_controller_commit_feedback_listener commit_feedback_listener = {
+    commit_feedback_listener_presented,
+    commit_feedback_listener_discarded
+};
+
+static ilmErrorTypes
+wayland_commitChangesOnFrame(struct ilmPresentationTiming* pTiming)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *ctx = get_instance();
+    struct ivi_controller_commit_feedback *feedback = NULL;
+    struct commit_feedback_context ctx_feedback;
+
+    memset(&ctx_feedback, 0, sizeof ctx_feedback);
+    ctx_feedback.result = ILM_FAILED;
+
+    do {
+        if (ctx->main_ctx.controller == NULL) {
+            break;
+        }
+
+        if (ctx->main_ctx.controller_version < 2) {
+            returnValue = ILM_ERROR_NOT_IMPLEMENTED;
+            break;
+        }
+
+        feedback = ivi_controller_commit_changes_on_frame(
+                       ctx->main_ctx.controller);
+        if (feedback == NULL) {
+            break;
+        }
+
+        ivi_controller_commit_feedback_add_listener(feedback,
+                                                    &commit_feedback_listener,
+                                                    &ctx_feedback);
+
+        while (ctx_feedback.done == 0) {
+            if (wl_display_dispatch(ctx->main_ctx.display) < 0) {
+                break;
+            }
+        }
+
+        /* the compositor destroys the object after its event */
+        ivi_controller_commit_feedback_destroy(feedback);
+
+        if ((ctx_feedback.result == ILM_SUCCESS) && (pTiming != NULL)) {
+            *pTiming = ctx_feedback.timing;
+        }
+        returnValue = ctx_feedback.result;
+    } while (0);
+
+    return returnValue;
+}
+
+static void
+finish_screenshot(struct wl_buffer *buffer,
+                  struct ilmScreenshotBuffer *pBuffer,
+                  ilmErrorTypes result)
+{
+    if (buffer != NULL) {
+        wl_buffer_destroy(buffer);
+    }
+
+    if ((result != ILM_SUCCESS) && (pBuffer->pixels != NULL)) {
+        munmap(pBuffer->pixels, pBuffer->size);
+        memset(pBuffer, 0, sizeof *pBuffer);
+    }
+}
+
+static ilmErrorTypes
+wayland_takeScreenshotToBuffer(t_ilm_uint screen,
+                               struct ilmScreenshotBuffer* pBuffer)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *ctx = get_instance();
+    struct screen_context *ctx_scrn = NULL;
+    struct wl_buffer *buffer = NULL;
+
+    do {
+        if (pBuffer == NULL) {
+            returnValue = ILM_ERROR_INVALID_ARGUMENTS;
+            break;
+        }
+        memset(pBuffer, 0, sizeof *pBuffer);
+
+        if (ctx->main_ctx.controller_version < 3) {
+            returnValue = ILM_ERROR_NOT_IMPLEMENTED;
+            break;
+        }
+
+        ctx_scrn = get_screen_context_by_id(&ctx->main_ctx,
+                                            (uint32_t)screen);
+        if (ctx_scrn == NULL) {
+            break;
+        }
+
+        buffer = create_screenshot_buffer(&ctx->main_ctx, pBuffer);
+        if (buffer == NULL) {
+            break;
+        }
+
+        returnValue = wait_for_screenshot(&ctx->main_ctx,
+                          ivi_controller_screen_screenshot_buffer(
+                              ctx_scrn->controller, buffer),
+                          pBuffer);
+    } while (0);
+
+    if (pBuffer != NULL) {
+        finish_screenshot(buffer, pBuffer, returnValue);
+    }
+
+    return returnValue;
+}
+
+static ilmErrorTypes
+wayland_takeLayerScreenshotToBuffer(t_ilm_layer layerid,
+                                    struct ilmScreenshotBuffer* pBuffer)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *ctx = get_instance();
+    struct layer_context *ctx_layer = NULL;
+    struct wl_buffer *buffer = NULL;
+
+    do {
+        if (pBuffer == NULL) {
+            returnValue = ILM_ERROR_INVALID_ARGUMENTS;
+            break;
+        }
+        memset(pBuffer, 0, sizeof *pBuffer);
+
+        if (ctx->main_ctx.controller_version < 3) {
+            returnValue = ILM_ERROR_NOT_IMPLEMENTED;
+            break;
+        }
+
+        ctx_layer = wayland_controller_get_layer_context(&ctx->main_ctx,
+                                                         (uint32_t)layerid);
+        if (ctx_layer == NULL) {
+            break;
+        }
+
+        buffer = create_screenshot_buffer(&ctx->main_ctx, pBuffer);
+        if (buffer == NULL) {
+            break;
+        }
+
+        returnValue = wait_for_screenshot(&ctx->main_ctx,
+                          ivi_controller_layer_screenshot_buffer(
+                              ctx_layer->controller, buffer),
+                          pBuffer);
+    } while (0);
+
+    if (pBuffer != NULL) {
+        finish_screenshot(buffer, pBuffer, returnValue);
+    }
+
+    return returnValue;
+}
+
+static ilmErrorTypes
+wayland_takeSurfaceScreenshotToBuffer(t_ilm_surface surfaceid,
+                                      struct ilmScreenshotBuffer* pBuffer)
+{
+    ilmErrorTypes returnValue = ILM_FAILED;
+    struct ilm_control_context *ctx = get_instance();
+    struct surface_context *ctx_surf = NULL;
+    struct wl_buffer *buffer = NULL;
+
+    do {
+        if (pBuffer == NULL) {
+            returnValue = ILM_ERROR_INVALID_ARGUMENTS;
+            break;
+        }
+        memset(pBuffer, 0, sizeof *pBuffer);
+
+        if (ctx->main_ctx.controller_version < 3) {
+            returnValue = ILM_ERROR_NOT_IMPLEMENTED;
+            break;
+        }
+
+        ctx_surf = get_surface_context(&ctx->main_ctx, (uint32_t)surfaceid);
+        if (ctx_surf == NULL) {
+            break;
+        }
+
+        buffer = create_screenshot_buffer(&ctx->main_ctx, pBuffer);
+        if (buffer == NULL) {
+            break;
+        }
+
+        returnValue = wait_for_screenshot(&ctx->main_ctx,
+                          ivi_controller_surface_screenshot_buffer(
+                              ctx_surf->controller, buffer),
+                          pBuffer);
+    } while (0);
+
+    if (pBuffer != NULL) {
+        finish_screenshot(buffer, pBuffer, returnValue);
+    }
+
+    return returnValue;
+}
+
+static ilmErrorTypes
+wayland_releaseScreenshotBuffer(struct ilmScreenshotBuffer* pBuffer)
+{
+    if ((pBuffer == NULL) || (pBuffer->pixels == NULL)) {
+        return ILM_FAILED;
+    }
+
+    munmap(pBuffer->pixels, pBuffer->size);
+    memset(pBuffer, 0, sizeof *pBuffer);
+
+    return ILM_SUCCESS;
+}
+
+static struct capture_context*
+get_capture_context(struct wayland_context *ctx, t_ilm_uint id_capture)
+{
+    struct capture_context *ctx_capture = NULL;
+
+    wl_list_for_each(ctx_capture, &ctx->list_capture, link) {
+        if (ctx_capture->id_capture == id_capture) {
+            return ctx_capture;
+        }
+    }
+
+    return NULL;
+}
+
+static void
+capture_listener_damage(void *data,
+                        struct ivi_controller_capture *capture,
+                        int32_t x,
+                        int32_t y,
+                        int32_t width,
+                        int32_t height)
+{
+    struct capture_context *ctx_capture = data;
+    int32_t *rect = NULL;
+    (void)capture;
+
+    rect = wl_array_add(&ctx_capture->damage, 4 * sizeof *rect);
+    if (rect == NULL) {
+        fprintf(stderr, "Failed to store capture damage\n");
+        return;
+    }
+
+    rect[0] = x;
+    rect[1] = y;
+    rect[2] = width;
+    rect[3] = height;
+}
+
+static void
+capture_listener_frame(void *data,
+                       struct ivi_controller_capture *capture,
+                       struct wl_buffer *buffer,
+                       uint32_t format,
+                       int32_t width,
+                       int32_t height,
+                       int32_t stride,
+                       uint32_t tv_sec,
+                       uint32_t tv_nsec,
+                       uint32_t seq)
+{
+    struct capture_context *ctx_capture = data;
+    struct capture_buffer_context *ctx_buffer = NULL;
+    struct wl_array damage;
+    t_ilm_uint i = 0;
+    (void)capture;
+
+    for (i = 0; i < ctx_capture->num_buffer; i++) {
+        if (ctx_capture->buffers[i].buffer == buffer) {
+            ctx_buffer = &ctx_capture->buffers[i];
+            break;
+        }
+    }
+    if (ctx_buffer == NULL) {
+        return;
+    }
+
+    ctx_buffer->frame.format = format;
+    ctx_buffer->frame.width = (t_ilm_uint)width;
+    ctx_buffer->frame.height = (t_ilm_uint)height;
+    ctx_buffer->frame.stride = (t_ilm_uint)stride;
+    ctx_buffer->frame.timing.seconds = tv_sec;
+    ctx_buffer->frame.timing.nanoseconds = tv_nsec;
+    ctx_buffer->frame.timing.sequence = seq;
+
+    /* the damage received so far belongs to this frame */
+    damage = ctx_buffer->damage;
+    ctx_buffer->damage = ctx_capture->damage;
+    ctx_capture->damage = damage;
+    ctx_capture->damage.size = 0;
+
+    ctx_buffer->queued = 0;
+    wl_list_insert(ctx_capture->list_ready.prev, &ctx_buffer->link);
+}
+
+static void
+capture_listener_stopped(void *data,
+                         struct ivi_controller_capture *capture)
+{
+    struct capture_context *ctx_capture = data;
+    (void)capture;
+
+    ctx_capture->stopped = 1;
+}
+
+static struct ivi_controller_capture_listener capture_listener = {
+    capture_listener_damage,
+    capture_listener_frame,
+    capture_listener_stopped
+};
+
+static void
+destroy_capture_context(struct capture_context *ctx_capture)
+{
+    struct capture_buffer_context *ctx_buffer = NULL;
+    t_ilm_uint i = 0;
+
+    if (ctx_capture->controller != NULL) {
+        ivi_controller_capture_destroy(ctx_capture->controller);
+    }
+
+    for (i = 0; i < ctx_capture->num_buffer; i++) {
+        ctx_buffer = &ctx_capture->buffers[i];
+        if (ctx_buffer->buffer != NULL) {
+            wl_buffer_destroy(ctx_buffer->buffer);
+        }
+        if (ctx_buffer->frame.pixels != NULL) {
+            munmap(ctx_buffer->frame.pixels, ctx_buffer->frame.size);
+        }
+        wl_array_release(&ctx_buffer->damage);
+    }
+
+    wl_list_remove(&ctx_capture->link);
+    wl_array_release(&ctx_capture->damage);
+    free(ctx_capture->buffers);
+    free(ctx_capture);
+}
+
+/*
+ * Every buffer of a capture is large enough for the largest screen and is
+ * queued to the compositor right away.
+ */
+static ilmErrorTypes
+start_capture(struct ilm_control_context *ctx,
+              struct ivi_controller_capture *controller,
+              t_ilm_uint bufferCount,
+              t_ilm_uint* pCaptureId)
+{
+    struct capture_context *ctx_capture = NULL;
+    struct capture_buffer_context *ctx_buffer = NULL;
+    t_ilm_uint i = 0;
+
+    if (controller == NULL) {
+        return ILM_FAILED;
+    }
+
+    ctx_capture = calloc(1, sizeof *ctx_capture);
+    if (ctx_capture == NULL) {
+        ivi_controller_capture_destroy(controller);
+        return ILM_FAILED;
+    }
+
+    ctx_capture->controller = controller;
+    wl_array_init(&ctx_capture->damage);
+    wl_list_init(&ctx_capture->list_ready);
+    wl_list_insert(&ctx->main_ctx.list_capture, &ctx_capture->link);
+    ivi_controller_capture_add_listener(controller, &capture_listener,
+                                        ctx_capture);
+
+    ctx_capture->buffers = calloc(bufferCount, sizeof *ctx_capture->buffers);
+    if (ctx_capture->buffers == NULL) {
+        destroy_capture_context(ctx_capture);
+        return ILM_FAILED;
+    }
+
+    for (i = 0; i < bufferCount; i++) {
+        ctx_buffer = &ctx_capture->buffers[i];
+        wl_array_init(&ctx_buffer->damage);
+        wl_list_init(&ctx_buffer->link);
+        ctx_capture->num_buffer++;
+
+        ctx_buffer->buffer = create_screenshot_buffer(&ctx->main_ctx,
+                                                      &ctx_buffer->frame);
+        if (ctx_buffer->buffer == NULL) {
+            destroy_capture_context(ctx_capture);
+            return ILM_FAILED;
+        }
+
+        ivi_controller_capture_queue_buffer(controller, ctx_buffer->buffer);
+        ctx_buffer->queued = 1;
+    }
+
+    ctx_capture->id_capture = ++ctx->internal_id_capture;
+    *pCaptureId = ctx_capture->id_capture;
+    wl_display_flush(ctx->main_ctx.display);
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+wayland_startScreenCapture(t_ilm_uint screen,
+                           t_ilm_uint interval,
+                           t_ilm_uint bufferCount,
+                           t_ilm_uint* pCaptureId)
+{
+    struct ilm_control_context *ctx = get_instance();
+    struct screen_context *ctx_scrn = NULL;
+
+    if ((pCaptureId == NULL) || (bufferCount == 0)) {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    if (ctx->main_ctx.controller_version < 4) {
+        return ILM_ERROR_NOT_IMPLEMENTED;
+    }
+
+    ctx_scrn = get_screen_context_by_id(&ctx->main_ctx, (uint32_t)screen);
+    if (ctx_scrn == NULL) {
+        return ILM_FAILED;
+    }
+
+    return start_capture(ctx,
+                         ivi_controller_screen_capture(ctx_scrn->controller,
+                                                       interval),
+                         bufferCount, pCaptureId);
+}
+
+static ilmErrorTypes
+wayland_startSurfaceCapture(t_ilm_surface surfaceid,
+                            t_ilm_uint interval,
+                            t_ilm_uint bufferCount,
+                            t_ilm_uint* pCaptureId)
+{
+    struct ilm_control_context *ctx = get_instance();
+    struct surface_context *ctx_surf = NULL;
+
+    if ((pCaptureId == NULL) || (bufferCount == 0)) {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    if (ctx->main_ctx.controller_version < 4) {
+        return ILM_ERROR_NOT_IMPLEMENTED;
+    }
+
+    ctx_surf = get_surface_context(&ctx->main_ctx, (uint32_t)surfaceid);
+    if (ctx_surf == NULL) {
+        return ILM_FAILED;
+    }
+
+    return start_capture(ctx,
+                         ivi_controller_surface_capture(ctx_surf->controller,
+                                                        interval),
+                         bufferCount, pCaptureId);
+}
+
+static ilmErrorTypes
+wayland_getCaptureFrame(t_ilm_uint captureId,
+                        struct ilmCaptureFrame* pFrame)
+{
+    struct ilm_control_context *ctx = get_instance();
+    struct capture_context *ctx_capture = NULL;
+    struct capture_buffer_context *ctx_buffer = NULL;
+
+    if (pFrame == NULL) {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+    memset(pFrame, 0, sizeof *pFrame);
+
+    ctx_capture = get_capture_context(&ctx->main_ctx, captureId);
+    if (ctx_capture == NULL) {
+        return ILM_FAILED;
+    }
+
+    while (wl_list_empty(&ctx_capture->list_ready) &&
+           (ctx_capture->stopped == 0)) {
+        if (wl_display_dispatch(ctx->main_ctx.display) < 0) {
+            break;
+        }
+    }
+
+    if (wl_list_empty(&ctx_capture->list_ready)) {
+        return ILM_FAILED;
+    }
+
+    ctx_buffer = wl_container_of(ctx_capture->list_ready.next,
+                                 ctx_buffer, link);
+    wl_list_remove(&ctx_buffer->link);
+    wl_list_init(&ctx_buffer->link);
+
+    pFrame->buffer = ctx_buffer->frame;
+    pFrame->damageCount = ctx_buffer->damage.size / (4 * sizeof(int32_t));
+    pFrame->damage = ctx_buffer->damage.data;
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+wayland_releaseCaptureFrame(t_ilm_uint captureId,
+                            struct ilmCaptureFrame* pFrame)
+{
+    struct ilm_control_context *ctx = get_instance();
+    struct capture_context *ctx_capture = NULL;
+    struct capture_buffer_context *ctx_buffer = NULL;
+    t_ilm_uint i = 0;
+
+    if (pFrame == NULL) {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    ctx_capture = get_capture_context(&ctx->main_ctx, captureId);
+    if (ctx_capture == NULL) {
+        return ILM_FAILED;
+    }
+
+    for (i = 0; i < ctx_capture->num_buffer; i++) {
+        if ((ctx_capture->buffers[i].frame.pixels == pFrame->buffer.pixels) &&
+            (ctx_capture->buffers[i].queued == 0) &&
+            wl_list_empty(&ctx_capture->buffers[i].link)) {
+            ctx_buffer = &ctx_capture->buffers[i];
+            break;
+        }
+    }
+    if (ctx_buffer == NULL) {
+        return ILM_FAILED;
+    }
+
+    ctx_buffer->damage.size = 0;
+    ivi_controller_capture_queue_buffer(ctx_capture->controller,
+                                        ctx_buffer->buffer);
+    ctx_buffer->queued = 1;
+    wl_display_flush(ctx->main_ctx.display);
+    memset(pFrame, 0, sizeof *pFrame);
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+wayland_stopCapture(t_ilm_uint captureId)
+{
+    struct ilm_control_context *ctx = get_instance();
+    struct capture_context *ctx_capture = NULL;
+
+    ctx_capture = get_capture_context(&ctx->main_ctx, captureId);
+    if (ctx_capture == NULL) {
+        return ILM_FAILED;
+    }
+
+    destroy_capture_context(ctx_capture);
+    wl_display_flush(ctx->main_ctx.display);
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+wayland_setEventRate(ilmEventRate policy, t_ilm_uint maxRate)
+{
+    struct ilm_control_context *ctx = get_instance();
+    uint32_t rate = 0;
+
+    switch (policy) {
+    case ILM_EVENT_RATE_IMMEDIATE:
+        rate = IVI_CONTROLLER_EVENT_RATE_IMMEDIATE;
+        break;
+    case ILM_EVENT_RATE_FRAME:
+        rate = IVI_CONTROLLER_EVENT_RATE_FRAME;
+        break;
+    case ILM_EVENT_RATE_LIMITED:
+        rate = IVI_CONTROLLER_EVENT_RATE_LIMITED;
+        break;
+    default:
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    if ((ctx->main_ctx.controller_version < 7) ||
+        (ctx->child_ctx.controller_version < 7)) {
+        return ILM_ERROR_NOT_IMPLEMENTED;
+    }
+
+    /* both connections receive scene changes */
+    ivi_controller_set_event_rate(ctx->main_ctx.controller, rate, maxRate);
+    ivi_controller_set_event_rate(ctx->child_ctx.controller, rate, maxRate);
+    wl_display_flush(ctx->main_ctx.display);
+    wl_display_flush(ctx->child_ctx.display);
+
+    return ILM_SUCCESS;
+}
+
+struct frame_stats_context {
+    int done;
+    ilmErrorTypes result;
+    struct ilmSurfaceFrameStats *stats;
+};
+
+static void
+frame_stats_listener_stats(void *data,
+                           struct ivi_controller_frame_stats *frame_stats,
+                           uint32_t commits,
+                           uint32_t presented,
+                           uint32_t dropped,
+                           uint32_t latency_avg,
+                           uint32_t latency_max,
+                           wl_fixed_t fps,
+                           struct wl_array *intervals)
+{
+    struct frame_stats_context *ctx_stats = data;
+    size_t size = intervals->size;
+    (void)frame_stats;
+
+    if (size > sizeof ctx_stats->stats->intervals) {
+        size = sizeof ctx_stats->stats->intervals;
+    }
+
+    ctx_stats->stats->commitCount = (t_ilm_uint)commits;
+    ctx_stats->stats->presentCount = (t_ilm_uint)presented;
+    ctx_stats->stats->dropCount = (t_ilm_uint)dropped;
+    ctx_stats->stats->latencyAverage = (t_ilm_uint)latency_avg;
+    ctx_stats->stats->latencyMax = (t_ilm_uint)latency_max;
+    ctx_stats->stats->fps = (t_ilm_float)wl_fixed_to_double(fps);
+    memcpy(ctx_stats->stats->intervals, intervals->data, size);
+    ctx_stats->result = ILM_SUCCESS;
+    ctx_stats->done = 1;
+}
+
+static void
+frame_stats_listener_destroyed(void *data,
+                               struct ivi_controller_frame_stats *frame_stats)
+{
+    struct frame_stats_context *ctx_stats = data;
+    (void)frame_stats;
+
+    ctx_stats->result = ILM_FAILED;
+    ctx_stats->done = 1;
+}
+
+static struct ivi_controller_frame_stats_listener frame_stats_listener = {
+    frame_stats_listener_stats,
+    frame_stats_listener_destroyed
+};
+
+static ilmErrorTypes
+wayland_getSurfaceFrameStats(t_ilm_surface surfaceId,
+                             struct ilmSurfaceFrameStats* pStats)
+{
+    struct ilm_control_context *ctx = get_instance();
+    struct surface_context *ctx_surf = NULL;
+    struct ivi_controller_frame_stats *frame_stats = NULL;
+    struct frame_stats_context ctx_stats;
+
+    if (pStats == NULL) {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    if (ctx->main_ctx.controller_version < 8) {
+        return ILM_ERROR_NOT_IMPLEMENTED;
+    }
+
+    ctx_surf = get_surface_context(&ctx->main_ctx, (uint32_t)surfaceId);
+    if (ctx_surf == NULL) {
+        return ILM_FAILED;
+    }
+
+    memset(pStats, 0, sizeof *pStats);
+    memset(&ctx_stats, 0, sizeof ctx_stats);
+    ctx_stats.result = ILM_FAILED;
+    ctx_stats.stats = pStats;
+
+    /* an interval of 0 sends the statistics once */
+    frame_stats = ivi_controller_surface_frame_stats(ctx_surf->controller, 0);
+    if (frame_stats == NULL) {
+        return ILM_FAILED;
+    }
+
+    ivi_controller_frame_stats_add_listener(frame_stats,
+                                            &frame_stats_listener,
+                                            &ctx_stats);
+
+    while (ctx_stats.done == 0) {
+        if (wl_display_dispatch(ctx->main_ctx.display) < 0) {
+            break;
+        }
+    }
+
+    ivi_controller_frame_stats_destroy(frame_stats);
+    wl_display_flush(ctx->main_ctx.display);
+
+    return ctx_stats.result;
+}
+
+/*
+ * Other formats than PNG need version 9 of the protocol, so they are only
+ * stored in the context if the compositor supports them.
+ */
+static ilmErrorTypes
+wayland_setScreenshotFormat(ilmScreenshotFormat format)
+{
+    struct ilm_control_context *ctx = get_instance();
+    uint32_t screenshot_format = 0;
+
+    switch (format) {
+    case ILM_SCREENSHOT_FORMAT_PNG:
+        screenshot_format = IVI_CONTROLLER_SCREENSHOT_FORMAT_PNG;
+        break;
+    case ILM_SCREENSHOT_FORMAT_RAW:
+        screenshot_format = IVI_CONTROLLER_SCREENSHOT_FORMAT_RAW;
+        break;
+    case ILM_SCREENSHOT_FORMAT_PPM:
+        screenshot_format = IVI_CONTROLLER_SCREENSHOT_FORMAT_PPM;
+        break;
+    case ILM_SCREENSHOT_FORMAT_PAM:
+        screenshot_format = IVI_CONTROLLER_SCREENSHOT_FORMAT_PAM;
+        break;
+    case ILM_SCREENSHOT_FORMAT_QOI:
+        screenshot_format = IVI_CONTROLLER_SCREENSHOT_FORMAT_QOI;
+        break;
+    default:
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    if ((screenshot_format != IVI_CONTROLLER_SCREENSHOT_FORMAT_PNG) &&
+        (ctx->main_ctx.controller_version < 9)) {
+        return ILM_ERROR_NOT_IMPLEMENTED;
+    }
+
+    ctx->screenshot_format = screenshot_format;
+
+    return ILM_SUCCESS;
+}
+
+/*
+ * Transitions need version 10 of the protocol. The easing values of ilm
+ * are the values of the transition_easing enum of the protocol.
+ */
+static ilmErrorTypes
+check_transition(struct ilm_control_context *ctx, ilmTransitionEasing easing)
+{
+    switch (easing) {
+    case ILM_EASING_LINEAR:
+    case ILM_EASING_EASE_IN:
+    case ILM_EASING_EASE_OUT:
+    case ILM_EASING_EASE_IN_OUT:
+        break;
+    default:
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    if (ctx->main_ctx.controller_version < 10) {
+        return ILM_ERROR_NOT_IMPLEMENTED;
+    }
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+wayland_surfaceTransitionOpacity(t_ilm_surface surfaceId,
+                                 t_ilm_float opacity,
+                                 t_ilm_uint durationMillis,
+                                 ilmTransitionEasing easing)
+{
+    struct ilm_control_context *ctx = get_instance();
+    struct surface_context *ctx_surf = NULL;
+    ilmErrorTypes returnValue = check_transition(ctx, easing);
+
+    if (returnValue != ILM_SUCCESS) {
+        return returnValue;
+    }
+
+    ctx_surf = get_surface_context(&ctx->main_ctx, surfaceId);
+    if (ctx_surf == NULL) {
+        return ILM_FAILED;
+    }
+
+    ivi_controller_surface_transition_opacity(ctx_surf->controller,
+                              wl_fixed_from_double((double)opacity),
+                              durationMillis, (uint32_t)easing);
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+wayland_surfaceTransitionDestinationRectangle(t_ilm_surface surfaceId,
+                                              t_ilm_int x, t_ilm_int y,
+                                              t_ilm_int width,
+                                              t_ilm_int height,
+                                              t_ilm_uint durationMillis,
+                                              ilmTransitionEasing easing)
+{
+    struct ilm_control_context *ctx = get_instance();
+    struct surface_context *ctx_surf = NULL;
+    ilmErrorTypes returnValue = check_transition(ctx, easing);
+
+    if (returnValue != ILM_SUCCESS) {
+        return returnValue;
+    }
+
+    ctx_surf = get_surface_context(&ctx->main_ctx, surfaceId);
+    if (ctx_surf == NULL) {
+        return ILM_FAILED;
+    }
+
+    ivi_controller_surface_transition_destination_rectangle(
+        ctx_surf->controller, x, y, width, height,
+        durationMillis, (uint32_t)easing);
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+wayland_layerTransitionOpacity(t_ilm_layer layerId,
+                               t_ilm_float opacity,
+                               t_ilm_uint durationMillis,
+                               ilmTransitionEasing easing)
+{
+    struct ilm_control_context *ctx = get_instance();
+    struct layer_context *ctx_layer = NULL;
+    ilmErrorTypes returnValue = check_transition(ctx, easing);
+
+    if (returnValue != ILM_SUCCESS) {
+        return returnValue;
+    }
+
+    ctx_layer = (struct layer_context*)wayland_controller_get_layer_context(
+                    &ctx->main_ctx, (uint32_t)layerId);
+    if (ctx_layer == NULL) {
+        return ILM_FAILED;
+    }
+
+    ivi_controller_layer_transition_opacity(ctx_layer->controller,
+                              wl_fixed_from_double((double)opacity),
+                              durationMillis, (uint32_t)easing);
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+wayland_layerTransitionDestinationRectangle(t_ilm_layer layerId,
+                                            t_ilm_int x, t_ilm_int y,
+                                            t_ilm_int width,
+                                            t_ilm_int height,
+                                            t_ilm_uint durationMillis,
+                                            ilmTransitionEasing easing)
+{
+    struct ilm_control_context *ctx = get_instance();
+    struct layer_context *ctx_layer = NULL;
+    ilmErrorTypes returnValue = check_transition(ctx, easing);
+
+    if (returnValue != ILM_SUCCESS) {
+        return returnValue;
+    }
+
+    ctx_layer = (struct layer_context*)wayland_controller_get_layer_context(
+                    &ctx->main_ctx, (uint32_t)layerId);
+    if (ctx_layer == NULL) {
+        return ILM_FAILED;
+    }
+
+    ivi_controller_layer_transition_destination_rectangle(
+        ctx_layer->controller, x, y, width, height,
+        durationMillis, (uint32_t)easing);
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+wayland_surfaceGetEffectiveVisibility(t_ilm_surface surfaceId,
+                                      t_ilm_bool *pVisibility)
+{
+    struct ilm_control_context *ctx = get_instance();
+    struct surface_context *ctx_surf = NULL;
+
+    if (ctx->child_ctx.controller_version < 12) {
+        return ILM_ERROR_NOT_IMPLEMENTED;
+    }
+
+    if (pVisibility == NULL) {
+        return ILM_FAILED;
+    }
+
+    ctx_surf = get_surface_context(&ctx->child_ctx, (uint32_t)surfaceId);
+    if (ctx_surf == NULL) {
+        return ILM_FAILED;
+    }
+
+    *pVisibility = ctx_surf->effective_visibility;
+
+    return ILM_SUCCESS;
+}
+
+/*
+ * Interest filters need version 13 of the protocol. Both connections
+ * receive the scene, so both are filtered; objects created outside of the
+ * ranges are neither reported nor controllable by this client.
+ */
+static ilmErrorTypes
+wayland_addInterest(ilmObjectType type, t_ilm_uint idMin, t_ilm_uint idMax,
+                    t_ilm_bool withMembers)
+{
+    struct ilm_control_context *ctx = get_instance();
+    uint32_t object_type = 0;
+    uint32_t flags = 0;
+
+    switch (type) {
+    case ILM_SURFACE:
+        object_type = IVI_CONTROLLER_OBJECT_TYPE_SURFACE;
+        break;
+    case ILM_LAYER:
+        object_type = IVI_CONTROLLER_OBJECT_TYPE_LAYER;
+        if (withMembers == ILM_TRUE) {
+            flags |= IVI_CONTROLLER_INTEREST_FLAG_MEMBERS;
+        }
+        break;
+    default:
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    if (idMin > idMax) {
+        return ILM_ERROR_INVALID_ARGUMENTS;
+    }
+
+    if ((ctx->main_ctx.controller_version < 13) ||
+        (ctx->child_ctx.controller_version < 13)) {
+        return ILM_ERROR_NOT_IMPLEMENTED;
+    }
+
+    ivi_controller_add_interest(ctx->main_ctx.controller, object_type,
+                                idMin, idMax, flags);
+    ivi_controller_add_interest(ctx->child_ctx.controller, object_type,
+                                idMin, idMax, flags);
+    wl_display_flush(ctx->main_ctx.display);
+    wl_display_flush(ctx->child_ctx.display);
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+wayland_setInterestMask(t_ilm_notification_mask mask)
+{
+    struct ilm_control_context *ctx = get_instance();
+    uint32_t fields = 0;
+
+    if ((ctx->main_ctx.controller_version < 13) ||
+        (ctx->child_ctx.controller_version < 13)) {
+        return ILM_ERROR_NOT_IMPLEMENTED;
+    }
+
+    if (mask & ILM_NOTIFICATION_VISIBILITY) {
+        fields |= IVI_CONTROLLER_SCENE_FIELD_VISIBILITY;
+    }
+    if (mask & ILM_NOTIFICATION_OPACITY) {
+        fields |= IVI_CONTROLLER_SCENE_FIELD_OPACITY;
+    }
+    if (mask & ILM_NOTIFICATION_ORIENTATION) {
+        fields |= IVI_CONTROLLER_SCENE_FIELD_ORIENTATION;
+    }
+    if (mask & ILM_NOTIFICATION_SOURCE_RECT) {
+        fields |= IVI_CONTROLLER_SCENE_FIELD_SOURCE_RECTANGLE;
+    }
+    if (mask & ILM_NOTIFICATION_DEST_RECT) {
+        fields |= IVI_CONTROLLER_SCENE_FIELD_DESTINATION_RECTANGLE;
+    }
+    if ((mask & ILM_NOTIFICATION_ALL) == ILM_NOTIFICATION_ALL) {
+        fields |= IVI_CONTROLLER_SCENE_FIELD_PIXELFORMAT;
+    }
+
+    ivi_controller_set_interest_fields(ctx->main_ctx.controller, fields);
+    ivi_controller_set_interest_fields(ctx->child_ctx.controller, fields);
+    wl_display_flush(ctx->main_ctx.display);
+    wl_display_flush(ctx->child_ctx.display);
+
+    return ILM_SUCCESS;
+}
+
+static ilmErrorTypes
+wayland_clearInterest(void)
+{
+    struct ilm_control_context *ctx = get_instance();
+
+    if ((ctx->main_ctx.controller_version < 13) ||
+        (ctx->child_ctx.controller_version < 13)) {
+        return ILM_ERROR_NOT_IMPLEMENTED;
+    }
+
+    ivi_controller_clear_interest(ctx->main_ctx.controller);
+    ivi_controller_clear_interest(ctx->child_ctx.controller);
+    wl_display_flush(ctx->main_ctx.display);
+    wl_display_flush(ctx->child_ctx.display);
+
+    return ILM_SUCCESS;
+}
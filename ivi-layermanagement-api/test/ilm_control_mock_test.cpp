@@ -0,0 +1,413 @@
+/***************************************************************************
+ *
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C" {
+    #include "ilm_client.h"
+    #include "ilm_control.h"
+    #include "ilm_control_recorder.h"
+}
+
+/* These tests run against the in-memory platform (ILM_PLATFORM=mock)
+ * and need no compositor.
+ */
+static t_ilm_uint callbackLayerId = INVALID_ID;
+static t_ilm_notification_mask callbackMask;
+static int timesCalled = 0;
+
+static void LayerCallbackFunction(t_ilm_layer layer,
+                                  struct ilmLayerProperties* properties,
+                                  t_ilm_notification_mask mask)
+{
+    (void)properties;
+    callbackLayerId = layer;
+    callbackMask = mask;
+    timesCalled++;
+}
+
+class IlmMockTest : public ::testing::Test {
+public:
+    void SetUp()
+    {
+        setenv("ILM_PLATFORM", "mock", 1);
+        ASSERT_EQ(ILM_SUCCESS, ilm_init());
+        callbackLayerId = INVALID_ID;
+        timesCalled = 0;
+    }
+
+    void TearDown()
+    {
+        ASSERT_EQ(ILM_SUCCESS, ilm_destroy());
+    }
+};
+
+TEST_F(IlmMockTest, SetterIsAppliedOnCommit) {
+    t_ilm_layer layer = 1000;
+    t_ilm_float opacity = 0.0f;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 800, 480));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetOpacity(layer, 0.5f));
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerGetOpacity(layer, &opacity));
+    EXPECT_FLOAT_EQ(1.0f, opacity);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerGetOpacity(layer, &opacity));
+    EXPECT_FLOAT_EQ(0.5f, opacity);
+}
+
+TEST_F(IlmMockTest, LayerIdIsGeneratedAndUnique) {
+    t_ilm_layer layer1 = INVALID_ID;
+    t_ilm_layer layer2 = INVALID_ID;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer1, 10, 10));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer2, 10, 10));
+    EXPECT_NE(layer1, layer2);
+    EXPECT_NE(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer1, 10, 10));
+}
+
+TEST_F(IlmMockTest, RenderOrders) {
+    t_ilm_layer layer = 2000;
+    t_ilm_surface surfaces[] = {10, 11, 12};
+    t_ilm_int length = 0;
+    t_ilm_surface* ids = NULL;
+    t_ilm_layer* layerIds = NULL;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 800, 480));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetRenderOrder(layer, surfaces, 3));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerRemoveSurface(layer, 11));
+    ASSERT_EQ(ILM_SUCCESS, ilm_displaySetRenderOrder(0, &layer, 1));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_getSurfaceIDsOnLayer(layer, &length, &ids));
+    ASSERT_EQ(2, length);
+    EXPECT_EQ(10u, ids[0]);
+    EXPECT_EQ(12u, ids[1]);
+    free(ids);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_getLayerIDsOnScreen(0, &length, &layerIds));
+    ASSERT_EQ(1, length);
+    EXPECT_EQ(layer, layerIds[0]);
+    free(layerIds);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerRemove(layer));
+    ASSERT_EQ(ILM_SUCCESS, ilm_getLayerIDsOnScreen(0, &length, &layerIds));
+    EXPECT_EQ(0, length);
+    free(layerIds);
+}
+
+TEST_F(IlmMockTest, LayerNotification) {
+    t_ilm_layer layer = 3000;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 800, 480));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerAddNotification(layer, &LayerCallbackFunction));
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetVisibility(layer, ILM_TRUE));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetDestinationRectangle(layer, 0, 0, 10, 10));
+    EXPECT_EQ(0, timesCalled);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    EXPECT_EQ(1, timesCalled);
+    EXPECT_EQ(layer, callbackLayerId);
+    EXPECT_EQ(ILM_NOTIFICATION_VISIBILITY | ILM_NOTIFICATION_DEST_RECT,
+              callbackMask);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    EXPECT_EQ(1, timesCalled);
+}
+
+TEST_F(IlmMockTest, ReplayRecordedCalls) {
+    const char* logFile = "/tmp/ilm_control_mock_test.rec";
+    t_ilm_layer layer = INVALID_ID;
+    t_ilm_layer* layerIds = NULL;
+    t_ilm_int length = 0;
+    t_ilm_bool visibility = ILM_FALSE;
+    struct ilmReplayStatistics statistics;
+
+    ASSERT_EQ(ILM_SUCCESS, ilmControl_startRecording(logFile));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 800, 480));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetVisibility(layer, ILM_TRUE));
+    ASSERT_EQ(ILM_SUCCESS, ilm_displaySetRenderOrder(0, &layer, 1));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    EXPECT_NE(ILM_SUCCESS, ilm_layerGetVisibility(9999, &visibility));
+    ilmControl_stopRecording();
+
+    // replay into a fresh scene with a different generated layer id
+    ASSERT_EQ(ILM_SUCCESS, ilm_destroy());
+    ASSERT_EQ(ILM_SUCCESS, ilm_init());
+    t_ilm_layer other = INVALID_ID;
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&other, 10, 10));
+
+    ASSERT_EQ(ILM_SUCCESS, ilmControl_replay(logFile, ILM_FALSE, &statistics));
+    EXPECT_EQ(5u, statistics.callCount);
+    EXPECT_EQ(0u, statistics.mismatchCount);
+    EXPECT_EQ(0u, statistics.skippedCount);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_getLayerIDsOnScreen(0, &length, &layerIds));
+    ASSERT_EQ(1, length);
+    EXPECT_NE(other, layerIds[0]);
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerGetVisibility(layerIds[0], &visibility));
+    EXPECT_EQ(ILM_TRUE, visibility);
+    free(layerIds);
+
+    remove(logFile);
+}
+
+TEST_F(IlmMockTest, CommitChangesOnFrame) {
+    t_ilm_layer layer = 4000;
+    t_ilm_float opacity = 0.0f;
+    struct ilmPresentationTiming first;
+    struct ilmPresentationTiming second;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 800, 480));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetOpacity(layer, 0.25f));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChangesOnFrame(&first));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerGetOpacity(layer, &opacity));
+    EXPECT_FLOAT_EQ(0.25f, opacity);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChangesOnFrame(&second));
+    EXPECT_EQ(first.sequence + 1, second.sequence);
+}
+
+TEST_F(IlmMockTest, ScreenshotToBuffer) {
+    t_ilm_layer layer = 5000;
+    struct ilmScreenshotBuffer screenshot;
+    t_ilm_uint screenCount = 0;
+    t_ilm_uint* screenIds = NULL;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_getScreenIDs(&screenCount, &screenIds));
+    ASSERT_LT(0u, screenCount);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_takeScreenshotToBuffer(screenIds[0], &screenshot));
+    EXPECT_TRUE(screenshot.pixels != NULL);
+    EXPECT_LE(screenshot.width * 4, screenshot.stride);
+    EXPECT_LE(screenshot.stride * screenshot.height, screenshot.size);
+    ASSERT_EQ(ILM_SUCCESS, ilm_releaseScreenshotBuffer(&screenshot));
+    EXPECT_TRUE(screenshot.pixels == NULL);
+    free(screenIds);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 320, 240));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetDestinationRectangle(layer, 0, 0, 320, 240));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    ASSERT_EQ(ILM_SUCCESS, ilm_takeLayerScreenshotToBuffer(layer, &screenshot));
+    EXPECT_EQ(320u, screenshot.width);
+    EXPECT_EQ(240u, screenshot.height);
+    ASSERT_EQ(ILM_SUCCESS, ilm_releaseScreenshotBuffer(&screenshot));
+
+    EXPECT_NE(ILM_SUCCESS, ilm_takeLayerScreenshotToBuffer(0xFFFFFFF0, &screenshot));
+    EXPECT_NE(ILM_SUCCESS, ilm_releaseScreenshotBuffer(&screenshot));
+}
+
+TEST_F(IlmMockTest, CaptureStream) {
+    t_ilm_layer layer = 5100;
+    t_ilm_uint screenCount = 0;
+    t_ilm_uint* screenIds = NULL;
+    t_ilm_uint captureId = 0;
+    struct ilmCaptureFrame first;
+    struct ilmCaptureFrame second;
+    struct ilmCaptureFrame third;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_getScreenIDs(&screenCount, &screenIds));
+    ASSERT_LT(0u, screenCount);
+    ASSERT_EQ(ILM_SUCCESS, ilm_startScreenCapture(screenIds[0], 2, 2, &captureId));
+    free(screenIds);
+
+    // the first frame is damaged fully
+    ASSERT_EQ(ILM_SUCCESS, ilm_getCaptureFrame(captureId, &first));
+    EXPECT_TRUE(first.buffer.pixels != NULL);
+    ASSERT_EQ(1u, first.damageCount);
+    EXPECT_EQ(0, first.damage[0]);
+    EXPECT_EQ(0, first.damage[1]);
+    EXPECT_EQ((t_ilm_int)first.buffer.width, first.damage[2]);
+    EXPECT_EQ((t_ilm_int)first.buffer.height, first.damage[3]);
+
+    // nothing changed
+    ASSERT_EQ(ILM_SUCCESS, ilm_getCaptureFrame(captureId, &second));
+    EXPECT_EQ(0u, second.damageCount);
+    EXPECT_EQ(first.buffer.timing.sequence + 2, second.buffer.timing.sequence);
+
+    // both buffers are held
+    EXPECT_NE(ILM_SUCCESS, ilm_getCaptureFrame(captureId, &third));
+    ASSERT_EQ(ILM_SUCCESS, ilm_releaseCaptureFrame(captureId, &first));
+    ASSERT_EQ(ILM_SUCCESS, ilm_releaseCaptureFrame(captureId, &second));
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 320, 240));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    ASSERT_EQ(ILM_SUCCESS, ilm_getCaptureFrame(captureId, &third));
+    EXPECT_EQ(1u, third.damageCount);
+    ASSERT_EQ(ILM_SUCCESS, ilm_releaseCaptureFrame(captureId, &third));
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_stopCapture(captureId));
+    EXPECT_NE(ILM_SUCCESS, ilm_getCaptureFrame(captureId, &third));
+    EXPECT_NE(ILM_SUCCESS, ilm_stopCapture(captureId));
+}
+
+TEST_F(IlmMockTest, EventRateMergesNotifications) {
+    t_ilm_layer layer = 5200;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 320, 240));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerAddNotification(layer, &LayerCallbackFunction));
+    ASSERT_EQ(ILM_SUCCESS, ilm_setEventRate(ILM_EVENT_RATE_FRAME, 0));
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetOpacity(layer, 0.5f));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetVisibility(layer, ILM_TRUE));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    EXPECT_EQ(0, timesCalled);
+
+    // both changes are reported once at the next frame
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChangesOnFrame(NULL));
+    EXPECT_EQ(1, timesCalled);
+    EXPECT_EQ(layer, callbackLayerId);
+    EXPECT_EQ(ILM_NOTIFICATION_OPACITY | ILM_NOTIFICATION_VISIBILITY, callbackMask);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_setEventRate(ILM_EVENT_RATE_IMMEDIATE, 0));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetOpacity(layer, 1.0f));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    EXPECT_EQ(2, timesCalled);
+
+    EXPECT_EQ(ILM_ERROR_INVALID_ARGUMENTS, ilm_setEventRate((ilmEventRate)7, 0));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerRemoveNotification(layer));
+}
+
+TEST_F(IlmMockTest, InterestFiltersNotifications) {
+    t_ilm_layer inside = 5250;
+    t_ilm_layer outside = 5290;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&inside, 320, 240));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&outside, 320, 240));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerAddNotification(inside, &LayerCallbackFunction));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerAddNotification(outside, &LayerCallbackFunction));
+    ASSERT_EQ(ILM_SUCCESS, ilm_addInterest(ILM_LAYER, 5250, 5259, ILM_TRUE));
+    ASSERT_EQ(ILM_SUCCESS, ilm_setInterestMask(ILM_NOTIFICATION_OPACITY));
+
+    // only the opacity of the layer in the range is reported
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetOpacity(outside, 0.5f));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetVisibility(inside, ILM_TRUE));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    EXPECT_EQ(0, timesCalled);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetOpacity(inside, 0.5f));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetVisibility(inside, ILM_FALSE));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    EXPECT_EQ(1, timesCalled);
+    EXPECT_EQ(inside, callbackLayerId);
+    EXPECT_EQ(ILM_NOTIFICATION_OPACITY, callbackMask);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_clearInterest());
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetOpacity(outside, 1.0f));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    EXPECT_EQ(2, timesCalled);
+    EXPECT_EQ(outside, callbackLayerId);
+
+    EXPECT_EQ(ILM_ERROR_INVALID_ARGUMENTS, ilm_addInterest(ILM_LAYER, 9, 1, ILM_FALSE));
+    EXPECT_EQ(ILM_ERROR_INVALID_ARGUMENTS, ilm_addInterest((ilmObjectType)7, 1, 9, ILM_FALSE));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerRemoveNotification(inside));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerRemoveNotification(outside));
+}
+
+TEST_F(IlmMockTest, SurfaceFrameStats) {
+    t_ilm_layer layer = 5300;
+    t_ilm_surface surface = 5301;
+    struct ilmSurfaceFrameStats stats;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 320, 240));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerAddSurface(layer, surface));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+
+    memset(&stats, 0xff, sizeof stats);
+    ASSERT_EQ(ILM_SUCCESS, ilm_getSurfaceFrameStats(surface, &stats));
+    EXPECT_EQ(0u, stats.commitCount);
+    EXPECT_EQ(0u, stats.presentCount);
+    EXPECT_EQ(0u, stats.intervals[ILM_FRAME_INTERVAL_BUCKETS - 1]);
+
+    EXPECT_EQ(ILM_FAILED, ilm_getSurfaceFrameStats(5399, &stats));
+    EXPECT_EQ(ILM_ERROR_INVALID_ARGUMENTS, ilm_getSurfaceFrameStats(surface, NULL));
+}
+
+TEST_F(IlmMockTest, ScreenshotFormat) {
+    t_ilm_layer layer = 5400;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 320, 240));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_setScreenshotFormat(ILM_SCREENSHOT_FORMAT_QOI));
+    EXPECT_EQ(ILM_SUCCESS, ilm_takeLayerScreenshot("/tmp/mock.qoi", layer));
+    EXPECT_EQ(ILM_ERROR_INVALID_ARGUMENTS, ilm_setScreenshotFormat((ilmScreenshotFormat)9));
+    EXPECT_EQ(ILM_SUCCESS, ilm_setScreenshotFormat(ILM_SCREENSHOT_FORMAT_PNG));
+}
+
+TEST_F(IlmMockTest, TransitionSetsTargetOnCommit) {
+    t_ilm_layer layer = 5500;
+    t_ilm_surface surface = 5501;
+    struct ilmSurfaceProperties surfaceProperties;
+    t_ilm_float opacity = 0.0f;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 320, 240));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerAddSurface(layer, surface));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerTransitionOpacity(layer, 0.25f, 500, ILM_EASING_EASE_OUT));
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceTransitionDestinationRectangle(surface, 10, 20, 30, 40, 500, ILM_EASING_LINEAR));
+    EXPECT_EQ(ILM_ERROR_INVALID_ARGUMENTS, ilm_surfaceTransitionOpacity(surface, 0.5f, 500, (ilmTransitionEasing)9));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerGetOpacity(layer, &opacity));
+    EXPECT_FLOAT_EQ(0.25f, opacity);
+    ASSERT_EQ(ILM_SUCCESS, ilm_getPropertiesOfSurface(surface, &surfaceProperties));
+    EXPECT_EQ(10u, surfaceProperties.destX);
+    EXPECT_EQ(40u, surfaceProperties.destHeight);
+}
+
+TEST_F(IlmMockTest, EffectiveVisibility) {
+    t_ilm_layer layer = 5600;
+    t_ilm_surface surface = 5601;
+    t_ilm_bool visibility = ILM_TRUE;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 320, 240));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerAddSurface(layer, surface));
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetVisibility(surface, ILM_TRUE));
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetOpacity(surface, 1.0f));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetVisibility(layer, ILM_TRUE));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetOpacity(layer, 1.0f));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+
+    // not on a screen yet
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceGetEffectiveVisibility(surface, &visibility));
+    EXPECT_EQ(ILM_FALSE, visibility);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_displaySetRenderOrder(0, &layer, 1));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceGetEffectiveVisibility(surface, &visibility));
+    EXPECT_EQ(ILM_TRUE, visibility);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetOpacity(layer, 0.0f));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceGetEffectiveVisibility(surface, &visibility));
+    EXPECT_EQ(ILM_FALSE, visibility);
+
+    EXPECT_EQ(ILM_FAILED, ilm_surfaceGetEffectiveVisibility(5699, &visibility));
+    EXPECT_EQ(ILM_FAILED, ilm_surfaceGetEffectiveVisibility(surface, NULL));
+}
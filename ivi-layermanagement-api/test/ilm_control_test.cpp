@@ -253,6 +253,144 @@ TEST_F(IlmCommandTest, SetGetLayerVisibility) {
     ASSERT_EQ(ILM_TRUE, visibility);
 }
 
+TEST_F(IlmCommandTest, ilm_commitChangesOnFrame) {
+    uint layer = 4316;
+    t_ilm_bool visibility;
+    struct ilmPresentationTiming first;
+    struct ilmPresentationTiming second;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 800, 480));
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetVisibility(layer, ILM_TRUE));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChangesOnFrame(&first));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerGetVisibility(layer, &visibility));
+    ASSERT_EQ(ILM_TRUE, visibility);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetVisibility(layer, ILM_FALSE));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChangesOnFrame(&second));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerGetVisibility(layer, &visibility));
+    ASSERT_EQ(ILM_FALSE, visibility);
+
+    EXPECT_LT(first.sequence, second.sequence);
+}
+
+TEST_F(IlmCommandTest, ilm_setEventRate) {
+    uint layer = 4317;
+    t_ilm_float opacity = 0.0f;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 800, 480));
+    ASSERT_EQ(ILM_SUCCESS, ilm_setEventRate(ILM_EVENT_RATE_LIMITED, 10));
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetOpacity(layer, 0.5f));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChangesOnFrame(NULL));
+
+    // held back changes are flushed when switching back
+    ASSERT_EQ(ILM_SUCCESS, ilm_setEventRate(ILM_EVENT_RATE_IMMEDIATE, 0));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerGetOpacity(layer, &opacity));
+    EXPECT_FLOAT_EQ(0.5f, opacity);
+
+    EXPECT_EQ(ILM_ERROR_INVALID_ARGUMENTS, ilm_setEventRate((ilmEventRate)7, 0));
+}
+
+TEST_F(IlmCommandTest, ilm_addInterest) {
+    uint layer = 4318;
+    t_ilm_float opacity = 0.0f;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 800, 480));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    ASSERT_EQ(ILM_SUCCESS, ilm_addInterest(ILM_LAYER, 4318, 4318, ILM_TRUE));
+    ASSERT_EQ(ILM_SUCCESS, ilm_setInterestMask(ILM_NOTIFICATION_OPACITY));
+
+    // properties of the layer in the range are still updated
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetOpacity(layer, 0.5f));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerGetOpacity(layer, &opacity));
+    EXPECT_FLOAT_EQ(0.5f, opacity);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_clearInterest());
+    EXPECT_EQ(ILM_ERROR_INVALID_ARGUMENTS, ilm_addInterest(ILM_LAYER, 9, 1, ILM_FALSE));
+}
+
+TEST_F(IlmCommandTest, ilm_layerTransitionOpacity) {
+    uint layer = 4319;
+    t_ilm_float opacity = 0.0f;
+    t_ilm_uint i = 0;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 800, 480));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetOpacity(layer, 0.0f));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerTransitionOpacity(layer, 1.0f, 100, ILM_EASING_LINEAR));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+
+    // the compositor steps the opacity at every repaint until the target
+    for (i = 0; (i < 100) && (opacity < 1.0f); i++) {
+        ASSERT_EQ(ILM_SUCCESS, ilm_commitChangesOnFrame(NULL));
+        ASSERT_EQ(ILM_SUCCESS, ilm_layerGetOpacity(layer, &opacity));
+    }
+    EXPECT_FLOAT_EQ(1.0f, opacity);
+
+    EXPECT_EQ(ILM_ERROR_INVALID_ARGUMENTS, ilm_layerTransitionOpacity(layer, 0.0f, 100, (ilmTransitionEasing)9));
+}
+
+TEST_F(IlmCommandTest, ilm_surfaceGetEffectiveVisibility_translucent) {
+    uint layer = 4320;
+    uint surface1 = 4320;
+    uint surface2 = 4321;
+    t_ilm_surface renderOrder[2];
+    t_ilm_bool visibility = ILM_FALSE;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerCreateWithDimension(&layer, 800, 480));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetDestinationRectangle(layer, 0, 0, 800, 480));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetVisibility(layer, ILM_TRUE));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetOpacity(layer, 1.0f));
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceCreate((t_ilm_nativehandle)wlSurface, 100, 100, ILM_PIXELFORMAT_RGB_888, &surface1));
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceCreate((t_ilm_nativehandle)wlSurface, 100, 100, ILM_PIXELFORMAT_RGB_888, &surface2));
+    renderOrder[0] = surface1;
+    renderOrder[1] = surface2;
+    for (int i = 0; i < 2; i++) {
+        ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetDestinationRectangle(renderOrder[i], 0, 0, 100, 100));
+        ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetVisibility(renderOrder[i], ILM_TRUE));
+    }
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetOpacity(surface1, 1.0f));
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetOpacity(surface2, 0.5f));
+    ASSERT_EQ(ILM_SUCCESS, ilm_layerSetRenderOrder(layer, renderOrder, 2));
+    ASSERT_EQ(ILM_SUCCESS, ilm_displaySetRenderOrder(0, &layer, 1));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+
+    // the translucent surface on top does not hide the one below
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceGetEffectiveVisibility(surface1, &visibility));
+    EXPECT_EQ(ILM_TRUE, visibility);
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceGetEffectiveVisibility(surface2, &visibility));
+    EXPECT_EQ(ILM_TRUE, visibility);
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceSetOpacity(surface2, 1.0f));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceGetEffectiveVisibility(surface1, &visibility));
+    EXPECT_EQ(ILM_FALSE, visibility);
+}
+
+TEST_F(IlmCommandTest, ilm_getSurfaceFrameStats) {
+    uint surface = 4318;
+    struct ilmSurfaceFrameStats stats;
+    t_ilm_uint total = 0;
+    t_ilm_uint i = 0;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_surfaceCreate((t_ilm_nativehandle)wlSurface, 10, 10, ILM_PIXELFORMAT_RGBA_8888, &surface));
+    ASSERT_EQ(ILM_SUCCESS, ilm_commitChanges());
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_getSurfaceFrameStats(surface, &stats));
+    EXPECT_LE(stats.presentCount + stats.dropCount, stats.commitCount);
+    EXPECT_LE(stats.latencyAverage, stats.latencyMax);
+    for (i = 0; i < ILM_FRAME_INTERVAL_BUCKETS; i++) {
+        total += stats.intervals[i];
+    }
+    EXPECT_EQ(stats.presentCount > 0 ? stats.presentCount - 1 : 0, total);
+
+    EXPECT_EQ(ILM_ERROR_INVALID_ARGUMENTS, ilm_getSurfaceFrameStats(surface, NULL));
+}
+
 TEST_F(IlmCommandTest, ilm_getScreenIDs) {
     t_ilm_uint numberOfScreens = 0;
     t_ilm_uint* screenIDs = NULL;
@@ -555,14 +693,64 @@ TEST_F(IlmCommandTest, ilm_takeScreenshot) {
         ASSERT_EQ(0, result);
     }
 
+    // the call returns once the file was written
     ASSERT_EQ(ILM_SUCCESS, ilm_takeScreenshot(0, "/tmp/test.bmp"));
 
-    sleep(1);
     f = fopen("/tmp/test.bmp", "r");
     ASSERT_TRUE(f!=NULL);
     fclose(f);
 }
 
+TEST_F(IlmCommandTest, ilm_takeScreenshotRaw) {
+    t_ilm_uint header[4] = {0, 0, 0, 0};
+    t_ilm_uint width = 0, height = 0;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_getScreenResolution(0, &width, &height));
+    ASSERT_EQ(ILM_SUCCESS, ilm_setScreenshotFormat(ILM_SCREENSHOT_FORMAT_RAW));
+    remove("/tmp/test.raw");
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_takeScreenshot(0, "/tmp/test.raw"));
+    ASSERT_EQ(ILM_SUCCESS, ilm_setScreenshotFormat(ILM_SCREENSHOT_FORMAT_PNG));
+
+    FILE* f = fopen("/tmp/test.raw", "r");
+    ASSERT_TRUE(f!=NULL);
+    ASSERT_EQ(4u, fread(header, sizeof header[0], 4, f));
+    fclose(f);
+
+    EXPECT_EQ(0x41524742u, header[0]);
+    EXPECT_EQ(width, header[1]);
+    EXPECT_EQ(height, header[2]);
+    EXPECT_EQ(width * 4, header[3]);
+
+    EXPECT_EQ(ILM_ERROR_INVALID_ARGUMENTS, ilm_setScreenshotFormat((ilmScreenshotFormat)9));
+}
+
+TEST_F(IlmCommandTest, ilm_takeScreenshotToBuffer) {
+    struct ilmScreenshotBuffer screenshot;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_takeScreenshotToBuffer(0, &screenshot));
+    ASSERT_TRUE(screenshot.pixels != NULL);
+    ASSERT_LT(0u, screenshot.width);
+    ASSERT_LT(0u, screenshot.height);
+    ASSERT_LE(screenshot.width * 4, screenshot.stride);
+    ASSERT_LE(screenshot.stride * screenshot.height, screenshot.size);
+    ASSERT_EQ(ILM_SUCCESS, ilm_releaseScreenshotBuffer(&screenshot));
+}
+
+TEST_F(IlmCommandTest, ilm_startScreenCapture) {
+    t_ilm_uint captureId = 0;
+    struct ilmCaptureFrame frame;
+
+    ASSERT_EQ(ILM_SUCCESS, ilm_startScreenCapture(0, 1, 2, &captureId));
+    ASSERT_EQ(ILM_SUCCESS, ilm_getCaptureFrame(captureId, &frame));
+    ASSERT_TRUE(frame.buffer.pixels != NULL);
+    ASSERT_LT(0u, frame.buffer.width);
+    ASSERT_LT(0u, frame.buffer.height);
+    ASSERT_LE(1u, frame.damageCount);
+    ASSERT_EQ(ILM_SUCCESS, ilm_releaseCaptureFrame(captureId, &frame));
+    ASSERT_EQ(ILM_SUCCESS, ilm_stopCapture(captureId));
+}
+
 TEST_F(IlmCommandTest, ilm_surfaceGetPixelformat) {
     t_ilm_uint surface1=0;
     t_ilm_uint surface2=1;
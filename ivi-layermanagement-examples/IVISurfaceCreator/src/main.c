@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <signal.h>
+#include <string.h>
 #include <wayland-client-protocol.h>
 
 #include "ivi-application-client-protocol.h"
@@ -15,6 +16,7 @@ struct display {
     struct wl_registry     *registry;
     struct ivi_application *ivi_application;
     struct ivi_controller  *ivi_controller;
+    uint32_t                controller_version;
     uint32_t                surface_id;
     int32_t                 error_code;
     int                     surface_created;
@@ -76,12 +78,40 @@ controller_event_native_handle(void *data, struct ivi_controller *ivi_controller
     }
 }
 
+static void
+controller_event_scene_changes(void *data, struct ivi_controller *ivi_controller,
+                               struct wl_array *changes)
+{
+    /* do nothing */
+}
+
+static void
+controller_event_scene(void *data, struct ivi_controller *ivi_controller,
+                       int32_t fd, uint32_t objects_size, uint32_t order_size)
+{
+    close(fd);
+}
+
 static const struct ivi_controller_listener controller_listener = {
     controller_event_screen,
     controller_event_layer,
     controller_event_surface,
     controller_event_error,
-    controller_event_native_handle
+    controller_event_native_handle,
+    controller_event_scene_changes,
+    controller_event_scene
+};
+
+static void
+watch_event_native_handle(void *data,
+                          struct ivi_controller_native_handle_watch *watch,
+                          struct wl_surface *surface)
+{
+    controller_event_native_handle(data, NULL, surface);
+}
+
+static const struct ivi_controller_native_handle_watch_listener watch_listener = {
+    watch_event_native_handle
 };
 
 static void
@@ -97,8 +127,11 @@ registry_handle_global(void *data, struct wl_registry *registry,
     }
     else if (strcmp(interface, "ivi_controller") == 0)
     {
+        /* version 11 can watch for the window instead of polling */
+        d->controller_version = (version < 11) ? 1 : 11;
         d->ivi_controller = wl_registry_bind(registry, name,
-                                             &ivi_controller_interface, 1);
+                                             &ivi_controller_interface,
+                                             d->controller_version);
         ivi_controller_add_listener(d->ivi_controller,
                                     &controller_listener, data);
     }
@@ -168,7 +201,26 @@ main(int argc, char **argv)
            display.ivi_controller);
     int retry_count = 0;
     int rc = 0;
-    do
+
+    if (display.controller_version >= 11)
+    {
+        struct ivi_controller_native_handle_watch *watch =
+            ivi_controller_watch_native_handle(display.ivi_controller,
+                                               process_id, window_title);
+        ivi_controller_native_handle_watch_add_listener(watch,
+                                                        &watch_listener,
+                                                        &display);
+
+        while (!display.surface_created && running && (rc != -1))
+        {
+            rc = wl_display_dispatch(display.display);
+        }
+
+        ivi_controller_native_handle_watch_destroy(watch);
+        retry_count = 10;
+    }
+
+    while ((retry_count < 10) && running)
     {
         ivi_controller_get_native_handle(display.ivi_controller,
                                          process_id,
@@ -195,7 +247,8 @@ main(int argc, char **argv)
             }
         }
 
-    } while ((++retry_count < 10) && running);
+        ++retry_count;
+    }
 
     wl_display_roundtrip(display.display);
 
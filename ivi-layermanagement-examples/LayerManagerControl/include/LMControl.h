@@ -251,6 +251,7 @@ void printScene();
 //control.cpp
 //=============================================================================
 void getCommunicatorPerformance();
+void replayCallLog(string filename, bool realtime);
 void setSurfaceKeyboardFocus(t_ilm_surface surface);
 void getKeyboardFocus();
 void setSurfaceAcceptsInput(t_ilm_surface surfaceId, string kbdPointerTouch, t_ilm_bool acceptance);
@@ -322,6 +323,12 @@ void demo(t_ilm_uint mode);
  */
 void exportSceneToFile(string filename);
 
+/*
+ * Saves the current scene as a scene file which ivi-shell loads at start,
+ * see the ivi-scene key of the [ivi-shell] section of weston.ini
+ */
+void exportBootSceneToFile(string filename);
+
 /*
  * Saves an xtext representation of the grammar of the scene
  */
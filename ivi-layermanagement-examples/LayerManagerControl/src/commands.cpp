@@ -650,6 +650,14 @@ COMMAND("get communicator performance")
     getCommunicatorPerformance();
 }
 
+//=============================================================================
+COMMAND("replay <filename> [realtime]")
+//=============================================================================
+{
+    string filename = (string) input->getString("filename");
+    replayCallLog(filename, input->contains("realtime"));
+}
+
 //=============================================================================
 COMMAND("set surface <surfaceid> keyboard focus")
 //=============================================================================
@@ -819,6 +827,14 @@ COMMAND("export scene to <filename>")
     exportSceneToFile(filename);
 }
 
+//=============================================================================
+COMMAND("export boot scene to <filename>")
+//=============================================================================
+{
+    string filename = (string) input->getString("filename");
+    exportBootSceneToFile(filename);
+}
+
 //=============================================================================
 COMMAND("export xtext to <filename> <grammar> <url>")
 //=============================================================================
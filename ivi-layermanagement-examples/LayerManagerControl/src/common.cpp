@@ -634,6 +634,52 @@ tuple4 interpolateCoordinatesHelper(tuple4& start, tuple4& end, float t)
             static_cast<int>(start.w * (1 - t) + end.w * t));
 }
 
+/*
+ * Let the compositor move the surfaces from their initial to their final
+ * coordinates. Returns false if the compositor does not support transitions.
+ */
+static bool transformSceneByCompositor(t_scene_data* pInitialScene, t_scene_data* pFinalScene,
+                                       t_scene_data* pDummyScene, t_ilm_long durationMillis)
+{
+    for (vector<t_ilm_surface>::iterator it = pDummyScene->surfaces.begin();
+            it != pDummyScene->surfaces.end(); ++it)
+    {
+        t_ilm_surface surface = *it;
+        tuple4 start = getSurfaceScreenCoordinates(pInitialScene, surface);
+
+        ilm_surfaceSetDestinationRectangle(surface, start.x, start.y, start.z - start.x, start.w - start.y);
+        ilm_surfaceSetOpacity(surface, pInitialScene->surfaceProperties[surface].opacity);
+    }
+
+    ilm_commitChanges();
+
+    for (vector<t_ilm_surface>::iterator it = pDummyScene->surfaces.begin();
+            it != pDummyScene->surfaces.end(); ++it)
+    {
+        t_ilm_surface surface = *it;
+        tuple4 end = getSurfaceScreenCoordinates(pFinalScene, surface);
+
+        ilmErrorTypes callResult = ilm_surfaceTransitionDestinationRectangle(surface, end.x, end.y,
+                                       end.z - end.x, end.w - end.y, durationMillis, ILM_EASING_EASE_OUT);
+        if (ILM_ERROR_NOT_IMPLEMENTED == callResult)
+        {
+            return false;
+        }
+
+        ilm_surfaceTransitionOpacity(surface, pFinalScene->surfaceProperties[surface].opacity,
+                                     durationMillis, ILM_EASING_LINEAR);
+    }
+
+    ilm_commitChanges();
+
+    struct timespec sleepTime;
+    sleepTime.tv_nsec = (durationMillis % 1000) * 1000000;
+    sleepTime.tv_sec = durationMillis / 1000;
+    nanosleep(&sleepTime, NULL);
+
+    return true;
+}
+
 void transformScene(t_scene_data* pInitialScene, t_scene_data* pFinalScene, t_ilm_long durationMillis, t_ilm_int frameCount)
 {
     t_scene_data dummyScene = cloneToUniLayerScene(pFinalScene);
@@ -642,7 +688,8 @@ void transformScene(t_scene_data* pInitialScene, t_scene_data* pFinalScene, t_il
 
     //animate dummy scene !
 
-    if (durationMillis > 0 && frameCount > 0)
+    if (durationMillis > 0 && frameCount > 0
+            && !transformSceneByCompositor(pInitialScene, pFinalScene, &dummyScene, durationMillis))
     {
         //sleep time
         long sleepMillis = durationMillis / frameCount;
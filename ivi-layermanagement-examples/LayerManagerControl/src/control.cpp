@@ -19,6 +19,7 @@
 
 #include "ilm_client.h"
 #include "ilm_control.h"
+#include "ilm_control_recorder.h"
 #include "LMControl.h"
 
 #include <cstring>
@@ -83,6 +84,33 @@ void getCommunicatorPerformance()
     cout << (runs / runtimeInSec) << " transactions/second\n";
 }
 
+void replayCallLog(string filename, bool realtime)
+{
+    struct ilmReplayStatistics statistics;
+
+    ilmErrorTypes callResult = ilmControl_replay(filename.c_str(),
+                                                 realtime ? ILM_TRUE : ILM_FALSE,
+                                                 &statistics);
+    if (ILM_SUCCESS != callResult)
+    {
+        cout << "Failed to replay call log " << filename << "\n";
+        return;
+    }
+
+    cout << "replayed calls:   " << statistics.callCount << "\n";
+    cout << "result mismatch:  " << statistics.mismatchCount << "\n";
+    cout << "skipped records:  " << statistics.skippedCount << "\n";
+    cout << "recorded time:    " << statistics.recordedTime << " us\n";
+    cout << "elapsed time:     " << statistics.elapsedTime << " us\n";
+    cout << "time in calls:    " << statistics.callTime << " us\n";
+
+    if (statistics.elapsedTime > 0)
+    {
+        cout << (statistics.callCount * 1000000ULL / statistics.elapsedTime)
+             << " calls/second\n";
+    }
+}
+
 void setSurfaceKeyboardFocus(t_ilm_surface surface)
 {
     ilmErrorTypes callResult = ilm_SetKeyboardFocusOn(surface);
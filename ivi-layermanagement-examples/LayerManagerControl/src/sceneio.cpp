@@ -22,6 +22,7 @@
 #include "Expression.h"
 #include "ExpressionInterpreter.h"
 #include "SceneStore.h"
+#include "ivi-scene-file.h"
 #include <cstdio>
 #include <cmath>
 #include <iostream>
@@ -667,6 +668,119 @@ void exportSceneToFile(string filename)
     stream.close();
 }
 
+namespace {
+int32_t toFixed(t_ilm_float value)
+{
+    return (int32_t) lround(value * 256.0);
+}
+
+ivi_scene_file_layer toSceneFileLayer(t_ilm_layer layerId, t_ilm_uint screenId,
+                                      const ilmLayerProperties& props)
+{
+    ivi_scene_file_layer layer;
+    layer.id_layer = layerId;
+    layer.width = props.origSourceWidth;
+    layer.height = props.origSourceHeight;
+    layer.id_screen = screenId;
+    layer.visibility = props.visibility;
+    layer.opacity = toFixed(props.opacity);
+    layer.source_x = props.sourceX;
+    layer.source_y = props.sourceY;
+    layer.source_width = props.sourceWidth;
+    layer.source_height = props.sourceHeight;
+    layer.dest_x = props.destX;
+    layer.dest_y = props.destY;
+    layer.dest_width = props.destWidth;
+    layer.dest_height = props.destHeight;
+    layer.orientation = props.orientation;
+    return layer;
+}
+} //end of anonymous namespace
+
+void exportBootSceneToFile(string filename)
+{
+    t_scene_data scene;
+    captureSceneData(&scene);
+
+    vector<ivi_scene_file_layer> layers;
+    vector<ivi_scene_file_rule> rules;
+
+    //layers on screens, bottom to top
+    for (map<t_ilm_display, vector<t_ilm_layer> >::iterator it = scene.screenLayers.begin();
+            it != scene.screenLayers.end(); ++it)
+    {
+        for (vector<t_ilm_layer>::iterator layer = it->second.begin();
+                layer != it->second.end(); ++layer)
+        {
+            layers.push_back(toSceneFileLayer(*layer, it->first, scene.layerProperties[*layer]));
+        }
+    }
+
+    //layers which are not rendered
+    for (vector<t_ilm_layer>::iterator layer = scene.layers.begin();
+            layer != scene.layers.end(); ++layer)
+    {
+        if (scene.layerScreen.find(*layer) == scene.layerScreen.end())
+        {
+            layers.push_back(toSceneFileLayer(*layer, IVI_SCENE_FILE_NO_SCREEN,
+                                              scene.layerProperties[*layer]));
+        }
+    }
+
+    //one rule for each surface on a layer
+    for (map<t_ilm_layer, vector<t_ilm_surface> >::iterator it = scene.layerSurfaces.begin();
+            it != scene.layerSurfaces.end(); ++it)
+    {
+        for (vector<t_ilm_surface>::iterator surface = it->second.begin();
+                surface != it->second.end(); ++surface)
+        {
+            ilmSurfaceProperties& props = scene.surfaceProperties[*surface];
+
+            ivi_scene_file_rule rule;
+            rule.id_surface_min = *surface;
+            rule.id_surface_max = *surface;
+            rule.id_layer = it->first;
+            rule.visibility = props.visibility;
+            rule.opacity = toFixed(props.opacity);
+            rule.dest_x = props.destX;
+            rule.dest_y = props.destY;
+            rule.dest_width = props.destWidth;
+            rule.dest_height = props.destHeight;
+            rule.orientation = props.orientation;
+            rules.push_back(rule);
+        }
+    }
+
+    ivi_scene_file_header header;
+    header.magic = IVI_SCENE_FILE_MAGIC;
+    header.version = IVI_SCENE_FILE_VERSION;
+    header.layer_count = layers.size();
+    header.rule_count = rules.size();
+
+    fstream stream(filename.c_str(), ios::out | ios::binary);
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!layers.empty())
+    {
+        stream.write(reinterpret_cast<const char*>(&layers[0]),
+                     layers.size() * sizeof(ivi_scene_file_layer));
+    }
+    if (!rules.empty())
+    {
+        stream.write(reinterpret_cast<const char*>(&rules[0]),
+                     rules.size() * sizeof(ivi_scene_file_rule));
+    }
+    stream.flush();
+
+    if (!stream)
+    {
+        cout << "Failed to write boot scene to " << filename << "\n";
+        return;
+    }
+
+    cout << "Boot scene with " << layers.size() << " layers and "
+         << rules.size() << " surfaces written to " << filename << "\n";
+}
+
 void importSceneFromFile(string filename)
 {
     IlmScene ilmscene;
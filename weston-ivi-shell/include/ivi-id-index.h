@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#ifndef IVI_ID_INDEX_H
+#define IVI_ID_INDEX_H
+
+#include <stdint.h>
+#include <wayland-util.h>
+
+/*
+ * Hash index from the id of a scene object to the objects registered for
+ * it, e.g. the controller resources of all clients for one surface.
+ * Objects are linked into the per-id list through a wl_list member of
+ * their own, so walking the objects of one id costs O(objects of that id).
+ */
+struct ivi_id_entry {
+    uint32_t id;
+    struct wl_list list;
+    struct wl_list link;
+};
+
+struct ivi_id_index {
+    struct wl_list *buckets;
+    uint32_t bits;
+    uint32_t count;
+    /* returned for ids without objects */
+    struct wl_list empty;
+};
+
+int
+ivi_id_index_init(struct ivi_id_index *index);
+
+void
+ivi_id_index_release(struct ivi_id_index *index);
+
+/*
+ * List of the objects registered for the id, an empty list if there are
+ * none. The list must not be modified except by ivi_id_index_remove().
+ */
+struct wl_list *
+ivi_id_index_find(struct ivi_id_index *index, uint32_t id);
+
+/*
+ * Link an object into the list of the id. Returns -1 if no memory is left,
+ * the link is initialized as an empty list in that case.
+ */
+int
+ivi_id_index_insert(struct ivi_id_index *index, uint32_t id,
+                    struct wl_list *link);
+
+/*
+ * Unlink an object inserted for the id. The entry of the id is freed with
+ * its last object.
+ */
+void
+ivi_id_index_remove(struct ivi_id_index *index, uint32_t id,
+                    struct wl_list *link);
+
+#endif /* IVI_ID_INDEX_H */
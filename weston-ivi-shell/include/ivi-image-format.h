@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#ifndef IVI_IMAGE_FORMAT_H
+#define IVI_IMAGE_FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <wayland-util.h>
+
+/*
+ * File formats of screenshots, with the values of the format enum of
+ * ivi_controller_screenshot.
+ */
+enum ivi_image_format {
+    IVI_IMAGE_FORMAT_PNG = 0,
+    IVI_IMAGE_FORMAT_RAW = 1,
+    IVI_IMAGE_FORMAT_PPM = 2,
+    IVI_IMAGE_FORMAT_PAM = 3,
+    IVI_IMAGE_FORMAT_QOI = 4
+};
+
+/* ARGB32 pixels in host byte order, rows are stride bytes apart */
+struct ivi_image {
+    int32_t width;
+    int32_t height;
+    int32_t stride;
+    uint8_t *data;
+    size_t alloc;
+    struct wl_list link;
+};
+
+int
+ivi_image_format_is_valid(uint32_t format);
+
+/*
+ * Encode the image in the format and store it in the file. Returns 0 on
+ * success, -1 otherwise. Safe to call from any thread.
+ */
+int32_t
+ivi_image_write_file(const struct ivi_image *image, const char *filename,
+                     enum ivi_image_format format);
+
+#endif /* IVI_IMAGE_FORMAT_H */
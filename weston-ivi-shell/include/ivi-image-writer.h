@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#ifndef IVI_IMAGE_WRITER_H
+#define IVI_IMAGE_WRITER_H
+
+#include <stdint.h>
+#include <wayland-server.h>
+
+#include "ivi-image-format.h"
+
+/*
+ * Writes images to files on worker threads, so that encoding and file
+ * I/O do not delay the repaint of the compositor. The pixels are read back
+ * on the main thread into an image taken from the pool of the writer. The
+ * completion of a write is reported on the main thread by the event loop
+ * of the compositor.
+ */
+struct ivi_image_writer;
+struct ivi_image_job;
+
+/* result is 0 if the file was written, -1 otherwise */
+typedef void (*ivi_image_written_func)(void *data, int32_t result);
+
+struct ivi_image_writer *
+ivi_image_writer_create(struct wl_event_loop *loop);
+
+/*
+ * Waits for the writes in progress. Queued writes are not started, their
+ * completion is reported as failed.
+ */
+void
+ivi_image_writer_destroy(struct ivi_image_writer *writer);
+
+/*
+ * Image of the given size from the pool, or a new one if no pooled image
+ * is large enough. Returns NULL if no memory is left or too many images
+ * are waiting to be written, so that clients can not queue up memory
+ * faster than the workers write it.
+ */
+struct ivi_image *
+ivi_image_writer_get_image(struct ivi_image_writer *writer,
+                           int32_t width, int32_t height);
+
+/*
+ * Return an image which is not written to the pool.
+ */
+void
+ivi_image_writer_put_image(struct ivi_image_writer *writer,
+                           struct ivi_image *image);
+
+/*
+ * Queue the image to be written to the file in the format. The writer
+ * owns the image afterwards, also if NULL is returned because no memory is
+ * left.
+ * done is called on the main thread once the file was written, unless
+ * the job was cancelled before.
+ */
+struct ivi_image_job *
+ivi_image_writer_write(struct ivi_image_writer *writer,
+                       struct ivi_image *image, const char *filename,
+                       enum ivi_image_format format,
+                       ivi_image_written_func done, void *data);
+
+/*
+ * Stop reporting the completion of the job, e.g. because the object
+ * waiting for it is destroyed. The file is written nevertheless.
+ */
+void
+ivi_image_job_cancel(struct ivi_image_job *job);
+
+#endif /* IVI_IMAGE_WRITER_H */
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+
+#ifndef IVI_JOURNAL_H
+#define IVI_JOURNAL_H
+
+#include <stdint.h>
+#include <stdarg.h>
+
+#include "ilm_control_recorder.h"
+
+/*
+ * Journal of controller requests, written in the call log format of
+ * ilm_control_recorder.h so that it can be replayed with
+ * ilmControl_replay(), e.g. by "LayerManagerControl replay". The client
+ * field of a record holds the number of the client which sent the request.
+ * Replay sends the requests of all clients over a single connection, so
+ * the field only tells them apart for the reader.
+ *
+ * The journal is a ring of two files: when the file reaches its size
+ * limit, it is renamed with the suffix ".1", replacing the older one, and
+ * a new file is started. A failed rotation or creation of the file is
+ * retried with the next record.
+ */
+struct ivi_journal;
+
+/* NULL if the file cannot be created or no memory is left */
+struct ivi_journal *
+ivi_journal_create(const char *filename, uint32_t max_size);
+
+void
+ivi_journal_destroy(struct ivi_journal *journal);
+
+/* write the buffered records to the file */
+void
+ivi_journal_flush(struct ivi_journal *journal);
+
+/*
+ * Append a record of the call. Each character of the signature takes one
+ * argument:
+ *   u  uint32_t
+ *   f  double
+ *   s  const char *, may be NULL
+ *   a  const struct wl_array * of uint32_t, may be NULL
+ * Records are buffered until ivi_journal_flush. Returns -1 if the record
+ * could not be written, or if the file could not be rotated and grows
+ * beyond its size limit.
+ */
+int
+ivi_journal_write(struct ivi_journal *journal, ilmRecordFunc func,
+                  uint16_t client, const char *signature, ...);
+
+int
+ivi_journal_vwrite(struct ivi_journal *journal, ilmRecordFunc func,
+                   uint16_t client, const char *signature, va_list ap);
+
+#endif /* IVI_JOURNAL_H */
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+
+#ifndef IVI_OBJECT_POOL_H
+#define IVI_OBJECT_POOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <wayland-util.h>
+
+/*
+ * Objects of one size, allocated from slabs holding a fixed number of
+ * objects each. Slabs with free objects are kept at the head of the list,
+ * so an allocation takes the first slab. A slab is released when its last
+ * object is freed, unless it is the only slab of the pool.
+ */
+struct ivi_object_pool {
+    size_t chunk_size;
+    struct wl_list list_slab;
+    uint32_t slab_count;
+    uint32_t live_count;
+};
+
+void
+ivi_object_pool_init(struct ivi_object_pool *pool, size_t object_size);
+
+/* releases all slabs, objects still allocated become invalid */
+void
+ivi_object_pool_release(struct ivi_object_pool *pool);
+
+/* zeroed object, NULL if no memory is left */
+void *
+ivi_object_pool_alloc(struct ivi_object_pool *pool);
+
+void
+ivi_object_pool_free(struct ivi_object_pool *pool, void *object);
+
+/* bytes taken by the slabs of the pool */
+size_t
+ivi_object_pool_get_size(const struct ivi_object_pool *pool);
+
+#endif /* IVI_OBJECT_POOL_H */
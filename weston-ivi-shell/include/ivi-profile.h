@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+
+#ifndef IVI_PROFILE_H
+#define IVI_PROFILE_H
+
+#include <stdint.h>
+#include <wayland-util.h>
+
+/*
+ * Call counts and duration histograms of code sites, e.g. the request
+ * handlers of the controller. A site is a static struct ivi_profile_site,
+ * registered in the profiler when it is hit for the first time. The
+ * statistics are kept per owner, e.g. per client, in a struct ivi_profile.
+ */
+
+/*
+ * Bucket 0 counts calls shorter than 1 us, bucket i calls from 2^(i-1) us
+ * to 2^i us, and the last bucket all longer calls.
+ */
+#define IVI_PROFILE_BUCKETS 16
+
+struct ivi_profile_site {
+    const char *name;
+    /* index in the profiler plus 1, 0 until the site is hit */
+    uint32_t index;
+};
+
+struct ivi_profile_stats {
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint32_t buckets[IVI_PROFILE_BUCKETS];
+};
+
+struct ivi_profiler {
+    int enabled;
+    /* struct ivi_profile_site *, in the order the sites were hit */
+    struct wl_array sites;
+};
+
+struct ivi_profile {
+    /* struct ivi_profile_stats, indexed like the sites of the profiler */
+    struct wl_array stats;
+};
+
+void
+ivi_profiler_init(struct ivi_profiler *profiler);
+
+void
+ivi_profiler_release(struct ivi_profiler *profiler);
+
+uint32_t
+ivi_profiler_get_site_count(const struct ivi_profiler *profiler);
+
+const char *
+ivi_profiler_get_site_name(const struct ivi_profiler *profiler,
+                           uint32_t index);
+
+/* CLOCK_MONOTONIC in nanoseconds */
+uint64_t
+ivi_profile_now(void);
+
+void
+ivi_profile_init(struct ivi_profile *profile);
+
+void
+ivi_profile_release(struct ivi_profile *profile);
+
+/*
+ * Count a call of the site which took duration_ns. Returns -1 if no memory
+ * is left, the call is not counted then.
+ */
+int
+ivi_profile_add(struct ivi_profiler *profiler, struct ivi_profile *profile,
+                struct ivi_profile_site *site, uint64_t duration_ns);
+
+/*
+ * Statistics of the site with the index, NULL if the site was not hit
+ * since the profile was created or reset.
+ */
+const struct ivi_profile_stats *
+ivi_profile_get_stats(const struct ivi_profile *profile, uint32_t index);
+
+void
+ivi_profile_reset(struct ivi_profile *profile);
+
+#endif /* IVI_PROFILE_H */
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+
+#ifndef IVI_SCENE_FILE_H
+#define IVI_SCENE_FILE_H
+
+#include <stdint.h>
+
+/*
+ * Scene created by the compositor at start, before any controller is
+ * bound. The file starts with a struct ivi_scene_file_header, followed by
+ * layer_count struct ivi_scene_file_layer and rule_count struct
+ * ivi_scene_file_rule. All values are in host byte order.
+ * LayerManagerControl writes such a file from the current scene with
+ * "export boot scene to <filename>".
+ */
+#define IVI_SCENE_FILE_MAGIC     0x53495649  /* "IVIS" */
+#define IVI_SCENE_FILE_VERSION   1
+#define IVI_SCENE_FILE_NO_SCREEN 0xffffffff
+
+struct ivi_scene_file_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t layer_count;
+    uint32_t rule_count;
+};
+
+/*
+ * Layers on the same screen are listed from bottom to top. Opacities are
+ * wl_fixed_t values.
+ */
+struct ivi_scene_file_layer {
+    uint32_t id_layer;
+    uint32_t width;
+    uint32_t height;
+    uint32_t id_screen;
+    uint32_t visibility;
+    int32_t opacity;
+    int32_t source_x;
+    int32_t source_y;
+    int32_t source_width;
+    int32_t source_height;
+    int32_t dest_x;
+    int32_t dest_y;
+    int32_t dest_width;
+    int32_t dest_height;
+    uint32_t orientation;
+};
+
+/*
+ * Placement of new surfaces with an id from id_surface_min to
+ * id_surface_max. The first matching rule is used. The surface is added on
+ * top of the layer, its source rectangle is the first buffer. A dest_width
+ * or dest_height of 0 keeps the size of the buffer.
+ */
+struct ivi_scene_file_rule {
+    uint32_t id_surface_min;
+    uint32_t id_surface_max;
+    uint32_t id_layer;
+    uint32_t visibility;
+    int32_t opacity;
+    int32_t dest_x;
+    int32_t dest_y;
+    int32_t dest_width;
+    int32_t dest_height;
+    uint32_t orientation;
+};
+
+struct ivi_scene {
+    struct ivi_scene_file_layer *layers;
+    uint32_t layer_count;
+    struct ivi_scene_file_rule *rules;
+    uint32_t rule_count;
+};
+
+/*
+ * Read a scene file. Returns 0 on success, -1 if the file can not be read,
+ * is not a scene file of this version or its size does not match the
+ * counts of its header.
+ */
+int
+ivi_scene_file_load(const char *filename, struct ivi_scene *scene);
+
+void
+ivi_scene_release(struct ivi_scene *scene);
+
+/* first rule for the surface, NULL if the surface is not placed */
+const struct ivi_scene_file_rule *
+ivi_scene_find_rule(const struct ivi_scene *scene, uint32_t id_surface);
+
+#endif /* IVI_SCENE_FILE_H */
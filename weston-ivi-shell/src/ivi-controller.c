@@ -22,46 +22,111 @@
 
 #include <sys/wait.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <signal.h>
+#include <sys/ioctl.h>
+#include <linux/sockios.h>
 #include <linux/input.h>
-#include <cairo.h>
 
 #include "weston/compositor.h"
 #include "ivi-controller-server-protocol.h"
 #include "weston/weston-layout.h"
 #include "weston/ivi-shell-ext.h"
+#include "ivi-id-index.h"
+#include "ivi-image-writer.h"
+#include "ivi-journal.h"
+#include "ivi-object-pool.h"
+#include "ivi-profile.h"
+#include "ivi-scene-file.h"
 
 struct ivishell;
 struct ivilayer;
 struct iviscreen;
 
-struct link_layer {
-    struct ivilayer *layer;
-    struct wl_list link;
+/*
+ * Sorted keys of the layers of a surface or the screens of a layer as of
+ * the last IVI_NOTIFICATION_ADD, with the change made by that update.
+ */
+struct ivi_membership {
+    struct wl_array keys;
+    struct wl_array added;
+    uint32_t removed;
 };
 
-struct link_screen {
-    struct iviscreen *screen;
-    struct wl_list link;
+#define FRAME_INTERVAL_BUCKETS 8
+
+/* unread bytes from which the property events of a client are held back */
+#define DEFAULT_CLIENT_BACKLOG_LIMIT 65536
+
+/* bytes of a journal file before it is rotated */
+#define DEFAULT_JOURNAL_SIZE (4 * 1024 * 1024)
+
+/* milliseconds the records of the journal are buffered at most */
+#define JOURNAL_FLUSH_INTERVAL 1000
+
+/* signals which dump and reset the timings of controller-profiling */
+#define PROFILE_DUMP_SIGNAL (SIGRTMIN + 1)
+#define PROFILE_RESET_SIGNAL (SIGRTMIN + 2)
+
+/*
+ * Frame statistics of a surface. Times are taken from the monotonic clock
+ * in microseconds, when a commit is configured and when the repaint of the
+ * screen showing the surface has finished.
+ */
+struct ivi_frame_stats {
+    uint32_t commit_count;
+    uint32_t present_count;
+    uint32_t drop_count;
+    uint64_t latency_sum;
+    uint32_t latency_max;
+    /* latest commit, not presented yet while linked to list_surface_committed */
+    uint64_t commit_time;
+    uint64_t present_time;
+    /* presented commits since fps_time, fps is updated once per second */
+    uint64_t fps_time;
+    uint32_t fps_count;
+    wl_fixed_t fps;
+    uint32_t intervals[FRAME_INTERVAL_BUCKETS];
 };
 
 struct ivisurface {
     struct wl_list link;
+    /* in shell->surfaces by id_surface */
+    struct wl_list id_link;
     struct wl_client *client;
     struct ivishell *shell;
-    uint32_t update_count;
     struct weston_layout_surface *layout_surface;
     struct wl_listener surface_destroy_listener;
-    struct wl_list list_layer;
+    struct ivi_membership layers;
+    /* record in shell->scene_changes, valid while scene_serial matches */
+    uint32_t scene_serial;
+    uint32_t scene_index;
+    struct ivi_frame_stats frame_stats;
+    struct wl_list committed_link;
+    /* commits of the weston surface, counted by the frame stats */
+    struct weston_surface *surface;
+    struct wl_listener surface_commit_listener;
+    /* whether the surface contributes to a screen, as last sent */
+    int32_t effective_visibility;
+    /* placement of the preloaded scene, applied to the first buffer */
+    const struct ivi_scene_file_rule *preload_rule;
 };
 
 struct ivilayer {
     struct wl_list link;
+    /* in shell->layers by id_layer */
+    struct wl_list id_link;
     struct ivishell *shell;
     struct weston_layout_layer *layout_layer;
-    struct wl_list list_screen;
+    struct ivi_membership screens;
+    /* record in shell->scene_changes, valid while scene_serial matches */
+    uint32_t scene_serial;
+    uint32_t scene_index;
 };
 
 struct iviscreen {
@@ -69,6 +134,13 @@ struct iviscreen {
     struct ivishell *shell;
     struct weston_layout_screen *layout_screen;
     struct weston_output *output;
+    struct wl_listener frame_listener;
+    uint32_t frame_count;
+    /* latest shell->commit_serial contained in a repaint of the screen */
+    uint32_t shown_serial;
+    /* changed by the shell, see schedule_marked_screens */
+    int repaint_needed;
+    struct wl_list list_screenshot;
 };
 
 struct ivicontroller_surface {
@@ -78,6 +150,8 @@ struct ivicontroller_surface {
     struct wl_client *client;
     struct wl_list link;
     struct ivishell *shell;
+    /* property events held back while the client is backlogged */
+    uint32_t held_mask;
 };
 
 struct ivicontroller_layer {
@@ -87,6 +161,41 @@ struct ivicontroller_layer {
     struct wl_client *client;
     struct wl_list link;
     struct ivishell *shell;
+    /* property events held back while the client is backlogged */
+    uint32_t held_mask;
+};
+
+/* controller objects allocated from the pools of the shell */
+enum controller_object_type {
+    CONTROLLER_OBJECT_SURFACE,
+    CONTROLLER_OBJECT_LAYER,
+    CONTROLLER_OBJECT_SCREEN,
+    CONTROLLER_OBJECT_TYPE_COUNT
+};
+
+/* live controller objects of a client, freed with the client */
+struct ivicontroller_client {
+    struct wl_client *client;
+    struct wl_listener destroy_listener;
+    uint32_t object_count[CONTROLLER_OBJECT_TYPE_COUNT];
+    uint32_t total_count;
+    size_t bytes;
+    /* timings of the requests and events of the client */
+    struct ivi_profile profile;
+    /*
+     * Bytes sent to the client which it did not read yet, measured at
+     * every frame. While the client is backlogged, only the latest values
+     * of the properties are sent once it caught up.
+     */
+    uint32_t backlog;
+    uint32_t max_backlog;
+    int backlogged;
+    uint32_t backlogged_count;
+    uint32_t held_events;
+    /* number of the client in the journal, 0 until it is journaled */
+    uint16_t journal_client;
+    struct ivishell *shell;
+    struct wl_list link;
 };
 
 struct ivicontroller_screen {
@@ -98,12 +207,204 @@ struct ivicontroller_screen {
     struct ivishell *shell;
 };
 
+/* ids of surfaces or layers a controller added by add_interest */
+struct ivi_interest {
+    uint32_t object_type;
+    uint32_t id_min;
+    uint32_t id_max;
+    uint32_t flags;
+};
+
 struct ivicontroller {
     struct wl_resource *resource;
     uint32_t id;
     struct wl_client *client;
     struct wl_list link;
     struct ivishell *shell;
+    /* scene changes of a rate limited controller, sorted by object */
+    uint32_t event_rate;
+    uint32_t event_interval;
+    uint32_t event_time;
+    struct wl_array pending_changes;
+    /* all objects are reported while no interest was added */
+    struct wl_array interests;
+    int interest_members;
+    uint32_t interest_fields;
+};
+
+/*
+ * Shell surface in the native handle index, keyed by process id. The title
+ * is a copy, updated when the shell notifies about a change.
+ */
+struct native_handle_entry {
+    struct ivishell *shell;
+    struct weston_surface *surface;
+    uint32_t pid;
+    char *title;
+    struct wl_listener surface_destroy_listener;
+    struct wl_list link;
+};
+
+struct ivicontroller_native_handle_watch {
+    struct wl_resource *resource;
+    struct ivishell *shell;
+    uint32_t pid;
+    /* NULL matches all titles */
+    char *title;
+    struct wl_list link;
+};
+
+struct ivicontroller_commit_feedback {
+    struct wl_resource *resource;
+    /* shell->commit_serial of the frame aligned commit, once latched */
+    uint32_t serial;
+    struct wl_list link;
+};
+
+struct ivicontroller_frame_stats {
+    struct wl_resource *resource;
+    struct ivishell *shell;
+    /* NULL after the surface was removed */
+    struct ivisurface *ivisurf;
+    uint32_t interval;
+    uint64_t send_time;
+    struct wl_list link;
+};
+
+enum transition_property {
+    TRANSITION_OPACITY = 1,
+    TRANSITION_DESTINATION_RECTANGLE = 2,
+    TRANSITION_ALL = 3
+};
+
+/*
+ * Property of a surface or a layer moved by the compositor. Times are
+ * taken from the monotonic clock in microseconds.
+ */
+struct ivi_transition {
+    /* one of them is set */
+    struct weston_layout_surface *layout_surface;
+    struct weston_layout_layer *layout_layer;
+    enum transition_property property;
+    uint32_t easing;
+    /* 0 until the transition is committed */
+    uint64_t start_time;
+    uint64_t duration;
+    float from[4];
+    float to[4];
+    struct wl_list link;
+};
+
+enum staged_property {
+    STAGED_OPACITY,
+    STAGED_SOURCE_RECTANGLE,
+    STAGED_DESTINATION_RECTANGLE,
+    STAGED_VISIBILITY,
+    STAGED_ORIENTATION,
+    STAGED_RENDER_ORDER
+};
+
+/*
+ * Property set into the pending state of weston_layout by a controller and
+ * not committed yet. weston_layout keeps one pending state for all
+ * clients, so when the shell commits on its own, the properties which are
+ * not part of that commit are put back to their committed values and set
+ * again afterwards. One entry is kept per property of an object, for the
+ * client which set it last.
+ */
+struct ivi_staged {
+    /* NULL after the client disconnected */
+    struct wl_client *client;
+    /* one of them is set */
+    struct weston_layout_surface *layout_surface;
+    struct weston_layout_layer *layout_layer;
+    struct weston_layout_screen *layout_screen;
+    enum staged_property property;
+    float opacity;
+    /* rectangle, or visibility or orientation in value[0] */
+    int32_t value[4];
+    /* surfaces of the layer or layers of the screen */
+    struct wl_array order;
+    /* put back to the committed value for the commit in progress */
+    int held;
+    struct wl_list link;
+};
+
+/*
+ * Record of a surface or layer in the scene_changes event. All fields are
+ * 32 bit wide, so the records are packed as described by the protocol.
+ */
+struct ivi_scene_change {
+    uint32_t object_type;
+    uint32_t id;
+    uint32_t mask;
+    wl_fixed_t opacity;
+    int32_t source_x;
+    int32_t source_y;
+    int32_t source_width;
+    int32_t source_height;
+    int32_t dest_x;
+    int32_t dest_y;
+    int32_t dest_width;
+    int32_t dest_height;
+    uint32_t orientation;
+    uint32_t visibility;
+    uint32_t pixelformat;
+};
+
+struct ivirect {
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+};
+
+enum screenshot_type {
+    SCREENSHOT_SCREEN,
+    SCREENSHOT_LAYER,
+    SCREENSHOT_SURFACE
+};
+
+struct ivicontroller_screenshot {
+    /* NULL for the screenshot requests without completion feedback */
+    struct wl_resource *resource;
+    struct wl_resource *buffer;
+    struct wl_listener buffer_destroy_listener;
+    /* NULL for screenshots into a buffer */
+    char *filename;
+    enum ivi_image_format format;
+    /* file being written by the image writer */
+    struct ivi_image_job *job;
+    enum screenshot_type type;
+    uint32_t id_surface;
+    struct ivirect area;
+    /* repaint the pixels were read from */
+    int has_frame;
+    uint32_t tv_sec;
+    uint32_t tv_nsec;
+    uint32_t seq;
+    struct wl_list link;
+};
+
+struct ivicontroller_capture_buffer {
+    struct wl_resource *resource;
+    struct wl_listener destroy_listener;
+    struct wl_list link;
+};
+
+struct ivicontroller_capture {
+    struct wl_resource *resource;
+    struct ivishell *shell;
+    /* NULL for the capture of a surface */
+    struct iviscreen *iviscrn;
+    uint32_t id_surface;
+    uint32_t interval;
+    uint32_t repaint_count;
+    int full_damage;
+    struct ivirect area;
+    pixman_region32_t damage;
+    struct wl_list list_buffer;
+    struct wl_list link;
 };
 
 struct link_shell_weston_surface
@@ -130,14 +431,83 @@ struct ivishell {
     struct wl_list list_surface;
     struct wl_list list_layer;
     struct wl_list list_screen;
+    /* list_surface and list_layer by id */
+    struct ivi_id_index surfaces;
+    struct ivi_id_index layers;
 
     struct wl_list list_weston_surface;
 
     struct wl_list list_controller;
-    struct wl_list list_controller_surface;
-    struct wl_list list_controller_layer;
+    /* controller resources of all clients by id_surface and id_layer */
+    struct ivi_id_index controller_surfaces;
+    struct ivi_id_index controller_layers;
     struct wl_list list_controller_screen;
 
+    /* frame aligned commits, waiting for the next repaint and latched */
+    struct wl_list list_commit_pending;
+    struct wl_list list_commit_latched;
+    uint32_t commit_serial;
+    /* frame time of the repaint which began the last frame cycle */
+    uint32_t frame_cycle_time;
+
+    /* continuous captures of screens and surfaces */
+    struct wl_list list_capture;
+
+    /* encodes and stores screenshots into files off the main thread */
+    struct ivi_image_writer *image_writer;
+
+    /* surfaces with a commit which was not presented yet */
+    struct wl_list list_surface_committed;
+    struct wl_list list_frame_stats;
+
+    /* property transitions, stepped at every repaint */
+    struct wl_list list_transition;
+    /* properties set by controllers and not committed yet */
+    struct wl_list list_staged;
+
+    /* changed properties, sent to controllers of version 5 when idle */
+    struct wl_array scene_changes;
+    uint32_t scene_serial;
+    uint32_t scene_controller_count;
+    int scene_flush_pending;
+    /* sends the changes held back for limited controllers without repaints,
+     * at a frame time in the clock of the outputs */
+    struct wl_event_source *event_rate_timer;
+    uint32_t event_rate_due;
+
+    /* scene from the ivi-scene file, used until a controller is bound */
+    struct ivi_scene preload;
+
+    /* controller objects, counted per client and dumped on SIGUSR2 */
+    struct ivi_object_pool object_pools[CONTROLLER_OBJECT_TYPE_COUNT];
+    struct wl_list list_client;
+    /* live controller objects allowed per client, 0 for no limit */
+    uint32_t client_object_quota;
+    /* unread bytes from which a client is backlogged, 0 for no limit */
+    uint32_t client_backlog_limit;
+    struct wl_event_source *dump_source;
+    /* timings of the controller, dumped on PROFILE_DUMP_SIGNAL and reset
+     * on PROFILE_RESET_SIGNAL */
+    struct ivi_profiler profiler;
+    struct ivi_profile unattributed_profile;
+    struct wl_event_source *profile_dump_source;
+    struct wl_event_source *profile_reset_source;
+
+    /* requests of the controllers, for replay with ilmControl_replay */
+    struct ivi_journal *journal;
+    uint16_t journal_client_count;
+    /* set while writing fails, to log the failure once */
+    int journal_failed;
+    struct wl_event_source *journal_flush_timer;
+    int journal_flush_pending;
+
+    /*
+     * Shell surfaces by process id, kept up to date by the notifications
+     * of the shell.
+     */
+    struct ivi_id_index native_handles;
+    struct wl_list list_native_handle_watch;
+
     struct {
         struct weston_process process;
         struct wl_client *client;
@@ -152,786 +522,4127 @@ struct ivishell {
     int event_restriction;
 };
 
-static void
-destroy_ivicontroller_surface(struct wl_resource *resource)
+static struct wl_list *
+get_controller_surfaces(struct ivishell *shell, uint32_t id_surface)
 {
-    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
-    struct ivishell *shell = ivisurf->shell;
-    struct ivicontroller_surface *ctrlsurf = NULL;
-    struct ivicontroller_surface *next = NULL;
-    uint32_t id_surface = 0;
+    return ivi_id_index_find(&shell->controller_surfaces, id_surface);
+}
 
-    id_surface = weston_layout_getIdOfSurface(ivisurf->layout_surface);
+static struct wl_list *
+get_controller_layers(struct ivishell *shell, uint32_t id_layer)
+{
+    return ivi_id_index_find(&shell->controller_layers, id_layer);
+}
+
+static const char *const controller_object_names[] = {
+    "surface", "layer", "screen"
+};
 
-    wl_list_for_each_safe(ctrlsurf, next,
-                          &shell->list_controller_surface, link) {
+static const size_t controller_object_sizes[] = {
+    sizeof(struct ivicontroller_surface),
+    sizeof(struct ivicontroller_layer),
+    sizeof(struct ivicontroller_screen)
+};
 
-        if (resource != ctrlsurf->resource) {
-            continue;
+static void
+controller_client_destroyed(struct wl_listener *listener, void *data)
+{
+    struct ivicontroller_client *ctrlclient =
+        wl_container_of(listener, ctrlclient, destroy_listener);
+    struct ivi_staged *staged = NULL;
+    (void)data;
+
+    /* staged properties stay pending until the next commit of any client */
+    wl_list_for_each(staged, &ctrlclient->shell->list_staged, link) {
+        if (staged->client == ctrlclient->client) {
+            staged->client = NULL;
         }
+    }
+
+    /* the resources of the client are destroyed after this notification */
+    wl_list_remove(&ctrlclient->destroy_listener.link);
+    wl_list_remove(&ctrlclient->link);
+    ivi_profile_release(&ctrlclient->profile);
+    free(ctrlclient);
+}
 
+static struct ivicontroller_client *
+find_controller_client(struct wl_client *client)
+{
+    struct ivicontroller_client *ctrlclient = NULL;
+    struct wl_listener *listener = NULL;
 
-        wl_list_remove(&ctrlsurf->link);
-        free(ctrlsurf);
-        ctrlsurf = NULL;
-        break;
+    listener = wl_client_get_destroy_listener(client,
+                                              controller_client_destroyed);
+    if (listener == NULL) {
+        return NULL;
     }
+
+    return wl_container_of(listener, ctrlclient, destroy_listener);
 }
 
-static void
-destroy_ivicontroller_layer(struct wl_resource *resource)
+static struct ivicontroller_client *
+get_controller_client(struct ivishell *shell, struct wl_client *client)
 {
-    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
-    struct ivishell *shell = ivilayer->shell;
-    struct ivicontroller_layer *ctrllayer = NULL;
-    struct ivicontroller_layer *next = NULL;
-    uint32_t id_layer = 0;
+    struct ivicontroller_client *ctrlclient = NULL;
 
-    id_layer = weston_layout_getIdOfLayer(ivilayer->layout_layer);
+    ctrlclient = find_controller_client(client);
+    if (ctrlclient != NULL) {
+        return ctrlclient;
+    }
 
-    wl_list_for_each_safe(ctrllayer, next,
-                          &shell->list_controller_layer, link) {
+    ctrlclient = calloc(1, sizeof *ctrlclient);
+    if (ctrlclient == NULL) {
+        return NULL;
+    }
 
-        if (resource != ctrllayer->resource) {
-            continue;
-        }
+    ctrlclient->client = client;
+    ctrlclient->shell = shell;
+    ivi_profile_init(&ctrlclient->profile);
+    ctrlclient->destroy_listener.notify = controller_client_destroyed;
+    wl_client_add_destroy_listener(client, &ctrlclient->destroy_listener);
+    wl_list_insert(&shell->list_client, &ctrlclient->link);
 
-        wl_list_remove(&ctrllayer->link);
-        free(ctrllayer);
-        ctrllayer = NULL;
-        break;
-    }
+    return ctrlclient;
 }
 
-static void
-destroy_ivicontroller_screen(struct wl_resource *resource)
+/*
+ * Zeroed controller object of the type, NULL if no memory is left or the
+ * client has reached its quota.
+ */
+static void *
+controller_object_alloc(struct ivishell *shell, struct wl_client *client,
+                        enum controller_object_type type)
 {
-    struct iviscreen *iviscrn = wl_resource_get_user_data(resource);
-    struct ivicontroller_screen *ctrlscrn = NULL;
-    struct ivicontroller_screen *next = NULL;
+    struct ivicontroller_client *ctrlclient = NULL;
+    void *object = NULL;
 
-    wl_list_for_each_safe(ctrlscrn, next,
-                          &iviscrn->shell->list_controller_screen, link) {
-// TODO : Only Single display
-#if 0
-        if (iviscrn->output->id != ctrlscrn->id_screen) {
-            continue;
-        }
-#endif
+    ctrlclient = get_controller_client(shell, client);
+    if (ctrlclient == NULL) {
+        return NULL;
+    }
 
-        if (resource != ctrlscrn->resource) {
-            continue;
-        }
+    if ((shell->client_object_quota > 0) &&
+        (ctrlclient->total_count >= shell->client_object_quota)) {
+        weston_log("client reached the quota of %u controller objects\n",
+                   shell->client_object_quota);
+        return NULL;
+    }
 
-        wl_list_remove(&ctrlscrn->link);
-        free(ctrlscrn);
-        ctrlscrn = NULL;
-        break;
+    object = ivi_object_pool_alloc(&shell->object_pools[type]);
+    if (object == NULL) {
+        return NULL;
     }
+
+    ctrlclient->object_count[type]++;
+    ctrlclient->total_count++;
+    ctrlclient->bytes += controller_object_sizes[type];
+
+    return object;
 }
 
 static void
-unbind_resource_controller(struct wl_resource *resource)
+controller_object_free(struct ivishell *shell, struct wl_client *client,
+                       enum controller_object_type type, void *object)
 {
-    struct ivicontroller *controller = wl_resource_get_user_data(resource);
+    struct ivicontroller_client *ctrlclient = NULL;
+
+    /* not found while the client is destroyed */
+    ctrlclient = find_controller_client(client);
+    if (ctrlclient != NULL) {
+        ctrlclient->object_count[type]--;
+        ctrlclient->total_count--;
+        ctrlclient->bytes -= controller_object_sizes[type];
+    }
 
-    wl_list_remove(&controller->link);
+    ivi_object_pool_free(&shell->object_pools[type], object);
+}
 
-    free(controller);
-    controller = NULL;
+static int
+journal_flush_handler(void *data)
+{
+    struct ivishell *shell = data;
+
+    ivi_journal_flush(shell->journal);
+    shell->journal_flush_pending = 0;
+
+    return 1;
 }
 
-static struct ivisurface*
-get_surface(struct wl_list *list_surf, uint32_t id_surface)
+/*
+ * Append the request of the client to the journal, if one is kept. The
+ * clients are numbered in the order of their first journaled request, the
+ * process of each number is logged. The arguments follow the signature of
+ * ivi_journal_write. The records are flushed by a timer, not on the path
+ * of the request.
+ */
+static void
+journal_request(struct ivishell *shell, struct wl_client *client,
+                ilmRecordFunc func, const char *signature, ...)
 {
-    struct ivisurface *ivisurf = NULL;
-    uint32_t ivisurf_id = 0;
+    struct ivicontroller_client *ctrlclient = NULL;
+    pid_t pid = 0;
+    uid_t uid = 0;
+    gid_t gid = 0;
+    va_list ap;
+    int ret = 0;
+
+    if (shell->journal == NULL) {
+        return;
+    }
 
-    wl_list_for_each(ivisurf, list_surf, link) {
-        ivisurf_id = weston_layout_getIdOfSurface(ivisurf->layout_surface);
-        if (ivisurf_id == id_surface) {
-            return ivisurf;
-        }
+    ctrlclient = get_controller_client(shell, client);
+    if (ctrlclient == NULL) {
+        return;
     }
 
-    return NULL;
+    if (ctrlclient->journal_client == 0) {
+        ctrlclient->journal_client = ++shell->journal_client_count;
+        wl_client_get_credentials(client, &pid, &uid, &gid);
+        weston_log("journal client %u is pid %d\n",
+                   ctrlclient->journal_client, (int)pid);
+    }
+
+    va_start(ap, signature);
+    ret = ivi_journal_vwrite(shell->journal, func, ctrlclient->journal_client,
+                             signature, ap);
+    va_end(ap);
+
+    if ((ret != 0) && !shell->journal_failed) {
+        weston_log("failed to write the controller journal, retrying\n");
+        shell->journal_failed = 1;
+    } else if ((ret == 0) && shell->journal_failed) {
+        weston_log("controller journal is written again\n");
+        shell->journal_failed = 0;
+    }
+
+    if (!shell->journal_flush_pending) {
+        wl_event_source_timer_update(shell->journal_flush_timer,
+                                     JOURNAL_FLUSH_INTERVAL);
+        shell->journal_flush_pending = 1;
+    }
 }
 
-static struct ivilayer*
-get_layer(struct wl_list *list_layer, uint32_t id_layer)
+/* bytes sent to the client which it did not read yet */
+static uint32_t
+get_client_backlog(struct wl_client *client)
 {
-    struct ivilayer *ivilayer = NULL;
-    uint32_t ivilayer_id = 0;
+    int bytes = 0;
 
-    wl_list_for_each(ivilayer, list_layer, link) {
-        ivilayer_id = weston_layout_getIdOfLayer(ivilayer->layout_layer);
-        if (ivilayer_id == id_layer) {
-            return ivilayer;
-        }
+    if ((ioctl(wl_client_get_fd(client), SIOCOUTQ, &bytes) != 0) ||
+        (bytes < 0)) {
+        return 0;
     }
 
-    return NULL;
+    return (uint32_t)bytes;
 }
 
-static const
-struct ivi_controller_screen_interface controller_screen_implementation;
-
-static struct ivicontroller_screen*
-controller_screen_create(struct ivishell *shell,
-                         struct wl_client *client,
-                         struct iviscreen *iviscrn)
+/* the accounting of the client if it is backlogged, NULL otherwise */
+static struct ivicontroller_client *
+find_backlogged_client(struct wl_client *client)
 {
-    struct ivicontroller_screen *ctrlscrn = NULL;
+    struct ivicontroller_client *ctrlclient = find_controller_client(client);
 
-    ctrlscrn = calloc(1, sizeof *ctrlscrn);
-    if (ctrlscrn == NULL) {
-        weston_log("no memory to allocate controller screen\n");
+    if ((ctrlclient == NULL) || !ctrlclient->backlogged) {
         return NULL;
     }
 
-    ctrlscrn->client = client;
-    ctrlscrn->shell  = shell;
-// FIXME
-// TODO : Only Single display
-#if 0
-    /* ctrlscrn->id_screen = iviscrn->id_screen; */
-#else
-    ctrlscrn->id_screen = 0;
-#endif
-
-    ctrlscrn->resource =
-        wl_resource_create(client, &ivi_controller_screen_interface, 1, 0);
-    if (ctrlscrn->resource == NULL) {
-        weston_log("couldn't new screen controller object");
+    return ctrlclient;
+}
 
-        free(ctrlscrn);
-        ctrlscrn = NULL;
+/*
+ * Add the property events in the mask to the held events of a controller
+ * surface or layer, if its client is backlogged. Returns 1 if the events
+ * were held.
+ */
+static int
+hold_property_events(struct wl_client *client, uint32_t *held_mask,
+                     uint32_t mask)
+{
+    struct ivicontroller_client *ctrlclient = find_backlogged_client(client);
 
-        return NULL;
+    if (ctrlclient == NULL) {
+        return 0;
     }
 
-    wl_resource_set_implementation(ctrlscrn->resource,
-                                   &controller_screen_implementation,
-                                   iviscrn, destroy_ivicontroller_screen);
+    *held_mask |= mask;
+    ctrlclient->held_events++;
 
-    wl_list_init(&ctrlscrn->link);
-    wl_list_insert(&shell->list_controller_screen, &ctrlscrn->link);
+    return 1;
+}
 
-    return ctrlscrn;
+/*
+ * Timings of the request handlers and notifications of the controller,
+ * enabled with controller-profiling in weston.ini. Calls are counted for
+ * the client of the request or event, the others are not attributed.
+ */
+struct profile_scope {
+    struct ivishell *shell;
+    struct wl_client *client;
+    struct ivi_profile_site *site;
+    uint64_t start;
+};
+
+static struct profile_scope
+profile_scope_begin(struct ivishell *shell, struct wl_client *client,
+                    struct ivi_profile_site *site)
+{
+    struct profile_scope scope = {shell, client, site, 0};
+
+    if (shell->profiler.enabled) {
+        scope.start = ivi_profile_now();
+    }
+
+    return scope;
 }
 
 static void
-send_surface_add_event(struct ivisurface *ivisurf,
-                       struct wl_resource *resource)
+profile_scope_end(struct profile_scope *scope)
 {
-    weston_layout_layer_ptr *pArray = NULL;
-    uint32_t length = 0;
-    int32_t ans = 0;
-    int i = 0;
-    struct link_layer *link_layer = NULL;
-    struct link_layer *next = NULL;
-    struct ivicontroller_layer *ctrllayer = NULL;
-    struct ivilayer *ivilayer = NULL;
-    struct ivishell *shell = ivisurf->shell;
-    uint32_t id_layout_layer = 0;
-    int found = 0;
+    struct ivicontroller_client *ctrlclient = NULL;
+    struct ivi_profile *profile = NULL;
+    uint64_t duration = 0;
 
-    ans = weston_layout_getLayersUnderSurface(ivisurf->layout_surface,
-                                          &length, &pArray);
-    if (0 != ans) {
-        weston_log("failed to get layers at send_surface_add_event\n");
+    if (scope->start == 0) {
         return;
     }
 
-    /* Send Null to cancel added surface */
-    wl_list_for_each_safe(link_layer, next, &ivisurf->list_layer, link) {
-        for (i = 0, found = 0; i < (int)length; i++) {
-            if (pArray[i] == link_layer->layer->layout_layer) {
-                /* No need to send event, if new layer doesn't be added. */
-                found = 1;
-                break;
-            }
-        }
-        if (found != 0) {
-            continue;
-        }
+    profile = &scope->shell->unattributed_profile;
 
-        ivi_controller_surface_send_layer(resource, NULL);
-        wl_list_remove(&link_layer->link);
-        free(link_layer);
-        link_layer = NULL;
+    duration = ivi_profile_now() - scope->start;
+
+    if (scope->client != NULL) {
+        ctrlclient = find_controller_client(scope->client);
+    }
+    if (ctrlclient != NULL) {
+        profile = &ctrlclient->profile;
     }
 
-    for (i = 0; i < (int)length; i++) {
-        found = 0;
-        wl_list_for_each(link_layer, &ivisurf->list_layer, link) {
-            if (pArray[i] == link_layer->layer->layout_layer) {
-                /* No need to send event, if new layer doesn't be added. */
-                found = 1;
-                break;
-            }
-        }
-        if (found != -1) {
-            continue;
-        }
+    ivi_profile_add(&scope->shell->profiler, profile, scope->site, duration);
+}
+
+/* time the rest of the enclosing function for the client, which may be NULL */
+#define PROFILE_SCOPE(shell, client) \
+    static struct ivi_profile_site profile_site = {__func__, 0}; \
+    struct profile_scope profile_scope \
+        __attribute__((cleanup(profile_scope_end))) = \
+        profile_scope_begin((shell), (client), &profile_site)
+
+static void
+dump_profile(struct ivishell *shell, const char *owner,
+             struct ivi_profile *profile)
+{
+    const struct ivi_profile_stats *stats = NULL;
+    uint32_t count = ivi_profiler_get_site_count(&shell->profiler);
+    uint32_t i = 0;
+    uint32_t j = 0;
 
-        /* Create list_layer */
-        link_layer = calloc(1, sizeof(*link_layer));
-        if (NULL == link_layer) {
+    for (i = 0; i < count; i++) {
+        stats = ivi_profile_get_stats(profile, i);
+        if (stats == NULL) {
             continue;
         }
-        wl_list_init(&link_layer->link);
-        link_layer->layer = NULL;
-        wl_list_for_each(ivilayer, &shell->list_layer, link) {
-            if (ivilayer->layout_layer == pArray[i]) {
-                link_layer->layer = ivilayer;
-                break;
-            }
-        }
-
-        if (link_layer->layer == NULL) {
-            free(link_layer);
-            link_layer = NULL;
-            continue;
-        }
-        wl_list_insert(&ivisurf->list_layer, &link_layer->link);
 
-        /* Send new surface event */
-        id_layout_layer =
-            weston_layout_getIdOfLayer(link_layer->layer->layout_layer);
-        wl_list_for_each(ctrllayer, &shell->list_controller_layer, link) {
-            if (id_layout_layer != ctrllayer->id_layer) {
+        weston_log_continue("  %s %s: %llu calls, %llu us average, "
+                            "%llu us max\n    ", owner,
+                            ivi_profiler_get_site_name(&shell->profiler, i),
+                            (unsigned long long)stats->count,
+                            (unsigned long long)(stats->total_ns /
+                                                 stats->count / 1000),
+                            (unsigned long long)(stats->max_ns / 1000));
+        for (j = 0; j < IVI_PROFILE_BUCKETS; j++) {
+            if (stats->buckets[j] == 0) {
                 continue;
             }
-            ivi_controller_surface_send_layer(resource, ctrllayer->resource);
+            if (j == 0) {
+                weston_log_continue(" <1us:%u", stats->buckets[j]);
+            } else {
+                weston_log_continue(" %uus:%u", 1u << (j - 1),
+                                    stats->buckets[j]);
+            }
         }
+        weston_log_continue("\n");
     }
-
-    free(pArray);
-    pArray = NULL;
 }
 
-static void
-send_surface_event(struct wl_resource *resource,
-                   struct ivisurface *ivisurf,
-                   struct weston_layout_SurfaceProperties *prop,
-                   uint32_t mask)
+static int
+dump_controller_objects(int signal_number, void *data)
 {
-    if (mask & IVI_NOTIFICATION_OPACITY) {
-        ivi_controller_surface_send_opacity(resource,
-                                            prop->opacity);
-    }
-    if (mask & IVI_NOTIFICATION_SOURCE_RECT) {
-        ivi_controller_surface_send_source_rectangle(resource,
-            prop->sourceX, prop->sourceY,
-            prop->sourceWidth, prop->sourceHeight);
-    }
-    if (mask & IVI_NOTIFICATION_DEST_RECT) {
-        ivi_controller_surface_send_destination_rectangle(resource,
-            prop->destX, prop->destY,
-            prop->destWidth, prop->destHeight);
+    struct ivishell *shell = data;
+    struct ivicontroller_client *ctrlclient = NULL;
+    pid_t pid = 0;
+    uid_t uid = 0;
+    gid_t gid = 0;
+    uint32_t i = 0;
+    (void)signal_number;
+
+    weston_log("controller objects:\n");
+    for (i = 0; i < CONTROLLER_OBJECT_TYPE_COUNT; i++) {
+        weston_log_continue("  %-8s %u live, %u slabs, %zu bytes\n",
+                            controller_object_names[i],
+                            shell->object_pools[i].live_count,
+                            shell->object_pools[i].slab_count,
+                            ivi_object_pool_get_size(&shell->object_pools[i]));
     }
-    if (mask & IVI_NOTIFICATION_ORIENTATION) {
-        ivi_controller_surface_send_orientation(resource,
-                                                prop->orientation);
+
+    wl_list_for_each(ctrlclient, &shell->list_client, link) {
+        wl_client_get_credentials(ctrlclient->client, &pid, &uid, &gid);
+        weston_log_continue("  pid %d: %u surfaces, %u layers, %u screens, "
+                            "%zu bytes\n", (int)pid,
+                            ctrlclient->object_count[CONTROLLER_OBJECT_SURFACE],
+                            ctrlclient->object_count[CONTROLLER_OBJECT_LAYER],
+                            ctrlclient->object_count[CONTROLLER_OBJECT_SCREEN],
+                            ctrlclient->bytes);
+        weston_log_continue("    backlog %u bytes, %u max, %s, backlogged "
+                            "%u times, %u events held\n",
+                            get_client_backlog(ctrlclient->client),
+                            ctrlclient->max_backlog,
+                            ctrlclient->backlogged ? "holding events" :
+                                                     "reading",
+                            ctrlclient->backlogged_count,
+                            ctrlclient->held_events);
     }
-    if (mask & IVI_NOTIFICATION_VISIBILITY) {
-        ivi_controller_surface_send_visibility(resource,
-                                               prop->visibility);
+
+    return 1;
+}
+
+static int
+dump_controller_profile(int signal_number, void *data)
+{
+    struct ivishell *shell = data;
+    struct ivicontroller_client *ctrlclient = NULL;
+    char owner[32];
+    pid_t pid = 0;
+    uid_t uid = 0;
+    gid_t gid = 0;
+    (void)signal_number;
+
+    if (!shell->profiler.enabled) {
+        weston_log("controller-profiling is not enabled\n");
+        return 1;
     }
-    if (mask & IVI_NOTIFICATION_PIXELFORMAT) {
-        ivi_controller_surface_send_pixelformat(resource,
-                                                prop->pixelformat);
+
+    weston_log("controller timings since the last reset:\n");
+    wl_list_for_each(ctrlclient, &shell->list_client, link) {
+        wl_client_get_credentials(ctrlclient->client, &pid, &uid, &gid);
+        snprintf(owner, sizeof owner, "pid %d", (int)pid);
+        dump_profile(shell, owner, &ctrlclient->profile);
     }
-    if (mask & IVI_NOTIFICATION_ADD) {
-        send_surface_add_event(ivisurf, resource);
+    dump_profile(shell, "compositor", &shell->unattributed_profile);
+
+    return 1;
+}
+
+static int
+reset_controller_profile(int signal_number, void *data)
+{
+    struct ivishell *shell = data;
+    struct ivicontroller_client *ctrlclient = NULL;
+    (void)signal_number;
+
+    wl_list_for_each(ctrlclient, &shell->list_client, link) {
+        ivi_profile_reset(&ctrlclient->profile);
     }
+    ivi_profile_reset(&shell->unattributed_profile);
+    weston_log("controller timings reset\n");
+
+    return 1;
 }
 
 static void
-send_surface_prop(struct weston_layout_surface *layout_surface,
-                  struct weston_layout_SurfaceProperties *prop,
-                  enum weston_layout_notification_mask mask,
-                  void *userdata)
+destroy_ivicontroller_surface(struct wl_resource *resource)
 {
-    struct ivisurface *ivisurf = userdata;
+    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
     struct ivishell *shell = ivisurf->shell;
     struct ivicontroller_surface *ctrlsurf = NULL;
     uint32_t id_surface = 0;
 
-    id_surface = weston_layout_getIdOfSurface(layout_surface);
+    id_surface = weston_layout_getIdOfSurface(ivisurf->layout_surface);
 
-    wl_list_for_each(ctrlsurf, &shell->list_controller_surface, link) {
-        if (id_surface != ctrlsurf->id_surface) {
+    wl_list_for_each(ctrlsurf,
+                     get_controller_surfaces(shell, id_surface), link) {
+        if (resource != ctrlsurf->resource) {
             continue;
         }
-        send_surface_event(ctrlsurf->resource, ivisurf, prop, mask);
+
+        ivi_id_index_remove(&shell->controller_surfaces, id_surface,
+                            &ctrlsurf->link);
+        controller_object_free(shell, ctrlsurf->client,
+                               CONTROLLER_OBJECT_SURFACE, ctrlsurf);
+        break;
     }
 }
 
 static void
-send_layer_add_event(struct ivilayer *ivilayer,
-                     struct wl_resource *resource)
+destroy_ivicontroller_layer(struct wl_resource *resource)
 {
-    weston_layout_screen_ptr *pArray = NULL;
-    uint32_t length = 0;
-    int32_t ans = 0;
-    int i = 0;
-    struct link_screen *link_scrn = NULL;
-    struct link_screen *next = NULL;
-    struct iviscreen *iviscrn = NULL;
+    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
     struct ivishell *shell = ivilayer->shell;
-    int found = 0;
-    struct wl_client *client = wl_resource_get_client(resource);
-    struct wl_resource *resource_output = NULL;
+    struct ivicontroller_layer *ctrllayer = NULL;
+    uint32_t id_layer = 0;
 
-    ans = weston_layout_getScreensUnderLayer(ivilayer->layout_layer,
-                                          &length, &pArray);
-    if (0 != ans) {
-        weston_log("failed to get screens at send_layer_add_event\n");
-        return;
-    }
+    id_layer = weston_layout_getIdOfLayer(ivilayer->layout_layer);
 
-    /* Send Null to cancel added layer */
-    wl_list_for_each_safe(link_scrn, next, &ivilayer->list_screen, link) {
-        for (i = 0, found = 0; i < (int)length; i++) {
-            if (pArray[i] == link_scrn->screen->layout_screen) {
-                /* No need to send event, if new layer doesn't be added. */
-                found = 1;
-                break;
-            }
-        }
-        if (found != 0) {
+    wl_list_for_each(ctrllayer,
+                     get_controller_layers(shell, id_layer), link) {
+        if (resource != ctrllayer->resource) {
             continue;
         }
 
-        ivi_controller_layer_send_screen(resource, NULL);
-        wl_list_remove(&link_scrn->link);
-        free(link_scrn);
-        link_scrn = NULL;
+        ivi_id_index_remove(&shell->controller_layers, id_layer,
+                            &ctrllayer->link);
+        controller_object_free(shell, ctrllayer->client,
+                               CONTROLLER_OBJECT_LAYER, ctrllayer);
+        break;
     }
+}
 
-    for (i = 0; i < (int)length; i++) {
-        found = 0;
-        wl_list_for_each(link_scrn, &ivilayer->list_screen, link) {
-            if (pArray[i] == link_scrn->screen->layout_screen) {
-                /* No need to send event, if new screen doesn't be added. */
-                found = 1;
-                break;
-            }
-        }
-        if (found != 0) {
-            continue;
-        }
-
-        /* Create list_screen */
-        link_scrn = calloc(1, sizeof(*link_scrn));
-        if (NULL == link_scrn) {
-            continue;
-        }
-        wl_list_init(&link_scrn->link);
-        link_scrn->screen = NULL;
-        wl_list_for_each(iviscrn, &shell->list_screen, link) {
-            if (iviscrn->layout_screen == pArray[i]) {
-                link_scrn->screen = iviscrn;
-                break;
-            }
-        }
+static void
+destroy_ivicontroller_screen(struct wl_resource *resource)
+{
+    struct iviscreen *iviscrn = wl_resource_get_user_data(resource);
+    struct ivicontroller_screen *ctrlscrn = NULL;
+    struct ivicontroller_screen *next = NULL;
 
-        if (link_scrn->screen == NULL) {
-            free(link_scrn);
-            link_scrn = NULL;
+    wl_list_for_each_safe(ctrlscrn, next,
+                          &iviscrn->shell->list_controller_screen, link) {
+        if (resource != ctrlscrn->resource) {
             continue;
         }
-        wl_list_insert(&ivilayer->list_screen, &link_scrn->link);
 
-        /* Send new layer event */
-        resource_output =
-            wl_resource_find_for_client(&iviscrn->output->resource_list,
-                                 client);
-        if (resource_output != NULL) {
-            ivi_controller_layer_send_screen(resource, resource_output);
-        }
+        wl_list_remove(&ctrlscrn->link);
+        controller_object_free(iviscrn->shell, ctrlscrn->client,
+                               CONTROLLER_OBJECT_SCREEN, ctrlscrn);
+        ctrlscrn = NULL;
+        break;
     }
-
-    free(pArray);
-    pArray = NULL;
 }
 
 static void
-send_layer_event(struct wl_resource *resource,
-                 struct ivilayer *ivilayer,
-                 struct weston_layout_LayerProperties *prop,
-                 uint32_t mask)
+unbind_resource_controller(struct wl_resource *resource)
 {
-    if (mask & IVI_NOTIFICATION_OPACITY) {
-        ivi_controller_layer_send_opacity(resource,
-                                          prop->opacity);
-    }
-    if (mask & IVI_NOTIFICATION_SOURCE_RECT) {
-        ivi_controller_layer_send_source_rectangle(resource,
-                                          prop->sourceX,
-                                          prop->sourceY,
-                                          prop->sourceWidth,
-                                          prop->sourceHeight);
-    }
-    if (mask & IVI_NOTIFICATION_DEST_RECT) {
-        ivi_controller_layer_send_destination_rectangle(resource,
-                                          prop->destX,
-                                          prop->destY,
-                                          prop->destWidth,
-                                          prop->destHeight);
-    }
-    if (mask & IVI_NOTIFICATION_ORIENTATION) {
-        ivi_controller_layer_send_orientation(resource,
-                                          prop->orientation);
-    }
-    if (mask & IVI_NOTIFICATION_VISIBILITY) {
-        ivi_controller_layer_send_visibility(resource,
-                                          prop->visibility);
-    }
-    if (mask & IVI_NOTIFICATION_ADD) {
-        send_layer_add_event(ivilayer, resource);
+    struct ivicontroller *controller = wl_resource_get_user_data(resource);
+
+    if (wl_resource_get_version(resource) >=
+        IVI_CONTROLLER_SCENE_CHANGES_SINCE_VERSION) {
+        controller->shell->scene_controller_count--;
     }
+
+    wl_array_release(&controller->pending_changes);
+    wl_array_release(&controller->interests);
+    wl_list_remove(&controller->link);
+
+    free(controller);
+    controller = NULL;
 }
 
-static void
-send_layer_prop(struct weston_layout_layer *layer,
-                struct weston_layout_LayerProperties *prop,
-                enum weston_layout_notification_mask mask,
-                void *userdata)
+static struct ivisurface*
+get_surface(struct ivishell *shell, uint32_t id_surface)
 {
-    struct ivilayer *ivilayer = userdata;
-    struct ivicontroller_layer *ctrllayer = NULL;
-    struct ivishell *shell = ivilayer->shell;
-    uint32_t id_layout_layer = 0;
+    struct wl_list *list = ivi_id_index_find(&shell->surfaces, id_surface);
+    struct ivisurface *ivisurf = NULL;
 
-    id_layout_layer = weston_layout_getIdOfLayer(layer);
-    wl_list_for_each(ctrllayer, &shell->list_controller_layer, link) {
-        if (id_layout_layer != ctrllayer->id_layer) {
-            continue;
-        }
-        send_layer_event(ctrllayer->resource, ivilayer, prop, mask);
+    if (wl_list_empty(list)) {
+        return NULL;
     }
-}
 
-static void
-controller_surface_set_opacity(struct wl_client *client,
-                   struct wl_resource *resource,
-                   wl_fixed_t opacity)
-{
-    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
-    (void)client;
-    weston_layout_surfaceSetOpacity(ivisurf->layout_surface, (float)opacity);
+    return wl_container_of(list->next, ivisurf, id_link);
 }
 
-static void
-controller_surface_set_source_rectangle(struct wl_client *client,
-                   struct wl_resource *resource,
-                   int32_t x,
-                   int32_t y,
-                   int32_t width,
-                   int32_t height)
+static struct ivilayer*
+get_layer(struct ivishell *shell, uint32_t id_layer)
 {
-    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
-    (void)client;
-    weston_layout_surfaceSetSourceRectangle(ivisurf->layout_surface,
-            (uint32_t)x, (uint32_t)y, (uint32_t)width, (uint32_t)height);
+    struct wl_list *list = ivi_id_index_find(&shell->layers, id_layer);
+    struct ivilayer *ivilayer = NULL;
+
+    if (wl_list_empty(list)) {
+        return NULL;
+    }
+
+    return wl_container_of(list->next, ivilayer, id_link);
 }
 
-static void
-controller_surface_set_destination_rectangle(struct wl_client *client,
-                     struct wl_resource *resource,
-                     int32_t x,
-                     int32_t y,
-                     int32_t width,
-                     int32_t height)
+static const
+struct ivi_controller_screen_interface controller_screen_implementation;
+
+static struct ivicontroller_screen*
+controller_screen_create(struct ivishell *shell,
+                         struct wl_client *client,
+                         struct iviscreen *iviscrn,
+                         int version)
 {
-    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
-    (void)client;
-    weston_layout_surfaceSetDestinationRectangle(ivisurf->layout_surface,
-            (uint32_t)x, (uint32_t)y, (uint32_t)width, (uint32_t)height);
+    struct ivicontroller_screen *ctrlscrn = NULL;
+
+    ctrlscrn = controller_object_alloc(shell, client, CONTROLLER_OBJECT_SCREEN);
+    if (ctrlscrn == NULL) {
+        weston_log("no memory to allocate controller screen\n");
+        return NULL;
+    }
+
+    ctrlscrn->client = client;
+    ctrlscrn->shell  = shell;
+    ctrlscrn->id_screen = weston_layout_getIdOfScreen(iviscrn->layout_screen);
+
+    ctrlscrn->resource =
+        wl_resource_create(client, &ivi_controller_screen_interface,
+                           version, 0);
+    if (ctrlscrn->resource == NULL) {
+        weston_log("couldn't new screen controller object");
+
+        controller_object_free(shell, client, CONTROLLER_OBJECT_SCREEN,
+                               ctrlscrn);
+        ctrlscrn = NULL;
+
+        return NULL;
+    }
+
+    wl_resource_set_implementation(ctrlscrn->resource,
+                                   &controller_screen_implementation,
+                                   iviscrn, destroy_ivicontroller_screen);
+
+    wl_list_init(&ctrlscrn->link);
+    wl_list_insert(&shell->list_controller_screen, &ctrlscrn->link);
+
+    return ctrlscrn;
 }
 
-static void
-controller_surface_set_visibility(struct wl_client *client,
-                      struct wl_resource *resource,
-                      uint32_t visibility)
+static int
+compare_key(const void *a, const void *b)
 {
-    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
-    (void)client;
-    weston_layout_surfaceSetVisibility(ivisurf->layout_surface, visibility);
+    uintptr_t key_a = *(const uintptr_t *)a;
+    uintptr_t key_b = *(const uintptr_t *)b;
+
+    return (key_a > key_b) - (key_a < key_b);
 }
 
 static void
-controller_surface_set_configuration(struct wl_client *client,
-                   struct wl_resource *resource,
-                   int32_t width, int32_t height)
+membership_init(struct ivi_membership *membership)
 {
-    /* This interface has been supported yet. */
-    (void)client;
-    (void)resource;
-    (void)width;
-    (void)height;
+    wl_array_init(&membership->keys);
+    wl_array_init(&membership->added);
+    membership->removed = 0;
 }
 
 static void
-controller_surface_set_orientation(struct wl_client *client,
-                   struct wl_resource *resource,
-                   int32_t orientation)
+membership_release(struct ivi_membership *membership)
 {
-    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
-    (void)client;
-    weston_layout_surfaceSetOrientation(ivisurf->layout_surface, (uint32_t)orientation);
+    wl_array_release(&membership->keys);
+    wl_array_release(&membership->added);
 }
 
-static void
-controller_surface_screenshot(struct wl_client *client,
-                  struct wl_resource *resource,
-                  const char *filename)
+/*
+ * Replace the members by keys, which are sorted in place. The keys added
+ * and the number of keys removed are kept until the next update. Both
+ * sets are sorted, so the difference is found in a single merge pass.
+ */
+static int32_t
+membership_update(struct ivi_membership *membership,
+                  uintptr_t *keys, uint32_t length)
 {
-    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
-    (void)client;
-    weston_layout_takeSurfaceScreenshot(filename, ivisurf->layout_surface);
+    uintptr_t *old_keys = membership->keys.data;
+    uint32_t old_length = membership->keys.size / sizeof *old_keys;
+    uintptr_t *added = NULL;
+    uint32_t i = 0;
+    uint32_t j = 0;
+
+    qsort(keys, length, sizeof *keys, compare_key);
+
+    membership->added.size = 0;
+    membership->removed = 0;
+
+    while ((i < old_length) || (j < length)) {
+        if ((j == length) || ((i < old_length) && (old_keys[i] < keys[j]))) {
+            membership->removed++;
+            i++;
+        } else if ((i == old_length) || (keys[j] < old_keys[i])) {
+            added = wl_array_add(&membership->added, sizeof *added);
+            if (added == NULL) {
+                return -1;
+            }
+            *added = keys[j];
+            j++;
+        } else {
+            i++;
+            j++;
+        }
+    }
+
+    membership->keys.size = 0;
+    if (length == 0) {
+        return 0;
+    }
+
+    if (wl_array_add(&membership->keys, length * sizeof *keys) == NULL) {
+        return -1;
+    }
+    memcpy(membership->keys.data, keys, length * sizeof *keys);
+
+    return 0;
 }
 
 static void
-controller_surface_send_stats(struct wl_client *client,
-                              struct wl_resource *resource)
+update_surface_layers(struct ivisurface *ivisurf)
 {
-    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
-    pid_t pid;
-    uid_t uid;
-    gid_t gid;
-    wl_client_get_credentials(client, &pid, &uid, &gid);
+    weston_layout_layer_ptr *pArray = NULL;
+    uintptr_t *keys = NULL;
+    uint32_t length = 0;
+    uint32_t i = 0;
 
-    ivi_controller_surface_send_stats(resource, 0, 0,
-                                      ivisurf->update_count, pid, "");
+    if (0 != weston_layout_getLayersUnderSurface(ivisurf->layout_surface,
+                                                 &length, &pArray)) {
+        weston_log("failed to get layers at update_surface_layers\n");
+        return;
+    }
+
+    keys = calloc(length + 1, sizeof *keys);
+    if (keys == NULL) {
+        weston_log("no memory to update layers of surface\n");
+        free(pArray);
+        return;
+    }
+
+    for (i = 0; i < length; i++) {
+        keys[i] = weston_layout_getIdOfLayer(pArray[i]);
+    }
+
+    if (membership_update(&ivisurf->layers, keys, length) != 0) {
+        weston_log("no memory to update layers of surface\n");
+    }
+
+    free(keys);
+    free(pArray);
 }
 
+/*
+ * Send a NULL layer for every layer the surface was removed from and the
+ * controller layers of the client for every layer it was added to.
+ */
 static void
-controller_surface_destroy(struct wl_client *client,
-              struct wl_resource *resource,
-              int32_t destroy_scene_object)
+send_surface_layers(struct ivisurface *ivisurf,
+                    struct wl_resource *resource,
+                    struct wl_array *added,
+                    uint32_t removed)
 {
-    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
-    struct ivishell *shell = ivisurf->shell;
-    struct ivicontroller_surface *ctrlsurf = NULL;
-    struct ivicontroller_surface *next = NULL;
-    uint32_t id_surface = weston_layout_getIdOfSurface(ivisurf->layout_surface);
-    (void)client;
-    (void)destroy_scene_object;
+    struct wl_client *client = wl_resource_get_client(resource);
+    struct ivicontroller_layer *ctrllayer = NULL;
+    uintptr_t *id_layer = NULL;
+    uint32_t i = 0;
 
-    wl_list_for_each_safe(ctrlsurf, next,
-                          &shell->list_controller_surface, link) {
-        if (ctrlsurf->resource != resource) {
-            continue;
-        }
+    for (i = 0; i < removed; i++) {
+        ivi_controller_surface_send_layer(resource, NULL);
+    }
 
-        if (!wl_list_empty(&ctrlsurf->link)) {
-            wl_list_remove(&ctrlsurf->link);
+    wl_array_for_each(id_layer, added) {
+        wl_list_for_each(ctrllayer,
+                         get_controller_layers(ivisurf->shell,
+                                               (uint32_t)*id_layer), link) {
+            if (ctrllayer->client != client) {
+                continue;
+            }
+            ivi_controller_surface_send_layer(resource, ctrllayer->resource);
         }
-        free(ctrlsurf);
-        wl_resource_destroy(resource);
-        break;
     }
 }
 
-static void
-controller_surface_set_input_focus(struct wl_client *client,
-              struct wl_resource *resource,
-              int32_t enabled)
-{
-    (void)client;
-    (void)resource;
-    (void)enabled;
-}
+/* records per scene_changes event, keeping it below the message size limit */
+#define SCENE_CHANGES_PER_EVENT 64
 
-static const
-struct ivi_controller_surface_interface controller_surface_implementation = {
-    controller_surface_set_visibility,
-    controller_surface_set_opacity,
-    controller_surface_set_source_rectangle,
-    controller_surface_set_destination_rectangle,
-    controller_surface_set_configuration,
-    controller_surface_set_orientation,
-    controller_surface_screenshot,
-    controller_surface_send_stats,
-    controller_surface_destroy,
-    controller_surface_set_input_focus
-};
+/* fields reported to a controller which did not restrict them */
+#define SCENE_FIELDS_ALL (IVI_CONTROLLER_SCENE_FIELD_OPACITY | \
+                          IVI_CONTROLLER_SCENE_FIELD_SOURCE_RECTANGLE | \
+                          IVI_CONTROLLER_SCENE_FIELD_DESTINATION_RECTANGLE | \
+                          IVI_CONTROLLER_SCENE_FIELD_ORIENTATION | \
+                          IVI_CONTROLLER_SCENE_FIELD_VISIBILITY | \
+                          IVI_CONTROLLER_SCENE_FIELD_PIXELFORMAT)
 
-static void
-controller_layer_set_source_rectangle(struct wl_client *client,
-                   struct wl_resource *resource,
-                   int32_t x,
-                   int32_t y,
-                   int32_t width,
-                   int32_t height)
+/*
+ * Whether the id is in an interest range of the object type. With members
+ * set, only layer ranges with the members flag count.
+ */
+static int
+in_interest(struct ivicontroller *controller, uint32_t object_type,
+            uint32_t id, int members)
 {
-    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
-    (void)client;
-    weston_layout_layerSetSourceRectangle(ivilayer->layout_layer,
-           (uint32_t)x, (uint32_t)y, (uint32_t)width, (uint32_t)height);
+    struct ivi_interest *interest = NULL;
+
+    wl_array_for_each(interest, &controller->interests) {
+        if ((interest->object_type == object_type) &&
+            (id >= interest->id_min) && (id <= interest->id_max) &&
+            (!members ||
+             (interest->flags & IVI_CONTROLLER_INTEREST_FLAG_MEMBERS))) {
+            return 1;
+        }
+    }
+
+    return 0;
 }
 
-static void
-controller_layer_set_destination_rectangle(struct wl_client *client,
-                 struct wl_resource *resource,
-                 int32_t x,
-                 int32_t y,
-                 int32_t width,
-                 int32_t height)
+/* number of the layers whose members the controller is interested in */
+static uint32_t
+count_member_interests(struct ivicontroller *controller,
+                       struct wl_array *id_layers)
 {
-    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
-    (void)client;
-    weston_layout_layerSetDestinationRectangle(ivilayer->layout_layer,
-            (uint32_t)x, (uint32_t)y, (uint32_t)width, (uint32_t)height);
+    uintptr_t *id_layer = NULL;
+    uint32_t count = 0;
+
+    wl_array_for_each(id_layer, id_layers) {
+        if (in_interest(controller, IVI_CONTROLLER_OBJECT_TYPE_LAYER,
+                        (uint32_t)*id_layer, 1)) {
+            count++;
+        }
+    }
+
+    return count;
 }
 
-static void
-controller_layer_set_visibility(struct wl_client *client,
-                    struct wl_resource *resource,
-                    uint32_t visibility)
+/*
+ * Whether the surface or layer is reported to the controller. Without
+ * interest ranges, all of them are.
+ */
+static int
+is_interesting(struct ivicontroller *controller, uint32_t object_type,
+               uint32_t id)
 {
-    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
-    (void)client;
-    weston_layout_layerSetVisibility(ivilayer->layout_layer, visibility);
+    struct ivisurface *ivisurf = NULL;
+
+    if ((controller->interests.size == 0) ||
+        in_interest(controller, object_type, id, 0)) {
+        return 1;
+    }
+
+    if ((object_type != IVI_CONTROLLER_OBJECT_TYPE_SURFACE) ||
+        !controller->interest_members) {
+        return 0;
+    }
+
+    ivisurf = get_surface(controller->shell, id);
+    return (ivisurf != NULL) &&
+           (count_member_interests(controller, &ivisurf->layers.keys) > 0);
 }
 
-static void
-controller_layer_set_opacity(struct wl_client *client,
-                 struct wl_resource *resource,
-                 wl_fixed_t opacity)
+static int
+has_interest_filter(struct ivicontroller *controller)
 {
-    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
-    (void)client;
-    weston_layout_layerSetOpacity(ivilayer->layout_layer, (float)opacity);
+    return (controller->interests.size > 0) ||
+           (controller->interest_fields != SCENE_FIELDS_ALL);
 }
 
-static void
-controller_layer_set_configuration(struct wl_client *client,
-                 struct wl_resource *resource,
-                 int32_t width,
-                 int32_t height)
+/*
+ * Replace the records of filtered by the changes the controller is
+ * interested in, reduced to its fields.
+ */
+static int32_t
+filter_scene_changes(struct ivicontroller *controller,
+                     const struct ivi_scene_change *change, uint32_t count,
+                     struct wl_array *filtered)
 {
-    /* This interface has been supported yet. */
-    (void)client;
-    (void)resource;
-    (void)width;
-    (void)height;
+    struct ivi_scene_change *dst = NULL;
+    uint32_t i = 0;
+
+    filtered->size = 0;
+
+    for (i = 0; i < count; i++) {
+        if (((change[i].mask & controller->interest_fields) == 0) ||
+            !is_interesting(controller, change[i].object_type,
+                            change[i].id)) {
+            continue;
+        }
+
+        dst = wl_array_add(filtered, sizeof *dst);
+        if (dst == NULL) {
+            return -1;
+        }
+
+        *dst = change[i];
+        dst->mask &= controller->interest_fields;
+    }
+
+    return 0;
 }
 
 static void
-controller_layer_set_orientation(struct wl_client *client,
-                 struct wl_resource *resource,
-                 int32_t orientation)
+send_scene_changes(struct wl_resource *resource,
+                   struct ivi_scene_change *change, uint32_t count)
 {
-    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
-    (void)client;
-    weston_layout_layerSetOrientation(ivilayer->layout_layer, (uint32_t)orientation);
+    struct wl_array chunk;
+    uint32_t i = 0;
+    struct ivicontroller *controller = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(controller->shell, wl_resource_get_client(resource));
+
+    for (i = 0; i < count; i += SCENE_CHANGES_PER_EVENT) {
+        chunk.data = &change[i];
+        chunk.size = ((count - i) < SCENE_CHANGES_PER_EVENT) ?
+                     (count - i) : SCENE_CHANGES_PER_EVENT;
+        chunk.size *= sizeof *change;
+        chunk.alloc = chunk.size;
+
+        ivi_controller_send_scene_changes(resource, &chunk);
+    }
 }
 
-static void
-controller_layer_clear_surfaces(struct wl_client *client,
-                    struct wl_resource *resource)
+static int
+compare_scene_change(const void *lhs, const void *rhs)
 {
-    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
-    (void)client;
-    weston_layout_layerSetRenderOrder(ivilayer->layout_layer, NULL, 0);
+    const struct ivi_scene_change *a = lhs;
+    const struct ivi_scene_change *b = rhs;
+
+    if (a->object_type != b->object_type) {
+        return (a->object_type < b->object_type) ? -1 : 1;
+    }
+    if (a->id != b->id) {
+        return (a->id < b->id) ? -1 : 1;
+    }
+    return 0;
 }
 
+/*
+ * Copy the values of the fields in the mask of src over dst.
+ */
 static void
-controller_layer_add_surface(struct wl_client *client,
-                 struct wl_resource *resource,
-                 struct wl_resource *surface)
+overlay_scene_change(struct ivi_scene_change *dst,
+                     const struct ivi_scene_change *src)
 {
-    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
-    struct ivisurface *ivisurf = wl_resource_get_user_data(surface);
-    (void)client;
-    weston_layout_layerAddSurface(ivilayer->layout_layer, ivisurf->layout_surface);
+    dst->mask |= src->mask;
+    if (src->mask & IVI_CONTROLLER_SCENE_FIELD_OPACITY) {
+        dst->opacity = src->opacity;
+    }
+    if (src->mask & IVI_CONTROLLER_SCENE_FIELD_SOURCE_RECTANGLE) {
+        dst->source_x = src->source_x;
+        dst->source_y = src->source_y;
+        dst->source_width = src->source_width;
+        dst->source_height = src->source_height;
+    }
+    if (src->mask & IVI_CONTROLLER_SCENE_FIELD_DESTINATION_RECTANGLE) {
+        dst->dest_x = src->dest_x;
+        dst->dest_y = src->dest_y;
+        dst->dest_width = src->dest_width;
+        dst->dest_height = src->dest_height;
+    }
+    if (src->mask & IVI_CONTROLLER_SCENE_FIELD_ORIENTATION) {
+        dst->orientation = src->orientation;
+    }
+    if (src->mask & IVI_CONTROLLER_SCENE_FIELD_VISIBILITY) {
+        dst->visibility = src->visibility;
+    }
+    if (src->mask & IVI_CONTROLLER_SCENE_FIELD_PIXELFORMAT) {
+        dst->pixelformat = src->pixelformat;
+    }
 }
 
-static void
-controller_layer_remove_surface(struct wl_client *client,
-                    struct wl_resource *resource,
-                    struct wl_resource *surface)
+/*
+ * Merge sorted changes into the sorted pending changes of a rate limited
+ * controller, the latest value of a field wins.
+ */
+static int32_t
+merge_scene_changes(struct wl_array *pending,
+                    const struct ivi_scene_change *change, uint32_t count)
 {
-    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
-    struct ivisurface *ivisurf = wl_resource_get_user_data(surface);
-    (void)client;
-    weston_layout_layerRemoveSurface(ivilayer->layout_layer, ivisurf->layout_surface);
+    const struct ivi_scene_change *old = pending->data;
+    uint32_t old_count = pending->size / sizeof *old;
+    struct ivi_scene_change *dst = NULL;
+    struct wl_array merged;
+    uint32_t i = 0;
+    uint32_t j = 0;
+    int cmp = 0;
+
+    wl_array_init(&merged);
+
+    while ((i < old_count) || (j < count)) {
+        if (i == old_count) {
+            cmp = 1;
+        } else if (j == count) {
+            cmp = -1;
+        } else {
+            cmp = compare_scene_change(&old[i], &change[j]);
+        }
+
+        dst = wl_array_add(&merged, sizeof *dst);
+        if (dst == NULL) {
+            wl_array_release(&merged);
+            return -1;
+        }
+
+        if (cmp < 0) {
+            *dst = old[i++];
+        } else if (cmp > 0) {
+            *dst = change[j++];
+        } else {
+            *dst = old[i++];
+            overlay_scene_change(dst, &change[j++]);
+        }
+    }
+
+    wl_array_release(pending);
+    *pending = merged;
+
+    return 0;
 }
 
 static void
-controller_layer_screenshot(struct wl_client *client,
-                struct wl_resource *resource,
-                const char *filename)
+send_pending_changes(struct ivicontroller *controller)
 {
-    (void)client;
-    (void)resource;
-    (void)filename;
+    send_scene_changes(controller->resource,
+                       controller->pending_changes.data,
+                       controller->pending_changes.size /
+                       sizeof(struct ivi_scene_change));
+    controller->pending_changes.size = 0;
 }
 
 static void
-controller_layer_set_render_order(struct wl_client *client,
-                                  struct wl_resource *resource,
-                                  struct wl_array *id_surfaces)
+flush_scene_changes(void *data)
 {
-    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
-    struct weston_layout_surface **layoutsurf_array = NULL;
-    struct ivisurface *ivisurf = NULL;
-    uint32_t *id_surface = NULL;
-    uint32_t id_layout_surface = 0;
-    int i = 0;
-    (void)client;
+    struct ivishell *shell = data;
+    struct ivicontroller *controller = NULL;
+    struct ivicontroller_client *ctrlclient = NULL;
+    struct ivi_scene_change *change = shell->scene_changes.data;
+    uint32_t count = shell->scene_changes.size / sizeof *change;
+    struct ivi_scene_change *records = NULL;
+    uint32_t record_count = 0;
+    struct wl_array filtered;
+    int sorted = 0;
 
-    wl_array_for_each(id_surface, id_surfaces) {
-        wl_list_for_each(ivisurf, &ivilayer->shell->list_surface, link) {
-            id_layout_surface = weston_layout_getIdOfSurface(ivisurf->layout_surface);
-            if (*id_surface == id_layout_surface) {
-                layoutsurf_array[i] = ivisurf->layout_surface;
-                i++;
-                break;
+    shell->scene_flush_pending = 0;
+    wl_array_init(&filtered);
+
+    wl_list_for_each(controller, &shell->list_controller, link) {
+        if (wl_resource_get_version(controller->resource) <
+            IVI_CONTROLLER_SCENE_CHANGES_SINCE_VERSION) {
+            continue;
+        }
+
+        records = change;
+        record_count = count;
+        if (has_interest_filter(controller)) {
+            /* filtered copies of sorted records stay sorted */
+            if (!sorted) {
+                qsort(change, count, sizeof *change, compare_scene_change);
+                sorted = 1;
             }
+            if (filter_scene_changes(controller, change, count,
+                                     &filtered) != 0) {
+                wl_resource_post_no_memory(controller->resource);
+                continue;
+            }
+            records = filtered.data;
+            record_count = filtered.size / sizeof *records;
+            if (record_count == 0) {
+                continue;
+            }
+        }
+
+        /* a backlogged client gets the merged changes once it caught up */
+        ctrlclient = find_backlogged_client(controller->client);
+        if (ctrlclient != NULL) {
+            ctrlclient->held_events += record_count;
+        } else if (controller->event_rate ==
+                   IVI_CONTROLLER_EVENT_RATE_IMMEDIATE) {
+            send_scene_changes(controller->resource, records, record_count);
+            continue;
+        }
+
+        /* the records are not looked up by index after the flush */
+        if (!sorted) {
+            qsort(change, count, sizeof *change, compare_scene_change);
+            sorted = 1;
+        }
+        if (merge_scene_changes(&controller->pending_changes,
+                                records, record_count) != 0) {
+            wl_resource_post_no_memory(controller->resource);
         }
     }
 
-    weston_layout_layerSetRenderOrder(ivilayer->layout_layer,
-                                   layoutsurf_array, id_surfaces->size);
-    free(layoutsurf_array);
+    wl_array_release(&filtered);
+
+    /* invalidates the records of all surfaces and layers */
+    shell->scene_changes.size = 0;
+    shell->scene_serial++;
+    if (shell->scene_serial == 0) {
+        shell->scene_serial = 1;
+    }
 }
 
-static void
-controller_layer_destroy(struct wl_client *client,
-              struct wl_resource *resource,
-              int32_t destroy_scene_object)
+/*
+ * Return the record of the object in the pending scene changes, appending
+ * one if the object has not changed since the last flush.
+ */
+static struct ivi_scene_change *
+get_scene_change(struct ivishell *shell, uint32_t *serial, uint32_t *index,
+                 uint32_t object_type, uint32_t id)
 {
-    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
-    struct ivishell *shell = ivilayer->shell;
-    struct ivicontroller_layer *ctrllayer = NULL;
-    uint32_t id_layer = weston_layout_getIdOfLayer(ivilayer->layout_layer);
-    (void)client;
-    (void)destroy_scene_object;
+    struct ivi_scene_change *change = NULL;
+    struct wl_event_loop *loop = NULL;
 
-    wl_list_for_each(ctrllayer, &shell->list_controller_layer, link) {
-        if (ctrllayer->id_layer != id_layer) {
-            continue;
-        }
+    if (*serial == shell->scene_serial) {
+        change = shell->scene_changes.data;
+        return &change[*index];
+    }
+
+    change = wl_array_add(&shell->scene_changes, sizeof *change);
+    if (change == NULL) {
+        return NULL;
+    }
 
-        if (!wl_list_empty(&ctrllayer->link)) {
-            wl_list_remove(&ctrllayer->link);
+    memset(change, 0, sizeof *change);
+    change->object_type = object_type;
+    change->id = id;
+    *serial = shell->scene_serial;
+    *index = shell->scene_changes.size / sizeof *change - 1;
+
+    if (!shell->scene_flush_pending) {
+        loop = wl_display_get_event_loop(shell->compositor->wl_display);
+        if (wl_event_loop_add_idle(loop, flush_scene_changes, shell) != NULL) {
+            shell->scene_flush_pending = 1;
+        } else {
+            weston_log("failed to schedule sending of scene changes\n");
         }
-        free(ctrllayer);
-        wl_resource_destroy(resource);
-        break;
     }
 
-    weston_layout_layerRemove(ivilayer->layout_layer);
+    return change;
 }
 
-static const
-struct ivi_controller_layer_interface controller_layer_implementation = {
+static uint32_t
+get_scene_mask(uint32_t mask)
+{
+    uint32_t scene_mask = 0;
+
+    if (mask & IVI_NOTIFICATION_OPACITY) {
+        scene_mask |= IVI_CONTROLLER_SCENE_FIELD_OPACITY;
+    }
+    if (mask & IVI_NOTIFICATION_SOURCE_RECT) {
+        scene_mask |= IVI_CONTROLLER_SCENE_FIELD_SOURCE_RECTANGLE;
+    }
+    if (mask & IVI_NOTIFICATION_DEST_RECT) {
+        scene_mask |= IVI_CONTROLLER_SCENE_FIELD_DESTINATION_RECTANGLE;
+    }
+    if (mask & IVI_NOTIFICATION_ORIENTATION) {
+        scene_mask |= IVI_CONTROLLER_SCENE_FIELD_ORIENTATION;
+    }
+    if (mask & IVI_NOTIFICATION_VISIBILITY) {
+        scene_mask |= IVI_CONTROLLER_SCENE_FIELD_VISIBILITY;
+    }
+    if (mask & IVI_NOTIFICATION_PIXELFORMAT) {
+        scene_mask |= IVI_CONTROLLER_SCENE_FIELD_PIXELFORMAT;
+    }
+
+    return scene_mask;
+}
+
+static void
+set_surface_change(struct ivi_scene_change *change,
+                   struct weston_layout_SurfaceProperties *prop,
+                   uint32_t mask)
+{
+    change->mask |= get_scene_mask(mask);
+    if (mask & IVI_NOTIFICATION_OPACITY) {
+        change->opacity = (wl_fixed_t)prop->opacity;
+    }
+    if (mask & IVI_NOTIFICATION_SOURCE_RECT) {
+        change->source_x = prop->sourceX;
+        change->source_y = prop->sourceY;
+        change->source_width = prop->sourceWidth;
+        change->source_height = prop->sourceHeight;
+    }
+    if (mask & IVI_NOTIFICATION_DEST_RECT) {
+        change->dest_x = prop->destX;
+        change->dest_y = prop->destY;
+        change->dest_width = prop->destWidth;
+        change->dest_height = prop->destHeight;
+    }
+    if (mask & IVI_NOTIFICATION_ORIENTATION) {
+        change->orientation = prop->orientation;
+    }
+    if (mask & IVI_NOTIFICATION_VISIBILITY) {
+        change->visibility = prop->visibility;
+    }
+    if (mask & IVI_NOTIFICATION_PIXELFORMAT) {
+        change->pixelformat = prop->pixelformat;
+    }
+}
+
+static void
+record_surface_change(struct ivisurface *ivisurf, uint32_t id_surface,
+                      struct weston_layout_SurfaceProperties *prop,
+                      uint32_t mask)
+{
+    struct ivishell *shell = ivisurf->shell;
+    struct ivi_scene_change *change = NULL;
+
+    if ((get_scene_mask(mask) == 0) || (shell->scene_controller_count == 0)) {
+        return;
+    }
+
+    change = get_scene_change(shell, &ivisurf->scene_serial,
+                              &ivisurf->scene_index,
+                              IVI_CONTROLLER_OBJECT_TYPE_SURFACE, id_surface);
+    if (change == NULL) {
+        weston_log("no memory to record surface change\n");
+        return;
+    }
+
+    set_surface_change(change, prop, mask);
+}
+
+static void
+set_layer_change(struct ivi_scene_change *change,
+                 struct weston_layout_LayerProperties *prop,
+                 uint32_t mask)
+{
+    /* layers have no pixelformat */
+    mask &= ~IVI_NOTIFICATION_PIXELFORMAT;
+    change->mask |= get_scene_mask(mask);
+    if (mask & IVI_NOTIFICATION_OPACITY) {
+        change->opacity = (wl_fixed_t)prop->opacity;
+    }
+    if (mask & IVI_NOTIFICATION_SOURCE_RECT) {
+        change->source_x = prop->sourceX;
+        change->source_y = prop->sourceY;
+        change->source_width = prop->sourceWidth;
+        change->source_height = prop->sourceHeight;
+    }
+    if (mask & IVI_NOTIFICATION_DEST_RECT) {
+        change->dest_x = prop->destX;
+        change->dest_y = prop->destY;
+        change->dest_width = prop->destWidth;
+        change->dest_height = prop->destHeight;
+    }
+    if (mask & IVI_NOTIFICATION_ORIENTATION) {
+        change->orientation = prop->orientation;
+    }
+    if (mask & IVI_NOTIFICATION_VISIBILITY) {
+        change->visibility = prop->visibility;
+    }
+}
+
+static void
+record_layer_change(struct ivilayer *ivilayer, uint32_t id_layer,
+                    struct weston_layout_LayerProperties *prop,
+                    uint32_t mask)
+{
+    struct ivishell *shell = ivilayer->shell;
+    struct ivi_scene_change *change = NULL;
+
+    mask &= ~IVI_NOTIFICATION_PIXELFORMAT;
+    if ((get_scene_mask(mask) == 0) || (shell->scene_controller_count == 0)) {
+        return;
+    }
+
+    change = get_scene_change(shell, &ivilayer->scene_serial,
+                              &ivilayer->scene_index,
+                              IVI_CONTROLLER_OBJECT_TYPE_LAYER, id_layer);
+    if (change == NULL) {
+        weston_log("no memory to record layer change\n");
+        return;
+    }
+
+    set_layer_change(change, prop, mask);
+}
+
+static void
+send_surface_event(struct wl_resource *resource,
+                   struct weston_layout_SurfaceProperties *prop,
+                   uint32_t mask)
+{
+    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(ivisurf->shell, wl_resource_get_client(resource));
+
+    if (mask & IVI_NOTIFICATION_OPACITY) {
+        ivi_controller_surface_send_opacity(resource,
+                                            prop->opacity);
+    }
+    if (mask & IVI_NOTIFICATION_SOURCE_RECT) {
+        ivi_controller_surface_send_source_rectangle(resource,
+            prop->sourceX, prop->sourceY,
+            prop->sourceWidth, prop->sourceHeight);
+    }
+    if (mask & IVI_NOTIFICATION_DEST_RECT) {
+        ivi_controller_surface_send_destination_rectangle(resource,
+            prop->destX, prop->destY,
+            prop->destWidth, prop->destHeight);
+    }
+    if (mask & IVI_NOTIFICATION_ORIENTATION) {
+        ivi_controller_surface_send_orientation(resource,
+                                                prop->orientation);
+    }
+    if (mask & IVI_NOTIFICATION_VISIBILITY) {
+        ivi_controller_surface_send_visibility(resource,
+                                               prop->visibility);
+    }
+    if (mask & IVI_NOTIFICATION_PIXELFORMAT) {
+        ivi_controller_surface_send_pixelformat(resource,
+                                                prop->pixelformat);
+    }
+}
+
+/*
+ * Announce a surface which was added to layers to the controllers which
+ * are interested in the members of one of them and did not know the
+ * surface before. Its properties follow in scene_changes.
+ */
+static void
+announce_member_surface(struct ivisurface *ivisurf, uint32_t id_surface,
+                        struct weston_layout_SurfaceProperties *prop)
+{
+    struct ivicontroller *controller = NULL;
+    uint32_t added = 0;
+    int announced = 0;
+
+    wl_list_for_each(controller, &ivisurf->shell->list_controller, link) {
+        if (!controller->interest_members ||
+            in_interest(controller, IVI_CONTROLLER_OBJECT_TYPE_SURFACE,
+                        id_surface, 0)) {
+            continue;
+        }
+
+        /* the layers added are part of all layers of the surface */
+        added = count_member_interests(controller, &ivisurf->layers.added);
+        if ((added == 0) ||
+            (count_member_interests(controller,
+                                    &ivisurf->layers.keys) != added)) {
+            continue;
+        }
+
+        ivi_controller_send_surface(controller->resource, id_surface);
+        announced = 1;
+    }
+
+    if (announced) {
+        record_surface_change(ivisurf, id_surface, prop,
+                              IVI_NOTIFICATION_ALL);
+    }
+}
+
+static void
+send_surface_prop(struct weston_layout_surface *layout_surface,
+                  struct weston_layout_SurfaceProperties *prop,
+                  enum weston_layout_notification_mask mask,
+                  void *userdata)
+{
+    struct ivisurface *ivisurf = userdata;
+    struct ivishell *shell = ivisurf->shell;
+    struct ivicontroller_surface *ctrlsurf = NULL;
+    uint32_t id_surface = 0;
+    PROFILE_SCOPE(shell, NULL);
+
+    id_surface = weston_layout_getIdOfSurface(layout_surface);
+
+    /* the change of the layers is shared by all controller surfaces */
+    if (mask & IVI_NOTIFICATION_ADD) {
+        update_surface_layers(ivisurf);
+        announce_member_surface(ivisurf, id_surface, prop);
+    }
+
+    /* controller surfaces of version 5 get the properties by scene_changes */
+    record_surface_change(ivisurf, id_surface, prop, mask);
+
+    wl_list_for_each(ctrlsurf,
+                     get_controller_surfaces(shell, id_surface), link) {
+        if (wl_resource_get_version(ctrlsurf->resource) <
+            IVI_CONTROLLER_SCENE_CHANGES_SINCE_VERSION) {
+            if (!hold_property_events(ctrlsurf->client,
+                                      &ctrlsurf->held_mask, mask)) {
+                send_surface_event(ctrlsurf->resource, prop, mask);
+            }
+        }
+        if (mask & IVI_NOTIFICATION_ADD) {
+            send_surface_layers(ivisurf, ctrlsurf->resource,
+                                &ivisurf->layers.added,
+                                ivisurf->layers.removed);
+        }
+    }
+}
+
+static void
+update_layer_screens(struct ivilayer *ivilayer)
+{
+    weston_layout_screen_ptr *pArray = NULL;
+    uintptr_t *keys = NULL;
+    uint32_t length = 0;
+    uint32_t i = 0;
+
+    if (0 != weston_layout_getScreensUnderLayer(ivilayer->layout_layer,
+                                                &length, &pArray)) {
+        weston_log("failed to get screens at update_layer_screens\n");
+        return;
+    }
+
+    keys = calloc(length + 1, sizeof *keys);
+    if (keys == NULL) {
+        weston_log("no memory to update screens of layer\n");
+        free(pArray);
+        return;
+    }
+
+    for (i = 0; i < length; i++) {
+        keys[i] = (uintptr_t)pArray[i];
+    }
+
+    if (membership_update(&ivilayer->screens, keys, length) != 0) {
+        weston_log("no memory to update screens of layer\n");
+    }
+
+    free(keys);
+    free(pArray);
+}
+
+/*
+ * Send a NULL output for every screen the layer was removed from and the
+ * wl_output of the client for every screen it was added to.
+ */
+static void
+send_layer_screens(struct ivilayer *ivilayer,
+                   struct wl_resource *resource,
+                   struct wl_array *added,
+                   uint32_t removed)
+{
+    struct wl_client *client = wl_resource_get_client(resource);
+    struct wl_resource *resource_output = NULL;
+    struct iviscreen *iviscrn = NULL;
+    uintptr_t *layout_screen = NULL;
+    uint32_t i = 0;
+
+    for (i = 0; i < removed; i++) {
+        ivi_controller_layer_send_screen(resource, NULL);
+    }
+
+    wl_array_for_each(layout_screen, added) {
+        wl_list_for_each(iviscrn, &ivilayer->shell->list_screen, link) {
+            if ((uintptr_t)iviscrn->layout_screen != *layout_screen) {
+                continue;
+            }
+
+            resource_output =
+                wl_resource_find_for_client(&iviscrn->output->resource_list,
+                                            client);
+            if (resource_output != NULL) {
+                ivi_controller_layer_send_screen(resource, resource_output);
+            }
+        }
+    }
+}
+
+static void
+send_layer_event(struct wl_resource *resource,
+                 struct weston_layout_LayerProperties *prop,
+                 uint32_t mask)
+{
+    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(ivilayer->shell, wl_resource_get_client(resource));
+
+    if (mask & IVI_NOTIFICATION_OPACITY) {
+        ivi_controller_layer_send_opacity(resource,
+                                          prop->opacity);
+    }
+    if (mask & IVI_NOTIFICATION_SOURCE_RECT) {
+        ivi_controller_layer_send_source_rectangle(resource,
+                                          prop->sourceX,
+                                          prop->sourceY,
+                                          prop->sourceWidth,
+                                          prop->sourceHeight);
+    }
+    if (mask & IVI_NOTIFICATION_DEST_RECT) {
+        ivi_controller_layer_send_destination_rectangle(resource,
+                                          prop->destX,
+                                          prop->destY,
+                                          prop->destWidth,
+                                          prop->destHeight);
+    }
+    if (mask & IVI_NOTIFICATION_ORIENTATION) {
+        ivi_controller_layer_send_orientation(resource,
+                                          prop->orientation);
+    }
+    if (mask & IVI_NOTIFICATION_VISIBILITY) {
+        ivi_controller_layer_send_visibility(resource,
+                                          prop->visibility);
+    }
+}
+
+static void
+send_layer_prop(struct weston_layout_layer *layer,
+                struct weston_layout_LayerProperties *prop,
+                enum weston_layout_notification_mask mask,
+                void *userdata)
+{
+    struct ivilayer *ivilayer = userdata;
+    struct ivicontroller_layer *ctrllayer = NULL;
+    struct ivishell *shell = ivilayer->shell;
+    uint32_t id_layout_layer = 0;
+    PROFILE_SCOPE(shell, NULL);
+
+    id_layout_layer = weston_layout_getIdOfLayer(layer);
+
+    /* the change of the screens is shared by all controller layers */
+    if (mask & IVI_NOTIFICATION_ADD) {
+        update_layer_screens(ivilayer);
+    }
+
+    /* controller layers of version 5 get the properties by scene_changes */
+    record_layer_change(ivilayer, id_layout_layer, prop, mask);
+
+    wl_list_for_each(ctrllayer,
+                     get_controller_layers(shell, id_layout_layer), link) {
+        if (wl_resource_get_version(ctrllayer->resource) <
+            IVI_CONTROLLER_SCENE_CHANGES_SINCE_VERSION) {
+            if (!hold_property_events(ctrllayer->client,
+                                      &ctrllayer->held_mask, mask)) {
+                send_layer_event(ctrllayer->resource, prop, mask);
+            }
+        }
+        if (mask & IVI_NOTIFICATION_ADD) {
+            send_layer_screens(ivilayer, ctrllayer->resource,
+                               &ivilayer->screens.added,
+                               ivilayer->screens.removed);
+        }
+    }
+}
+
+static void
+free_staged(struct ivi_staged *staged)
+{
+    wl_list_remove(&staged->link);
+    wl_array_release(&staged->order);
+    free(staged);
+}
+
+/*
+ * Copy the committed render order of the layer or screen of the entry into
+ * its order. Returns -1 if no memory is left.
+ */
+static int
+get_committed_order(struct ivi_staged *staged)
+{
+    void **pArray = NULL;
+    void *order = NULL;
+    uint32_t length = 0;
+    int32_t ans = 0;
+
+    if (staged->layout_layer != NULL) {
+        ans = weston_layout_getSurfacesOnLayer(staged->layout_layer, &length,
+                  (struct weston_layout_surface ***)&pArray);
+    } else {
+        ans = weston_layout_getLayersOnScreen(staged->layout_screen, &length,
+                  (struct weston_layout_layer ***)&pArray);
+    }
+    if (ans != 0) {
+        return 0;
+    }
+
+    staged->order.size = 0;
+    if (length > 0) {
+        order = wl_array_add(&staged->order, length * sizeof *pArray);
+        if (order == NULL) {
+            free(pArray);
+            return -1;
+        }
+        memcpy(order, pArray, length * sizeof *pArray);
+    }
+    free(pArray);
+
+    return 0;
+}
+
+/*
+ * Entry of the property, created if the property was not staged yet. The
+ * order of a new entry starts from the committed one. Returns NULL if no
+ * memory is left.
+ */
+static struct ivi_staged *
+stage_property(struct ivishell *shell, struct wl_client *client,
+               struct weston_layout_surface *layout_surface,
+               struct weston_layout_layer *layout_layer,
+               struct weston_layout_screen *layout_screen,
+               enum staged_property property)
+{
+    struct ivi_staged *staged = NULL;
+
+    wl_list_for_each(staged, &shell->list_staged, link) {
+        if ((staged->property == property) &&
+            (staged->layout_surface == layout_surface) &&
+            (staged->layout_layer == layout_layer) &&
+            (staged->layout_screen == layout_screen)) {
+            staged->client = client;
+            return staged;
+        }
+    }
+
+    staged = calloc(1, sizeof *staged);
+    if (staged == NULL) {
+        return NULL;
+    }
+
+    staged->client = client;
+    staged->layout_surface = layout_surface;
+    staged->layout_layer = layout_layer;
+    staged->layout_screen = layout_screen;
+    staged->property = property;
+    wl_array_init(&staged->order);
+    if ((property == STAGED_RENDER_ORDER) &&
+        (get_committed_order(staged) != 0)) {
+        wl_array_release(&staged->order);
+        free(staged);
+        return NULL;
+    }
+
+    wl_list_insert(shell->list_staged.prev, &staged->link);
+    return staged;
+}
+
+static int
+find_in_order(struct wl_array *order, void *object)
+{
+    void **entry = NULL;
+    int index = 0;
+
+    wl_array_for_each(entry, order) {
+        if (*entry == object) {
+            return index;
+        }
+        index++;
+    }
+
+    return -1;
+}
+
+/*
+ * Add the object on top of the staged order, unless it is contained
+ * already. Returns -1 if no memory is left.
+ */
+static int
+add_to_order(struct wl_array *order, void *object)
+{
+    void **entry = NULL;
+
+    if (find_in_order(order, object) >= 0) {
+        return 0;
+    }
+
+    entry = wl_array_add(order, sizeof *entry);
+    if (entry == NULL) {
+        return -1;
+    }
+    *entry = object;
+
+    return 0;
+}
+
+static void
+remove_from_order(struct wl_array *order, void *object)
+{
+    void **entries = order->data;
+    uint32_t count = order->size / sizeof *entries;
+    int index = find_in_order(order, object);
+
+    if (index < 0) {
+        return;
+    }
+
+    memmove(&entries[index], &entries[index + 1],
+            (count - (uint32_t)index - 1) * sizeof *entries);
+    order->size -= sizeof *entries;
+}
+
+/*
+ * Set the staged value into the pending state of weston_layout.
+ */
+static void
+apply_staged(struct ivi_staged *staged)
+{
+    const int32_t *v = staged->value;
+    uint32_t count = staged->order.size / sizeof(void *);
+
+    switch (staged->property) {
+    case STAGED_OPACITY:
+        if (staged->layout_surface != NULL) {
+            weston_layout_surfaceSetOpacity(staged->layout_surface,
+                                            staged->opacity);
+        } else {
+            weston_layout_layerSetOpacity(staged->layout_layer,
+                                          staged->opacity);
+        }
+        break;
+    case STAGED_SOURCE_RECTANGLE:
+        if (staged->layout_surface != NULL) {
+            weston_layout_surfaceSetSourceRectangle(staged->layout_surface,
+                (uint32_t)v[0], (uint32_t)v[1], (uint32_t)v[2], (uint32_t)v[3]);
+        } else {
+            weston_layout_layerSetSourceRectangle(staged->layout_layer,
+                (uint32_t)v[0], (uint32_t)v[1], (uint32_t)v[2], (uint32_t)v[3]);
+        }
+        break;
+    case STAGED_DESTINATION_RECTANGLE:
+        if (staged->layout_surface != NULL) {
+            weston_layout_surfaceSetDestinationRectangle(
+                staged->layout_surface,
+                v[0], v[1], (uint32_t)v[2], (uint32_t)v[3]);
+        } else {
+            weston_layout_layerSetDestinationRectangle(staged->layout_layer,
+                v[0], v[1], (uint32_t)v[2], (uint32_t)v[3]);
+        }
+        break;
+    case STAGED_VISIBILITY:
+        if (staged->layout_surface != NULL) {
+            weston_layout_surfaceSetVisibility(staged->layout_surface,
+                                               (uint32_t)v[0]);
+        } else {
+            weston_layout_layerSetVisibility(staged->layout_layer,
+                                             (uint32_t)v[0]);
+        }
+        break;
+    case STAGED_ORIENTATION:
+        if (staged->layout_surface != NULL) {
+            weston_layout_surfaceSetOrientation(staged->layout_surface,
+                                                (uint32_t)v[0]);
+        } else {
+            weston_layout_layerSetOrientation(staged->layout_layer,
+                                              (uint32_t)v[0]);
+        }
+        break;
+    case STAGED_RENDER_ORDER:
+        if (staged->layout_layer != NULL) {
+            weston_layout_layerSetRenderOrder(staged->layout_layer,
+                staged->order.data, count);
+        } else {
+            weston_layout_screenSetRenderOrder(staged->layout_screen,
+                staged->order.data, count);
+        }
+        break;
+    }
+}
+
+/*
+ * Set the committed value of the staged property into the pending state
+ * of weston_layout. The entry keeps the staged value.
+ */
+static void
+reset_staged(struct ivi_staged *staged)
+{
+    struct weston_layout_SurfaceProperties surface_prop;
+    struct weston_layout_LayerProperties layer_prop;
+    struct ivi_staged committed = *staged;
+
+    memset(&surface_prop, 0, sizeof surface_prop);
+    memset(&layer_prop, 0, sizeof layer_prop);
+
+    if (staged->property == STAGED_RENDER_ORDER) {
+        wl_array_init(&committed.order);
+        if (get_committed_order(&committed) == 0) {
+            apply_staged(&committed);
+        }
+        wl_array_release(&committed.order);
+        return;
+    }
+
+    if (staged->layout_surface != NULL) {
+        weston_layout_getPropertiesOfSurface(staged->layout_surface,
+                                             &surface_prop);
+        layer_prop.opacity = surface_prop.opacity;
+        layer_prop.sourceX = surface_prop.sourceX;
+        layer_prop.sourceY = surface_prop.sourceY;
+        layer_prop.sourceWidth = surface_prop.sourceWidth;
+        layer_prop.sourceHeight = surface_prop.sourceHeight;
+        layer_prop.destX = surface_prop.destX;
+        layer_prop.destY = surface_prop.destY;
+        layer_prop.destWidth = surface_prop.destWidth;
+        layer_prop.destHeight = surface_prop.destHeight;
+        layer_prop.visibility = surface_prop.visibility;
+        layer_prop.orientation = surface_prop.orientation;
+    } else {
+        weston_layout_getPropertiesOfLayer(staged->layout_layer, &layer_prop);
+    }
+
+    committed.opacity = layer_prop.opacity;
+    switch (staged->property) {
+    case STAGED_SOURCE_RECTANGLE:
+        committed.value[0] = (int32_t)layer_prop.sourceX;
+        committed.value[1] = (int32_t)layer_prop.sourceY;
+        committed.value[2] = (int32_t)layer_prop.sourceWidth;
+        committed.value[3] = (int32_t)layer_prop.sourceHeight;
+        break;
+    case STAGED_DESTINATION_RECTANGLE:
+        committed.value[0] = layer_prop.destX;
+        committed.value[1] = layer_prop.destY;
+        committed.value[2] = (int32_t)layer_prop.destWidth;
+        committed.value[3] = (int32_t)layer_prop.destHeight;
+        break;
+    case STAGED_VISIBILITY:
+        committed.value[0] = (int32_t)layer_prop.visibility;
+        break;
+    case STAGED_ORIENTATION:
+        committed.value[0] = (int32_t)layer_prop.orientation;
+        break;
+    default:
+        break;
+    }
+    apply_staged(&committed);
+}
+
+static int
+has_frame_commit(struct ivishell *shell, struct wl_client *client)
+{
+    struct ivicontroller_commit_feedback *feedback = NULL;
+
+    if (client == NULL) {
+        return 0;
+    }
+
+    wl_list_for_each(feedback, &shell->list_commit_pending, link) {
+        if (wl_resource_get_client(feedback->resource) == client) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Before a commit of the shell, put back the committed values of the
+ * properties which are not part of it: all of them for changes of the shell
+ * alone, those of clients without a frame aligned commit at a frame.
+ */
+static void
+hold_staged_changes(struct ivishell *shell, int frame)
+{
+    struct ivi_staged *staged = NULL;
+
+    wl_list_for_each(staged, &shell->list_staged, link) {
+        staged->held = !frame || !has_frame_commit(shell, staged->client);
+        if (staged->held) {
+            reset_staged(staged);
+        }
+    }
+}
+
+/*
+ * After a commit of the shell, set the held properties again. The others
+ * were committed.
+ */
+static void
+restage_held_changes(struct ivishell *shell)
+{
+    struct ivi_staged *staged = NULL;
+    struct ivi_staged *next = NULL;
+
+    wl_list_for_each_safe(staged, next, &shell->list_staged, link) {
+        if (!staged->held) {
+            free_staged(staged);
+            continue;
+        }
+
+        apply_staged(staged);
+    }
+}
+
+/*
+ * All staged properties were committed by a controller.
+ */
+static void
+clear_staged_changes(struct ivishell *shell)
+{
+    struct ivi_staged *staged = NULL;
+    struct ivi_staged *next = NULL;
+
+    wl_list_for_each_safe(staged, next, &shell->list_staged, link) {
+        free_staged(staged);
+    }
+}
+
+/*
+ * Forget the staged properties of a removed surface or layer, and take it
+ * out of the staged orders.
+ */
+static void
+forget_staged_object(struct ivishell *shell,
+                     struct weston_layout_surface *layout_surface,
+                     struct weston_layout_layer *layout_layer)
+{
+    struct ivi_staged *staged = NULL;
+    struct ivi_staged *next = NULL;
+    void *object = (layout_surface != NULL) ? (void *)layout_surface :
+                                              (void *)layout_layer;
+
+    wl_list_for_each_safe(staged, next, &shell->list_staged, link) {
+        if (((layout_surface != NULL) &&
+             (staged->layout_surface == layout_surface)) ||
+            ((layout_layer != NULL) &&
+             (staged->layout_layer == layout_layer))) {
+            free_staged(staged);
+        } else if (staged->property == STAGED_RENDER_ORDER) {
+            remove_from_order(&staged->order, object);
+        }
+    }
+}
+
+static uint64_t
+get_monotonic_time(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static int
+is_transition_of(struct ivi_transition *transition,
+                 struct weston_layout_surface *layout_surface,
+                 struct weston_layout_layer *layout_layer,
+                 uint32_t property)
+{
+    return (transition->layout_surface == layout_surface) &&
+           (transition->layout_layer == layout_layer) &&
+           ((transition->property & property) != 0);
+}
+
+static void
+free_transition(struct ivi_transition *transition)
+{
+    wl_list_remove(&transition->link);
+    free(transition);
+}
+
+/*
+ * Stop the transitions of the properties of a surface or a layer, e.g.
+ * because the property was set or the object was removed.
+ */
+static void
+cancel_transitions(struct ivishell *shell,
+                   struct weston_layout_surface *layout_surface,
+                   struct weston_layout_layer *layout_layer,
+                   uint32_t property)
+{
+    struct ivi_transition *transition = NULL;
+    struct ivi_transition *next = NULL;
+
+    wl_list_for_each_safe(transition, next, &shell->list_transition, link) {
+        if (is_transition_of(transition, layout_surface, layout_layer,
+                             property)) {
+            free_transition(transition);
+        }
+    }
+}
+
+/*
+ * Queue a transition until the next commit. A transition of the same
+ * property which is not committed yet is replaced.
+ */
+static void
+create_transition(struct ivishell *shell,
+                  struct wl_resource *resource,
+                  struct weston_layout_surface *layout_surface,
+                  struct weston_layout_layer *layout_layer,
+                  enum transition_property property,
+                  const float to[4],
+                  uint32_t duration,
+                  uint32_t easing)
+{
+    struct ivi_transition *transition = NULL;
+    struct ivi_transition *next = NULL;
+
+    if (easing > IVI_CONTROLLER_TRANSITION_EASING_EASE_IN_OUT) {
+        wl_resource_post_error(resource,
+                               (layout_surface != NULL) ?
+                               IVI_CONTROLLER_SURFACE_ERROR_BAD_EASING :
+                               IVI_CONTROLLER_LAYER_ERROR_BAD_EASING,
+                               "unknown transition easing %u", easing);
+        return;
+    }
+
+    wl_list_for_each_safe(transition, next, &shell->list_transition, link) {
+        if ((transition->start_time == 0) &&
+            is_transition_of(transition, layout_surface, layout_layer,
+                             property)) {
+            free_transition(transition);
+        }
+    }
+
+    transition = calloc(1, sizeof *transition);
+    if (transition == NULL) {
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+
+    transition->layout_surface = layout_surface;
+    transition->layout_layer = layout_layer;
+    transition->property = property;
+    transition->easing = easing;
+    transition->duration = (uint64_t)duration * 1000;
+    memcpy(transition->to, to, sizeof transition->to);
+    wl_list_insert(shell->list_transition.prev, &transition->link);
+}
+
+static void
+get_transition_value(struct ivi_transition *transition, float value[4])
+{
+    struct weston_layout_SurfaceProperties surface_prop;
+    struct weston_layout_LayerProperties layer_prop;
+
+    memset(&surface_prop, 0, sizeof surface_prop);
+    memset(&layer_prop, 0, sizeof layer_prop);
+
+    if (transition->layout_surface != NULL) {
+        weston_layout_getPropertiesOfSurface(transition->layout_surface,
+                                             &surface_prop);
+        layer_prop.opacity = surface_prop.opacity;
+        layer_prop.destX = surface_prop.destX;
+        layer_prop.destY = surface_prop.destY;
+        layer_prop.destWidth = surface_prop.destWidth;
+        layer_prop.destHeight = surface_prop.destHeight;
+    } else {
+        weston_layout_getPropertiesOfLayer(transition->layout_layer,
+                                           &layer_prop);
+    }
+
+    if (transition->property == TRANSITION_OPACITY) {
+        value[0] = layer_prop.opacity;
+        return;
+    }
+
+    value[0] = (float)(int32_t)layer_prop.destX;
+    value[1] = (float)(int32_t)layer_prop.destY;
+    value[2] = (float)(int32_t)layer_prop.destWidth;
+    value[3] = (float)(int32_t)layer_prop.destHeight;
+}
+
+static uint32_t
+round_to_pixel(float value)
+{
+    return (uint32_t)(int32_t)((value < 0.0f) ? (value - 0.5f) :
+                                                (value + 0.5f));
+}
+
+static void
+set_transition_value(struct ivi_transition *transition, const float value[4])
+{
+    if (transition->property == TRANSITION_OPACITY) {
+        if (transition->layout_surface != NULL) {
+            weston_layout_surfaceSetOpacity(transition->layout_surface,
+                                            value[0]);
+        } else {
+            weston_layout_layerSetOpacity(transition->layout_layer,
+                                          value[0]);
+        }
+        return;
+    }
+
+    if (transition->layout_surface != NULL) {
+        weston_layout_surfaceSetDestinationRectangle(
+            transition->layout_surface,
+            round_to_pixel(value[0]), round_to_pixel(value[1]),
+            round_to_pixel(value[2]), round_to_pixel(value[3]));
+    } else {
+        weston_layout_layerSetDestinationRectangle(
+            transition->layout_layer,
+            round_to_pixel(value[0]), round_to_pixel(value[1]),
+            round_to_pixel(value[2]), round_to_pixel(value[3]));
+    }
+}
+
+static void
+mark_screens_of_layer(struct ivishell *shell,
+                      struct weston_layout_layer *layout_layer)
+{
+    struct weston_layout_screen **pArray = NULL;
+    struct iviscreen *iviscrn = NULL;
+    uint32_t length = 0;
+    uint32_t i = 0;
+
+    if (weston_layout_getScreensUnderLayer(layout_layer,
+                                           &length, &pArray) != 0) {
+        return;
+    }
+
+    wl_list_for_each(iviscrn, &shell->list_screen, link) {
+        for (i = 0; i < length; i++) {
+            if (iviscrn->layout_screen == pArray[i]) {
+                iviscrn->repaint_needed = 1;
+            }
+        }
+    }
+
+    free(pArray);
+}
+
+/*
+ * Mark the screens showing a changed surface, layer or screen for
+ * schedule_marked_screens. A surface is shown on the screens of all
+ * layers containing it.
+ */
+static void
+mark_screens_of(struct ivishell *shell,
+                struct weston_layout_surface *layout_surface,
+                struct weston_layout_layer *layout_layer,
+                struct weston_layout_screen *layout_screen)
+{
+    struct weston_layout_layer **pArray = NULL;
+    struct iviscreen *iviscrn = NULL;
+    uint32_t length = 0;
+    uint32_t i = 0;
+
+    if (layout_layer != NULL) {
+        mark_screens_of_layer(shell, layout_layer);
+    }
+
+    if (layout_screen != NULL) {
+        wl_list_for_each(iviscrn, &shell->list_screen, link) {
+            if (iviscrn->layout_screen == layout_screen) {
+                iviscrn->repaint_needed = 1;
+            }
+        }
+    }
+
+    if ((layout_surface == NULL) ||
+        (weston_layout_getLayersUnderSurface(layout_surface,
+                                             &length, &pArray) != 0)) {
+        return;
+    }
+
+    for (i = 0; i < length; i++) {
+        mark_screens_of_layer(shell, pArray[i]);
+    }
+
+    free(pArray);
+}
+
+/*
+ * Repaint the outputs of the marked screens only, the others keep their
+ * frame.
+ */
+static void
+schedule_marked_screens(struct ivishell *shell)
+{
+    struct iviscreen *iviscrn = NULL;
+
+    wl_list_for_each(iviscrn, &shell->list_screen, link) {
+        if (iviscrn->repaint_needed) {
+            weston_output_schedule_repaint(iviscrn->output);
+            iviscrn->repaint_needed = 0;
+        }
+    }
+}
+
+/*
+ * Start the transitions requested before the changes were just committed,
+ * from the committed values. A running transition of the same property
+ * is replaced. The screens of the started transitions are marked for a
+ * repaint.
+ */
+static void
+start_transitions(struct ivishell *shell)
+{
+    struct ivi_transition *transition = NULL;
+    struct ivi_transition *other = NULL;
+    struct ivi_transition *next = NULL;
+    uint64_t now = 0;
+
+    wl_list_for_each(transition, &shell->list_transition, link) {
+        if (transition->start_time != 0) {
+            continue;
+        }
+
+        if (now == 0) {
+            now = get_monotonic_time();
+        }
+
+        wl_list_for_each_safe(other, next, &shell->list_transition, link) {
+            if ((other->start_time != 0) &&
+                is_transition_of(other, transition->layout_surface,
+                                 transition->layout_layer,
+                                 transition->property)) {
+                free_transition(other);
+            }
+        }
+
+        get_transition_value(transition, transition->from);
+        transition->start_time = now;
+        mark_screens_of(shell, transition->layout_surface,
+                        transition->layout_layer, NULL);
+    }
+}
+
+static float
+ease(uint32_t easing, float t)
+{
+    switch (easing) {
+    case IVI_CONTROLLER_TRANSITION_EASING_EASE_IN:
+        return t * t;
+    case IVI_CONTROLLER_TRANSITION_EASING_EASE_OUT:
+        return 1.0f - (1.0f - t) * (1.0f - t);
+    case IVI_CONTROLLER_TRANSITION_EASING_EASE_IN_OUT:
+        if (t < 0.5f) {
+            return 2.0f * t * t;
+        }
+        return 1.0f - 2.0f * (1.0f - t) * (1.0f - t);
+    default:
+        return t;
+    }
+}
+
+static int
+has_running_transitions(struct ivishell *shell)
+{
+    struct ivi_transition *transition = NULL;
+
+    wl_list_for_each(transition, &shell->list_transition, link) {
+        if (transition->start_time != 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Set the values of the running transitions for the next frame. Finished
+ * transitions are set to their target and removed. The caller commits the
+ * changes.
+ */
+static void
+step_transitions(struct ivishell *shell)
+{
+    struct ivi_transition *transition = NULL;
+    struct ivi_transition *next = NULL;
+    uint64_t now = get_monotonic_time();
+    uint64_t elapsed = 0;
+    float value[4];
+    float t = 0.0f;
+    uint32_t i = 0;
+
+    wl_list_for_each_safe(transition, next, &shell->list_transition, link) {
+        if (transition->start_time == 0) {
+            continue;
+        }
+
+        elapsed = now - transition->start_time;
+        t = 1.0f;
+        if (elapsed < transition->duration) {
+            t = ease(transition->easing,
+                     (float)elapsed / (float)transition->duration);
+        }
+
+        for (i = 0; i < 4; i++) {
+            value[i] = transition->from[i] +
+                       (transition->to[i] - transition->from[i]) * t;
+        }
+        set_transition_value(transition, value);
+
+        if (elapsed >= transition->duration) {
+            free_transition(transition);
+        }
+    }
+}
+
+/*
+ * Stage a property of the surface or layer of a controller request and
+ * set it into the pending state of weston_layout.
+ */
+static void
+stage_value(struct ivishell *shell, struct wl_client *client,
+            struct wl_resource *resource,
+            struct weston_layout_surface *layout_surface,
+            struct weston_layout_layer *layout_layer,
+            enum staged_property property,
+            float opacity, int32_t x, int32_t y, int32_t width, int32_t height)
+{
+    struct ivi_staged *staged = NULL;
+
+    staged = stage_property(shell, client, layout_surface, layout_layer,
+                            NULL, property);
+    if (staged == NULL) {
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+
+    staged->opacity = opacity;
+    staged->value[0] = x;
+    staged->value[1] = y;
+    staged->value[2] = width;
+    staged->value[3] = height;
+    apply_staged(staged);
+}
+
+static void
+controller_surface_set_opacity(struct wl_client *client,
+                   struct wl_resource *resource,
+                   wl_fixed_t opacity)
+{
+    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(ivisurf->shell, client);
+    journal_request(ivisurf->shell, client, ILM_RECORD_SURFACE_SET_OPACITY,
+                    "uf", weston_layout_getIdOfSurface(ivisurf->layout_surface),
+                    wl_fixed_to_double(opacity));
+    cancel_transitions(ivisurf->shell, ivisurf->layout_surface, NULL,
+                       TRANSITION_OPACITY);
+    stage_value(ivisurf->shell, client, resource, ivisurf->layout_surface,
+                NULL, STAGED_OPACITY, (float)opacity, 0, 0, 0, 0);
+}
+
+static void
+controller_surface_set_source_rectangle(struct wl_client *client,
+                   struct wl_resource *resource,
+                   int32_t x,
+                   int32_t y,
+                   int32_t width,
+                   int32_t height)
+{
+    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(ivisurf->shell, client);
+    journal_request(ivisurf->shell, client,
+                    ILM_RECORD_SURFACE_SET_SOURCE_RECTANGLE, "uuuuu",
+                    weston_layout_getIdOfSurface(ivisurf->layout_surface),
+                    (uint32_t)x, (uint32_t)y,
+                    (uint32_t)width, (uint32_t)height);
+    stage_value(ivisurf->shell, client, resource, ivisurf->layout_surface,
+                NULL, STAGED_SOURCE_RECTANGLE, 0.0f, x, y, width, height);
+}
+
+static void
+controller_surface_set_destination_rectangle(struct wl_client *client,
+                     struct wl_resource *resource,
+                     int32_t x,
+                     int32_t y,
+                     int32_t width,
+                     int32_t height)
+{
+    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(ivisurf->shell, client);
+    journal_request(ivisurf->shell, client,
+                    ILM_RECORD_SURFACE_SET_DESTINATION_RECTANGLE, "uuuuu",
+                    weston_layout_getIdOfSurface(ivisurf->layout_surface),
+                    (uint32_t)x, (uint32_t)y,
+                    (uint32_t)width, (uint32_t)height);
+    cancel_transitions(ivisurf->shell, ivisurf->layout_surface, NULL,
+                       TRANSITION_DESTINATION_RECTANGLE);
+    stage_value(ivisurf->shell, client, resource, ivisurf->layout_surface,
+                NULL, STAGED_DESTINATION_RECTANGLE, 0.0f, x, y, width, height);
+}
+
+static void
+controller_surface_set_visibility(struct wl_client *client,
+                      struct wl_resource *resource,
+                      uint32_t visibility)
+{
+    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(ivisurf->shell, client);
+    journal_request(ivisurf->shell, client, ILM_RECORD_SURFACE_SET_VISIBILITY,
+                    "uu",
+                    weston_layout_getIdOfSurface(ivisurf->layout_surface),
+                    visibility);
+    stage_value(ivisurf->shell, client, resource, ivisurf->layout_surface,
+                NULL, STAGED_VISIBILITY, 0.0f, (int32_t)visibility, 0, 0, 0);
+}
+
+static void
+controller_surface_set_configuration(struct wl_client *client,
+                   struct wl_resource *resource,
+                   int32_t width, int32_t height)
+{
+    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(ivisurf->shell, client);
+
+    /* This interface has been supported yet. */
+    (void)width;
+    (void)height;
+}
+
+static void
+controller_surface_set_orientation(struct wl_client *client,
+                   struct wl_resource *resource,
+                   int32_t orientation)
+{
+    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(ivisurf->shell, client);
+    journal_request(ivisurf->shell, client, ILM_RECORD_SURFACE_SET_ORIENTATION,
+                    "uu", weston_layout_getIdOfSurface(ivisurf->layout_surface),
+                    (uint32_t)orientation);
+    stage_value(ivisurf->shell, client, resource, ivisurf->layout_surface,
+                NULL, STAGED_ORIENTATION, 0.0f, orientation, 0, 0, 0);
+}
+
+static void
+get_frame_time(struct weston_output *output,
+               uint32_t *tv_sec, uint32_t *tv_nsec)
+{
+    *tv_sec = output->frame_time / 1000;
+    *tv_nsec = (output->frame_time % 1000) * 1000000;
+}
+
+/*
+ * Crop an area given in coordinates of the output to the current mode.
+ */
+static void
+crop_area_to_output(struct ivirect *area, struct weston_output *output)
+{
+    int32_t output_width = output->current_mode->width;
+    int32_t output_height = output->current_mode->height;
+
+    if (area->x < 0) {
+        area->width += area->x;
+        area->x = 0;
+    }
+    if (area->y < 0) {
+        area->height += area->y;
+        area->y = 0;
+    }
+    if (area->x + area->width > output_width) {
+        area->width = output_width - area->x;
+    }
+    if (area->y + area->height > output_height) {
+        area->height = output_height - area->y;
+    }
+}
+
+/*
+ * Read an area of the output which was just repainted into ARGB8888
+ * memory. The area is cropped to the output and to the memory.
+ */
+static int32_t
+read_output_area(struct weston_output *output, struct ivirect *area,
+                 uint8_t *data, int32_t stride,
+                 int32_t data_width, int32_t data_height)
+{
+    struct weston_compositor *compositor = output->compositor;
+    int yflip = compositor->capabilities & WESTON_CAP_CAPTURE_YFLIP;
+    int32_t read_y = 0;
+    int32_t row = 0;
+    int32_t col = 0;
+    uint8_t *pixels = NULL;
+    uint8_t *src = NULL;
+    uint8_t *dst = NULL;
+
+    crop_area_to_output(area, output);
+    if (area->width > data_width) {
+        area->width = data_width;
+    }
+    if (area->width > stride / 4) {
+        area->width = stride / 4;
+    }
+    if (area->height > data_height) {
+        area->height = data_height;
+    }
+
+    if ((area->width <= 0) || (area->height <= 0)) {
+        return -1;
+    }
+
+    pixels = malloc(area->width * area->height * 4);
+    if (pixels == NULL) {
+        weston_log("no memory to read back output\n");
+        return -1;
+    }
+
+    read_y = yflip ? output->current_mode->height - (area->y + area->height)
+                   : area->y;
+    if (compositor->renderer->read_pixels(output, compositor->read_format,
+                                          pixels, area->x, read_y,
+                                          area->width, area->height) < 0) {
+        free(pixels);
+        return -1;
+    }
+
+    for (row = 0; row < area->height; row++) {
+        src = pixels +
+              (yflip ? area->height - 1 - row : row) * area->width * 4;
+        dst = data + row * stride;
+
+        if (compositor->read_format == PIXMAN_a8r8g8b8) {
+            memcpy(dst, src, area->width * 4);
+            continue;
+        }
+
+        /* PIXMAN_a8b8g8r8, swap red and blue */
+        for (col = 0; col < area->width * 4; col += 4) {
+            dst[col + 0] = src[col + 2];
+            dst[col + 1] = src[col + 1];
+            dst[col + 2] = src[col + 0];
+            dst[col + 3] = src[col + 3];
+        }
+    }
+    free(pixels);
+
+    return 0;
+}
+
+/*
+ * The client may truncate the pool of the buffer at any time, the access
+ * is guarded so that this fails the client instead of the compositor.
+ */
+static int32_t
+read_output_area_to_buffer(struct weston_output *output,
+                           struct ivirect *area,
+                           struct wl_resource *buffer)
+{
+    struct wl_shm_buffer *shm_buffer = wl_shm_buffer_get(buffer);
+    int32_t ans = 0;
+
+    wl_shm_buffer_begin_access(shm_buffer);
+    ans = read_output_area(output, area,
+                           wl_shm_buffer_get_data(shm_buffer),
+                           wl_shm_buffer_get_stride(shm_buffer),
+                           wl_shm_buffer_get_width(shm_buffer),
+                           wl_shm_buffer_get_height(shm_buffer));
+    wl_shm_buffer_end_access(shm_buffer);
+
+    return ans;
+}
+
+/*
+ * Read the area back into an image of the writer. The image is encoded
+ * in the format and written to the file by a worker thread, done is
+ * called when the file was written.
+ */
+static struct ivi_image_job *
+write_output_area_to_file(struct ivi_image_writer *writer,
+                          struct weston_output *output,
+                          struct ivirect *area,
+                          const char *filename,
+                          enum ivi_image_format format,
+                          ivi_image_written_func done, void *data)
+{
+    struct ivi_image *image = NULL;
+
+    crop_area_to_output(area, output);
+    if ((area->width <= 0) || (area->height <= 0)) {
+        return NULL;
+    }
+
+    image = ivi_image_writer_get_image(writer, area->width, area->height);
+    if (image == NULL) {
+        weston_log("too many screenshots pending or no memory to store "
+                   "screenshot\n");
+        return NULL;
+    }
+
+    if (read_output_area(output, area, image->data, image->stride,
+                         image->width, image->height) != 0) {
+        ivi_image_writer_put_image(writer, image);
+        return NULL;
+    }
+
+    return ivi_image_writer_write(writer, image, filename, format,
+                                  done, data);
+}
+
+static int
+is_supported_shm_buffer(struct wl_resource *buffer)
+{
+    struct wl_shm_buffer *shm_buffer = wl_shm_buffer_get(buffer);
+    uint32_t format = 0;
+
+    if (shm_buffer == NULL) {
+        return 0;
+    }
+
+    format = wl_shm_buffer_get_format(shm_buffer);
+    return (format == WL_SHM_FORMAT_ARGB8888) ||
+           (format == WL_SHM_FORMAT_XRGB8888);
+}
+
+static struct iviscreen*
+get_screen_of_layer(struct ivishell *shell,
+                    struct weston_layout_layer *layout_layer)
+{
+    struct weston_layout_screen **pArray = NULL;
+    struct iviscreen *iviscrn = NULL;
+    struct iviscreen *found = NULL;
+    uint32_t length = 0;
+    int32_t ans = 0;
+
+    ans = weston_layout_getScreensUnderLayer(layout_layer, &length, &pArray);
+    if (0 != ans) {
+        weston_log("failed to get screens at get_screen_of_layer\n");
+        return NULL;
+    }
+
+    if (length > 0) {
+        wl_list_for_each(iviscrn, &shell->list_screen, link) {
+            if (iviscrn->layout_screen == pArray[0]) {
+                found = iviscrn;
+                break;
+            }
+        }
+    }
+
+    free(pArray);
+    return found;
+}
+
+/*
+ * Screen showing the layer and the area covered by the layer on it.
+ */
+static struct iviscreen*
+get_layer_area(struct ivishell *shell,
+               struct weston_layout_layer *layout_layer,
+               struct ivirect *area)
+{
+    struct weston_layout_LayerProperties prop;
+
+    memset(&prop, 0, sizeof prop);
+    weston_layout_getPropertiesOfLayer(layout_layer, &prop);
+
+    area->x = prop.destX;
+    area->y = prop.destY;
+    area->width = (int32_t)prop.destWidth;
+    area->height = (int32_t)prop.destHeight;
+
+    return get_screen_of_layer(shell, layout_layer);
+}
+
+/*
+ * Area covered by the surface on the screen showing its layer, cropped to
+ * the layer.
+ */
+static void
+get_surface_area_in_layer(
+    const struct weston_layout_SurfaceProperties *prop,
+    const struct weston_layout_LayerProperties *layer_prop,
+    struct ivirect *area)
+{
+    int32_t x = 0;
+    int32_t y = 0;
+    int32_t width = 0;
+    int32_t height = 0;
+
+    /* the surface destination is given in the source area of its layer */
+    x = (int32_t)prop->destX - (int32_t)layer_prop->sourceX;
+    y = (int32_t)prop->destY - (int32_t)layer_prop->sourceY;
+    width = (int32_t)prop->destWidth;
+    height = (int32_t)prop->destHeight;
+    if ((layer_prop->sourceWidth > 0) && (layer_prop->sourceHeight > 0)) {
+        x = x * (int32_t)layer_prop->destWidth / (int32_t)layer_prop->sourceWidth;
+        y = y * (int32_t)layer_prop->destHeight / (int32_t)layer_prop->sourceHeight;
+        width = width * (int32_t)layer_prop->destWidth /
+                (int32_t)layer_prop->sourceWidth;
+        height = height * (int32_t)layer_prop->destHeight /
+                 (int32_t)layer_prop->sourceHeight;
+    }
+
+    /* crop to the layer */
+    if (x < 0) {
+        width += x;
+        x = 0;
+    }
+    if (y < 0) {
+        height += y;
+        y = 0;
+    }
+    if (x + width > (int32_t)layer_prop->destWidth) {
+        width = (int32_t)layer_prop->destWidth - x;
+    }
+    if (y + height > (int32_t)layer_prop->destHeight) {
+        height = (int32_t)layer_prop->destHeight - y;
+    }
+
+    area->x = layer_prop->destX + x;
+    area->y = layer_prop->destY + y;
+    area->width = width;
+    area->height = height;
+}
+
+/*
+ * Screen showing the surface and the area covered by the surface on it.
+ * Only the first layer containing the surface is taken into account.
+ */
+static struct iviscreen*
+get_surface_area(struct ivishell *shell,
+                 struct weston_layout_surface *layout_surface,
+                 struct ivirect *area)
+{
+    struct weston_layout_SurfaceProperties prop;
+    struct weston_layout_LayerProperties layer_prop;
+    struct weston_layout_layer **pArray = NULL;
+    struct iviscreen *iviscrn = NULL;
+    uint32_t length = 0;
+
+    memset(&prop, 0, sizeof prop);
+    memset(&layer_prop, 0, sizeof layer_prop);
+
+    if ((0 == weston_layout_getLayersUnderSurface(layout_surface,
+                                                  &length, &pArray)) &&
+        (length > 0)) {
+        iviscrn = get_screen_of_layer(shell, pArray[0]);
+        weston_layout_getPropertiesOfLayer(pArray[0], &layer_prop);
+        weston_layout_getPropertiesOfSurface(layout_surface, &prop);
+    }
+    free(pArray);
+
+    get_surface_area_in_layer(&prop, &layer_prop, area);
+
+    return iviscrn;
+}
+
+static int
+is_opaque_pixelformat(uint32_t pixelformat)
+{
+    return (pixelformat == IVI_CONTROLLER_SURFACE_PIXELFORMAT_R_8) ||
+           (pixelformat == IVI_CONTROLLER_SURFACE_PIXELFORMAT_RGB_888) ||
+           (pixelformat == IVI_CONTROLLER_SURFACE_PIXELFORMAT_RGB_565);
+}
+
+/*
+ * Add the surfaces of the layer which are visible on the screen to
+ * visible, from top to bottom. covered is the area of the screen hidden by
+ * opaque surfaces above, opaque surfaces of the layer are added to it.
+ */
+static void
+collect_visible_surfaces(struct weston_layout_layer *layout_layer,
+                         struct weston_output *output,
+                         pixman_region32_t *covered,
+                         struct wl_array *visible)
+{
+    struct weston_layout_LayerProperties layer_prop;
+    struct weston_layout_SurfaceProperties prop;
+    struct weston_layout_surface **pArray = NULL;
+    struct ivirect area;
+    pixman_box32_t box;
+    uintptr_t *key = NULL;
+    uint32_t length = 0;
+    uint32_t i = 0;
+
+    memset(&layer_prop, 0, sizeof layer_prop);
+    weston_layout_getPropertiesOfLayer(layout_layer, &layer_prop);
+    if (!layer_prop.visibility || (layer_prop.opacity <= 0.0f) ||
+        (layer_prop.destWidth == 0) || (layer_prop.destHeight == 0)) {
+        return;
+    }
+
+    if (weston_layout_getSurfacesOnLayer(layout_layer, &length, &pArray) != 0) {
+        return;
+    }
+
+    for (i = length; i > 0; i--) {
+        memset(&prop, 0, sizeof prop);
+        weston_layout_getPropertiesOfSurface(pArray[i - 1], &prop);
+        if (!prop.visibility || (prop.opacity <= 0.0f)) {
+            continue;
+        }
+
+        get_surface_area_in_layer(&prop, &layer_prop, &area);
+        crop_area_to_output(&area, output);
+        if ((area.width <= 0) || (area.height <= 0)) {
+            continue;
+        }
+
+        box.x1 = area.x;
+        box.y1 = area.y;
+        box.x2 = area.x + area.width;
+        box.y2 = area.y + area.height;
+        if (pixman_region32_contains_rectangle(covered, &box) ==
+            PIXMAN_REGION_IN) {
+            continue;
+        }
+
+        key = wl_array_add(visible, sizeof *key);
+        if (key != NULL) {
+            *key = (uintptr_t)pArray[i - 1];
+        }
+
+        /* weston_layout keeps the opacity as a wl_fixed_t value */
+        if ((layer_prop.opacity >= (float)wl_fixed_from_int(1)) &&
+            (prop.opacity >= (float)wl_fixed_from_int(1)) &&
+            is_opaque_pixelformat(prop.pixelformat)) {
+            pixman_region32_union_rect(covered, covered, area.x, area.y,
+                                       area.width, area.height);
+        }
+    }
+
+    free(pArray);
+}
+
+static void
+send_effective_visibility(struct ivishell *shell, uint32_t id_surface,
+                          int32_t visibility)
+{
+    struct ivicontroller_surface *ctrlsurf = NULL;
+
+    wl_list_for_each(ctrlsurf,
+                     get_controller_surfaces(shell, id_surface), link) {
+        if (wl_resource_get_version(ctrlsurf->resource) >=
+            IVI_CONTROLLER_SURFACE_EFFECTIVE_VISIBILITY_SINCE_VERSION) {
+            ivi_controller_surface_send_effective_visibility(
+                ctrlsurf->resource, visibility);
+        }
+    }
+}
+
+/*
+ * Find the surfaces contributing to a screen after a commit, and send the
+ * changes of their effective visibility. Screens are walked from the top
+ * layer down, so fully covered surfaces are found with one region.
+ */
+static void
+update_effective_visibility(struct ivishell *shell)
+{
+    struct weston_layout_layer **pArray = NULL;
+    struct iviscreen *iviscrn = NULL;
+    struct ivisurface *ivisurf = NULL;
+    pixman_region32_t covered;
+    struct wl_array visible;
+    uintptr_t key = 0;
+    uint32_t length = 0;
+    uint32_t i = 0;
+    int32_t visibility = 0;
+
+    wl_array_init(&visible);
+
+    wl_list_for_each(iviscrn, &shell->list_screen, link) {
+        if (weston_layout_getLayersOnScreen(iviscrn->layout_screen,
+                                            &length, &pArray) != 0) {
+            continue;
+        }
+
+        pixman_region32_init(&covered);
+        for (i = length; i > 0; i--) {
+            collect_visible_surfaces(pArray[i - 1], iviscrn->output,
+                                     &covered, &visible);
+        }
+        pixman_region32_fini(&covered);
+
+        free(pArray);
+        pArray = NULL;
+    }
+
+    qsort(visible.data, visible.size / sizeof key, sizeof key, compare_key);
+
+    wl_list_for_each(ivisurf, &shell->list_surface, link) {
+        key = (uintptr_t)ivisurf->layout_surface;
+        visibility = bsearch(&key, visible.data, visible.size / sizeof key,
+                             sizeof key, compare_key) != NULL;
+        if (visibility == ivisurf->effective_visibility) {
+            continue;
+        }
+
+        ivisurf->effective_visibility = visibility;
+        send_effective_visibility(shell,
+            weston_layout_getIdOfSurface(ivisurf->layout_surface),
+            visibility);
+    }
+
+    wl_array_release(&visible);
+}
+
+static void
+free_screenshot(struct ivicontroller_screenshot *shot)
+{
+    if (shot->job != NULL) {
+        ivi_image_job_cancel(shot->job);
+    }
+
+    wl_list_remove(&shot->link);
+    wl_list_remove(&shot->buffer_destroy_listener.link);
+    free(shot->filename);
+    free(shot);
+}
+
+static void
+destroy_screenshot(struct wl_resource *resource)
+{
+    free_screenshot(wl_resource_get_user_data(resource));
+}
+
+static void
+screenshot_finish(struct ivicontroller_screenshot *shot)
+{
+    if (shot->resource != NULL) {
+        wl_resource_destroy(shot->resource);
+    } else {
+        free_screenshot(shot);
+    }
+}
+
+static void
+screenshot_failed(struct ivicontroller_screenshot *shot)
+{
+    if (shot->resource != NULL) {
+        ivi_controller_screenshot_send_failed(shot->resource);
+    }
+    screenshot_finish(shot);
+}
+
+static void
+screenshot_buffer_destroyed(struct wl_listener *listener, void *data)
+{
+    struct ivicontroller_screenshot *shot =
+        container_of(listener, struct ivicontroller_screenshot,
+                     buffer_destroy_listener);
+    (void)data;
+
+    screenshot_failed(shot);
+}
+
+/*
+ * Screenshot without a screenshot object, for the requests which report
+ * nothing to the client.
+ */
+static struct ivicontroller_screenshot*
+screenshot_alloc(struct wl_resource *resource)
+{
+    struct ivicontroller_screenshot *shot = NULL;
+
+    shot = calloc(1, sizeof *shot);
+    if (shot == NULL) {
+        wl_resource_post_no_memory(resource);
+        return NULL;
+    }
+
+    wl_list_init(&shot->link);
+    wl_list_init(&shot->buffer_destroy_listener.link);
+
+    return shot;
+}
+
+static struct ivicontroller_screenshot*
+screenshot_create(struct wl_client *client,
+                  struct wl_resource *resource,
+                  uint32_t id)
+{
+    struct ivicontroller_screenshot *shot = NULL;
+
+    shot = screenshot_alloc(resource);
+    if (shot == NULL) {
+        return NULL;
+    }
+
+    shot->resource =
+        wl_resource_create(client, &ivi_controller_screenshot_interface,
+                           wl_resource_get_version(resource), id);
+    if (shot->resource == NULL) {
+        free(shot);
+        wl_resource_post_no_memory(resource);
+        return NULL;
+    }
+
+    wl_resource_set_implementation(shot->resource, NULL,
+                                   shot, destroy_screenshot);
+
+    return shot;
+}
+
+/*
+ * Queue a screenshot of the given area of a screen into a wl_shm buffer.
+ * The pixels are read back after the next repaint of the screen.
+ */
+static void
+screenshot_queue_buffer(struct ivicontroller_screenshot *shot,
+                        struct iviscreen *iviscrn,
+                        struct ivirect *area,
+                        struct wl_resource *buffer)
+{
+    if ((iviscrn == NULL) || (area->width <= 0) || (area->height <= 0) ||
+        !is_supported_shm_buffer(buffer)) {
+        screenshot_failed(shot);
+        return;
+    }
+
+    shot->buffer = buffer;
+    shot->area = *area;
+
+    shot->buffer_destroy_listener.notify = screenshot_buffer_destroyed;
+    wl_resource_add_destroy_listener(buffer, &shot->buffer_destroy_listener);
+
+    wl_list_insert(iviscrn->list_screenshot.prev, &shot->link);
+    weston_output_schedule_repaint(iviscrn->output);
+}
+
+/*
+ * Queue a screenshot into a file. It is taken after the next repaint of
+ * the screen.
+ */
+static void
+screenshot_queue_file(struct ivicontroller_screenshot *shot,
+                      struct iviscreen *iviscrn,
+                      const char *filename)
+{
+    shot->filename = strdup(filename);
+    if ((iviscrn == NULL) || (shot->filename == NULL)) {
+        screenshot_failed(shot);
+        return;
+    }
+
+    wl_list_insert(iviscrn->list_screenshot.prev, &shot->link);
+    weston_output_schedule_repaint(iviscrn->output);
+}
+
+static void
+screenshot_done(struct ivicontroller_screenshot *shot)
+{
+    struct wl_shm_buffer *shm_buffer = NULL;
+
+    if (shot->resource == NULL) {
+        screenshot_finish(shot);
+        return;
+    }
+
+    /* frame was added with version 4 */
+    if (shot->has_frame &&
+        (wl_resource_get_version(shot->resource) >= 4)) {
+        ivi_controller_screenshot_send_frame(shot->resource, shot->tv_sec,
+                                             shot->tv_nsec, shot->seq);
+    }
+
+    if (shot->filename != NULL) {
+        ivi_controller_screenshot_send_done(shot->resource, 0, 0, 0, 0);
+    } else {
+        shm_buffer = wl_shm_buffer_get(shot->buffer);
+        ivi_controller_screenshot_send_done(shot->resource,
+                                    wl_shm_buffer_get_format(shm_buffer),
+                                    shot->area.width, shot->area.height,
+                                    wl_shm_buffer_get_stride(shm_buffer));
+    }
+    screenshot_finish(shot);
+}
+
+static void
+screenshot_written(void *data, int32_t result)
+{
+    struct ivicontroller_screenshot *shot = data;
+
+    shot->job = NULL;
+    if (result != 0) {
+        screenshot_failed(shot);
+        return;
+    }
+
+    screenshot_done(shot);
+}
+
+/*
+ * Screenshots of screens and layers are read back here and stored by the
+ * image writer. The content of a surface is stored by weston-layout as
+ * PNG, other formats store the area of the surface on the screen.
+ */
+static int32_t
+screenshot_write_file(struct ivicontroller_screenshot *shot,
+                      struct iviscreen *iviscrn,
+                      struct weston_output *output)
+{
+    struct weston_layout_surface *layout_surface = NULL;
+
+    switch (shot->type) {
+    case SCREENSHOT_SCREEN:
+        shot->area.x = 0;
+        shot->area.y = 0;
+        shot->area.width = output->current_mode->width;
+        shot->area.height = output->current_mode->height;
+        /* fall through */
+    case SCREENSHOT_LAYER:
+        shot->job = write_output_area_to_file(iviscrn->shell->image_writer,
+                                              output, &shot->area,
+                                              shot->filename, shot->format,
+                                              screenshot_written, shot);
+        return (shot->job != NULL) ? 0 : -1;
+    case SCREENSHOT_SURFACE:
+        if (shot->format != IVI_IMAGE_FORMAT_PNG) {
+            shot->job =
+                write_output_area_to_file(iviscrn->shell->image_writer,
+                                          output, &shot->area,
+                                          shot->filename, shot->format,
+                                          screenshot_written, shot);
+            return (shot->job != NULL) ? 0 : -1;
+        }
+        layout_surface = weston_layout_getSurfaceFromId(shot->id_surface);
+        if (layout_surface == NULL) {
+            return -1;
+        }
+        return weston_layout_takeSurfaceScreenshot(shot->filename,
+                                                   layout_surface);
+    }
+
+    return -1;
+}
+
+/*
+ * Take a queued screenshot from the output which was just repainted. The
+ * result is reported when the pixels are stored.
+ */
+static void
+screenshot_take(struct ivicontroller_screenshot *shot,
+                struct iviscreen *iviscrn,
+                struct weston_output *output)
+{
+    int32_t ans = 0;
+
+    wl_list_remove(&shot->link);
+    wl_list_init(&shot->link);
+
+    shot->has_frame = 1;
+    get_frame_time(output, &shot->tv_sec, &shot->tv_nsec);
+    shot->seq = iviscrn->frame_count;
+
+    if (shot->filename != NULL) {
+        ans = screenshot_write_file(shot, iviscrn, output);
+    } else {
+        ans = read_output_area_to_buffer(output, &shot->area, shot->buffer);
+    }
+
+    if (ans != 0) {
+        screenshot_failed(shot);
+        return;
+    }
+
+    if (shot->job == NULL) {
+        screenshot_done(shot);
+    }
+}
+
+static void
+destroy_capture_buffer(struct ivicontroller_capture_buffer *capture_buffer)
+{
+    wl_list_remove(&capture_buffer->link);
+    wl_list_remove(&capture_buffer->destroy_listener.link);
+    free(capture_buffer);
+}
+
+static void
+capture_buffer_destroyed(struct wl_listener *listener, void *data)
+{
+    struct ivicontroller_capture_buffer *capture_buffer =
+        container_of(listener, struct ivicontroller_capture_buffer,
+                     destroy_listener);
+    (void)data;
+
+    destroy_capture_buffer(capture_buffer);
+}
+
+static void
+destroy_capture(struct wl_resource *resource)
+{
+    struct ivicontroller_capture *capture =
+        wl_resource_get_user_data(resource);
+    struct ivicontroller_capture_buffer *capture_buffer = NULL;
+    struct ivicontroller_capture_buffer *next = NULL;
+
+    wl_list_for_each_safe(capture_buffer, next,
+                          &capture->list_buffer, link) {
+        destroy_capture_buffer(capture_buffer);
+    }
+
+    wl_list_remove(&capture->link);
+    pixman_region32_fini(&capture->damage);
+    free(capture);
+}
+
+static void
+capture_destroy(struct wl_client *client,
+                struct wl_resource *resource)
+{
+    struct ivicontroller_capture *capture =
+        wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(capture->shell, client);
+    wl_resource_destroy(resource);
+}
+
+static void
+capture_queue_buffer(struct wl_client *client,
+                     struct wl_resource *resource,
+                     struct wl_resource *buffer)
+{
+    struct ivicontroller_capture *capture =
+        wl_resource_get_user_data(resource);
+    struct ivicontroller_capture_buffer *capture_buffer = NULL;
+    PROFILE_SCOPE(capture->shell, client);
+
+    if (!is_supported_shm_buffer(buffer)) {
+        wl_resource_post_error(resource,
+                               IVI_CONTROLLER_CAPTURE_ERROR_BAD_BUFFER,
+                               "capture buffer must be a wl_shm buffer "
+                               "of format argb8888 or xrgb8888");
+        return;
+    }
+
+    capture_buffer = calloc(1, sizeof *capture_buffer);
+    if (capture_buffer == NULL) {
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+
+    capture_buffer->resource = buffer;
+    capture_buffer->destroy_listener.notify = capture_buffer_destroyed;
+    wl_resource_add_destroy_listener(buffer,
+                                     &capture_buffer->destroy_listener);
+    wl_list_insert(capture->list_buffer.prev, &capture_buffer->link);
+
+    /* make sure the first frame of a stream is captured without waiting
+     * for a change on the screen */
+    if (!capture->full_damage) {
+        return;
+    }
+
+    if (capture->iviscrn != NULL) {
+        weston_output_schedule_repaint(capture->iviscrn->output);
+    } else {
+        weston_compositor_schedule_repaint(capture->shell->compositor);
+    }
+}
+
+static const
+struct ivi_controller_capture_interface controller_capture_implementation = {
+    capture_destroy,
+    capture_queue_buffer
+};
+
+static void
+capture_create(struct wl_client *client,
+               struct wl_resource *resource,
+               uint32_t id,
+               uint32_t interval,
+               struct ivishell *shell,
+               struct iviscreen *iviscrn,
+               uint32_t id_surface)
+{
+    struct ivicontroller_capture *capture = NULL;
+
+    capture = calloc(1, sizeof *capture);
+    if (capture == NULL) {
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+
+    capture->resource =
+        wl_resource_create(client, &ivi_controller_capture_interface,
+                           wl_resource_get_version(resource), id);
+    if (capture->resource == NULL) {
+        free(capture);
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+
+    capture->shell = shell;
+    capture->iviscrn = iviscrn;
+    capture->id_surface = id_surface;
+    capture->interval = (interval > 0) ? interval : 1;
+    capture->full_damage = 1;
+    pixman_region32_init(&capture->damage);
+    wl_list_init(&capture->list_buffer);
+    wl_list_insert(shell->list_capture.prev, &capture->link);
+
+    wl_resource_set_implementation(capture->resource,
+                                   &controller_capture_implementation,
+                                   capture, destroy_capture);
+}
+
+static void
+capture_send_damage(struct ivicontroller_capture *capture,
+                    struct weston_output *output,
+                    struct ivirect *area)
+{
+    pixman_box32_t *rects = NULL;
+    int n_rects = 0;
+    int i = 0;
+
+    if (capture->full_damage) {
+        ivi_controller_capture_send_damage(capture->resource, 0, 0,
+                                           area->width, area->height);
+        capture->full_damage = 0;
+        return;
+    }
+
+    /* damage of the output is tracked in global coordinates */
+    pixman_region32_translate(&capture->damage,
+                              -(output->x + area->x),
+                              -(output->y + area->y));
+    pixman_region32_intersect_rect(&capture->damage, &capture->damage,
+                                   0, 0, area->width, area->height);
+
+    rects = pixman_region32_rectangles(&capture->damage, &n_rects);
+    for (i = 0; i < n_rects; i++) {
+        ivi_controller_capture_send_damage(capture->resource,
+                                           rects[i].x1, rects[i].y1,
+                                           rects[i].x2 - rects[i].x1,
+                                           rects[i].y2 - rects[i].y1);
+    }
+}
+
+/*
+ * Called for every repaint of every screen. Damage is collected for the
+ * repaints which are skipped, every interval-th repaint of the captured
+ * screen is copied into the oldest queued buffer.
+ */
+static void
+capture_repaint(struct ivicontroller_capture *capture,
+                struct iviscreen *iviscrn,
+                struct weston_output *output)
+{
+    struct ivicontroller_capture_buffer *capture_buffer = NULL;
+    struct weston_layout_surface *layout_surface = NULL;
+    struct iviscreen *target = capture->iviscrn;
+    struct wl_shm_buffer *shm_buffer = NULL;
+    struct ivirect area;
+    uint32_t tv_sec = 0;
+    uint32_t tv_nsec = 0;
+
+    memset(&area, 0, sizeof area);
+
+    if (target == NULL) {
+        layout_surface = weston_layout_getSurfaceFromId(capture->id_surface);
+        if (layout_surface == NULL) {
+            ivi_controller_capture_send_stopped(capture->resource);
+            wl_list_remove(&capture->link);
+            wl_list_init(&capture->link);
+            return;
+        }
+        target = get_surface_area(capture->shell, layout_surface, &area);
+    } else {
+        area.width = output->current_mode->width;
+        area.height = output->current_mode->height;
+    }
+
+    if (target != iviscrn) {
+        return;
+    }
+
+    pixman_region32_union(&capture->damage, &capture->damage,
+                          &output->previous_damage);
+
+    capture->repaint_count++;
+    if (((capture->repaint_count % capture->interval) != 0) ||
+        wl_list_empty(&capture->list_buffer)) {
+        return;
+    }
+
+    capture_buffer = container_of(capture->list_buffer.next,
+                                  struct ivicontroller_capture_buffer, link);
+    if (read_output_area_to_buffer(output, &area,
+                                   capture_buffer->resource) != 0) {
+        return;
+    }
+
+    /* a moved or resized area has changed completely */
+    if (memcmp(&area, &capture->area, sizeof area) != 0) {
+        capture->full_damage = 1;
+        capture->area = area;
+    }
+
+    capture_send_damage(capture, output, &area);
+    pixman_region32_fini(&capture->damage);
+    pixman_region32_init(&capture->damage);
+
+    get_frame_time(output, &tv_sec, &tv_nsec);
+    shm_buffer = wl_shm_buffer_get(capture_buffer->resource);
+    ivi_controller_capture_send_frame(capture->resource,
+                                      capture_buffer->resource,
+                                      wl_shm_buffer_get_format(shm_buffer),
+                                      area.width, area.height,
+                                      wl_shm_buffer_get_stride(shm_buffer),
+                                      tv_sec, tv_nsec, iviscrn->frame_count);
+    destroy_capture_buffer(capture_buffer);
+}
+
+static void
+controller_surface_screenshot_buffer(struct wl_client *client,
+                                     struct wl_resource *resource,
+                                     struct wl_resource *buffer,
+                                     uint32_t id)
+{
+    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
+    struct ivicontroller_screenshot *shot = NULL;
+    struct iviscreen *iviscrn = NULL;
+    struct ivirect area;
+    PROFILE_SCOPE(ivisurf->shell, client);
+
+    journal_request(ivisurf->shell, client,
+                    ILM_RECORD_TAKE_SURFACE_SCREENSHOT_TO_BUFFER, "u",
+                    weston_layout_getIdOfSurface(ivisurf->layout_surface));
+
+    shot = screenshot_create(client, resource, id);
+    if (shot == NULL) {
+        return;
+    }
+
+    iviscrn = get_surface_area(ivisurf->shell, ivisurf->layout_surface,
+                               &area);
+    screenshot_queue_buffer(shot, iviscrn, &area, buffer);
+}
+
+static void
+surface_screenshot_file(struct wl_client *client,
+                        struct wl_resource *resource,
+                        const char *filename,
+                        enum ivi_image_format format,
+                        uint32_t id)
+{
+    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
+    struct ivicontroller_screenshot *shot = NULL;
+    struct iviscreen *iviscrn = NULL;
+
+    journal_request(ivisurf->shell, client, ILM_RECORD_TAKE_SURFACE_SCREENSHOT,
+                    "us",
+                    weston_layout_getIdOfSurface(ivisurf->layout_surface),
+                    filename);
+
+    shot = screenshot_create(client, resource, id);
+    if (shot == NULL) {
+        return;
+    }
+
+    shot->type = SCREENSHOT_SURFACE;
+    shot->format = format;
+    shot->id_surface = weston_layout_getIdOfSurface(ivisurf->layout_surface);
+
+    iviscrn = get_surface_area(ivisurf->shell, ivisurf->layout_surface,
+                               &shot->area);
+    if (iviscrn != NULL) {
+        screenshot_queue_file(shot, iviscrn, filename);
+        return;
+    }
+
+    /* other formats than PNG are read back from the screen */
+    if (format != IVI_IMAGE_FORMAT_PNG) {
+        screenshot_failed(shot);
+        return;
+    }
+
+    /* not shown, the content of the surface is stored right away */
+    if (weston_layout_takeSurfaceScreenshot(filename,
+                                            ivisurf->layout_surface) != 0) {
+        screenshot_failed(shot);
+        return;
+    }
+    ivi_controller_screenshot_send_done(shot->resource, 0, 0, 0, 0);
+    wl_resource_destroy(shot->resource);
+}
+
+static void
+controller_surface_screenshot_file(struct wl_client *client,
+                                   struct wl_resource *resource,
+                                   const char *filename,
+                                   uint32_t id)
+{
+    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(ivisurf->shell, client);
+
+    surface_screenshot_file(client, resource, filename,
+                            IVI_IMAGE_FORMAT_PNG, id);
+}
+
+static void
+controller_surface_screenshot_file_format(struct wl_client *client,
+                                          struct wl_resource *resource,
+                                          const char *filename,
+                                          uint32_t format,
+                                          uint32_t id)
+{
+    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(ivisurf->shell, client);
+
+    if (!ivi_image_format_is_valid(format)) {
+        wl_resource_post_error(resource,
+                               IVI_CONTROLLER_SURFACE_ERROR_BAD_FORMAT,
+                               "unknown screenshot format %u", format);
+        return;
+    }
+
+    surface_screenshot_file(client, resource, filename,
+                            (enum ivi_image_format)format, id);
+}
+
+static void
+controller_surface_capture(struct wl_client *client,
+                           struct wl_resource *resource,
+                           uint32_t id,
+                           uint32_t interval)
+{
+    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(ivisurf->shell, client);
+
+    capture_create(client, resource, id, interval, ivisurf->shell, NULL,
+                   weston_layout_getIdOfSurface(ivisurf->layout_surface));
+}
+
+static void
+controller_surface_screenshot(struct wl_client *client,
+                  struct wl_resource *resource,
+                  const char *filename)
+{
+    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(ivisurf->shell, client);
+    journal_request(ivisurf->shell, client, ILM_RECORD_TAKE_SURFACE_SCREENSHOT,
+                    "us",
+                    weston_layout_getIdOfSurface(ivisurf->layout_surface),
+                    filename);
+    weston_layout_takeSurfaceScreenshot(filename, ivisurf->layout_surface);
+}
+
+/* upper bounds of the frame interval buckets in milliseconds */
+static const uint32_t frame_interval_bounds[FRAME_INTERVAL_BUCKETS - 1] = {
+    17, 34, 50, 67, 100, 200, 500
+};
+
+static void
+frame_stats_commit(struct wl_listener *listener, void *data)
+{
+    struct ivisurface *ivisurf =
+        container_of(listener, struct ivisurface, surface_commit_listener);
+    struct ivi_frame_stats *stats = &ivisurf->frame_stats;
+    (void)data;
+
+    stats->commit_count++;
+    if (wl_list_empty(&ivisurf->committed_link)) {
+        wl_list_insert(ivisurf->shell->list_surface_committed.prev,
+                       &ivisurf->committed_link);
+    } else {
+        /* the previous commit is replaced before it was shown */
+        stats->drop_count++;
+    }
+    stats->commit_time = get_monotonic_time();
+}
+
+static void
+frame_stats_present(struct ivisurface *ivisurf, uint64_t now)
+{
+    struct ivi_frame_stats *stats = &ivisurf->frame_stats;
+    uint64_t latency = now - stats->commit_time;
+    uint32_t interval = 0;
+    uint32_t i = 0;
+
+    wl_list_remove(&ivisurf->committed_link);
+    wl_list_init(&ivisurf->committed_link);
+
+    stats->latency_sum += latency;
+    if (latency > stats->latency_max) {
+        stats->latency_max = (uint32_t)latency;
+    }
+
+    if (stats->present_count > 0) {
+        interval = (uint32_t)((now - stats->present_time) / 1000);
+        while ((i < FRAME_INTERVAL_BUCKETS - 1) &&
+               (interval > frame_interval_bounds[i])) {
+            i++;
+        }
+        stats->intervals[i]++;
+    } else {
+        stats->fps_time = now;
+    }
+    stats->present_count++;
+    stats->present_time = now;
+
+    stats->fps_count++;
+    if (now - stats->fps_time >= 1000000) {
+        stats->fps = wl_fixed_from_double(stats->fps_count * 1000000.0 /
+                                          (double)(now - stats->fps_time));
+        stats->fps_time = now;
+        stats->fps_count = 0;
+    }
+}
+
+static void
+send_frame_stats(struct ivicontroller_frame_stats *frame_stats, uint64_t now)
+{
+    struct ivi_frame_stats *stats = &frame_stats->ivisurf->frame_stats;
+    struct wl_array intervals;
+    uint32_t latency_avg = 0;
+    wl_fixed_t fps = 0;
+
+    if (stats->present_count > 0) {
+        latency_avg = (uint32_t)(stats->latency_sum / stats->present_count);
+    }
+
+    /* a surface which was not presented for a second has no frame rate */
+    if (now - stats->present_time < 1000000) {
+        fps = stats->fps;
+    }
+
+    intervals.data = stats->intervals;
+    intervals.size = sizeof stats->intervals;
+    intervals.alloc = intervals.size;
+
+    ivi_controller_frame_stats_send_stats(frame_stats->resource,
+                                          stats->commit_count,
+                                          stats->present_count,
+                                          stats->drop_count,
+                                          latency_avg, stats->latency_max,
+                                          fps, &intervals);
+    frame_stats->send_time = now;
+}
+
+static void
+destroy_frame_stats(struct wl_resource *resource)
+{
+    struct ivicontroller_frame_stats *frame_stats =
+        wl_resource_get_user_data(resource);
+
+    wl_list_remove(&frame_stats->link);
+    free(frame_stats);
+}
+
+static void
+frame_stats_destroy(struct wl_client *client,
+                    struct wl_resource *resource)
+{
+    struct ivicontroller_frame_stats *frame_stats =
+        wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(frame_stats->shell, client);
+    wl_resource_destroy(resource);
+}
+
+static const
+struct ivi_controller_frame_stats_interface controller_frame_stats_implementation = {
+    frame_stats_destroy
+};
+
+static void
+controller_surface_frame_stats(struct wl_client *client,
+                               struct wl_resource *resource,
+                               uint32_t id,
+                               uint32_t interval)
+{
+    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
+    struct ivicontroller_frame_stats *frame_stats = NULL;
+    PROFILE_SCOPE(ivisurf->shell, client);
+
+    frame_stats = calloc(1, sizeof *frame_stats);
+    if (frame_stats == NULL) {
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+
+    frame_stats->resource =
+        wl_resource_create(client, &ivi_controller_frame_stats_interface,
+                           wl_resource_get_version(resource), id);
+    if (frame_stats->resource == NULL) {
+        free(frame_stats);
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+
+    frame_stats->shell = ivisurf->shell;
+    frame_stats->ivisurf = ivisurf;
+    frame_stats->interval = interval;
+    wl_list_insert(ivisurf->shell->list_frame_stats.prev, &frame_stats->link);
+
+    wl_resource_set_implementation(frame_stats->resource,
+                                   &controller_frame_stats_implementation,
+                                   frame_stats, destroy_frame_stats);
+
+    send_frame_stats(frame_stats, get_monotonic_time());
+}
+
+static void
+controller_surface_send_stats(struct wl_client *client,
+                              struct wl_resource *resource)
+{
+    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
+    struct ivi_frame_stats *stats = &ivisurf->frame_stats;
+    pid_t pid;
+    uid_t uid;
+    gid_t gid;
+    PROFILE_SCOPE(ivisurf->shell, client);
+
+    wl_client_get_credentials(client, &pid, &uid, &gid);
+
+    ivi_controller_surface_send_stats(resource, stats->commit_count,
+                                      stats->present_count,
+                                      stats->commit_count, pid, "");
+}
+
+static void
+controller_surface_destroy(struct wl_client *client,
+              struct wl_resource *resource,
+              int32_t destroy_scene_object)
+{
+    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(ivisurf->shell, client);
+    (void)destroy_scene_object;
+
+    /* destroy_ivicontroller_surface unlinks the controller surface */
+    wl_resource_destroy(resource);
+}
+
+static void
+controller_surface_set_input_focus(struct wl_client *client,
+              struct wl_resource *resource,
+              int32_t enabled)
+{
+    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(ivisurf->shell, client);
+    (void)enabled;
+}
+
+static void
+controller_surface_transition_opacity(struct wl_client *client,
+                                      struct wl_resource *resource,
+                                      wl_fixed_t opacity,
+                                      uint32_t duration,
+                                      uint32_t easing)
+{
+    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
+    float to[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    PROFILE_SCOPE(ivisurf->shell, client);
+    journal_request(ivisurf->shell, client,
+                    ILM_RECORD_SURFACE_TRANSITION_OPACITY, "ufuu",
+                    weston_layout_getIdOfSurface(ivisurf->layout_surface),
+                    wl_fixed_to_double(opacity), duration, easing);
+
+    to[0] = (float)opacity;
+    create_transition(ivisurf->shell, resource, ivisurf->layout_surface,
+                      NULL, TRANSITION_OPACITY, to, duration, easing);
+}
+
+static void
+controller_surface_transition_destination_rectangle(
+                                      struct wl_client *client,
+                                      struct wl_resource *resource,
+                                      int32_t x,
+                                      int32_t y,
+                                      int32_t width,
+                                      int32_t height,
+                                      uint32_t duration,
+                                      uint32_t easing)
+{
+    struct ivisurface *ivisurf = wl_resource_get_user_data(resource);
+    float to[4];
+    PROFILE_SCOPE(ivisurf->shell, client);
+    journal_request(ivisurf->shell, client,
+                    ILM_RECORD_SURFACE_TRANSITION_DESTINATION_RECTANGLE,
+                    "uuuuuuu",
+                    weston_layout_getIdOfSurface(ivisurf->layout_surface),
+                    (uint32_t)x, (uint32_t)y,
+                    (uint32_t)width, (uint32_t)height, duration, easing);
+
+    to[0] = (float)x;
+    to[1] = (float)y;
+    to[2] = (float)width;
+    to[3] = (float)height;
+    create_transition(ivisurf->shell, resource, ivisurf->layout_surface,
+                      NULL, TRANSITION_DESTINATION_RECTANGLE, to,
+                      duration, easing);
+}
+
+static const
+struct ivi_controller_surface_interface controller_surface_implementation = {
+    controller_surface_set_visibility,
+    controller_surface_set_opacity,
+    controller_surface_set_source_rectangle,
+    controller_surface_set_destination_rectangle,
+    controller_surface_set_configuration,
+    controller_surface_set_orientation,
+    controller_surface_screenshot,
+    controller_surface_send_stats,
+    controller_surface_destroy,
+    controller_surface_set_input_focus,
+    controller_surface_screenshot_buffer,
+    controller_surface_screenshot_file,
+    controller_surface_capture,
+    controller_surface_frame_stats,
+    controller_surface_screenshot_file_format,
+    controller_surface_transition_opacity,
+    controller_surface_transition_destination_rectangle
+};
+
+static void
+controller_layer_set_source_rectangle(struct wl_client *client,
+                   struct wl_resource *resource,
+                   int32_t x,
+                   int32_t y,
+                   int32_t width,
+                   int32_t height)
+{
+    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(ivilayer->shell, client);
+    journal_request(ivilayer->shell, client,
+                    ILM_RECORD_LAYER_SET_SOURCE_RECTANGLE, "uuuuu",
+                    weston_layout_getIdOfLayer(ivilayer->layout_layer),
+                    (uint32_t)x, (uint32_t)y,
+                    (uint32_t)width, (uint32_t)height);
+    stage_value(ivilayer->shell, client, resource, NULL,
+                ivilayer->layout_layer, STAGED_SOURCE_RECTANGLE,
+                0.0f, x, y, width, height);
+}
+
+static void
+controller_layer_set_destination_rectangle(struct wl_client *client,
+                 struct wl_resource *resource,
+                 int32_t x,
+                 int32_t y,
+                 int32_t width,
+                 int32_t height)
+{
+    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(ivilayer->shell, client);
+    journal_request(ivilayer->shell, client,
+                    ILM_RECORD_LAYER_SET_DESTINATION_RECTANGLE, "uuuuu",
+                    weston_layout_getIdOfLayer(ivilayer->layout_layer),
+                    (uint32_t)x, (uint32_t)y,
+                    (uint32_t)width, (uint32_t)height);
+    cancel_transitions(ivilayer->shell, NULL, ivilayer->layout_layer,
+                       TRANSITION_DESTINATION_RECTANGLE);
+    stage_value(ivilayer->shell, client, resource, NULL,
+                ivilayer->layout_layer, STAGED_DESTINATION_RECTANGLE,
+                0.0f, x, y, width, height);
+}
+
+static void
+controller_layer_set_visibility(struct wl_client *client,
+                    struct wl_resource *resource,
+                    uint32_t visibility)
+{
+    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(ivilayer->shell, client);
+    journal_request(ivilayer->shell, client, ILM_RECORD_LAYER_SET_VISIBILITY,
+                    "uu",
+                    weston_layout_getIdOfLayer(ivilayer->layout_layer),
+                    visibility);
+    stage_value(ivilayer->shell, client, resource, NULL,
+                ivilayer->layout_layer, STAGED_VISIBILITY,
+                0.0f, (int32_t)visibility, 0, 0, 0);
+}
+
+static void
+controller_layer_set_opacity(struct wl_client *client,
+                 struct wl_resource *resource,
+                 wl_fixed_t opacity)
+{
+    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(ivilayer->shell, client);
+    journal_request(ivilayer->shell, client, ILM_RECORD_LAYER_SET_OPACITY,
+                    "uf", weston_layout_getIdOfLayer(ivilayer->layout_layer),
+                    wl_fixed_to_double(opacity));
+    cancel_transitions(ivilayer->shell, NULL, ivilayer->layout_layer,
+                       TRANSITION_OPACITY);
+    stage_value(ivilayer->shell, client, resource, NULL,
+                ivilayer->layout_layer, STAGED_OPACITY,
+                (float)opacity, 0, 0, 0, 0);
+}
+
+static void
+controller_layer_set_configuration(struct wl_client *client,
+                 struct wl_resource *resource,
+                 int32_t width,
+                 int32_t height)
+{
+    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(ivilayer->shell, client);
+
+    /* This interface has been supported yet. */
+    (void)width;
+    (void)height;
+}
+
+static void
+controller_layer_set_orientation(struct wl_client *client,
+                 struct wl_resource *resource,
+                 int32_t orientation)
+{
+    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(ivilayer->shell, client);
+    journal_request(ivilayer->shell, client, ILM_RECORD_LAYER_SET_ORIENTATION,
+                    "uu", weston_layout_getIdOfLayer(ivilayer->layout_layer),
+                    (uint32_t)orientation);
+    stage_value(ivilayer->shell, client, resource, NULL,
+                ivilayer->layout_layer, STAGED_ORIENTATION,
+                0.0f, orientation, 0, 0, 0);
+}
+
+/*
+ * Staged render order of the layer or screen of a controller request, NULL
+ * after posting no_memory.
+ */
+static struct ivi_staged *
+stage_order(struct ivishell *shell, struct wl_client *client,
+            struct wl_resource *resource,
+            struct weston_layout_layer *layout_layer,
+            struct weston_layout_screen *layout_screen)
+{
+    struct ivi_staged *staged = NULL;
+
+    staged = stage_property(shell, client, NULL, layout_layer, layout_screen,
+                            STAGED_RENDER_ORDER);
+    if (staged == NULL) {
+        wl_resource_post_no_memory(resource);
+    }
+
+    return staged;
+}
+
+static void
+controller_layer_clear_surfaces(struct wl_client *client,
+                    struct wl_resource *resource)
+{
+    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
+    struct ivi_staged *staged = NULL;
+    PROFILE_SCOPE(ivilayer->shell, client);
+    journal_request(ivilayer->shell, client, ILM_RECORD_LAYER_SET_RENDER_ORDER,
+                    "ua",
+                    weston_layout_getIdOfLayer(ivilayer->layout_layer), NULL);
+
+    staged = stage_order(ivilayer->shell, client, resource,
+                         ivilayer->layout_layer, NULL);
+    if (staged == NULL) {
+        return;
+    }
+
+    staged->order.size = 0;
+    apply_staged(staged);
+}
+
+static void
+controller_layer_add_surface(struct wl_client *client,
+                 struct wl_resource *resource,
+                 struct wl_resource *surface)
+{
+    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
+    struct ivisurface *ivisurf = wl_resource_get_user_data(surface);
+    struct ivi_staged *staged = NULL;
+    PROFILE_SCOPE(ivilayer->shell, client);
+    journal_request(ivilayer->shell, client, ILM_RECORD_LAYER_ADD_SURFACE,
+                    "uu", weston_layout_getIdOfLayer(ivilayer->layout_layer),
+                    weston_layout_getIdOfSurface(ivisurf->layout_surface));
+
+    staged = stage_order(ivilayer->shell, client, resource,
+                         ivilayer->layout_layer, NULL);
+    if (staged == NULL) {
+        return;
+    }
+
+    if (add_to_order(&staged->order, ivisurf->layout_surface) != 0) {
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+    weston_layout_layerAddSurface(ivilayer->layout_layer, ivisurf->layout_surface);
+}
+
+static void
+controller_layer_remove_surface(struct wl_client *client,
+                    struct wl_resource *resource,
+                    struct wl_resource *surface)
+{
+    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
+    struct ivisurface *ivisurf = wl_resource_get_user_data(surface);
+    struct ivi_staged *staged = NULL;
+    PROFILE_SCOPE(ivilayer->shell, client);
+    journal_request(ivilayer->shell, client, ILM_RECORD_LAYER_REMOVE_SURFACE,
+                    "uu", weston_layout_getIdOfLayer(ivilayer->layout_layer),
+                    weston_layout_getIdOfSurface(ivisurf->layout_surface));
+
+    staged = stage_order(ivilayer->shell, client, resource,
+                         ivilayer->layout_layer, NULL);
+    if (staged == NULL) {
+        return;
+    }
+
+    remove_from_order(&staged->order, ivisurf->layout_surface);
+    weston_layout_layerRemoveSurface(ivilayer->layout_layer, ivisurf->layout_surface);
+}
+
+static void
+controller_layer_screenshot(struct wl_client *client,
+                struct wl_resource *resource,
+                const char *filename)
+{
+    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
+    struct ivicontroller_screenshot *shot = NULL;
+    struct iviscreen *iviscrn = NULL;
+    PROFILE_SCOPE(ivilayer->shell, client);
+    journal_request(ivilayer->shell, client, ILM_RECORD_TAKE_LAYER_SCREENSHOT,
+                    "us",
+                    weston_layout_getIdOfLayer(ivilayer->layout_layer),
+                    filename);
+
+    shot = screenshot_alloc(resource);
+    if (shot == NULL) {
+        return;
+    }
+
+    shot->type = SCREENSHOT_LAYER;
+    iviscrn = get_layer_area(ivilayer->shell, ivilayer->layout_layer,
+                             &shot->area);
+    screenshot_queue_file(shot, iviscrn, filename);
+}
+
+static void
+controller_layer_set_render_order(struct wl_client *client,
+                                  struct wl_resource *resource,
+                                  struct wl_array *id_surfaces)
+{
+    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
+    struct weston_layout_surface **layoutsurf = NULL;
+    struct ivisurface *ivisurf = NULL;
+    struct ivi_staged *staged = NULL;
+    uint32_t *id_surface = NULL;
+    PROFILE_SCOPE(ivilayer->shell, client);
+    journal_request(ivilayer->shell, client, ILM_RECORD_LAYER_SET_RENDER_ORDER,
+                    "ua",
+                    weston_layout_getIdOfLayer(ivilayer->layout_layer),
+                    id_surfaces);
+
+    staged = stage_order(ivilayer->shell, client, resource,
+                         ivilayer->layout_layer, NULL);
+    if (staged == NULL) {
+        return;
+    }
+
+    /* unknown ids are left out of the order */
+    staged->order.size = 0;
+    wl_array_for_each(id_surface, id_surfaces) {
+        ivisurf = get_surface(ivilayer->shell, *id_surface);
+        if (ivisurf == NULL) {
+            continue;
+        }
+
+        layoutsurf = wl_array_add(&staged->order, sizeof *layoutsurf);
+        if (layoutsurf == NULL) {
+            wl_resource_post_no_memory(resource);
+            return;
+        }
+        *layoutsurf = ivisurf->layout_surface;
+    }
+
+    apply_staged(staged);
+}
+
+static void
+controller_layer_destroy(struct wl_client *client,
+              struct wl_resource *resource,
+              int32_t destroy_scene_object)
+{
+    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
+    struct weston_layout_layer *layout_layer = ivilayer->layout_layer;
+    PROFILE_SCOPE(ivilayer->shell, client);
+    (void)destroy_scene_object;
+
+    journal_request(ivilayer->shell, client, ILM_RECORD_LAYER_REMOVE, "u",
+                    weston_layout_getIdOfLayer(layout_layer));
+
+    /* destroy_ivicontroller_layer unlinks the controller layer */
+    wl_resource_destroy(resource);
+
+    weston_layout_layerRemove(layout_layer);
+}
+
+static void
+controller_layer_screenshot_buffer(struct wl_client *client,
+                                   struct wl_resource *resource,
+                                   struct wl_resource *buffer,
+                                   uint32_t id)
+{
+    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
+    struct ivicontroller_screenshot *shot = NULL;
+    struct iviscreen *iviscrn = NULL;
+    struct ivirect area;
+    PROFILE_SCOPE(ivilayer->shell, client);
+
+    journal_request(ivilayer->shell, client,
+                    ILM_RECORD_TAKE_LAYER_SCREENSHOT_TO_BUFFER, "u",
+                    weston_layout_getIdOfLayer(ivilayer->layout_layer));
+
+    shot = screenshot_create(client, resource, id);
+    if (shot == NULL) {
+        return;
+    }
+
+    iviscrn = get_layer_area(ivilayer->shell, ivilayer->layout_layer, &area);
+    screenshot_queue_buffer(shot, iviscrn, &area, buffer);
+}
+
+static void
+layer_screenshot_file(struct wl_client *client,
+                      struct wl_resource *resource,
+                      const char *filename,
+                      enum ivi_image_format format,
+                      uint32_t id)
+{
+    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
+    struct ivicontroller_screenshot *shot = NULL;
+    struct iviscreen *iviscrn = NULL;
+
+    journal_request(ivilayer->shell, client, ILM_RECORD_TAKE_LAYER_SCREENSHOT,
+                    "us",
+                    weston_layout_getIdOfLayer(ivilayer->layout_layer),
+                    filename);
+
+    shot = screenshot_create(client, resource, id);
+    if (shot == NULL) {
+        return;
+    }
+
+    shot->type = SCREENSHOT_LAYER;
+    shot->format = format;
+    iviscrn = get_layer_area(ivilayer->shell, ivilayer->layout_layer,
+                             &shot->area);
+    screenshot_queue_file(shot, iviscrn, filename);
+}
+
+static void
+controller_layer_screenshot_file(struct wl_client *client,
+                                 struct wl_resource *resource,
+                                 const char *filename,
+                                 uint32_t id)
+{
+    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(ivilayer->shell, client);
+
+    layer_screenshot_file(client, resource, filename,
+                          IVI_IMAGE_FORMAT_PNG, id);
+}
+
+static void
+controller_layer_screenshot_file_format(struct wl_client *client,
+                                        struct wl_resource *resource,
+                                        const char *filename,
+                                        uint32_t format,
+                                        uint32_t id)
+{
+    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(ivilayer->shell, client);
+
+    if (!ivi_image_format_is_valid(format)) {
+        wl_resource_post_error(resource,
+                               IVI_CONTROLLER_LAYER_ERROR_BAD_FORMAT,
+                               "unknown screenshot format %u", format);
+        return;
+    }
+
+    layer_screenshot_file(client, resource, filename,
+                          (enum ivi_image_format)format, id);
+}
+
+static void
+controller_layer_transition_opacity(struct wl_client *client,
+                                    struct wl_resource *resource,
+                                    wl_fixed_t opacity,
+                                    uint32_t duration,
+                                    uint32_t easing)
+{
+    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
+    float to[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    PROFILE_SCOPE(ivilayer->shell, client);
+    journal_request(ivilayer->shell, client,
+                    ILM_RECORD_LAYER_TRANSITION_OPACITY, "ufuu",
+                    weston_layout_getIdOfLayer(ivilayer->layout_layer),
+                    wl_fixed_to_double(opacity), duration, easing);
+
+    to[0] = (float)opacity;
+    create_transition(ivilayer->shell, resource, NULL, ivilayer->layout_layer,
+                      TRANSITION_OPACITY, to, duration, easing);
+}
+
+static void
+controller_layer_transition_destination_rectangle(struct wl_client *client,
+                                                  struct wl_resource *resource,
+                                                  int32_t x,
+                                                  int32_t y,
+                                                  int32_t width,
+                                                  int32_t height,
+                                                  uint32_t duration,
+                                                  uint32_t easing)
+{
+    struct ivilayer *ivilayer = wl_resource_get_user_data(resource);
+    float to[4];
+    PROFILE_SCOPE(ivilayer->shell, client);
+    journal_request(ivilayer->shell, client,
+                    ILM_RECORD_LAYER_TRANSITION_DESTINATION_RECTANGLE,
+                    "uuuuuuu",
+                    weston_layout_getIdOfLayer(ivilayer->layout_layer),
+                    (uint32_t)x, (uint32_t)y,
+                    (uint32_t)width, (uint32_t)height, duration, easing);
+
+    to[0] = (float)x;
+    to[1] = (float)y;
+    to[2] = (float)width;
+    to[3] = (float)height;
+    create_transition(ivilayer->shell, resource, NULL, ivilayer->layout_layer,
+                      TRANSITION_DESTINATION_RECTANGLE, to, duration, easing);
+}
+
+static const
+struct ivi_controller_layer_interface controller_layer_implementation = {
     controller_layer_set_visibility,
     controller_layer_set_opacity,
     controller_layer_set_source_rectangle,
@@ -943,370 +4654,1707 @@ struct ivi_controller_layer_interface controller_layer_implementation = {
     controller_layer_add_surface,
     controller_layer_remove_surface,
     controller_layer_set_render_order,
-    controller_layer_destroy
+    controller_layer_destroy,
+    controller_layer_screenshot_buffer,
+    controller_layer_screenshot_file,
+    controller_layer_screenshot_file_format,
+    controller_layer_transition_opacity,
+    controller_layer_transition_destination_rectangle
+};
+
+static void
+controller_screen_destroy(struct wl_client *client,
+                          struct wl_resource *resource)
+{
+    struct iviscreen *iviscrn = wl_resource_get_user_data(resource);
+    struct ivicontroller_screen *ctrlscrn = NULL;
+    struct ivicontroller_screen *next = NULL;
+    PROFILE_SCOPE(iviscrn->shell, client);
+
+    wl_list_for_each_safe(ctrlscrn, next,
+                          &iviscrn->shell->list_controller_screen, link) {
+        if (resource != ctrlscrn->resource) {
+            continue;
+        }
+
+        /* the controller screen is freed by the resource destructor */
+        wl_resource_destroy(resource);
+        break;
+    }
+}
+
+static void
+controller_screen_clear(struct wl_client *client,
+                struct wl_resource *resource)
+{
+    struct iviscreen *iviscrn = wl_resource_get_user_data(resource);
+    struct ivi_staged *staged = NULL;
+    PROFILE_SCOPE(iviscrn->shell, client);
+    journal_request(iviscrn->shell, client, ILM_RECORD_DISPLAY_SET_RENDER_ORDER,
+                    "ua",
+                    weston_layout_getIdOfScreen(iviscrn->layout_screen), NULL);
+
+    staged = stage_order(iviscrn->shell, client, resource, NULL,
+                         iviscrn->layout_screen);
+    if (staged == NULL) {
+        return;
+    }
+
+    staged->order.size = 0;
+    apply_staged(staged);
+}
+
+static void
+controller_screen_add_layer(struct wl_client *client,
+                struct wl_resource *resource,
+                struct wl_resource *layer)
+{
+    struct iviscreen *iviscrn = wl_resource_get_user_data(resource);
+    struct ivilayer *ivilayer = wl_resource_get_user_data(layer);
+    struct ivi_staged *staged = NULL;
+    PROFILE_SCOPE(iviscrn->shell, client);
+
+    staged = stage_order(iviscrn->shell, client, resource, NULL,
+                         iviscrn->layout_screen);
+    if (staged == NULL) {
+        return;
+    }
+
+    if (add_to_order(&staged->order, ivilayer->layout_layer) != 0) {
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+    weston_layout_screenAddLayer(iviscrn->layout_screen, ivilayer->layout_layer);
+}
+
+static void
+controller_screen_screenshot(struct wl_client *client,
+                struct wl_resource *resource,
+                const char *filename)
+{
+    struct iviscreen *iviscrn = wl_resource_get_user_data(resource);
+    struct ivicontroller_screenshot *shot = NULL;
+    PROFILE_SCOPE(iviscrn->shell, client);
+    journal_request(iviscrn->shell, client, ILM_RECORD_TAKE_SCREENSHOT,
+                    "us",
+                    weston_layout_getIdOfScreen(iviscrn->layout_screen),
+                    filename);
+
+    shot = screenshot_alloc(resource);
+    if (shot == NULL) {
+        return;
+    }
+
+    shot->type = SCREENSHOT_SCREEN;
+    screenshot_queue_file(shot, iviscrn, filename);
+}
+
+static void
+controller_screen_set_render_order(struct wl_client *client,
+                struct wl_resource *resource,
+                struct wl_array *id_layers)
+{
+    struct iviscreen *iviscrn = wl_resource_get_user_data(resource);
+    struct weston_layout_layer **layoutlayer = NULL;
+    struct ivilayer *ivilayer = NULL;
+    struct ivi_staged *staged = NULL;
+    uint32_t *id_layer = NULL;
+    PROFILE_SCOPE(iviscrn->shell, client);
+    journal_request(iviscrn->shell, client, ILM_RECORD_DISPLAY_SET_RENDER_ORDER,
+                    "ua",
+                    weston_layout_getIdOfScreen(iviscrn->layout_screen),
+                    id_layers);
+
+    staged = stage_order(iviscrn->shell, client, resource, NULL,
+                         iviscrn->layout_screen);
+    if (staged == NULL) {
+        return;
+    }
+
+    /* unknown ids are left out of the order */
+    staged->order.size = 0;
+    wl_array_for_each(id_layer, id_layers) {
+        ivilayer = get_layer(iviscrn->shell, *id_layer);
+        if (ivilayer == NULL) {
+            continue;
+        }
+
+        layoutlayer = wl_array_add(&staged->order, sizeof *layoutlayer);
+        if (layoutlayer == NULL) {
+            wl_resource_post_no_memory(resource);
+            return;
+        }
+        *layoutlayer = ivilayer->layout_layer;
+    }
+
+    apply_staged(staged);
+}
+
+static void
+controller_screen_screenshot_buffer(struct wl_client *client,
+                                    struct wl_resource *resource,
+                                    struct wl_resource *buffer,
+                                    uint32_t id)
+{
+    struct iviscreen *iviscrn = wl_resource_get_user_data(resource);
+    struct weston_mode *mode = iviscrn->output->current_mode;
+    struct ivicontroller_screenshot *shot = NULL;
+    struct ivirect area = {0, 0, mode->width, mode->height};
+    PROFILE_SCOPE(iviscrn->shell, client);
+
+    journal_request(iviscrn->shell, client,
+                    ILM_RECORD_TAKE_SCREENSHOT_TO_BUFFER, "u",
+                    weston_layout_getIdOfScreen(iviscrn->layout_screen));
+
+    shot = screenshot_create(client, resource, id);
+    if (shot == NULL) {
+        return;
+    }
+
+    screenshot_queue_buffer(shot, iviscrn, &area, buffer);
+}
+
+static void
+screen_screenshot_file(struct wl_client *client,
+                       struct wl_resource *resource,
+                       const char *filename,
+                       enum ivi_image_format format,
+                       uint32_t id)
+{
+    struct iviscreen *iviscrn = wl_resource_get_user_data(resource);
+    struct ivicontroller_screenshot *shot = NULL;
+
+    journal_request(iviscrn->shell, client, ILM_RECORD_TAKE_SCREENSHOT,
+                    "us",
+                    weston_layout_getIdOfScreen(iviscrn->layout_screen),
+                    filename);
+
+    shot = screenshot_create(client, resource, id);
+    if (shot == NULL) {
+        return;
+    }
+
+    shot->type = SCREENSHOT_SCREEN;
+    shot->format = format;
+    screenshot_queue_file(shot, iviscrn, filename);
+}
+
+static void
+controller_screen_screenshot_file(struct wl_client *client,
+                                  struct wl_resource *resource,
+                                  const char *filename,
+                                  uint32_t id)
+{
+    struct iviscreen *iviscrn = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(iviscrn->shell, client);
+
+    screen_screenshot_file(client, resource, filename,
+                           IVI_IMAGE_FORMAT_PNG, id);
+}
+
+static void
+controller_screen_screenshot_file_format(struct wl_client *client,
+                                         struct wl_resource *resource,
+                                         const char *filename,
+                                         uint32_t format,
+                                         uint32_t id)
+{
+    struct iviscreen *iviscrn = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(iviscrn->shell, client);
+
+    if (!ivi_image_format_is_valid(format)) {
+        wl_resource_post_error(resource,
+                               IVI_CONTROLLER_SCREEN_ERROR_BAD_FORMAT,
+                               "unknown screenshot format %u", format);
+        return;
+    }
+
+    screen_screenshot_file(client, resource, filename,
+                           (enum ivi_image_format)format, id);
+}
+
+static void
+controller_screen_capture(struct wl_client *client,
+                          struct wl_resource *resource,
+                          uint32_t id,
+                          uint32_t interval)
+{
+    struct iviscreen *iviscrn = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(iviscrn->shell, client);
+
+    capture_create(client, resource, id, interval, iviscrn->shell,
+                   iviscrn, 0);
+}
+
+static const
+struct ivi_controller_screen_interface controller_screen_implementation = {
+    controller_screen_destroy,
+    controller_screen_clear,
+    controller_screen_add_layer,
+    controller_screen_screenshot,
+    controller_screen_set_render_order,
+    controller_screen_screenshot_buffer,
+    controller_screen_screenshot_file,
+    controller_screen_capture,
+    controller_screen_screenshot_file_format
+};
+
+static void
+controller_commit_changes(struct wl_client *client,
+                          struct wl_resource *resource)
+{
+    struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
+    int32_t ans = 0;
+    PROFILE_SCOPE(ctrl->shell, client);
+    journal_request(ctrl->shell, client, ILM_RECORD_COMMIT_CHANGES, "");
+
+    ans = weston_layout_commitChanges();
+    if (ans < 0) {
+        weston_log("Failed to commit changes at controller_commit_changes\n");
+    }
+    clear_staged_changes(ctrl->shell);
+
+    start_transitions(ctrl->shell);
+    schedule_marked_screens(ctrl->shell);
+    update_effective_visibility(ctrl->shell);
+}
+
+static void
+controller_layer_create(struct wl_client *client,
+                        struct wl_resource *resource,
+                        uint32_t id_layer,
+                        int32_t width,
+                        int32_t height,
+                        uint32_t id)
+{
+    struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
+    struct ivishell *shell = ctrl->shell;
+    struct weston_layout_layer *layout_layer = NULL;
+    struct ivicontroller_layer *ctrllayer = NULL;
+    struct ivilayer *ivilayer = NULL;
+    struct weston_layout_LayerProperties prop;
+    PROFILE_SCOPE(shell, client);
+
+    ivilayer = get_layer(shell, id_layer);
+    if (ivilayer == NULL) {
+        layout_layer = weston_layout_layerCreateWithDimension(id_layer,
+                           (uint32_t)width, (uint32_t)height);
+        if (layout_layer == NULL) {
+            weston_log("id_layer is already created\n");
+            return;
+        }
+
+        journal_request(shell, client, ILM_RECORD_LAYER_CREATE_WITH_DIMENSION,
+                        "uuuu", id_layer, (uint32_t)width, (uint32_t)height,
+                        id_layer);
+
+        /* ivilayer will be created by layer_event_create */
+        ivilayer = get_layer(shell, id_layer);
+        if (ivilayer == NULL) {
+            weston_log("couldn't get layer object\n");
+            return;
+        }
+    }
+
+    ctrllayer = controller_object_alloc(shell, client, CONTROLLER_OBJECT_LAYER);
+    if (!ctrllayer) {
+        weston_log("no memory to allocate client layer\n");
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+
+    ctrllayer->shell = shell;
+    ctrllayer->client = client;
+    ctrllayer->id = id;
+    ctrllayer->id_layer = id_layer;
+    ctrllayer->resource = wl_resource_create(client,
+                               &ivi_controller_layer_interface,
+                               wl_resource_get_version(resource), id);
+    if (ctrllayer->resource == NULL) {
+        weston_log("couldn't get layer object\n");
+        controller_object_free(shell, client, CONTROLLER_OBJECT_LAYER,
+                               ctrllayer);
+        return;
+    }
+
+    ivi_id_index_insert(&shell->controller_layers, id_layer,
+                        &ctrllayer->link);
+
+    wl_resource_set_implementation(ctrllayer->resource,
+                                   &controller_layer_implementation,
+                                   ivilayer, destroy_ivicontroller_layer);
+
+    memset(&prop, 0, sizeof prop);
+
+    weston_layout_getPropertiesOfLayer(ivilayer->layout_layer, &prop);
+
+    /* the new controller layer learns the screens showing the layer */
+    send_layer_screens(ivilayer, ctrllayer->resource,
+                       &ivilayer->screens.keys, 0);
+
+    /*
+     * Only the new controller layer gets the initial state, the others
+     * know it already. Version 6 knows it from the scene events.
+     */
+    if (wl_resource_get_version(ctrllayer->resource) <
+        IVI_CONTROLLER_SCENE_SINCE_VERSION) {
+        send_layer_event(ctrllayer->resource, &prop, IVI_NOTIFICATION_ALL);
+    }
+}
+
+static void
+controller_surface_create(struct wl_client *client,
+                          struct wl_resource *resource,
+                          uint32_t id_surface,
+                          uint32_t id)
+{
+    struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
+    struct ivishell *shell = ctrl->shell;
+    struct ivicontroller_surface *ctrlsurf = NULL;
+    struct weston_layout_SurfaceProperties prop;
+    struct ivisurface *ivisurf = NULL;
+    PROFILE_SCOPE(shell, client);
+
+    ctrlsurf = controller_object_alloc(shell, client,
+                                       CONTROLLER_OBJECT_SURFACE);
+    if (!ctrlsurf) {
+        weston_log("no memory to allocate controller surface\n");
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+
+    ctrlsurf->shell = shell;
+    ctrlsurf->client = client;
+    ctrlsurf->id = id;
+    ctrlsurf->id_surface = id_surface;
+    ivi_id_index_insert(&shell->controller_surfaces, id_surface,
+                        &ctrlsurf->link);
+
+    ctrlsurf->resource = wl_resource_create(client,
+                               &ivi_controller_surface_interface,
+                               wl_resource_get_version(resource), id);
+    if (ctrlsurf->resource == NULL) {
+        weston_log("couldn't surface object");
+        ivi_id_index_remove(&shell->controller_surfaces, id_surface,
+                            &ctrlsurf->link);
+        controller_object_free(shell, client, CONTROLLER_OBJECT_SURFACE,
+                               ctrlsurf);
+        return;
+    }
+
+    ivisurf = get_surface(shell, id_surface);
+    if (ivisurf == NULL) {
+        /* the resource has no destructor yet, release the object here */
+        ivi_id_index_remove(&shell->controller_surfaces, id_surface,
+                            &ctrlsurf->link);
+        wl_resource_destroy(ctrlsurf->resource);
+        controller_object_free(shell, client, CONTROLLER_OBJECT_SURFACE,
+                               ctrlsurf);
+        return;
+    }
+
+    wl_resource_set_implementation(ctrlsurf->resource,
+                                   &controller_surface_implementation,
+                                   ivisurf, destroy_ivicontroller_surface);
+
+    memset(&prop, 0, sizeof prop);
+
+    weston_layout_getPropertiesOfSurface(ivisurf->layout_surface, &prop);
+
+    /* the new controller surface learns the layers the surface is on */
+    send_surface_layers(ivisurf, ctrlsurf->resource,
+                        &ivisurf->layers.keys, 0);
+
+    /*
+     * Only the new controller surface gets the initial state, the others
+     * know it already. Version 6 knows it from the scene events.
+     */
+    if (wl_resource_get_version(ctrlsurf->resource) <
+        IVI_CONTROLLER_SCENE_SINCE_VERSION) {
+        send_surface_event(ctrlsurf->resource, &prop, IVI_NOTIFICATION_ALL);
+    }
+
+    if (wl_resource_get_version(ctrlsurf->resource) >=
+        IVI_CONTROLLER_SURFACE_EFFECTIVE_VISIBILITY_SINCE_VERSION) {
+        ivi_controller_surface_send_effective_visibility(
+            ctrlsurf->resource, ivisurf->effective_visibility);
+    }
+}
+
+static int
+title_matches(const char *title, const char *surface_title)
+{
+    if (title == NULL) {
+        return 1;
+    }
+
+    return (surface_title != NULL) && (strcmp(title, surface_title) == 0);
+}
+
+static void
+send_native_handle(struct wl_resource *resource, struct weston_surface *es,
+                   int watch)
+{
+    struct wl_client *client = wl_resource_get_client(resource);
+    struct wl_resource *res = NULL;
+
+    res = wl_resource_create(client, &wl_surface_interface, 1, 0);
+    if (res == NULL) {
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+    wl_resource_set_user_data(res, es);
+
+    if (watch) {
+        ivi_controller_native_handle_watch_send_native_handle(resource, res);
+    } else {
+        ivi_controller_send_native_handle(resource, res);
+    }
+}
+
+static void
+notify_native_handle_watches(struct ivishell *shell,
+                             struct native_handle_entry *entry)
+{
+    struct ivicontroller_native_handle_watch *watch = NULL;
+
+    wl_list_for_each(watch, &shell->list_native_handle_watch, link) {
+        if ((watch->pid == entry->pid) &&
+            title_matches(watch->title, entry->title)) {
+            send_native_handle(watch->resource, entry->surface, 1);
+        }
+    }
+}
+
+static void
+native_handle_entry_destroy(struct native_handle_entry *entry)
+{
+    ivi_id_index_remove(&entry->shell->native_handles, entry->pid,
+                        &entry->link);
+    wl_list_remove(&entry->surface_destroy_listener.link);
+    free(entry->title);
+    free(entry);
+}
+
+static void
+native_handle_surface_destroyed(struct wl_listener *listener, void *data)
+{
+    struct native_handle_entry *entry =
+        wl_container_of(listener, entry, surface_destroy_listener);
+    (void)data;
+
+    native_handle_entry_destroy(entry);
+}
+
+static int
+native_handle_entry_set(struct native_handle_entry *entry, uint32_t pid,
+                        const char *title)
+{
+    char *title_copy = NULL;
+
+    if (title != NULL) {
+        title_copy = strdup(title);
+        if (title_copy == NULL) {
+            return -1;
+        }
+    }
+
+    free(entry->title);
+    entry->title = title_copy;
+
+    if (entry->pid != pid) {
+        ivi_id_index_remove(&entry->shell->native_handles, entry->pid,
+                            &entry->link);
+        entry->pid = pid;
+        ivi_id_index_insert(&entry->shell->native_handles, pid,
+                            &entry->link);
+    }
+
+    return 0;
+}
+
+static struct native_handle_entry *
+native_handle_entry_create(struct ivishell *shell, struct weston_surface *es,
+                           uint32_t pid, const char *title)
+{
+    struct native_handle_entry *entry = NULL;
+
+    entry = calloc(1, sizeof *entry);
+    if (entry == NULL) {
+        return NULL;
+    }
+
+    if (title != NULL) {
+        entry->title = strdup(title);
+        if (entry->title == NULL) {
+            free(entry);
+            return NULL;
+        }
+    }
+
+    entry->shell = shell;
+    entry->surface = es;
+    entry->pid = pid;
+    ivi_id_index_insert(&shell->native_handles, pid, &entry->link);
+    entry->surface_destroy_listener.notify = native_handle_surface_destroyed;
+    wl_signal_add(&es->destroy_signal, &entry->surface_destroy_listener);
+
+    return entry;
+}
+
+static struct native_handle_entry *
+find_native_handle_entry(struct weston_surface *es)
+{
+    struct native_handle_entry *entry = NULL;
+    struct wl_listener *listener = NULL;
+
+    listener = wl_signal_get(&es->destroy_signal,
+                             native_handle_surface_destroyed);
+    if (listener == NULL) {
+        return NULL;
+    }
+
+    return wl_container_of(listener, entry, surface_destroy_listener);
+}
+
+/*
+ * Index the shell surface, or update its process and title. Watches are
+ * told about surfaces which are new or changed.
+ */
+static void
+index_shell_surface(struct ivishell *shell, struct shell_surface *shsurf)
+{
+    struct native_handle_entry *entry = NULL;
+    struct weston_surface *es = NULL;
+    const char *title = NULL;
+    uint32_t pid = 0;
+
+    es = shell_surface_get_surface(shsurf);
+    if (es == NULL) {
+        return;
+    }
+
+    pid = shell_surface_get_process_id(shsurf);
+    title = shell_surface_get_title(shsurf);
+
+    entry = find_native_handle_entry(es);
+    if (entry == NULL) {
+        entry = native_handle_entry_create(shell, es, pid, title);
+        if (entry == NULL) {
+            weston_log("no memory to index shell surface\n");
+            return;
+        }
+    } else if ((entry->pid == pid) &&
+               ((entry->title == NULL) == (title == NULL)) &&
+               ((title == NULL) || (strcmp(entry->title, title) == 0))) {
+        return;
+    } else if (native_handle_entry_set(entry, pid, title) != 0) {
+        weston_log("no memory to index shell surface\n");
+        return;
+    }
+
+    notify_native_handle_watches(shell, entry);
+}
+
+static void
+shell_surface_event_create(struct shell_surface *shsurf, void *userdata)
+{
+    index_shell_surface(userdata, shsurf);
+}
+
+static void
+shell_surface_event_change(struct shell_surface *shsurf, void *userdata)
+{
+    index_shell_surface(userdata, shsurf);
+}
+
+/* the shell surface is gone, but not necessarily its weston surface */
+static void
+shell_surface_event_remove(struct shell_surface *shsurf, void *userdata)
+{
+    struct native_handle_entry *entry = NULL;
+    struct weston_surface *es = NULL;
+    (void)userdata;
+
+    es = shell_surface_get_surface(shsurf);
+    if (es == NULL) {
+        return;
+    }
+
+    entry = find_native_handle_entry(es);
+    if (entry != NULL) {
+        native_handle_entry_destroy(entry);
+    }
+}
+
+/*
+ * Index the shell surfaces which exist before the notifications are set.
+ */
+static void
+index_shell_surfaces(struct ivishell *shell)
+{
+    struct shell_surface **shsurf = NULL;
+    struct wl_array surfaces;
+
+    wl_array_init(&surfaces);
+    ivi_shell_get_shell_surfaces(&surfaces);
+
+    wl_array_for_each(shsurf, &surfaces) {
+        index_shell_surface(shell, *shsurf);
+    }
+
+    wl_array_release(&surfaces);
+}
+
+static void
+controller_get_native_handle(struct wl_client *client,
+                             struct wl_resource *resource,
+                             uint32_t id_process,
+                             const char *title)
+{
+    struct ivicontroller *controller = wl_resource_get_user_data(resource);
+    struct ivishell *shell = controller->shell;
+    struct native_handle_entry *entry = NULL;
+    int32_t id_object = 0;
+    PROFILE_SCOPE(shell, client);
+
+    wl_list_for_each(entry,
+                     ivi_id_index_find(&shell->native_handles, id_process),
+                     link) {
+        if (title_matches(title, entry->title)) {
+            send_native_handle(resource, entry->surface, 0);
+        }
+    }
+
+    ivi_controller_send_error(
+        resource, id_object, IVI_CONTROLLER_OBJECT_TYPE_SURFACE,
+        IVI_CONTROLLER_ERROR_CODE_NATIVE_HANDLE_END, "");
+}
+
+static void
+destroy_native_handle_watch(struct wl_resource *resource)
+{
+    struct ivicontroller_native_handle_watch *watch =
+        wl_resource_get_user_data(resource);
+
+    wl_list_remove(&watch->link);
+    free(watch->title);
+    free(watch);
+}
+
+static void
+native_handle_watch_destroy(struct wl_client *client,
+                            struct wl_resource *resource)
+{
+    struct ivicontroller_native_handle_watch *watch =
+        wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(watch->shell, client);
+    wl_resource_destroy(resource);
+}
+
+static const
+struct ivi_controller_native_handle_watch_interface native_handle_watch_implementation = {
+    native_handle_watch_destroy
+};
+
+static void
+controller_watch_native_handle(struct wl_client *client,
+                               struct wl_resource *resource,
+                               uint32_t id,
+                               uint32_t id_process,
+                               const char *title)
+{
+    struct ivicontroller *controller = wl_resource_get_user_data(resource);
+    struct ivishell *shell = controller->shell;
+    struct ivicontroller_native_handle_watch *watch = NULL;
+    struct native_handle_entry *entry = NULL;
+    PROFILE_SCOPE(shell, client);
+
+    watch = calloc(1, sizeof *watch);
+    if (watch == NULL) {
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+
+    if (title != NULL) {
+        watch->title = strdup(title);
+        if (watch->title == NULL) {
+            free(watch);
+            wl_resource_post_no_memory(resource);
+            return;
+        }
+    }
+
+    watch->resource = wl_resource_create(client,
+                          &ivi_controller_native_handle_watch_interface, 1, id);
+    if (watch->resource == NULL) {
+        free(watch->title);
+        free(watch);
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+
+    watch->shell = shell;
+    watch->pid = id_process;
+    wl_resource_set_implementation(watch->resource,
+                                   &native_handle_watch_implementation,
+                                   watch, destroy_native_handle_watch);
+
+    /* existing surfaces are reported now, before the watch is linked */
+    wl_list_for_each(entry,
+                     ivi_id_index_find(&shell->native_handles, id_process),
+                     link) {
+        if (title_matches(watch->title, entry->title)) {
+            send_native_handle(watch->resource, entry->surface, 1);
+        }
+    }
+
+    wl_list_insert(&shell->list_native_handle_watch, &watch->link);
+}
+
+static void
+destroy_commit_feedback(struct wl_resource *resource)
+{
+    struct ivicontroller_commit_feedback *feedback =
+        wl_resource_get_user_data(resource);
+
+    wl_list_remove(&feedback->link);
+    free(feedback);
+}
+
+static void
+controller_commit_changes_on_frame(struct wl_client *client,
+                                   struct wl_resource *resource,
+                                   uint32_t id)
+{
+    struct ivicontroller *controller = wl_resource_get_user_data(resource);
+    struct ivishell *shell = controller->shell;
+    struct ivicontroller_commit_feedback *feedback = NULL;
+    struct iviscreen *iviscrn = NULL;
+    PROFILE_SCOPE(shell, client);
+
+    journal_request(shell, client, ILM_RECORD_COMMIT_CHANGES_ON_FRAME, "");
+
+    feedback = calloc(1, sizeof *feedback);
+    if (feedback == NULL) {
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+
+    feedback->resource =
+        wl_resource_create(client, &ivi_controller_commit_feedback_interface,
+                           1, id);
+    if (feedback->resource == NULL) {
+        free(feedback);
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+
+    wl_resource_set_implementation(feedback->resource, NULL,
+                                   feedback, destroy_commit_feedback);
+
+    if (wl_list_empty(&shell->list_screen)) {
+        wl_list_init(&feedback->link);
+        ivi_controller_commit_feedback_send_discarded(feedback->resource);
+        wl_resource_destroy(feedback->resource);
+        return;
+    }
+
+    wl_list_insert(shell->list_commit_pending.prev, &feedback->link);
+
+    /* the changes are latched by the next repaint of any screen, make sure
+     * one happens */
+    iviscrn = wl_container_of(shell->list_screen.next, iviscrn, link);
+    weston_output_schedule_repaint(iviscrn->output);
+}
+
+static void
+controller_set_event_rate(struct wl_client *client,
+                          struct wl_resource *resource,
+                          uint32_t policy,
+                          uint32_t max_rate)
+{
+    struct ivicontroller *controller = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(controller->shell, client);
+
+    switch (policy) {
+    case IVI_CONTROLLER_EVENT_RATE_IMMEDIATE:
+    case IVI_CONTROLLER_EVENT_RATE_FRAME:
+        controller->event_interval = 0;
+        break;
+    case IVI_CONTROLLER_EVENT_RATE_LIMITED:
+        controller->event_interval = 1000 / ((max_rate > 0) ? max_rate : 1);
+        break;
+    default:
+        wl_resource_post_error(resource,
+                               IVI_CONTROLLER_PROTOCOL_ERROR_BAD_EVENT_RATE,
+                               "unknown event rate policy %u", policy);
+        return;
+    }
+
+    controller->event_rate = policy;
+
+    /* nothing is held back from an immediate controller */
+    if (policy == IVI_CONTROLLER_EVENT_RATE_IMMEDIATE) {
+        send_pending_changes(controller);
+    }
+}
+
+static void
+controller_add_interest(struct wl_client *client,
+                        struct wl_resource *resource,
+                        uint32_t object_type,
+                        uint32_t id_min,
+                        uint32_t id_max,
+                        uint32_t flags)
+{
+    struct ivicontroller *controller = wl_resource_get_user_data(resource);
+    struct ivi_interest *interest = NULL;
+    PROFILE_SCOPE(controller->shell, client);
+
+    if ((object_type != IVI_CONTROLLER_OBJECT_TYPE_SURFACE) &&
+        (object_type != IVI_CONTROLLER_OBJECT_TYPE_LAYER)) {
+        wl_resource_post_error(resource,
+                               IVI_CONTROLLER_PROTOCOL_ERROR_BAD_INTEREST,
+                               "no interest in object type %u", object_type);
+        return;
+    }
+
+    if (id_min > id_max) {
+        wl_resource_post_error(resource,
+                               IVI_CONTROLLER_PROTOCOL_ERROR_BAD_INTEREST,
+                               "empty interest range %u to %u",
+                               id_min, id_max);
+        return;
+    }
+
+    interest = wl_array_add(&controller->interests, sizeof *interest);
+    if (interest == NULL) {
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+
+    interest->object_type = object_type;
+    interest->id_min = id_min;
+    interest->id_max = id_max;
+    interest->flags = flags;
+
+    if ((object_type == IVI_CONTROLLER_OBJECT_TYPE_LAYER) &&
+        (flags & IVI_CONTROLLER_INTEREST_FLAG_MEMBERS)) {
+        controller->interest_members = 1;
+    }
+}
+
+static void
+controller_set_interest_fields(struct wl_client *client,
+                               struct wl_resource *resource,
+                               uint32_t fields)
+{
+    struct ivicontroller *controller = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(controller->shell, client);
+
+    controller->interest_fields = fields & SCENE_FIELDS_ALL;
+}
+
+static void
+controller_clear_interest(struct wl_client *client,
+                          struct wl_resource *resource)
+{
+    struct ivicontroller *controller = wl_resource_get_user_data(resource);
+    PROFILE_SCOPE(controller->shell, client);
+
+    controller->interests.size = 0;
+    controller->interest_members = 0;
+    controller->interest_fields = SCENE_FIELDS_ALL;
+}
+
+static const struct ivi_controller_interface controller_implementation = {
+    controller_commit_changes,
+    controller_layer_create,
+    controller_surface_create,
+    controller_get_native_handle,
+    controller_commit_changes_on_frame,
+    controller_set_event_rate,
+    controller_watch_native_handle,
+    controller_add_interest,
+    controller_set_interest_fields,
+    controller_clear_interest
 };
 
+static int
+create_scene_file(const void *data, size_t size)
+{
+    static const char template[] = "/ivi-scene-XXXXXX";
+    const char *path = getenv("XDG_RUNTIME_DIR");
+    const char *pos = data;
+    char *name = NULL;
+    ssize_t written = 0;
+    int fd = -1;
+
+    if (path == NULL) {
+        weston_log("XDG_RUNTIME_DIR is not set\n");
+        return -1;
+    }
+
+    name = malloc(strlen(path) + sizeof template);
+    if (name == NULL) {
+        return -1;
+    }
+    strcpy(name, path);
+    strcat(name, template);
+
+    fd = mkstemp(name);
+    if (fd >= 0) {
+        unlink(name);
+        fcntl(fd, F_SETFD, fcntl(fd, F_GETFD) | FD_CLOEXEC);
+    }
+    free(name);
+
+    while ((fd >= 0) && (size > 0)) {
+        written = write(fd, pos, size);
+        if (written < 0) {
+            close(fd);
+            fd = -1;
+            break;
+        }
+        pos += written;
+        size -= written;
+    }
+
+    return fd;
+}
+
+static int32_t
+add_scene_objects(struct ivishell *shell, struct wl_array *scene)
+{
+    struct weston_layout_SurfaceProperties surface_prop;
+    struct weston_layout_LayerProperties layer_prop;
+    struct ivi_scene_change *change = NULL;
+    struct ivisurface *ivisurf = NULL;
+    struct ivilayer *ivilayer = NULL;
+
+    wl_list_for_each(ivisurf, &shell->list_surface, link) {
+        change = wl_array_add(scene, sizeof *change);
+        if (change == NULL) {
+            return -1;
+        }
+
+        memset(change, 0, sizeof *change);
+        change->object_type = IVI_CONTROLLER_OBJECT_TYPE_SURFACE;
+        change->id = weston_layout_getIdOfSurface(ivisurf->layout_surface);
+
+        memset(&surface_prop, 0, sizeof surface_prop);
+        weston_layout_getPropertiesOfSurface(ivisurf->layout_surface,
+                                             &surface_prop);
+        set_surface_change(change, &surface_prop, IVI_NOTIFICATION_ALL);
+    }
+
+    wl_list_for_each(ivilayer, &shell->list_layer, link) {
+        change = wl_array_add(scene, sizeof *change);
+        if (change == NULL) {
+            return -1;
+        }
+
+        memset(change, 0, sizeof *change);
+        change->object_type = IVI_CONTROLLER_OBJECT_TYPE_LAYER;
+        change->id = weston_layout_getIdOfLayer(ivilayer->layout_layer);
+
+        memset(&layer_prop, 0, sizeof layer_prop);
+        weston_layout_getPropertiesOfLayer(ivilayer->layout_layer,
+                                           &layer_prop);
+        set_layer_change(change, &layer_prop, IVI_NOTIFICATION_ALL);
+    }
+
+    return 0;
+}
+
+/*
+ * Append the render order entry of a screen or layer, returning the room
+ * for its length ids.
+ */
+static uint32_t *
+add_scene_order(struct wl_array *scene, uint32_t object_type,
+                uint32_t id, uint32_t length)
+{
+    uint32_t *entry = NULL;
+
+    entry = wl_array_add(scene, (3 + length) * sizeof *entry);
+    if (entry == NULL) {
+        return NULL;
+    }
+
+    entry[0] = object_type;
+    entry[1] = id;
+    entry[2] = length;
+
+    return &entry[3];
+}
+
+static int32_t
+add_scene_order_of_screens(struct ivishell *shell, struct wl_client *client,
+                           struct wl_array *scene)
+{
+    struct iviscreen *iviscrn = NULL;
+    struct wl_resource *resource_output = NULL;
+    weston_layout_layer_ptr *pArray = NULL;
+    uint32_t *ids = NULL;
+    uint32_t length = 0;
+    uint32_t i = 0;
+
+    wl_list_for_each(iviscrn, &shell->list_screen, link) {
+        resource_output = wl_resource_find_for_client(
+                &iviscrn->output->resource_list, client);
+        if (resource_output == NULL) {
+            continue;
+        }
+
+        if (weston_layout_getLayersOnScreen(iviscrn->layout_screen,
+                                            &length, &pArray) != 0) {
+            weston_log("failed to get layers at add_scene_order_of_screens\n");
+            continue;
+        }
+
+        ids = add_scene_order(scene, IVI_CONTROLLER_OBJECT_TYPE_SCREEN,
+                              wl_resource_get_id(resource_output), length);
+        for (i = 0; (ids != NULL) && (i < length); i++) {
+            ids[i] = weston_layout_getIdOfLayer(pArray[i]);
+        }
+
+        free(pArray);
+        pArray = NULL;
+
+        if (ids == NULL) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int32_t
+add_scene_order_of_layers(struct ivishell *shell, struct wl_array *scene)
+{
+    struct ivilayer *ivilayer = NULL;
+    weston_layout_surface_ptr *pArray = NULL;
+    uint32_t *ids = NULL;
+    uint32_t length = 0;
+    uint32_t i = 0;
+
+    wl_list_for_each(ivilayer, &shell->list_layer, link) {
+        if (weston_layout_getSurfacesOnLayer(ivilayer->layout_layer,
+                                             &length, &pArray) != 0) {
+            weston_log("failed to get surfaces at add_scene_order_of_layers\n");
+            continue;
+        }
+
+        ids = add_scene_order(scene, IVI_CONTROLLER_OBJECT_TYPE_LAYER,
+                    weston_layout_getIdOfLayer(ivilayer->layout_layer),
+                    length);
+        for (i = 0; (ids != NULL) && (i < length); i++) {
+            ids[i] = weston_layout_getIdOfSurface(pArray[i]);
+        }
+
+        free(pArray);
+        pArray = NULL;
+
+        if (ids == NULL) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Hand the complete scene to a new controller in one file instead of an
+ * event per object, which may not fit into a single message.
+ */
+static void
+send_scene(struct ivishell *shell, struct wl_client *client,
+           struct wl_resource *resource)
+{
+    struct wl_array scene;
+    uint32_t objects_size = 0;
+    int fd = -1;
+    PROFILE_SCOPE(shell, client);
+
+    wl_array_init(&scene);
+
+    if (add_scene_objects(shell, &scene) != 0) {
+        wl_array_release(&scene);
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+    objects_size = scene.size;
+
+    if ((add_scene_order_of_screens(shell, client, &scene) != 0) ||
+        (add_scene_order_of_layers(shell, &scene) != 0)) {
+        wl_array_release(&scene);
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+
+    fd = create_scene_file(scene.data, scene.size);
+    if (fd < 0) {
+        weston_log("failed to write scene file\n");
+        wl_array_release(&scene);
+        wl_resource_post_no_memory(resource);
+        return;
+    }
+
+    ivi_controller_send_scene(resource, fd, objects_size,
+                              scene.size - objects_size);
+
+    close(fd);
+    wl_array_release(&scene);
+}
+
+static void
+announce_surfaces_and_layers(struct ivishell *shell,
+                             struct ivicontroller *controller)
+{
+    struct ivisurface* ivisurf = NULL;
+    struct ivilayer* ivilayer = NULL;
+    uint32_t id_layout_surface = 0;
+    uint32_t id_layout_layer = 0;
+
+    wl_list_for_each(ivisurf, &shell->list_surface, link) {
+        id_layout_surface =
+            weston_layout_getIdOfSurface(ivisurf->layout_surface);
+
+        ivi_controller_send_surface(controller->resource,
+                                    id_layout_surface);
+    }
+
+    wl_list_for_each(ivilayer, &shell->list_layer, link) {
+        id_layout_layer =
+            weston_layout_getIdOfLayer(ivilayer->layout_layer);
+
+        ivi_controller_send_layer(controller->resource,
+                                  id_layout_layer);
+    }
+}
+
 static void
-controller_screen_destroy(struct wl_client *client,
-                          struct wl_resource *resource)
+add_client_to_resources(struct ivishell *shell,
+                        struct wl_client *client,
+                        struct ivicontroller *controller)
 {
-    struct iviscreen *iviscrn = wl_resource_get_user_data(resource);
+    struct iviscreen* iviscrn = NULL;
     struct ivicontroller_screen *ctrlscrn = NULL;
-    struct ivicontroller_screen *next = NULL;
-//    uint32_t id_screen = weston_layout_getIdOfScreen(iviscrn->layout_screen);
-    (void)client;
+    struct wl_resource *resource_output = NULL;
+    uint32_t version = wl_resource_get_version(controller->resource);
 
-    wl_list_for_each_safe(ctrlscrn, next,
-                          &iviscrn->shell->list_controller_screen, link) {
-        if (resource != ctrlscrn->resource) {
+    /* version 6 gets the surfaces and layers in one scene event */
+    if (version < IVI_CONTROLLER_SCENE_SINCE_VERSION) {
+        announce_surfaces_and_layers(shell, controller);
+    }
+
+    wl_list_for_each(iviscrn, &shell->list_screen, link) {
+        resource_output = wl_resource_find_for_client(
+                &iviscrn->output->resource_list, client);
+        if (resource_output == NULL) {
             continue;
         }
 
-        wl_list_remove(&ctrlscrn->link);
-        free(ctrlscrn);
-        ctrlscrn = NULL;
-        wl_resource_destroy(ctrlscrn->resource);
-        break;
+        ctrlscrn = controller_screen_create(iviscrn->shell, client, iviscrn,
+                                            version);
+        if (ctrlscrn == NULL) {
+            continue;
+        }
+
+        ivi_controller_send_screen(controller->resource,
+                                   wl_resource_get_id(resource_output),
+                                   ctrlscrn->resource);
     }
-}
 
-static void
-controller_screen_clear(struct wl_client *client,
-                struct wl_resource *resource)
-{
-    struct iviscreen *iviscrn = wl_resource_get_user_data(resource);
-    (void)client;
-    weston_layout_screenSetRenderOrder(iviscrn->layout_screen, NULL, 0);
+    if (version >= IVI_CONTROLLER_SCENE_SINCE_VERSION) {
+        send_scene(shell, client, controller->resource);
+    }
 }
 
 static void
-controller_screen_add_layer(struct wl_client *client,
-                struct wl_resource *resource,
-                struct wl_resource *layer)
+bind_ivi_controller(struct wl_client *client, void *data,
+                    uint32_t version, uint32_t id)
 {
-    struct iviscreen *iviscrn = wl_resource_get_user_data(resource);
-    struct ivilayer *ivilayer = wl_resource_get_user_data(layer);
-    (void)client;
-    weston_layout_screenAddLayer(iviscrn->layout_screen, ivilayer->layout_layer);
-}
+    struct ivishell *shell = data;
+    struct ivicontroller *controller;
 
-static void
-controller_screen_screenshot(struct wl_client *client,
-                struct wl_resource *resource,
-                const char *filename)
-{
-    struct iviscreen *iviscrn = wl_resource_get_user_data(resource);
-    (void)client;
-    weston_layout_takeScreenshot(iviscrn->layout_screen, filename);
+    controller = calloc(1, sizeof *controller);
+    if (controller == NULL) {
+        weston_log("no memory to allocate controller\n");
+        return;
+    }
+
+    controller->resource =
+        wl_resource_create(client, &ivi_controller_interface, version, id);
+    wl_resource_set_implementation(controller->resource,
+                                   &controller_implementation,
+                                   controller, unbind_resource_controller);
+
+    controller->shell = shell;
+    controller->client = client;
+    controller->id = id;
+    /* account the timings of the client from its first request */
+    get_controller_client(shell, client);
+    controller->event_rate = IVI_CONTROLLER_EVENT_RATE_IMMEDIATE;
+    wl_array_init(&controller->pending_changes);
+    wl_array_init(&controller->interests);
+    controller->interest_fields = SCENE_FIELDS_ALL;
+
+    wl_list_init(&controller->link);
+    wl_list_insert(&shell->list_controller, &controller->link);
+
+    if (version >= IVI_CONTROLLER_SCENE_CHANGES_SINCE_VERSION) {
+        shell->scene_controller_count++;
+    }
+
+    add_client_to_resources(shell, client, controller);
 }
 
 static void
-controller_screen_set_render_order(struct wl_client *client,
-                struct wl_resource *resource,
-                struct wl_array *id_layers)
+send_rate_limited_changes(struct ivishell *shell, uint32_t frame_time)
 {
-    struct iviscreen *iviscrn = wl_resource_get_user_data(resource);
-    struct weston_layout_layer **layoutlayer_array = NULL;
-    struct ivilayer *ivilayer = NULL;
-    uint32_t *id_layer = NULL;
-    uint32_t id_layout_layer = 0;
-    int i = 0;
-    (void)client;
+    struct ivicontroller *controller = NULL;
+    uint32_t elapsed = 0;
+    uint32_t remaining = 0;
 
-    *layoutlayer_array = (struct weston_layout_layer*)calloc(
-                            id_layers->size, sizeof(void*));
+    wl_list_for_each(controller, &shell->list_controller, link) {
+        /* pending changes of an immediate controller are left from a
+         * backlog, they are sent as soon as the client caught up */
+        if ((controller->pending_changes.size == 0) ||
+            (find_backlogged_client(controller->client) != NULL)) {
+            continue;
+        }
 
-    wl_array_for_each(id_layer, id_layers) {
-        wl_list_for_each(ivilayer, &iviscrn->shell->list_layer, link) {
-            id_layout_layer = weston_layout_getIdOfLayer(ivilayer->layout_layer);
-            if (*id_layer == id_layout_layer) {
-                layoutlayer_array[i] = ivilayer->layout_layer;
-                i++;
-                break;
+        elapsed = frame_time - controller->event_time;
+        if ((controller->event_rate != IVI_CONTROLLER_EVENT_RATE_IMMEDIATE) &&
+            (elapsed < controller->event_interval)) {
+            /* the next repaint may be far away, wake up for the earliest */
+            if ((remaining == 0) ||
+                (controller->event_interval - elapsed < remaining)) {
+                remaining = controller->event_interval - elapsed;
             }
+            continue;
         }
+
+        send_pending_changes(controller);
+        controller->event_time = frame_time;
     }
 
-    weston_layout_screenSetRenderOrder(iviscrn->layout_screen,
-                                    layoutlayer_array, id_layers->size);
-    free(layoutlayer_array);
+    if (remaining > 0) {
+        shell->event_rate_due = frame_time + remaining;
+        wl_event_source_timer_update(shell->event_rate_timer, remaining);
+    }
 }
 
-static const
-struct ivi_controller_screen_interface controller_screen_implementation = {
-    controller_screen_destroy,
-    controller_screen_clear,
-    controller_screen_add_layer,
-    controller_screen_screenshot,
-    controller_screen_set_render_order
-};
-
-static void
-controller_commit_changes(struct wl_client *client,
-                          struct wl_resource *resource)
+static int
+event_rate_timer_handler(void *data)
 {
-    int32_t ans = 0;
-    (void)client;
-    (void)resource;
+    struct ivishell *shell = data;
 
-    ans = weston_layout_commitChanges();
-    if (ans < 0) {
-        weston_log("Failed to commit changes at controller_commit_changes\n");
-    }
+    /* the timer expired at the earliest, so the due time has passed */
+    send_rate_limited_changes(shell, shell->event_rate_due);
+
+    return 0;
 }
 
+/*
+ * Send the latest values of the properties held back from the controller
+ * surfaces and layers of a client which caught up.
+ */
 static void
-controller_layer_create(struct wl_client *client,
-                        struct wl_resource *resource,
-                        uint32_t id_layer,
-                        int32_t width,
-                        int32_t height,
-                        uint32_t id)
+send_held_events(struct ivishell *shell, struct wl_client *client)
 {
-    struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
-    struct ivishell *shell = ctrl->shell;
-    struct weston_layout_layer *layout_layer = NULL;
+    struct weston_layout_SurfaceProperties surface_prop;
+    struct weston_layout_LayerProperties layer_prop;
+    struct ivicontroller_surface *ctrlsurf = NULL;
     struct ivicontroller_layer *ctrllayer = NULL;
+    struct ivisurface *ivisurf = NULL;
     struct ivilayer *ivilayer = NULL;
-    struct weston_layout_LayerProperties prop;
+    uint32_t id = 0;
 
-    ivilayer = get_layer(&shell->list_layer, id_layer);
-    if (ivilayer == NULL) {
-        layout_layer = weston_layout_layerCreateWithDimension(id_layer,
-                           (uint32_t)width, (uint32_t)height);
-        if (layout_layer == NULL) {
-            weston_log("id_layer is already created\n");
-            return;
-        }
+    wl_list_for_each(ivisurf, &shell->list_surface, link) {
+        id = weston_layout_getIdOfSurface(ivisurf->layout_surface);
+        wl_list_for_each(ctrlsurf, get_controller_surfaces(shell, id), link) {
+            if ((ctrlsurf->client != client) || (ctrlsurf->held_mask == 0)) {
+                continue;
+            }
 
-        /* ivilayer will be created by layer_event_create */
-        ivilayer = get_layer(&shell->list_layer, id_layer);
-        if (ivilayer == NULL) {
-            weston_log("couldn't get layer object\n");
-            return;
+            memset(&surface_prop, 0, sizeof surface_prop);
+            weston_layout_getPropertiesOfSurface(ivisurf->layout_surface,
+                                                 &surface_prop);
+            send_surface_event(ctrlsurf->resource, &surface_prop,
+                               ctrlsurf->held_mask);
+            ctrlsurf->held_mask = 0;
         }
     }
 
-    ctrllayer = calloc(1, sizeof *ctrllayer);
-    if (!ctrllayer) {
-        weston_log("no memory to allocate client layer\n");
-        return;
-    }
-
-    ctrllayer->shell = shell;
-    ctrllayer->client = client;
-    ctrllayer->id = id;
-    ctrllayer->id_layer = id_layer;
-    ctrllayer->resource = wl_resource_create(client,
-                               &ivi_controller_layer_interface, 1, id);
-    if (ctrllayer->resource == NULL) {
-        weston_log("couldn't get layer object\n");
-        return;
-    }
-
-    wl_list_init(&ctrllayer->link);
-    wl_list_insert(&shell->list_controller_layer, &ctrllayer->link);
-
-    wl_resource_set_implementation(ctrllayer->resource,
-                                   &controller_layer_implementation,
-                                   ivilayer, destroy_ivicontroller_layer);
-
-    memset(&prop, 0, sizeof prop);
-
-    weston_layout_getPropertiesOfLayer(ivilayer->layout_layer, &prop);
+    wl_list_for_each(ivilayer, &shell->list_layer, link) {
+        id = weston_layout_getIdOfLayer(ivilayer->layout_layer);
+        wl_list_for_each(ctrllayer, get_controller_layers(shell, id), link) {
+            if ((ctrllayer->client != client) ||
+                (ctrllayer->held_mask == 0)) {
+                continue;
+            }
 
-    wl_list_for_each(ctrllayer, &shell->list_controller_layer, link) {
-        if (id_layer != ctrllayer->id_layer) {
-            continue;
+            memset(&layer_prop, 0, sizeof layer_prop);
+            weston_layout_getPropertiesOfLayer(ivilayer->layout_layer,
+                                               &layer_prop);
+            send_layer_event(ctrllayer->resource, &layer_prop,
+                             ctrllayer->held_mask);
+            ctrllayer->held_mask = 0;
         }
-        send_layer_event(ctrllayer->resource, ivilayer,
-                         &prop, IVI_NOTIFICATION_ALL);
     }
 }
 
+/*
+ * A client becomes backlogged when the bytes it did not read reach the
+ * limit, and catches up when they drop below half of it.
+ */
 static void
-controller_surface_create(struct wl_client *client,
-                          struct wl_resource *resource,
-                          uint32_t id_surface,
-                          uint32_t id)
+update_client_backlogs(struct ivishell *shell)
 {
-    struct ivicontroller *ctrl = wl_resource_get_user_data(resource);
-    struct ivishell *shell = ctrl->shell;
-    struct ivicontroller_surface *ctrlsurf = NULL;
-    struct weston_layout_SurfaceProperties prop;
-    struct ivisurface *ivisurf = NULL;
+    struct ivicontroller_client *ctrlclient = NULL;
+    pid_t pid = 0;
+    uid_t uid = 0;
+    gid_t gid = 0;
 
-    ctrlsurf = calloc(1, sizeof *ctrlsurf);
-    if (!ctrlsurf) {
-        weston_log("no memory to allocate controller surface\n");
+    if (shell->client_backlog_limit == 0) {
         return;
     }
 
-    ctrlsurf->shell = shell;
-    ctrlsurf->client = client;
-    ctrlsurf->id = id;
-    ctrlsurf->id_surface = id_surface;
-    wl_list_init(&ctrlsurf->link);
-    wl_list_insert(&shell->list_controller_surface, &ctrlsurf->link);
-
-    ctrlsurf->resource = wl_resource_create(client,
-                               &ivi_controller_surface_interface, 1, id);
-    if (ctrlsurf->resource == NULL) {
-        weston_log("couldn't surface object");
-        return;
-    }
+    wl_list_for_each(ctrlclient, &shell->list_client, link) {
+        ctrlclient->backlog = get_client_backlog(ctrlclient->client);
+        if (ctrlclient->max_backlog < ctrlclient->backlog) {
+            ctrlclient->max_backlog = ctrlclient->backlog;
+        }
 
-    ivisurf = get_surface(&shell->list_surface, id_surface);
-    if (ivisurf == NULL) {
-        return;
+        if (!ctrlclient->backlogged &&
+            (ctrlclient->backlog >= shell->client_backlog_limit)) {
+            wl_client_get_credentials(ctrlclient->client, &pid, &uid, &gid);
+            weston_log("controller client pid %d is %u bytes behind, "
+                       "holding back its property events\n",
+                       (int)pid, ctrlclient->backlog);
+            ctrlclient->backlogged = 1;
+            ctrlclient->backlogged_count++;
+        } else if (ctrlclient->backlogged &&
+                   (ctrlclient->backlog < shell->client_backlog_limit / 2)) {
+            wl_client_get_credentials(ctrlclient->client, &pid, &uid, &gid);
+            weston_log("controller client pid %d caught up\n", (int)pid);
+            ctrlclient->backlogged = 0;
+            send_held_events(shell, ctrlclient->client);
+        }
     }
+}
 
-    wl_resource_set_implementation(ctrlsurf->resource,
-                                   &controller_surface_implementation,
-                                   ivisurf, destroy_ivicontroller_surface);
+/*
+ * Whether the surface is visible on a visible layer of the screen. Any of
+ * the layers containing the surface may show it.
+ */
+static int
+is_surface_on_screen(struct weston_layout_surface *layout_surface,
+                     struct iviscreen *iviscrn)
+{
+    struct weston_layout_SurfaceProperties prop;
+    struct weston_layout_LayerProperties layer_prop;
+    struct weston_layout_layer **pLayers = NULL;
+    struct weston_layout_screen **pScreens = NULL;
+    uint32_t layer_count = 0;
+    uint32_t screen_count = 0;
+    uint32_t i = 0;
+    uint32_t j = 0;
+    int found = 0;
 
     memset(&prop, 0, sizeof prop);
+    weston_layout_getPropertiesOfSurface(layout_surface, &prop);
+    if (prop.visibility == 0) {
+        return 0;
+    }
 
-    weston_layout_getPropertiesOfSurface(ivisurf->layout_surface, &prop);
+    if (weston_layout_getLayersUnderSurface(layout_surface,
+                                            &layer_count, &pLayers) != 0) {
+        return 0;
+    }
+
+    for (i = 0; (i < layer_count) && !found; i++) {
+        memset(&layer_prop, 0, sizeof layer_prop);
+        weston_layout_getPropertiesOfLayer(pLayers[i], &layer_prop);
+        if (layer_prop.visibility == 0) {
+            continue;
+        }
 
-    wl_list_for_each(ctrlsurf, &shell->list_controller_surface, link) {
-        if (id_surface != ctrlsurf->id_surface) {
+        if (weston_layout_getScreensUnderLayer(pLayers[i], &screen_count,
+                                               &pScreens) != 0) {
             continue;
         }
-        send_surface_event(ctrlsurf->resource, ivisurf,
-                           &prop, IVI_NOTIFICATION_ALL);
+        for (j = 0; j < screen_count; j++) {
+            if (pScreens[j] == iviscrn->layout_screen) {
+                found = 1;
+                break;
+            }
+        }
+        free(pScreens);
+        pScreens = NULL;
     }
+    free(pLayers);
+
+    return found;
 }
 
 static void
-controller_get_native_handle(struct wl_client *client,
-                             struct wl_resource *resource,
-                             uint32_t id_process,
-                             const char *title)
+update_frame_stats(struct ivishell *shell, struct iviscreen *iviscrn)
 {
-    struct wl_array surfaces;
-    ivi_shell_get_shell_surfaces(&surfaces);
-    struct shell_surface ** surface;
+    struct ivisurface *ivisurf = NULL;
+    struct ivisurface *next = NULL;
+    struct ivicontroller_frame_stats *frame_stats = NULL;
+    uint64_t now = get_monotonic_time();
 
-    wl_array_for_each(surface, &surfaces) {
+    wl_list_for_each_safe(ivisurf, next,
+                          &shell->list_surface_committed, committed_link) {
+        if (is_surface_on_screen(ivisurf->layout_surface, iviscrn)) {
+            frame_stats_present(ivisurf, now);
+        }
+    }
 
-        uint32_t pid = shell_surface_get_process_id(*surface);
-        if (pid != id_process) {
+    wl_list_for_each(frame_stats, &shell->list_frame_stats, link) {
+        if ((frame_stats->interval == 0) || (frame_stats->ivisurf == NULL) ||
+            (now - frame_stats->send_time <
+             (uint64_t)frame_stats->interval * 1000)) {
             continue;
         }
 
-        if (title) {
-            char* surface_title = shell_surface_get_title(*surface);
-            if (strcmp(title, surface_title)) {
-                continue;
-            }
-        }
+        send_frame_stats(frame_stats, now);
+    }
+}
 
-        struct weston_surface *es = shell_surface_get_surface(*surface);
-        if (es) {
-            struct wl_resource *res = wl_resource_create(client, &wl_surface_interface, 1, 0);
-            wl_resource_set_user_data(res, es);
+/*
+ * Frame aligned commits are latched with a new serial right after an
+ * output finished its repaint, so they are contained in the next repaint
+ * of the marked screens. The other screens are not changed by them and
+ * show the serial already.
+ */
+static void
+latch_commit_feedback(struct ivishell *shell)
+{
+    struct ivicontroller_commit_feedback *feedback = NULL;
+    struct iviscreen *iviscrn = NULL;
+
+    shell->commit_serial++;
 
-            ivi_controller_send_native_handle(resource, res);
+    wl_list_for_each(iviscrn, &shell->list_screen, link) {
+        if (!iviscrn->repaint_needed) {
+            iviscrn->shown_serial = shell->commit_serial;
         }
     }
 
-    wl_array_release(&surfaces);
+    wl_list_for_each(feedback, &shell->list_commit_pending, link) {
+        feedback->serial = shell->commit_serial;
+    }
 
-    int32_t id_object = 0;
-    ivi_controller_send_error(
-        resource, id_object, IVI_CONTROLLER_OBJECT_TYPE_SURFACE,
-        IVI_CONTROLLER_ERROR_CODE_NATIVE_HANDLE_END, "");
+    wl_list_insert_list(shell->list_commit_latched.prev,
+                        &shell->list_commit_pending);
+    wl_list_init(&shell->list_commit_pending);
 }
 
-static const struct ivi_controller_interface controller_implementation = {
-    controller_commit_changes,
-    controller_layer_create,
-    controller_surface_create,
-    controller_get_native_handle
-};
-
-static void
-add_client_to_resources(struct ivishell *shell,
-                        struct wl_client *client,
-                        struct ivicontroller *controller)
+/*
+ * A latched commit is presented once every screen repainted it. The frame
+ * of the screen which showed it last is reported.
+ */
+static void
+send_commit_feedback(struct ivishell *shell, struct iviscreen *iviscrn,
+                     uint32_t tv_sec, uint32_t tv_nsec)
 {
-    struct ivisurface* ivisurf = NULL;
-    struct ivilayer* ivilayer = NULL;
-    struct iviscreen* iviscrn = NULL;
-    struct ivicontroller_screen *ctrlscrn = NULL;
-    struct wl_resource *resource_output = NULL;
-    uint32_t id_layout_surface = 0;
-    uint32_t id_layout_layer = 0;
+    struct ivicontroller_commit_feedback *feedback = NULL;
+    struct ivicontroller_commit_feedback *next = NULL;
+    struct iviscreen *other = NULL;
+    uint32_t shown_serial = iviscrn->shown_serial;
+
+    wl_list_for_each(other, &shell->list_screen, link) {
+        if ((int32_t)(other->shown_serial - shown_serial) < 0) {
+            shown_serial = other->shown_serial;
+        }
+    }
 
-    wl_list_for_each(ivisurf, &shell->list_surface, link) {
-        id_layout_surface =
-            weston_layout_getIdOfSurface(ivisurf->layout_surface);
+    /* latched in the order of their serials */
+    wl_list_for_each_safe(feedback, next,
+                          &shell->list_commit_latched, link) {
+        if ((int32_t)(shown_serial - feedback->serial) < 0) {
+            break;
+        }
 
-        ivi_controller_send_surface(controller->resource,
-                                    id_layout_surface);
+        ivi_controller_commit_feedback_send_presented(feedback->resource,
+                                                      tv_sec, tv_nsec,
+                                                      iviscrn->frame_count);
+        wl_resource_destroy(feedback->resource);
     }
+}
 
-    wl_list_for_each(ivilayer, &shell->list_layer, link) {
-        id_layout_layer =
-            weston_layout_getIdOfLayer(ivilayer->layout_layer);
+/*
+ * Mark the screens changed by the commit of a frame: those of the running
+ * transitions and of the staged properties which are not held.
+ */
+static void
+mark_frame_changes(struct ivishell *shell)
+{
+    struct ivi_transition *transition = NULL;
+    struct ivi_staged *staged = NULL;
 
-        ivi_controller_send_layer(controller->resource,
-                                  id_layout_layer);
+    wl_list_for_each(transition, &shell->list_transition, link) {
+        if (transition->start_time != 0) {
+            mark_screens_of(shell, transition->layout_surface,
+                            transition->layout_layer, NULL);
+        }
     }
 
+    wl_list_for_each(staged, &shell->list_staged, link) {
+        if (!staged->held) {
+            mark_screens_of(shell, staged->layout_surface,
+                            staged->layout_layer, staged->layout_screen);
+        }
+    }
+}
+
+/*
+ * The outputs repaint at their own vsync, and the work for all screens is
+ * done once per frame cycle: by the first repaint after at least three
+ * quarters of the shortest refresh period passed since the last cycle.
+ */
+static int
+begin_frame_cycle(struct ivishell *shell, struct weston_output *output)
+{
+    struct iviscreen *iviscrn = NULL;
+    uint32_t period = 0;
+    uint32_t refresh = 0;
+
     wl_list_for_each(iviscrn, &shell->list_screen, link) {
-        resource_output = wl_resource_find_for_client(
-                &iviscrn->output->resource_list, client);
-        if (resource_output == NULL) {
+        if (iviscrn->output->current_mode == NULL) {
             continue;
         }
 
-        ctrlscrn = controller_screen_create(iviscrn->shell, client, iviscrn);
-        if (ctrlscrn == NULL) {
-            continue;
+        refresh = iviscrn->output->current_mode->refresh;
+        if ((refresh > 0) &&
+            ((period == 0) || (1000000 / refresh < period))) {
+            period = 1000000 / refresh;
         }
+    }
 
-        ivi_controller_send_screen(controller->resource,
-                                   wl_resource_get_id(resource_output),
-                                   ctrlscrn->resource);
+    if (output->frame_time - shell->frame_cycle_time < period * 3 / 4) {
+        return 0;
     }
+
+    shell->frame_cycle_time = output->frame_time;
+    return 1;
 }
 
+/*
+ * Commits latched by an earlier frame are reported once all screens
+ * repainted them.
+ * Screenshots queued for the screen are read back from the frame which
+ * was just repainted. Surfaces committed since the last repaint of their
+ * screen are counted as presented. Once per frame cycle, rate limited
+ * controllers get the changes held back for them, and running transitions
+ * are stepped and committed together with the frame aligned commits. Only
+ * the screens changed by that commit are repainted.
+ */
 static void
-bind_ivi_controller(struct wl_client *client, void *data,
-                    uint32_t version, uint32_t id)
+screen_frame_notify(struct wl_listener *listener, void *data)
 {
-    struct ivishell *shell = data;
-    struct ivicontroller *controller;
-    (void)version;
+    struct iviscreen *iviscrn =
+        container_of(listener, struct iviscreen, frame_listener);
+    struct ivishell *shell = iviscrn->shell;
+    struct weston_output *output = data;
+    struct ivicontroller_screenshot *shot = NULL;
+    struct ivicontroller_screenshot *next_shot = NULL;
+    struct ivicontroller_capture *capture = NULL;
+    struct ivicontroller_capture *next_capture = NULL;
+    uint32_t tv_sec = 0;
+    uint32_t tv_nsec = 0;
+
+    iviscrn->frame_count++;
+    iviscrn->shown_serial = shell->commit_serial;
+    get_frame_time(output, &tv_sec, &tv_nsec);
+
+    wl_list_for_each_safe(shot, next_shot, &iviscrn->list_screenshot, link) {
+        screenshot_take(shot, iviscrn, output);
+    }
 
-    controller = calloc(1, sizeof *controller);
-    if (controller == NULL) {
-        weston_log("no memory to allocate controller\n");
+    wl_list_for_each_safe(capture, next_capture, &shell->list_capture, link) {
+        capture_repaint(capture, iviscrn, output);
+    }
+
+    update_frame_stats(shell, iviscrn);
+
+    send_commit_feedback(shell, iviscrn, tv_sec, tv_nsec);
+
+    if (!begin_frame_cycle(shell, output)) {
+        /* the pending work is done by the next repaint of the output */
+        if (has_running_transitions(shell) ||
+            !wl_list_empty(&shell->list_commit_pending)) {
+            weston_output_schedule_repaint(output);
+        }
         return;
     }
 
-    controller->resource =
-        wl_resource_create(client, &ivi_controller_interface, 1, id);
-    wl_resource_set_implementation(controller->resource,
-                                   &controller_implementation,
-                                   controller, unbind_resource_controller);
+    update_client_backlogs(shell);
+    send_rate_limited_changes(shell, output->frame_time);
 
-    controller->shell = shell;
-    controller->client = client;
-    controller->id = id;
+    if (!has_running_transitions(shell) &&
+        wl_list_empty(&shell->list_commit_pending)) {
+        return;
+    }
 
-    wl_list_init(&controller->link);
-    wl_list_insert(&shell->list_controller, &controller->link);
+    /* changes staged by clients without a frame commit stay pending */
+    hold_staged_changes(shell, 1);
+    mark_frame_changes(shell);
+    step_transitions(shell);
+    if (weston_layout_commitChanges() < 0) {
+        weston_log("Failed to commit changes at screen_frame_notify\n");
+    }
+    restage_held_changes(shell);
+    start_transitions(shell);
+    update_effective_visibility(shell);
 
-    add_client_to_resources(shell, client, controller);
+    latch_commit_feedback(shell);
+    /* a commit changing no screen is presented already */
+    send_commit_feedback(shell, iviscrn, tv_sec, tv_nsec);
+
+    schedule_marked_screens(shell);
+}
+
+/*
+ * weston-layout creates a screen for every output, numbered in the order
+ * of the outputs of the compositor.
+ */
+static struct weston_layout_screen *
+get_layout_screen_of_output(struct weston_compositor *ec,
+                            struct weston_output *output)
+{
+    struct weston_output *other = NULL;
+    uint32_t id_screen = 0;
+
+    wl_list_for_each(other, &ec->output_list, link) {
+        if (other == output) {
+            break;
+        }
+        id_screen++;
+    }
+
+    return weston_layout_getScreenFromId(id_screen);
 }
 
 static struct iviscreen*
 create_screen(struct ivishell *shell, struct weston_output *output)
 {
+    struct weston_layout_screen *layout_screen = NULL;
     struct iviscreen *iviscrn;
+
+    layout_screen = get_layout_screen_of_output(shell->compositor, output);
+    if (layout_screen == NULL) {
+        weston_log("no layout screen for output %s\n", output->name);
+        return NULL;
+    }
+
     iviscrn = calloc(1, sizeof *iviscrn);
     if (iviscrn == NULL) {
         weston_log("no memory to allocate client screen\n");
@@ -1315,11 +6363,13 @@ create_screen(struct ivishell *shell, struct weston_output *output)
 
     iviscrn->shell = shell;
     iviscrn->output = output;
-
-// TODO : Only Single display
-    iviscrn->layout_screen = weston_layout_getScreenFromId(0);
+    iviscrn->layout_screen = layout_screen;
 
     wl_list_init(&iviscrn->link);
+    wl_list_init(&iviscrn->list_screenshot);
+
+    iviscrn->frame_listener.notify = screen_frame_notify;
+    wl_signal_add(&output->frame_signal, &iviscrn->frame_listener);
 
     return iviscrn;
 }
@@ -1331,8 +6381,9 @@ create_layer(struct ivishell *shell,
 {
     struct ivilayer *ivilayer = NULL;
     struct ivicontroller *controller = NULL;
+    struct weston_layout_LayerProperties prop;
 
-    ivilayer = get_layer(&shell->list_layer, id_layer);
+    ivilayer = get_layer(shell, id_layer);
     if (ivilayer != NULL) {
         weston_log("id_layer is already created\n");
         return NULL;
@@ -1344,18 +6395,34 @@ create_layer(struct ivishell *shell,
         return NULL;
     }
 
+    if (ivi_id_index_insert(&shell->layers, id_layer,
+                            &ivilayer->id_link) != 0) {
+        weston_log("no memory to index client layer\n");
+        free(ivilayer);
+        return NULL;
+    }
+
     ivilayer->shell = shell;
-    wl_list_init(&ivilayer->list_screen);
+    membership_init(&ivilayer->screens);
     wl_list_init(&ivilayer->link);
     wl_list_insert(&shell->list_layer, &ivilayer->link);
     ivilayer->layout_layer = layout_layer;
+    update_layer_screens(ivilayer);
 
     weston_layout_layerAddNotification(layout_layer, send_layer_prop, ivilayer);
 
     wl_list_for_each(controller, &shell->list_controller, link) {
-        ivi_controller_send_layer(controller->resource, id_layer);
+        if (is_interesting(controller, IVI_CONTROLLER_OBJECT_TYPE_LAYER,
+                           id_layer)) {
+            ivi_controller_send_layer(controller->resource, id_layer);
+        }
     }
 
+    /* the initial properties follow in scene_changes */
+    memset(&prop, 0, sizeof prop);
+    weston_layout_getPropertiesOfLayer(layout_layer, &prop);
+    record_layer_change(ivilayer, id_layer, &prop, IVI_NOTIFICATION_ALL);
+
     return ivilayer;
 }
 
@@ -1366,8 +6433,9 @@ create_surface(struct ivishell *shell,
 {
     struct ivisurface *ivisurf = NULL;
     struct ivicontroller *controller = NULL;
+    struct weston_layout_SurfaceProperties prop;
 
-    ivisurf = get_surface(&shell->list_surface, id_surface);
+    ivisurf = get_surface(shell, id_surface);
     if (ivisurf != NULL) {
         weston_log("id_surface is already created\n");
         return NULL;
@@ -1379,17 +6447,40 @@ create_surface(struct ivishell *shell,
         return NULL;
     }
 
+    if (ivi_id_index_insert(&shell->surfaces, id_surface,
+                            &ivisurf->id_link) != 0) {
+        weston_log("no memory to index client surface\n");
+        free(ivisurf);
+        return NULL;
+    }
+
     ivisurf->shell = shell;
     ivisurf->layout_surface = layout_surface;
-    wl_list_init(&ivisurf->list_layer);
+    wl_list_init(&ivisurf->surface_commit_listener.link);
+    ivisurf->surface = weston_layout_surfaceGetWestonSurface(layout_surface);
+    if (ivisurf->surface != NULL) {
+        ivisurf->surface_commit_listener.notify = frame_stats_commit;
+        wl_signal_add(&ivisurf->surface->commit_signal,
+                      &ivisurf->surface_commit_listener);
+    }
+    membership_init(&ivisurf->layers);
+    update_surface_layers(ivisurf);
+    wl_list_init(&ivisurf->committed_link);
     wl_list_init(&ivisurf->link);
     wl_list_insert(&shell->list_surface, &ivisurf->link);
 
     wl_list_for_each(controller, &shell->list_controller, link) {
-        ivi_controller_send_surface(controller->resource,
-                                    id_surface);
+        if (is_interesting(controller, IVI_CONTROLLER_OBJECT_TYPE_SURFACE,
+                           id_surface)) {
+            ivi_controller_send_surface(controller->resource, id_surface);
+        }
     }
 
+    /* the initial properties follow in scene_changes */
+    memset(&prop, 0, sizeof prop);
+    weston_layout_getPropertiesOfSurface(layout_surface, &prop);
+    record_surface_change(ivisurf, id_surface, &prop, IVI_NOTIFICATION_ALL);
+
     weston_layout_surfaceAddNotification(layout_surface,
                                     send_surface_prop, ivisurf);
 
@@ -1420,30 +6511,126 @@ layer_event_remove(struct weston_layout_layer *layout_layer,
     struct ivishell *shell = userdata;
     struct ivicontroller_layer *ctrllayer = NULL;
     struct ivilayer *ivilayer = NULL;
-    struct ivilayer *next = NULL;
     uint32_t id_layer = 0;
 
-    wl_list_for_each_safe(ivilayer, next, &shell->list_layer, link) {
-        if (layout_layer != ivilayer->layout_layer) {
-            continue;
-        }
+    id_layer = weston_layout_getIdOfLayer(layout_layer);
 
+    ivilayer = get_layer(shell, id_layer);
+    if ((ivilayer != NULL) && (ivilayer->layout_layer == layout_layer)) {
+        ivi_id_index_remove(&shell->layers, id_layer, &ivilayer->id_link);
         wl_list_remove(&ivilayer->link);
+        membership_release(&ivilayer->screens);
         free(ivilayer);
         ivilayer = NULL;
-        break;
     }
 
-    id_layer = weston_layout_getIdOfLayer(layout_layer);
+    cancel_transitions(shell, NULL, layout_layer, TRANSITION_ALL);
+    forget_staged_object(shell, NULL, layout_layer);
+
+    wl_list_for_each(ctrllayer,
+                     get_controller_layers(shell, id_layer), link) {
+        ivi_controller_layer_send_destroyed(ctrllayer->resource);
+    }
+
+    update_effective_visibility(shell);
+}
+
+
+/*
+ * Commit the changes the shell made after hold_staged_changes. Changes
+ * staged by controllers stay pending.
+ */
+static void
+commit_shell_changes(struct ivishell *shell)
+{
+    if (weston_layout_commitChanges() < 0) {
+        weston_log("Failed to commit changes of the shell\n");
+    }
+    restage_held_changes(shell);
+    update_effective_visibility(shell);
+}
+
+/*
+ * A render order staged for the layer is set again after the commit of
+ * the shell, keep the surface added by the shell in it.
+ */
+static void
+stage_preloaded_surface(struct ivishell *shell,
+                        struct weston_layout_layer *layout_layer,
+                        struct weston_layout_surface *layout_surface)
+{
+    struct ivi_staged *staged = NULL;
 
-    wl_list_for_each(ctrllayer, &shell->list_controller_layer, link) {
-        if (id_layer != ctrllayer->id_layer) {
+    wl_list_for_each(staged, &shell->list_staged, link) {
+        if ((staged->property != STAGED_RENDER_ORDER) ||
+            (staged->layout_layer != layout_layer)) {
             continue;
         }
-        ivi_controller_layer_send_destroyed(ctrllayer->resource);
+
+        if (add_to_order(&staged->order, layout_surface) != 0) {
+            weston_log("no memory to keep surface in staged order\n");
+            continue;
+        }
+        apply_staged(staged);
+    }
+}
+
+static void
+preload_place_surface(struct ivishell *shell, struct ivisurface *ivisurf,
+                      uint32_t id_surface)
+{
+    const struct ivi_scene_file_rule *rule = NULL;
+    struct weston_layout_layer *layout_layer = NULL;
+
+    rule = ivi_scene_find_rule(&shell->preload, id_surface);
+    if (rule == NULL) {
+        return;
+    }
+
+    layout_layer = weston_layout_getLayerFromId(rule->id_layer);
+    if (layout_layer == NULL) {
+        weston_log("preloaded layer %u of surface %u does not exist\n",
+                   rule->id_layer, id_surface);
+        return;
     }
+
+    hold_staged_changes(shell, 0);
+    weston_layout_surfaceSetVisibility(ivisurf->layout_surface,
+                                       rule->visibility);
+    weston_layout_surfaceSetOpacity(ivisurf->layout_surface,
+                                    (float)rule->opacity);
+    weston_layout_surfaceSetOrientation(ivisurf->layout_surface,
+                                        rule->orientation);
+    weston_layout_layerAddSurface(layout_layer, ivisurf->layout_surface);
+    commit_shell_changes(shell);
+    stage_preloaded_surface(shell, layout_layer, ivisurf->layout_surface);
+
+    /* the rectangles are set when the size of the buffer is known */
+    ivisurf->preload_rule = rule;
 }
 
+static void
+preload_size_surface(struct ivisurface *ivisurf,
+                     const struct weston_layout_SurfaceProperties *prop)
+{
+    const struct ivi_scene_file_rule *rule = ivisurf->preload_rule;
+    uint32_t width = prop->origSourceWidth;
+    uint32_t height = prop->origSourceHeight;
+
+    ivisurf->preload_rule = NULL;
+
+    hold_staged_changes(ivisurf->shell, 0);
+    weston_layout_surfaceSetSourceRectangle(ivisurf->layout_surface,
+                                            0, 0, width, height);
+    if ((rule->dest_width > 0) && (rule->dest_height > 0)) {
+        width = (uint32_t)rule->dest_width;
+        height = (uint32_t)rule->dest_height;
+    }
+    weston_layout_surfaceSetDestinationRectangle(ivisurf->layout_surface,
+                                                 rule->dest_x, rule->dest_y,
+                                                 width, height);
+    commit_shell_changes(ivisurf->shell);
+}
 
 static void
 surface_event_create(struct weston_layout_surface *layout_surface,
@@ -1460,6 +6647,12 @@ surface_event_create(struct weston_layout_surface *layout_surface,
         weston_log("failed to create surface");
         return;
     }
+
+    if (wl_list_empty(&shell->list_controller)) {
+        preload_place_surface(shell, ivisurf, id_surface);
+    } else {
+        update_effective_visibility(shell);
+    }
 }
 
 static void
@@ -1468,29 +6661,40 @@ surface_event_remove(struct weston_layout_surface *layout_surface,
 {
     struct ivishell *shell = userdata;
     struct ivicontroller_surface *ctrlsurf = NULL;
+    struct ivicontroller_frame_stats *frame_stats = NULL;
     struct ivisurface *ivisurf = NULL;
-    struct ivisurface *next = NULL;
     uint32_t id_surface = 0;
 
-    wl_list_for_each_safe(ivisurf, next, &shell->list_surface, link) {
-        if (layout_surface != ivisurf->layout_surface) {
-            continue;
+    id_surface = weston_layout_getIdOfSurface(layout_surface);
+
+    ivisurf = get_surface(shell, id_surface);
+    if ((ivisurf != NULL) && (ivisurf->layout_surface == layout_surface)) {
+        wl_list_for_each(frame_stats, &shell->list_frame_stats, link) {
+            if (frame_stats->ivisurf == ivisurf) {
+                frame_stats->ivisurf = NULL;
+                ivi_controller_frame_stats_send_destroyed(
+                    frame_stats->resource);
+            }
         }
 
+        ivi_id_index_remove(&shell->surfaces, id_surface, &ivisurf->id_link);
+        wl_list_remove(&ivisurf->surface_commit_listener.link);
+        wl_list_remove(&ivisurf->committed_link);
         wl_list_remove(&ivisurf->link);
+        membership_release(&ivisurf->layers);
         free(ivisurf);
         ivisurf = NULL;
-        break;
     }
 
-    id_surface = weston_layout_getIdOfSurface(layout_surface);
+    cancel_transitions(shell, layout_surface, NULL, TRANSITION_ALL);
+    forget_staged_object(shell, layout_surface, NULL);
 
-    wl_list_for_each(ctrlsurf, &shell->list_controller_surface, link) {
-        if (id_surface != ctrlsurf->id_surface) {
-            continue;
-        }
+    wl_list_for_each(ctrlsurf,
+                     get_controller_surfaces(shell, id_surface), link) {
         ivi_controller_surface_send_destroyed(ctrlsurf->resource);
     }
+
+    update_effective_visibility(shell);
 }
 
 static void
@@ -1505,7 +6709,7 @@ surface_event_configure(struct weston_layout_surface *layout_surface,
 
     id_surface = weston_layout_getIdOfSurface(layout_surface);
 
-    ivisurf = get_surface(&shell->list_surface, id_surface);
+    ivisurf = get_surface(shell, id_surface);
     if (ivisurf == NULL) {
         weston_log("id_surface is not created yet\n");
         return;
@@ -1514,12 +6718,22 @@ surface_event_configure(struct weston_layout_surface *layout_surface,
     memset(&prop, 0, sizeof prop);
     weston_layout_getPropertiesOfSurface(layout_surface, &prop);
 
-    wl_list_for_each(ctrlsurf, &shell->list_controller_surface, link) {
-        if (id_surface != ctrlsurf->id_surface) {
-            continue;
+    if ((ivisurf->preload_rule != NULL) && (prop.origSourceWidth > 0)) {
+        preload_size_surface(ivisurf, &prop);
+        weston_layout_getPropertiesOfSurface(layout_surface, &prop);
+    } else {
+        update_effective_visibility(shell);
+    }
+
+    record_surface_change(ivisurf, id_surface, &prop, IVI_NOTIFICATION_ALL);
+
+    wl_list_for_each(ctrlsurf,
+                     get_controller_surfaces(shell, id_surface), link) {
+        if (wl_resource_get_version(ctrlsurf->resource) <
+            IVI_CONTROLLER_SCENE_CHANGES_SINCE_VERSION) {
+            send_surface_event(ctrlsurf->resource, &prop,
+                               IVI_NOTIFICATION_ALL);
         }
-        send_surface_event(ctrlsurf->resource, ivisurf,
-                           &prop, IVI_NOTIFICATION_ALL);
     }
 }
 
@@ -1594,11 +6808,134 @@ check_layout_surfaces(struct ivishell *shell)
 }
 
 static void
+preload_layers_of_screen(struct ivishell *shell, struct iviscreen *iviscrn)
+{
+    struct weston_layout_layer **layout_layers = NULL;
+    uint32_t id_screen = 0;
+    uint32_t length = 0;
+    uint32_t i = 0;
+
+    if (shell->preload.layer_count == 0) {
+        return;
+    }
+
+    id_screen = weston_layout_getIdOfScreen(iviscrn->layout_screen);
+
+    layout_layers = calloc(shell->preload.layer_count, sizeof *layout_layers);
+    if (layout_layers == NULL) {
+        weston_log("no memory to preload the layers of screen %u\n",
+                   id_screen);
+        return;
+    }
+
+    for (i = 0; i < shell->preload.layer_count; i++) {
+        if (shell->preload.layers[i].id_screen != id_screen) {
+            continue;
+        }
+
+        layout_layers[length] =
+            weston_layout_getLayerFromId(shell->preload.layers[i].id_layer);
+        if (layout_layers[length] != NULL) {
+            length++;
+        }
+    }
+
+    if (length > 0) {
+        weston_layout_screenSetRenderOrder(iviscrn->layout_screen,
+                                           layout_layers, length);
+    }
+    free(layout_layers);
+}
+
+static void
+load_preload_scene(struct ivishell *shell)
+{
+    struct weston_config_section *section = NULL;
+    const struct ivi_scene_file_layer *layer = NULL;
+    struct weston_layout_layer *layout_layer = NULL;
+    struct iviscreen *iviscrn = NULL;
+    char *filename = NULL;
+    uint32_t i = 0;
+
+    section = weston_config_get_section(shell->compositor->config,
+                                        "ivi-shell", NULL, NULL);
+    weston_config_section_get_string(section, "ivi-scene", &filename, NULL);
+    if (filename == NULL) {
+        return;
+    }
+
+    if (ivi_scene_file_load(filename, &shell->preload) != 0) {
+        weston_log("failed to load the scene file %s\n", filename);
+        free(filename);
+        return;
+    }
+    free(filename);
+
+    hold_staged_changes(shell, 0);
+    for (i = 0; i < shell->preload.layer_count; i++) {
+        layer = &shell->preload.layers[i];
+
+        layout_layer = weston_layout_getLayerFromId(layer->id_layer);
+        if (layout_layer == NULL) {
+            layout_layer = weston_layout_layerCreateWithDimension(
+                               layer->id_layer, layer->width, layer->height);
+        }
+        if (layout_layer == NULL) {
+            weston_log("failed to preload layer %u\n", layer->id_layer);
+            continue;
+        }
+
+        weston_layout_layerSetSourceRectangle(layout_layer,
+            (uint32_t)layer->source_x, (uint32_t)layer->source_y,
+            (uint32_t)layer->source_width, (uint32_t)layer->source_height);
+        weston_layout_layerSetDestinationRectangle(layout_layer,
+            layer->dest_x, layer->dest_y,
+            (uint32_t)layer->dest_width, (uint32_t)layer->dest_height);
+        weston_layout_layerSetVisibility(layout_layer, layer->visibility);
+        weston_layout_layerSetOpacity(layout_layer, (float)layer->opacity);
+        weston_layout_layerSetOrientation(layout_layer, layer->orientation);
+    }
+
+    wl_list_for_each(iviscrn, &shell->list_screen, link) {
+        preload_layers_of_screen(shell, iviscrn);
+    }
+
+    commit_shell_changes(shell);
+}
+
+/*
+ * Workers of the shell are stopped before the compositor goes away. Writes
+ * in progress are finished, the queued ones are reported as failed.
+ */
+static void
+shell_destroy(struct wl_listener *listener, void *data)
+{
+    struct ivishell *shell =
+        container_of(listener, struct ivishell, destroy_listener);
+    (void)data;
+
+    wl_list_remove(&shell->destroy_listener.link);
+
+    ivi_image_writer_destroy(shell->image_writer);
+    shell->image_writer = NULL;
+
+    if (shell->journal != NULL) {
+        wl_event_source_remove(shell->journal_flush_timer);
+        ivi_journal_destroy(shell->journal);
+        shell->journal = NULL;
+    }
+}
+
+static int32_t
 init_ivi_shell(struct weston_compositor *ec, struct ivishell *shell)
 {
+    struct weston_config_section *section = NULL;
     struct weston_output *output = NULL;
     struct iviscreen *iviscrn = NULL;
+    char *journal_file = NULL;
+    uint32_t journal_size = 0;
     int32_t ret = 0;
+    uint32_t i = 0;
 
     shell->compositor = ec;
 
@@ -1608,14 +6945,98 @@ init_ivi_shell(struct weston_compositor *ec, struct ivishell *shell)
     wl_list_init(&shell->list_weston_surface);
     wl_list_init(&shell->list_controller);
     wl_list_init(&shell->list_controller_screen);
-    wl_list_init(&shell->list_controller_layer);
-    wl_list_init(&shell->list_controller_surface);
+    if ((ivi_id_index_init(&shell->controller_layers) != 0) ||
+        (ivi_id_index_init(&shell->controller_surfaces) != 0) ||
+        (ivi_id_index_init(&shell->layers) != 0) ||
+        (ivi_id_index_init(&shell->surfaces) != 0)) {
+        weston_log("no memory to allocate controller index\n");
+        return -1;
+    }
+    wl_list_init(&shell->list_commit_pending);
+    wl_list_init(&shell->list_commit_latched);
+    wl_list_init(&shell->list_capture);
+    shell->image_writer = ivi_image_writer_create(
+                              wl_display_get_event_loop(ec->wl_display));
+    if (shell->image_writer == NULL) {
+        weston_log("failed to create the screenshot writer\n");
+        return -1;
+    }
+    wl_list_init(&shell->list_surface_committed);
+    wl_list_init(&shell->list_frame_stats);
+    wl_list_init(&shell->list_transition);
+    wl_list_init(&shell->list_staged);
+    wl_array_init(&shell->scene_changes);
+    shell->scene_serial = 1;
     shell->event_restriction = 0;
 
+    for (i = 0; i < CONTROLLER_OBJECT_TYPE_COUNT; i++) {
+        ivi_object_pool_init(&shell->object_pools[i],
+                             controller_object_sizes[i]);
+    }
+    wl_list_init(&shell->list_client);
+    ivi_profiler_init(&shell->profiler);
+    ivi_profile_init(&shell->unattributed_profile);
+    section = weston_config_get_section(ec->config, "ivi-shell", NULL, NULL);
+    weston_config_section_get_uint(section, "controller-object-quota",
+                                   &shell->client_object_quota, 0);
+    weston_config_section_get_uint(section, "controller-backlog-limit",
+                                   &shell->client_backlog_limit,
+                                   DEFAULT_CLIENT_BACKLOG_LIMIT);
+    weston_config_section_get_bool(section, "controller-profiling",
+                                   &shell->profiler.enabled, 0);
+    if (ivi_id_index_init(&shell->native_handles) != 0) {
+        weston_log("no memory to allocate native handle index\n");
+        return -1;
+    }
+    shell->event_rate_timer = wl_event_loop_add_timer(
+                                  wl_display_get_event_loop(ec->wl_display),
+                                  event_rate_timer_handler, shell);
+    if (shell->event_rate_timer == NULL) {
+        weston_log("failed to create the event rate timer\n");
+        return -1;
+    }
+
+    /* nothing fails from here on, which keeps the sources below out of
+     * the cleanup of module_init */
+    shell->dump_source = wl_event_loop_add_signal(
+                             wl_display_get_event_loop(ec->wl_display),
+                             SIGUSR2, dump_controller_objects, shell);
+    shell->profile_dump_source = wl_event_loop_add_signal(
+                                     wl_display_get_event_loop(ec->wl_display),
+                                     PROFILE_DUMP_SIGNAL,
+                                     dump_controller_profile, shell);
+    shell->profile_reset_source = wl_event_loop_add_signal(
+                                      wl_display_get_event_loop(ec->wl_display),
+                                      PROFILE_RESET_SIGNAL,
+                                      reset_controller_profile, shell);
+    weston_config_section_get_string(section, "journal", &journal_file, NULL);
+    weston_config_section_get_uint(section, "journal-size", &journal_size,
+                                   DEFAULT_JOURNAL_SIZE);
+    if (journal_file != NULL) {
+        shell->journal = ivi_journal_create(journal_file, journal_size);
+        if (shell->journal == NULL) {
+            weston_log("failed to create the controller journal %s\n",
+                       journal_file);
+        }
+        free(journal_file);
+    }
+    if (shell->journal != NULL) {
+        shell->journal_flush_timer = wl_event_loop_add_timer(
+                                     wl_display_get_event_loop(ec->wl_display),
+                                     journal_flush_handler, shell);
+        if (shell->journal_flush_timer == NULL) {
+            weston_log("failed to create the journal flush timer\n");
+            ivi_journal_destroy(shell->journal);
+            shell->journal = NULL;
+        }
+    }
+    wl_list_init(&shell->list_native_handle_watch);
+
     wl_list_for_each(output, &ec->output_list, link) {
         iviscrn = create_screen(shell, output);
         if (iviscrn != NULL) {
-            wl_list_insert(&shell->list_screen, &iviscrn->link);
+            /* screens are listed in the order of the outputs */
+            wl_list_insert(shell->list_screen.prev, &iviscrn->link);
         }
     }
 
@@ -1635,6 +7056,18 @@ init_ivi_shell(struct weston_compositor *ec, struct ivishell *shell)
     weston_layout_setNotificationCreateSurface(surface_event_create, shell);
     weston_layout_setNotificationRemoveSurface(surface_event_remove, shell);
     weston_layout_setNotificationConfigureSurface(surface_event_configure, shell);
+
+    index_shell_surfaces(shell);
+    ivi_shell_set_notification_create_shell_surface(shell_surface_event_create,
+                                                    shell);
+    ivi_shell_set_notification_remove_shell_surface(shell_surface_event_remove,
+                                                    shell);
+    ivi_shell_set_notification_change_shell_surface(shell_surface_event_change,
+                                                    shell);
+
+    load_preload_scene(shell);
+
+    return 0;
 }
 
 WL_EXPORT int
@@ -1642,6 +7075,7 @@ module_init(struct weston_compositor *ec,
             int *argc, char *argv[])
 {
     struct ivishell *shell;
+    struct wl_global *global = NULL;
     (void)argc;
     (void)argv;
 
@@ -1650,12 +7084,32 @@ module_init(struct weston_compositor *ec,
         return -1;
 
     memset(shell, 0, sizeof *shell);
-    init_ivi_shell(ec, shell);
 
-    if (wl_global_create(ec->wl_display, &ivi_controller_interface, 1,
-                         shell, bind_ivi_controller) == NULL) {
+    /* controllers can not bind before the event loop runs, so the global
+     * is created first and removed if the shell fails */
+    global = wl_global_create(ec->wl_display, &ivi_controller_interface, 13,
+                              shell, bind_ivi_controller);
+    if (global == NULL) {
+        free(shell);
+        return -1;
+    }
+
+    if (init_ivi_shell(ec, shell) != 0) {
+        wl_global_destroy(global);
+        if (shell->image_writer != NULL) {
+            ivi_image_writer_destroy(shell->image_writer);
+        }
+        ivi_id_index_release(&shell->controller_layers);
+        ivi_id_index_release(&shell->controller_surfaces);
+        ivi_id_index_release(&shell->layers);
+        ivi_id_index_release(&shell->surfaces);
+        ivi_id_index_release(&shell->native_handles);
+        free(shell);
         return -1;
     }
 
+    shell->destroy_listener.notify = shell_destroy;
+    wl_signal_add(&ec->destroy_signal, &shell->destroy_listener);
+
     return 0;
 }
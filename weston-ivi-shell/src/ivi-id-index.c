@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include <stdlib.h>
+
+#include "ivi-id-index.h"
+
+#define IVI_ID_INDEX_MIN_BITS 6
+
+static uint32_t
+hash_id(uint32_t id, uint32_t bits)
+{
+    /* Fibonacci hashing, ids are often allocated in sequence */
+    return (id * 2654435761u) >> (32 - bits);
+}
+
+static struct wl_list *
+alloc_buckets(uint32_t bits)
+{
+    struct wl_list *buckets = NULL;
+    uint32_t i = 0;
+
+    buckets = calloc(1u << bits, sizeof *buckets);
+    if (buckets == NULL) {
+        return NULL;
+    }
+
+    for (i = 0; i < (1u << bits); i++) {
+        wl_list_init(&buckets[i]);
+    }
+
+    return buckets;
+}
+
+static struct ivi_id_entry *
+find_entry(struct ivi_id_index *index, uint32_t id)
+{
+    struct ivi_id_entry *entry = NULL;
+
+    wl_list_for_each(entry, &index->buckets[hash_id(id, index->bits)], link) {
+        if (entry->id == id) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Double the number of buckets when there are more ids than buckets.
+ * The index keeps working with the old buckets if no memory is left.
+ */
+static void
+grow(struct ivi_id_index *index)
+{
+    struct wl_list *buckets = NULL;
+    struct ivi_id_entry *entry = NULL;
+    struct ivi_id_entry *next = NULL;
+    uint32_t bits = index->bits + 1;
+    uint32_t i = 0;
+
+    buckets = alloc_buckets(bits);
+    if (buckets == NULL) {
+        return;
+    }
+
+    for (i = 0; i < (1u << index->bits); i++) {
+        wl_list_for_each_safe(entry, next, &index->buckets[i], link) {
+            wl_list_remove(&entry->link);
+            wl_list_insert(&buckets[hash_id(entry->id, bits)], &entry->link);
+        }
+    }
+
+    free(index->buckets);
+    index->buckets = buckets;
+    index->bits = bits;
+}
+
+int
+ivi_id_index_init(struct ivi_id_index *index)
+{
+    index->bits = IVI_ID_INDEX_MIN_BITS;
+    index->count = 0;
+    index->buckets = alloc_buckets(index->bits);
+    wl_list_init(&index->empty);
+
+    return (index->buckets != NULL) ? 0 : -1;
+}
+
+void
+ivi_id_index_release(struct ivi_id_index *index)
+{
+    struct ivi_id_entry *entry = NULL;
+    struct ivi_id_entry *next = NULL;
+    uint32_t i = 0;
+
+    if (index->buckets == NULL) {
+        return;
+    }
+
+    /* objects still linked are left to their owners */
+    for (i = 0; i < (1u << index->bits); i++) {
+        wl_list_for_each_safe(entry, next, &index->buckets[i], link) {
+            wl_list_remove(&entry->list);
+            free(entry);
+        }
+    }
+
+    free(index->buckets);
+    index->buckets = NULL;
+    index->count = 0;
+}
+
+struct wl_list *
+ivi_id_index_find(struct ivi_id_index *index, uint32_t id)
+{
+    struct ivi_id_entry *entry = find_entry(index, id);
+
+    return (entry != NULL) ? &entry->list : &index->empty;
+}
+
+int
+ivi_id_index_insert(struct ivi_id_index *index, uint32_t id,
+                    struct wl_list *link)
+{
+    struct ivi_id_entry *entry = find_entry(index, id);
+
+    if (entry == NULL) {
+        entry = calloc(1, sizeof *entry);
+        if (entry == NULL) {
+            wl_list_init(link);
+            return -1;
+        }
+
+        entry->id = id;
+        wl_list_init(&entry->list);
+        wl_list_insert(&index->buckets[hash_id(id, index->bits)],
+                       &entry->link);
+
+        index->count++;
+        if (index->count > (1u << index->bits)) {
+            grow(index);
+        }
+    }
+
+    wl_list_insert(entry->list.prev, link);
+    return 0;
+}
+
+void
+ivi_id_index_remove(struct ivi_id_index *index, uint32_t id,
+                    struct wl_list *link)
+{
+    struct ivi_id_entry *entry = NULL;
+
+    wl_list_remove(link);
+    wl_list_init(link);
+
+    entry = find_entry(index, id);
+    if ((entry == NULL) || !wl_list_empty(&entry->list)) {
+        return;
+    }
+
+    wl_list_remove(&entry->link);
+    free(entry);
+    index->count--;
+}
@@ -0,0 +1,462 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cairo.h>
+#if defined(__i386__) || defined(__x86_64__)
+#include <tmmintrin.h>
+#define HAVE_SSSE3_SWIZZLE 1
+#endif
+
+#include "ivi-image-format.h"
+
+#define RAW_MAGIC 0x41524742 /* "BGRA" */
+
+/* slack for the 16 byte stores of the swizzles */
+#define ROW_SLACK 16
+
+#define QOI_OP_INDEX 0x00
+#define QOI_OP_DIFF  0x40
+#define QOI_OP_LUMA  0x80
+#define QOI_OP_RUN   0xc0
+#define QOI_OP_RGB   0xfe
+#define QOI_OP_RGBA  0xff
+
+#define IS_LITTLE_ENDIAN (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+
+#ifdef HAVE_SSSE3_SWIZZLE
+/*
+ * Shuffles of 4 pixels at a time, built for SSSE3 regardless of the flags
+ * of the compiler and only called if the processor supports it. They
+ * return the number of pixels converted, the rest is left to the portable
+ * loops.
+ */
+__attribute__((target("ssse3")))
+static int32_t
+swizzle_to_rgba_ssse3(const uint32_t *src, uint8_t *dst, int32_t count)
+{
+    const __m128i mask = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7,
+                                       10, 9, 8, 11, 14, 13, 12, 15);
+    int32_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)&src[i]);
+        _mm_storeu_si128((__m128i *)&dst[i * 4], _mm_shuffle_epi8(v, mask));
+    }
+
+    return i;
+}
+
+/*
+ * 4 pixels are packed into 12 bytes, the store writes 4 more bytes which
+ * are overwritten by the next pixels or lie in the slack.
+ */
+__attribute__((target("ssse3")))
+static int32_t
+swizzle_to_rgb_ssse3(const uint32_t *src, uint8_t *dst, int32_t count)
+{
+    const __m128i mask = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9,
+                                       8, 14, 13, 12, -1, -1, -1, -1);
+    int32_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)&src[i]);
+        _mm_storeu_si128((__m128i *)&dst[i * 3], _mm_shuffle_epi8(v, mask));
+    }
+
+    return i;
+}
+#endif
+
+/*
+ * The swizzles convert count ARGB32 pixels of a row into bytes in the
+ * order of the file format. Rows of cairo images are 4 byte aligned.
+ */
+static void
+swizzle_to_bgra(const uint32_t *src, uint8_t *dst, int32_t count)
+{
+    int32_t i = 0;
+
+    if (IS_LITTLE_ENDIAN) {
+        memcpy(dst, src, (size_t)count * 4);
+        return;
+    }
+
+    for (i = 0; i < count; i++) {
+        dst[i * 4 + 0] = (uint8_t)(src[i]);
+        dst[i * 4 + 1] = (uint8_t)(src[i] >> 8);
+        dst[i * 4 + 2] = (uint8_t)(src[i] >> 16);
+        dst[i * 4 + 3] = (uint8_t)(src[i] >> 24);
+    }
+}
+
+static void
+swizzle_to_rgba(const uint32_t *src, uint8_t *dst, int32_t count)
+{
+    int32_t i = 0;
+    uint32_t pixel = 0;
+
+#ifdef HAVE_SSSE3_SWIZZLE
+    if (__builtin_cpu_supports("ssse3")) {
+        i = swizzle_to_rgba_ssse3(src, dst, count);
+    }
+#endif
+
+    if (IS_LITTLE_ENDIAN) {
+        /* swap red and blue in place of the word, vectorized by the
+         * compiler */
+        for (; i < count; i++) {
+            pixel = src[i];
+            pixel = (pixel & 0xff00ff00) |
+                    ((pixel >> 16) & 0xff) | ((pixel & 0xff) << 16);
+            memcpy(&dst[i * 4], &pixel, 4);
+        }
+        return;
+    }
+
+    for (; i < count; i++) {
+        dst[i * 4 + 0] = (uint8_t)(src[i] >> 16);
+        dst[i * 4 + 1] = (uint8_t)(src[i] >> 8);
+        dst[i * 4 + 2] = (uint8_t)(src[i]);
+        dst[i * 4 + 3] = (uint8_t)(src[i] >> 24);
+    }
+}
+
+static void
+swizzle_to_rgb(const uint32_t *src, uint8_t *dst, int32_t count)
+{
+    int32_t i = 0;
+
+#ifdef HAVE_SSSE3_SWIZZLE
+    if (__builtin_cpu_supports("ssse3")) {
+        i = swizzle_to_rgb_ssse3(src, dst, count);
+    }
+#endif
+
+    for (; i < count; i++) {
+        dst[i * 3 + 0] = (uint8_t)(src[i] >> 16);
+        dst[i * 3 + 1] = (uint8_t)(src[i] >> 8);
+        dst[i * 3 + 2] = (uint8_t)(src[i]);
+    }
+}
+
+static void
+put_uint32_le(uint8_t *dst, uint32_t value)
+{
+    dst[0] = (uint8_t)(value);
+    dst[1] = (uint8_t)(value >> 8);
+    dst[2] = (uint8_t)(value >> 16);
+    dst[3] = (uint8_t)(value >> 24);
+}
+
+static void
+put_uint32_be(uint8_t *dst, uint32_t value)
+{
+    dst[0] = (uint8_t)(value >> 24);
+    dst[1] = (uint8_t)(value >> 16);
+    dst[2] = (uint8_t)(value >> 8);
+    dst[3] = (uint8_t)(value);
+}
+
+/*
+ * Write the header and each row converted by the swizzle into bpp bytes
+ * per pixel.
+ */
+static int32_t
+write_rows(const struct ivi_image *image, FILE *fp,
+           const uint8_t *header, size_t header_size,
+           void (*swizzle)(const uint32_t *, uint8_t *, int32_t),
+           int32_t bpp)
+{
+    size_t row_size = (size_t)image->width * (size_t)bpp;
+    uint8_t *row = NULL;
+    int32_t y = 0;
+    int32_t ret = 0;
+
+    if (fwrite(header, 1, header_size, fp) != header_size) {
+        return -1;
+    }
+
+    row = malloc(row_size + ROW_SLACK);
+    if (row == NULL) {
+        return -1;
+    }
+
+    for (y = 0; y < image->height; y++) {
+        swizzle((const uint32_t *)(image->data + y * image->stride),
+                row, image->width);
+        if (fwrite(row, 1, row_size, fp) != row_size) {
+            ret = -1;
+            break;
+        }
+    }
+
+    free(row);
+    return ret;
+}
+
+static int32_t
+write_raw(const struct ivi_image *image, FILE *fp)
+{
+    uint8_t header[16];
+
+    put_uint32_le(&header[0], RAW_MAGIC);
+    put_uint32_le(&header[4], (uint32_t)image->width);
+    put_uint32_le(&header[8], (uint32_t)image->height);
+    put_uint32_le(&header[12], (uint32_t)image->width * 4);
+
+    return write_rows(image, fp, header, sizeof header, swizzle_to_bgra, 4);
+}
+
+static int32_t
+write_ppm(const struct ivi_image *image, FILE *fp)
+{
+    char header[64];
+    int length = 0;
+
+    length = snprintf(header, sizeof header, "P6\n%d %d\n255\n",
+                      image->width, image->height);
+
+    return write_rows(image, fp, (const uint8_t *)header, (size_t)length,
+                      swizzle_to_rgb, 3);
+}
+
+static int32_t
+write_pam(const struct ivi_image *image, FILE *fp)
+{
+    char header[128];
+    int length = 0;
+
+    length = snprintf(header, sizeof header,
+                      "P7\nWIDTH %d\nHEIGHT %d\nDEPTH 4\nMAXVAL 255\n"
+                      "TUPLTYPE RGB_ALPHA\nENDHDR\n",
+                      image->width, image->height);
+
+    return write_rows(image, fp, (const uint8_t *)header, (size_t)length,
+                      swizzle_to_rgba, 4);
+}
+
+/*
+ * Encoder of the "Quite OK Image Format", see https://qoiformat.org.
+ * Pixels are handled as RGBA bytes, the index holds previously seen
+ * pixels by their hash.
+ */
+struct qoi_encoder {
+    uint8_t index[64][4];
+    uint8_t prev[4];
+    uint32_t run;
+    uint8_t *out;
+    size_t size;
+};
+
+static void
+qoi_flush_run(struct qoi_encoder *qoi)
+{
+    if (qoi->run > 0) {
+        qoi->out[qoi->size++] = QOI_OP_RUN | (uint8_t)(qoi->run - 1);
+        qoi->run = 0;
+    }
+}
+
+static void
+qoi_encode_pixel(struct qoi_encoder *qoi, const uint8_t *px)
+{
+    uint32_t hash = 0;
+    int vr = 0;
+    int vg = 0;
+    int vb = 0;
+    int vg_r = 0;
+    int vg_b = 0;
+
+    if (memcmp(px, qoi->prev, 4) == 0) {
+        qoi->run++;
+        if (qoi->run == 62) {
+            qoi_flush_run(qoi);
+        }
+        return;
+    }
+    qoi_flush_run(qoi);
+
+    hash = (px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64;
+    if (memcmp(qoi->index[hash], px, 4) == 0) {
+        qoi->out[qoi->size++] = QOI_OP_INDEX | (uint8_t)hash;
+        memcpy(qoi->prev, px, 4);
+        return;
+    }
+    memcpy(qoi->index[hash], px, 4);
+
+    if (px[3] != qoi->prev[3]) {
+        qoi->out[qoi->size++] = QOI_OP_RGBA;
+        memcpy(&qoi->out[qoi->size], px, 4);
+        qoi->size += 4;
+        memcpy(qoi->prev, px, 4);
+        return;
+    }
+
+    vr = (int8_t)(px[0] - qoi->prev[0]);
+    vg = (int8_t)(px[1] - qoi->prev[1]);
+    vb = (int8_t)(px[2] - qoi->prev[2]);
+    vg_r = vr - vg;
+    vg_b = vb - vg;
+
+    if ((vr > -3) && (vr < 2) && (vg > -3) && (vg < 2) &&
+        (vb > -3) && (vb < 2)) {
+        qoi->out[qoi->size++] = QOI_OP_DIFF | (uint8_t)((vr + 2) << 4) |
+                                (uint8_t)((vg + 2) << 2) | (uint8_t)(vb + 2);
+    } else if ((vg_r > -9) && (vg_r < 8) && (vg > -33) && (vg < 32) &&
+               (vg_b > -9) && (vg_b < 8)) {
+        qoi->out[qoi->size++] = QOI_OP_LUMA | (uint8_t)(vg + 32);
+        qoi->out[qoi->size++] = (uint8_t)((vg_r + 8) << 4) |
+                                (uint8_t)(vg_b + 8);
+    } else {
+        qoi->out[qoi->size++] = QOI_OP_RGB;
+        memcpy(&qoi->out[qoi->size], px, 3);
+        qoi->size += 3;
+    }
+    memcpy(qoi->prev, px, 4);
+}
+
+static int32_t
+write_qoi(const struct ivi_image *image, FILE *fp)
+{
+    static const uint8_t end_marker[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+    struct qoi_encoder qoi;
+    uint8_t header[14];
+    uint8_t *row = NULL;
+    int32_t x = 0;
+    int32_t y = 0;
+    int32_t ret = 0;
+
+    memcpy(header, "qoif", 4);
+    put_uint32_be(&header[4], (uint32_t)image->width);
+    put_uint32_be(&header[8], (uint32_t)image->height);
+    header[12] = 4; /* RGBA */
+    header[13] = 0; /* sRGB with linear alpha */
+    if (fwrite(header, 1, sizeof header, fp) != sizeof header) {
+        return -1;
+    }
+
+    memset(&qoi, 0, sizeof qoi);
+    qoi.prev[3] = 255;
+
+    /* a row takes at most 5 bytes per pixel */
+    row = malloc((size_t)image->width * 4 + ROW_SLACK);
+    qoi.out = malloc((size_t)image->width * 5 + 1);
+    if ((row == NULL) || (qoi.out == NULL)) {
+        free(row);
+        free(qoi.out);
+        return -1;
+    }
+
+    for (y = 0; y < image->height; y++) {
+        swizzle_to_rgba((const uint32_t *)(image->data + y * image->stride),
+                        row, image->width);
+
+        qoi.size = 0;
+        for (x = 0; x < image->width; x++) {
+            qoi_encode_pixel(&qoi, &row[x * 4]);
+        }
+        if (y == image->height - 1) {
+            qoi_flush_run(&qoi);
+        }
+
+        if (fwrite(qoi.out, 1, qoi.size, fp) != qoi.size) {
+            ret = -1;
+            break;
+        }
+    }
+
+    if ((ret == 0) &&
+        (fwrite(end_marker, 1, sizeof end_marker, fp) != sizeof end_marker)) {
+        ret = -1;
+    }
+
+    free(row);
+    free(qoi.out);
+    return ret;
+}
+
+static int32_t
+write_png(const struct ivi_image *image, const char *filename)
+{
+    cairo_surface_t *surface = NULL;
+    cairo_status_t status = CAIRO_STATUS_SUCCESS;
+
+    surface = cairo_image_surface_create_for_data(image->data,
+                                                  CAIRO_FORMAT_ARGB32,
+                                                  image->width,
+                                                  image->height,
+                                                  image->stride);
+    status = cairo_surface_write_to_png(surface, filename);
+    cairo_surface_destroy(surface);
+
+    return (status == CAIRO_STATUS_SUCCESS) ? 0 : -1;
+}
+
+int
+ivi_image_format_is_valid(uint32_t format)
+{
+    return format <= IVI_IMAGE_FORMAT_QOI;
+}
+
+int32_t
+ivi_image_write_file(const struct ivi_image *image, const char *filename,
+                     enum ivi_image_format format)
+{
+    FILE *fp = NULL;
+    int32_t ret = -1;
+
+    if (format == IVI_IMAGE_FORMAT_PNG) {
+        return write_png(image, filename);
+    }
+
+    fp = fopen(filename, "wb");
+    if (fp == NULL) {
+        return -1;
+    }
+
+    switch (format) {
+    case IVI_IMAGE_FORMAT_RAW:
+        ret = write_raw(image, fp);
+        break;
+    case IVI_IMAGE_FORMAT_PPM:
+        ret = write_ppm(image, fp);
+        break;
+    case IVI_IMAGE_FORMAT_PAM:
+        ret = write_pam(image, fp);
+        break;
+    case IVI_IMAGE_FORMAT_QOI:
+        ret = write_qoi(image, fp);
+        break;
+    default:
+        break;
+    }
+
+    if (fclose(fp) != 0) {
+        ret = -1;
+    }
+
+    return ret;
+}
@@ -0,0 +1,344 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+
+#include "ivi-image-writer.h"
+
+#define IVI_IMAGE_WRITER_THREADS 2
+#define IVI_IMAGE_POOL_SIZE 4
+/* writes not reported yet, each holding an image of an output area */
+#define IVI_IMAGE_WRITER_MAX_JOBS 16
+
+struct ivi_image_job {
+    struct ivi_image *image;
+    char *filename;
+    enum ivi_image_format format;
+    int32_t result;
+    /* NULL after the job was cancelled, main thread only */
+    ivi_image_written_func done;
+    void *data;
+    struct wl_list link;
+};
+
+struct ivi_image_writer {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    /* jobs waiting for a worker, and written jobs waiting to be reported */
+    struct wl_list list_queued;
+    struct wl_list list_finished;
+    int quit;
+
+    /* signalled by the workers when a job is finished */
+    int event_fd;
+    struct wl_event_source *source;
+
+    pthread_t threads[IVI_IMAGE_WRITER_THREADS];
+    uint32_t thread_count;
+
+    /* images not in use, main thread only */
+    struct wl_list list_image;
+    uint32_t image_count;
+    /* images handed out or written and not reported, main thread only */
+    uint32_t job_count;
+};
+
+static void
+finish_job(struct ivi_image_writer *writer, struct ivi_image_job *job)
+{
+    uint64_t count = 1;
+
+    pthread_mutex_lock(&writer->mutex);
+    wl_list_insert(writer->list_finished.prev, &job->link);
+    pthread_mutex_unlock(&writer->mutex);
+
+    if (write(writer->event_fd, &count, sizeof count) != sizeof count) {
+        /* the counter is already signalled */
+    }
+}
+
+static void *
+writer_thread(void *arg)
+{
+    struct ivi_image_writer *writer = arg;
+    struct ivi_image_job *job = NULL;
+
+    pthread_mutex_lock(&writer->mutex);
+    while (!writer->quit) {
+        if (wl_list_empty(&writer->list_queued)) {
+            pthread_cond_wait(&writer->cond, &writer->mutex);
+            continue;
+        }
+
+        job = wl_container_of(writer->list_queued.next, job, link);
+        wl_list_remove(&job->link);
+        pthread_mutex_unlock(&writer->mutex);
+
+        job->result = ivi_image_write_file(job->image, job->filename,
+                                           job->format);
+        finish_job(writer, job);
+
+        pthread_mutex_lock(&writer->mutex);
+    }
+    pthread_mutex_unlock(&writer->mutex);
+
+    return NULL;
+}
+
+static void
+report_job(struct ivi_image_writer *writer, struct ivi_image_job *job)
+{
+    if (job->done != NULL) {
+        job->done(job->data, job->result);
+    }
+
+    ivi_image_writer_put_image(writer, job->image);
+    free(job->filename);
+    free(job);
+}
+
+static int
+writer_dispatch(int fd, uint32_t mask, void *data)
+{
+    struct ivi_image_writer *writer = data;
+    struct ivi_image_job *job = NULL;
+    struct ivi_image_job *next = NULL;
+    struct wl_list list_finished;
+    uint64_t count = 0;
+    (void)mask;
+
+    if (read(fd, &count, sizeof count) != sizeof count) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&writer->mutex);
+    wl_list_init(&list_finished);
+    wl_list_insert_list(&list_finished, &writer->list_finished);
+    wl_list_init(&writer->list_finished);
+    pthread_mutex_unlock(&writer->mutex);
+
+    wl_list_for_each_safe(job, next, &list_finished, link) {
+        wl_list_remove(&job->link);
+        report_job(writer, job);
+    }
+
+    return 0;
+}
+
+struct ivi_image_writer *
+ivi_image_writer_create(struct wl_event_loop *loop)
+{
+    struct ivi_image_writer *writer = NULL;
+    uint32_t i = 0;
+
+    writer = calloc(1, sizeof *writer);
+    if (writer == NULL) {
+        return NULL;
+    }
+
+    pthread_mutex_init(&writer->mutex, NULL);
+    pthread_cond_init(&writer->cond, NULL);
+    wl_list_init(&writer->list_queued);
+    wl_list_init(&writer->list_finished);
+    wl_list_init(&writer->list_image);
+
+    writer->event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (writer->event_fd < 0) {
+        free(writer);
+        return NULL;
+    }
+
+    writer->source = wl_event_loop_add_fd(loop, writer->event_fd,
+                                          WL_EVENT_READABLE,
+                                          writer_dispatch, writer);
+    if (writer->source == NULL) {
+        close(writer->event_fd);
+        free(writer);
+        return NULL;
+    }
+
+    /* without any worker, images are written by the main thread */
+    for (i = 0; i < IVI_IMAGE_WRITER_THREADS; i++) {
+        if (pthread_create(&writer->threads[writer->thread_count], NULL,
+                           writer_thread, writer) == 0) {
+            writer->thread_count++;
+        }
+    }
+
+    return writer;
+}
+
+void
+ivi_image_writer_destroy(struct ivi_image_writer *writer)
+{
+    struct ivi_image_job *job = NULL;
+    struct ivi_image_job *next = NULL;
+    struct ivi_image *image = NULL;
+    struct ivi_image *next_image = NULL;
+    uint32_t i = 0;
+
+    pthread_mutex_lock(&writer->mutex);
+    writer->quit = 1;
+    pthread_cond_broadcast(&writer->cond);
+    pthread_mutex_unlock(&writer->mutex);
+
+    for (i = 0; i < writer->thread_count; i++) {
+        pthread_join(writer->threads[i], NULL);
+    }
+
+    wl_list_for_each_safe(job, next, &writer->list_queued, link) {
+        wl_list_remove(&job->link);
+        job->result = -1;
+        report_job(writer, job);
+    }
+
+    wl_list_for_each_safe(job, next, &writer->list_finished, link) {
+        wl_list_remove(&job->link);
+        report_job(writer, job);
+    }
+
+    wl_list_for_each_safe(image, next_image, &writer->list_image, link) {
+        free(image->data);
+        free(image);
+    }
+
+    wl_event_source_remove(writer->source);
+    close(writer->event_fd);
+    pthread_cond_destroy(&writer->cond);
+    pthread_mutex_destroy(&writer->mutex);
+    free(writer);
+}
+
+struct ivi_image *
+ivi_image_writer_get_image(struct ivi_image_writer *writer,
+                           int32_t width, int32_t height)
+{
+    struct ivi_image *image = NULL;
+    int32_t stride = 0;
+    size_t size = 0;
+
+    if ((width <= 0) || (height <= 0) ||
+        (writer->job_count >= IVI_IMAGE_WRITER_MAX_JOBS)) {
+        return NULL;
+    }
+
+    stride = width * 4;
+    size = (size_t)stride * (size_t)height;
+
+    wl_list_for_each(image, &writer->list_image, link) {
+        if (image->alloc >= size) {
+            wl_list_remove(&image->link);
+            writer->image_count--;
+            break;
+        }
+    }
+
+    if (&image->link == &writer->list_image) {
+        image = calloc(1, sizeof *image);
+        if (image == NULL) {
+            return NULL;
+        }
+
+        image->data = malloc(size);
+        if (image->data == NULL) {
+            free(image);
+            return NULL;
+        }
+        image->alloc = size;
+    }
+
+    wl_list_init(&image->link);
+    image->width = width;
+    image->height = height;
+    image->stride = stride;
+    writer->job_count++;
+
+    return image;
+}
+
+void
+ivi_image_writer_put_image(struct ivi_image_writer *writer,
+                           struct ivi_image *image)
+{
+    writer->job_count--;
+
+    if (writer->image_count >= IVI_IMAGE_POOL_SIZE) {
+        free(image->data);
+        free(image);
+        return;
+    }
+
+    wl_list_insert(&writer->list_image, &image->link);
+    writer->image_count++;
+}
+
+struct ivi_image_job *
+ivi_image_writer_write(struct ivi_image_writer *writer,
+                       struct ivi_image *image, const char *filename,
+                       enum ivi_image_format format,
+                       ivi_image_written_func done, void *data)
+{
+    struct ivi_image_job *job = NULL;
+
+    job = calloc(1, sizeof *job);
+    if (job == NULL) {
+        ivi_image_writer_put_image(writer, image);
+        return NULL;
+    }
+
+    job->filename = strdup(filename);
+    if (job->filename == NULL) {
+        ivi_image_writer_put_image(writer, image);
+        free(job);
+        return NULL;
+    }
+
+    job->image = image;
+    job->format = format;
+    job->done = done;
+    job->data = data;
+
+    if (writer->thread_count == 0) {
+        job->result = ivi_image_write_file(job->image, job->filename,
+                                           job->format);
+        finish_job(writer, job);
+        return job;
+    }
+
+    pthread_mutex_lock(&writer->mutex);
+    wl_list_insert(writer->list_queued.prev, &job->link);
+    pthread_cond_signal(&writer->cond);
+    pthread_mutex_unlock(&writer->mutex);
+
+    return job;
+}
+
+void
+ivi_image_job_cancel(struct ivi_image_job *job)
+{
+    job->done = NULL;
+}
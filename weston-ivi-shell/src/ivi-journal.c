@@ -0,0 +1,282 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <wayland-util.h>
+
+#include "ivi-journal.h"
+
+struct ivi_journal {
+    char *filename;
+    char *previous_filename;
+    FILE *file;
+    uint32_t max_size;
+    uint32_t size;
+    /* arguments of the record being written */
+    struct wl_array words;
+    int error;
+};
+
+static uint64_t
+get_time_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int
+open_file(struct ivi_journal *journal)
+{
+    uint32_t file_header[2] = {ILM_RECORD_MAGIC, ILM_RECORD_VERSION};
+
+    journal->file = fopen(journal->filename, "wb");
+    if (journal->file == NULL) {
+        return -1;
+    }
+
+    if (fwrite(file_header, sizeof file_header, 1, journal->file) != 1) {
+        fclose(journal->file);
+        journal->file = NULL;
+        return -1;
+    }
+    journal->size = sizeof file_header;
+
+    return 0;
+}
+
+/*
+ * The file stays open and keeps growing if it can not be renamed. If the
+ * new file can not be created, there is no file until the next attempt.
+ */
+static int
+rotate_file(struct ivi_journal *journal)
+{
+    if (rename(journal->filename, journal->previous_filename) != 0) {
+        return -1;
+    }
+
+    fclose(journal->file);
+    journal->file = NULL;
+
+    return open_file(journal);
+}
+
+struct ivi_journal *
+ivi_journal_create(const char *filename, uint32_t max_size)
+{
+    struct ivi_journal *journal = NULL;
+    size_t length = strlen(filename);
+
+    journal = calloc(1, sizeof *journal);
+    if (journal == NULL) {
+        return NULL;
+    }
+
+    journal->filename = strdup(filename);
+    journal->previous_filename = malloc(length + sizeof ".1");
+    if ((journal->filename == NULL) || (journal->previous_filename == NULL)) {
+        ivi_journal_destroy(journal);
+        return NULL;
+    }
+    memcpy(journal->previous_filename, filename, length);
+    memcpy(journal->previous_filename + length, ".1", sizeof ".1");
+
+    journal->max_size = max_size;
+    wl_array_init(&journal->words);
+
+    if (open_file(journal) != 0) {
+        ivi_journal_destroy(journal);
+        return NULL;
+    }
+
+    return journal;
+}
+
+void
+ivi_journal_flush(struct ivi_journal *journal)
+{
+    if (journal->file != NULL) {
+        fflush(journal->file);
+    }
+}
+
+void
+ivi_journal_destroy(struct ivi_journal *journal)
+{
+    if (journal->file != NULL) {
+        fclose(journal->file);
+    }
+
+    wl_array_release(&journal->words);
+    free(journal->previous_filename);
+    free(journal->filename);
+    free(journal);
+}
+
+static void
+put_word(struct ivi_journal *journal, uint32_t value)
+{
+    uint32_t *word = NULL;
+
+    word = wl_array_add(&journal->words, sizeof *word);
+    if (word == NULL) {
+        journal->error = 1;
+        return;
+    }
+
+    *word = value;
+}
+
+static void
+put_float(struct ivi_journal *journal, double value)
+{
+    uint32_t words[2];
+
+    memcpy(words, &value, sizeof words);
+    put_word(journal, words[0]);
+    put_word(journal, words[1]);
+}
+
+static void
+put_string(struct ivi_journal *journal, const char *string)
+{
+    uint32_t length = 0;
+    uint32_t word = 0;
+    uint32_t i = 0;
+
+    if (string != NULL) {
+        length = (uint32_t)strlen(string);
+    }
+
+    put_word(journal, length);
+    for (i = 0; i < length; i += sizeof word) {
+        word = 0;
+        memcpy(&word, string + i,
+               (length - i < sizeof word) ? length - i : sizeof word);
+        put_word(journal, word);
+    }
+}
+
+static void
+put_array(struct ivi_journal *journal, const struct wl_array *array)
+{
+    const uint32_t *value = NULL;
+
+    if (array == NULL) {
+        put_word(journal, 0);
+        return;
+    }
+
+    put_word(journal, (uint32_t)(array->size / sizeof *value));
+    wl_array_for_each(value, array) {
+        put_word(journal, *value);
+    }
+}
+
+int
+ivi_journal_vwrite(struct ivi_journal *journal, ilmRecordFunc func,
+                   uint16_t client, const char *signature, va_list ap)
+{
+    struct ilmRecordHeader header;
+    const char *type = NULL;
+    uint32_t record_size = 0;
+    int ret = 0;
+
+    if ((journal->file == NULL) && (open_file(journal) != 0)) {
+        return -1;
+    }
+
+    memset(&header, 0, sizeof header);
+    header.func = (unsigned short)func;
+    header.client = client;
+    header.result = ILM_SUCCESS;
+    header.timestamp = get_time_ns();
+
+    journal->words.size = 0;
+    journal->error = 0;
+
+    for (type = signature; *type != '\0'; type++) {
+        switch (*type) {
+        case 'u':
+            put_word(journal, va_arg(ap, uint32_t));
+            break;
+        case 'f':
+            put_float(journal, va_arg(ap, double));
+            break;
+        case 's':
+            put_string(journal, va_arg(ap, const char *));
+            break;
+        case 'a':
+            put_array(journal, va_arg(ap, const struct wl_array *));
+            break;
+        default:
+            journal->error = 1;
+            break;
+        }
+    }
+
+    if (journal->error) {
+        return -1;
+    }
+
+    header.size = (unsigned int)journal->words.size;
+    record_size = sizeof header + header.size;
+
+    if ((journal->size + record_size > journal->max_size) &&
+        (journal->size > 2 * sizeof(uint32_t)) &&
+        (rotate_file(journal) != 0)) {
+        ret = -1;
+        if (journal->file == NULL) {
+            return -1;
+        }
+    }
+
+    if ((fwrite(&header, sizeof header, 1, journal->file) != 1) ||
+        ((header.size > 0) &&
+         (fwrite(journal->words.data, header.size, 1, journal->file) != 1))) {
+        return -1;
+    }
+    journal->size += record_size;
+
+    return ret;
+}
+
+int
+ivi_journal_write(struct ivi_journal *journal, ilmRecordFunc func,
+                  uint16_t client, const char *signature, ...)
+{
+    va_list ap;
+    int ret = 0;
+
+    va_start(ap, signature);
+    ret = ivi_journal_vwrite(journal, func, client, signature, ap);
+    va_end(ap);
+
+    return ret;
+}
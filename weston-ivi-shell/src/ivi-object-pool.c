@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ivi-object-pool.h"
+
+#define IVI_OBJECT_SLAB_SIZE 32
+#define IVI_OBJECT_ALIGN 16
+#define ALIGN_SIZE(size) \
+    (((size) + IVI_OBJECT_ALIGN - 1) & ~(size_t)(IVI_OBJECT_ALIGN - 1))
+
+struct ivi_object_slab {
+    struct wl_list link;
+    struct ivi_object_chunk *free_list;
+    uint32_t live_count;
+};
+
+/* header in front of each object */
+struct ivi_object_chunk {
+    struct ivi_object_slab *slab;
+    /* next free chunk of the slab, while the chunk is free */
+    struct ivi_object_chunk *next;
+};
+
+#define SLAB_HEADER_SIZE ALIGN_SIZE(sizeof(struct ivi_object_slab))
+#define CHUNK_HEADER_SIZE ALIGN_SIZE(sizeof(struct ivi_object_chunk))
+
+static struct ivi_object_slab *
+create_slab(struct ivi_object_pool *pool)
+{
+    struct ivi_object_slab *slab = NULL;
+    struct ivi_object_chunk *chunk = NULL;
+    char *chunks = NULL;
+    uint32_t i = 0;
+
+    slab = malloc(SLAB_HEADER_SIZE + IVI_OBJECT_SLAB_SIZE * pool->chunk_size);
+    if (slab == NULL) {
+        return NULL;
+    }
+
+    slab->free_list = NULL;
+    slab->live_count = 0;
+
+    chunks = (char *)slab + SLAB_HEADER_SIZE;
+    for (i = IVI_OBJECT_SLAB_SIZE; i > 0; i--) {
+        chunk = (struct ivi_object_chunk *)(chunks + (i - 1) * pool->chunk_size);
+        chunk->slab = slab;
+        chunk->next = slab->free_list;
+        slab->free_list = chunk;
+    }
+
+    wl_list_insert(&pool->list_slab, &slab->link);
+    pool->slab_count++;
+
+    return slab;
+}
+
+void
+ivi_object_pool_init(struct ivi_object_pool *pool, size_t object_size)
+{
+    pool->chunk_size = CHUNK_HEADER_SIZE + ALIGN_SIZE(object_size);
+    wl_list_init(&pool->list_slab);
+    pool->slab_count = 0;
+    pool->live_count = 0;
+}
+
+void
+ivi_object_pool_release(struct ivi_object_pool *pool)
+{
+    struct ivi_object_slab *slab = NULL;
+    struct ivi_object_slab *next = NULL;
+
+    wl_list_for_each_safe(slab, next, &pool->list_slab, link) {
+        free(slab);
+    }
+
+    wl_list_init(&pool->list_slab);
+    pool->slab_count = 0;
+    pool->live_count = 0;
+}
+
+void *
+ivi_object_pool_alloc(struct ivi_object_pool *pool)
+{
+    struct ivi_object_slab *slab = NULL;
+    struct ivi_object_chunk *chunk = NULL;
+
+    if (!wl_list_empty(&pool->list_slab)) {
+        slab = wl_container_of(pool->list_slab.next, slab, link);
+    }
+
+    if ((slab == NULL) || (slab->free_list == NULL)) {
+        slab = create_slab(pool);
+        if (slab == NULL) {
+            return NULL;
+        }
+    }
+
+    chunk = slab->free_list;
+    slab->free_list = chunk->next;
+    slab->live_count++;
+    pool->live_count++;
+
+    /* full slabs go to the tail */
+    if (slab->free_list == NULL) {
+        wl_list_remove(&slab->link);
+        wl_list_insert(pool->list_slab.prev, &slab->link);
+    }
+
+    memset((char *)chunk + CHUNK_HEADER_SIZE, 0,
+           pool->chunk_size - CHUNK_HEADER_SIZE);
+
+    return (char *)chunk + CHUNK_HEADER_SIZE;
+}
+
+void
+ivi_object_pool_free(struct ivi_object_pool *pool, void *object)
+{
+    struct ivi_object_chunk *chunk = NULL;
+    struct ivi_object_slab *slab = NULL;
+
+    if (object == NULL) {
+        return;
+    }
+
+    chunk = (struct ivi_object_chunk *)((char *)object - CHUNK_HEADER_SIZE);
+    slab = chunk->slab;
+
+    chunk->next = slab->free_list;
+    slab->free_list = chunk;
+    slab->live_count--;
+    pool->live_count--;
+
+    wl_list_remove(&slab->link);
+    if ((slab->live_count == 0) && (pool->slab_count > 1)) {
+        free(slab);
+        pool->slab_count--;
+        return;
+    }
+
+    wl_list_insert(&pool->list_slab, &slab->link);
+}
+
+size_t
+ivi_object_pool_get_size(const struct ivi_object_pool *pool)
+{
+    return pool->slab_count *
+           (SLAB_HEADER_SIZE + IVI_OBJECT_SLAB_SIZE * pool->chunk_size);
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+
+#include <string.h>
+#include <time.h>
+
+#include "ivi-profile.h"
+
+void
+ivi_profiler_init(struct ivi_profiler *profiler)
+{
+    profiler->enabled = 0;
+    wl_array_init(&profiler->sites);
+}
+
+void
+ivi_profiler_release(struct ivi_profiler *profiler)
+{
+    struct ivi_profile_site **site = NULL;
+
+    /* the sites are static, they may be registered again */
+    wl_array_for_each(site, &profiler->sites) {
+        (*site)->index = 0;
+    }
+
+    wl_array_release(&profiler->sites);
+}
+
+uint32_t
+ivi_profiler_get_site_count(const struct ivi_profiler *profiler)
+{
+    return profiler->sites.size / sizeof(struct ivi_profile_site *);
+}
+
+const char *
+ivi_profiler_get_site_name(const struct ivi_profiler *profiler,
+                           uint32_t index)
+{
+    struct ivi_profile_site *const *sites = profiler->sites.data;
+
+    if (index >= ivi_profiler_get_site_count(profiler)) {
+        return NULL;
+    }
+
+    return sites[index]->name;
+}
+
+uint64_t
+ivi_profile_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+void
+ivi_profile_init(struct ivi_profile *profile)
+{
+    wl_array_init(&profile->stats);
+}
+
+void
+ivi_profile_release(struct ivi_profile *profile)
+{
+    wl_array_release(&profile->stats);
+}
+
+static uint32_t
+get_bucket(uint64_t duration_ns)
+{
+    uint64_t us = duration_ns / 1000;
+    uint32_t bucket = 0;
+
+    while ((us > 0) && (bucket < IVI_PROFILE_BUCKETS - 1)) {
+        us >>= 1;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+static int
+register_site(struct ivi_profiler *profiler, struct ivi_profile_site *site)
+{
+    struct ivi_profile_site **entry = NULL;
+
+    entry = wl_array_add(&profiler->sites, sizeof *entry);
+    if (entry == NULL) {
+        return -1;
+    }
+
+    *entry = site;
+    site->index = ivi_profiler_get_site_count(profiler);
+
+    return 0;
+}
+
+int
+ivi_profile_add(struct ivi_profiler *profiler, struct ivi_profile *profile,
+                struct ivi_profile_site *site, uint64_t duration_ns)
+{
+    struct ivi_profile_stats *stats = NULL;
+    size_t size = 0;
+    void *added = NULL;
+
+    if ((site->index == 0) && (register_site(profiler, site) != 0)) {
+        return -1;
+    }
+
+    size = site->index * sizeof *stats;
+    if (profile->stats.size < size) {
+        added = wl_array_add(&profile->stats, size - profile->stats.size);
+        if (added == NULL) {
+            return -1;
+        }
+        memset(added, 0, (char *)profile->stats.data + size - (char *)added);
+    }
+
+    stats = (struct ivi_profile_stats *)profile->stats.data +
+            (site->index - 1);
+    stats->count++;
+    stats->total_ns += duration_ns;
+    if (stats->max_ns < duration_ns) {
+        stats->max_ns = duration_ns;
+    }
+    stats->buckets[get_bucket(duration_ns)]++;
+
+    return 0;
+}
+
+const struct ivi_profile_stats *
+ivi_profile_get_stats(const struct ivi_profile *profile, uint32_t index)
+{
+    const struct ivi_profile_stats *stats = profile->stats.data;
+
+    if ((index + 1) * sizeof *stats > profile->stats.size) {
+        return NULL;
+    }
+
+    if (stats[index].count == 0) {
+        return NULL;
+    }
+
+    return &stats[index];
+}
+
+void
+ivi_profile_reset(struct ivi_profile *profile)
+{
+    if (profile->stats.size > 0) {
+        memset(profile->stats.data, 0, profile->stats.size);
+    }
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, distribute, and sell this software and
+ * its documentation for any purpose is hereby granted without fee, provided
+ * that the above copyright notice appear in all copies and that both that
+ * copyright notice and this permission notice appear in supporting
+ * documentation, and that the name of the copyright holders not be used in
+ * advertising or publicity pertaining to distribution of the software
+ * without specific, written prior permission.  The copyright holders make
+ * no representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ * THE COPYRIGHT HOLDERS DISCLAIM ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE, INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND
+ * FITNESS, IN NO EVENT SHALL THE COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * SPECIAL, INDIRECT OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER
+ * RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF
+ * CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN
+ * CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "ivi-scene-file.h"
+
+static int
+read_records(FILE *file, void **records, size_t size, uint32_t count)
+{
+    *records = NULL;
+    if (count == 0) {
+        return 0;
+    }
+
+    *records = calloc(count, size);
+    if (*records == NULL) {
+        return -1;
+    }
+
+    if (fread(*records, size, count, file) != count) {
+        free(*records);
+        *records = NULL;
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * Whether the counts of the header match the size of the file, so that
+ * no more records are allocated than the file contains.
+ */
+static int
+has_header_size(FILE *file, const struct ivi_scene_file_header *header)
+{
+    struct stat st;
+    uint64_t size = 0;
+
+    if (fstat(fileno(file), &st) != 0) {
+        return 0;
+    }
+
+    size = sizeof *header +
+           (uint64_t)header->layer_count *
+           sizeof(struct ivi_scene_file_layer) +
+           (uint64_t)header->rule_count * sizeof(struct ivi_scene_file_rule);
+
+    return (uint64_t)st.st_size == size;
+}
+
+int
+ivi_scene_file_load(const char *filename, struct ivi_scene *scene)
+{
+    struct ivi_scene_file_header header;
+    FILE *file = NULL;
+    int ret = -1;
+
+    memset(scene, 0, sizeof *scene);
+
+    file = fopen(filename, "rb");
+    if (file == NULL) {
+        return -1;
+    }
+
+    if ((fread(&header, sizeof header, 1, file) != 1) ||
+        (header.magic != IVI_SCENE_FILE_MAGIC) ||
+        (header.version != IVI_SCENE_FILE_VERSION) ||
+        !has_header_size(file, &header)) {
+        fclose(file);
+        return -1;
+    }
+
+    if ((read_records(file, (void **)&scene->layers,
+                      sizeof *scene->layers, header.layer_count) == 0) &&
+        (read_records(file, (void **)&scene->rules,
+                      sizeof *scene->rules, header.rule_count) == 0)) {
+        scene->layer_count = header.layer_count;
+        scene->rule_count = header.rule_count;
+        ret = 0;
+    }
+    fclose(file);
+
+    if (ret != 0) {
+        ivi_scene_release(scene);
+    }
+
+    return ret;
+}
+
+void
+ivi_scene_release(struct ivi_scene *scene)
+{
+    free(scene->layers);
+    free(scene->rules);
+    memset(scene, 0, sizeof *scene);
+}
+
+const struct ivi_scene_file_rule *
+ivi_scene_find_rule(const struct ivi_scene *scene, uint32_t id_surface)
+{
+    uint32_t i = 0;
+
+    for (i = 0; i < scene->rule_count; i++) {
+        if ((id_surface >= scene->rules[i].id_surface_min) &&
+            (id_surface <= scene->rules[i].id_surface_max)) {
+            return &scene->rules[i];
+        }
+    }
+
+    return NULL;
+}